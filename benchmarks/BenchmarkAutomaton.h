@@ -0,0 +1,104 @@
+#ifndef HYBRID_AUTOMATON_BENCHMARK_AUTOMATON_H_
+#define HYBRID_AUTOMATON_BENCHMARK_AUTOMATON_H_
+
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "hybrid_automaton/JointConfigurationSensor.h"
+#include "hybrid_automaton/ClockSensor.h"
+
+#include <sstream>
+
+// ----------------------------------
+// A PD controller on the joint configuration of a SimulatedSystem
+class BenchmarkControlSet : public ha::ControlSet {
+public:
+    BenchmarkControlSet(const ha::System::ConstPtr& system) : _system(system) {
+        setType("BenchmarkControlSet");
+    }
+
+    virtual void initialize() {}
+    virtual void terminate() {}
+
+    virtual ::Eigen::MatrixXd step(const double& t) {
+        ::Eigen::MatrixXd torque = ::Eigen::MatrixXd::Zero(_system->getDof(), 1);
+        const ::Eigen::MatrixXd q = _system->getJointConfiguration();
+        for (std::map<std::string, ha::Controller::Ptr>::const_iterator it = _controllers.begin(); it != _controllers.end(); ++it)
+            torque += 10.0 * (it->second->getGoal() - q) - 2.0 * _system->getJointVelocity();
+        return torque;
+    }
+
+    virtual void switchControlSet(ha::ControlSet::ConstPtr other_set) {}
+
+protected:
+    virtual ha::ControlSet* _doClone() const { return new BenchmarkControlSet(*this); }
+
+    ha::System::ConstPtr _system;
+};
+
+// ----------------------------------
+// modes mode_0 .. mode_<n-1>, each with fan_out switches to the following modes.
+// The joint conditions never become active; if period > 0 the first switch of each mode
+// is a relative ClockSensor condition that fires every period seconds.
+inline ha::HybridAutomaton::Ptr createBenchmarkAutomaton(const ha::System::ConstPtr& system, int num_modes, int fan_out, double period = 0.0) {
+    ha::HybridAutomaton::Ptr ha(new ha::HybridAutomaton);
+    ha->setName("benchmark");
+    const int dof = system->getDof();
+
+    for (int i = 0; i < num_modes; i++) {
+        std::ostringstream name;
+        name << "mode_" << i;
+
+        ha::Controller::Ptr controller(new ha::Controller);
+        controller->setName(name.str() + "_controller");
+        controller->setType("BenchmarkController");
+        controller->setGoal(::Eigen::MatrixXd::Constant(dof, 1, 0.1 * i));
+        controller->setKp(::Eigen::MatrixXd::Constant(dof, 1, 10.0));
+        controller->setKv(::Eigen::MatrixXd::Constant(dof, 1, 1.0));
+        controller->setCompletionTime(1.0);
+
+        ha::ControlSet::Ptr control_set(new BenchmarkControlSet(system));
+        control_set->setName(name.str() + "_control_set");
+        control_set->appendController(controller);
+
+        ha::ControlMode::Ptr mode(new ha::ControlMode(name.str()));
+        mode->setControlSet(control_set);
+        ha->addControlMode(mode);
+    }
+
+    for (int i = 0; i < num_modes; i++) {
+        for (int k = 0; k < fan_out; k++) {
+            std::ostringstream source, target, name;
+            source << "mode_" << i;
+            target << "mode_" << (i + 1 + k) % num_modes;
+            name << "switch_" << i << "_" << k;
+
+            ha::JumpCondition::Ptr jump_condition(new ha::JumpCondition);
+            if (period > 0.0 && k == 0) {
+                ha::Sensor::Ptr sensor(new ha::ClockSensor);
+                sensor->setSystem(system);
+                jump_condition->setSensor(sensor);
+                jump_condition->setConstantGoal(period);
+                jump_condition->setGoalRelative();
+                jump_condition->setJumpCriterion(ha::JumpCondition::THRESH_UPPER_BOUND);
+                jump_condition->setEpsilon(0.0);
+            } else {
+                ha::Sensor::Ptr sensor(new ha::JointConfigurationSensor);
+                sensor->setSystem(system);
+                jump_condition->setSensor(sensor);
+                jump_condition->setConstantGoal(::Eigen::MatrixXd::Constant(dof, 1, 10.0));
+                jump_condition->setJumpCriterion(ha::JumpCondition::NORM_L2);
+                jump_condition->setEpsilon(0.01);
+            }
+
+            ha::ControlSwitch::Ptr control_switch(new ha::ControlSwitch);
+            control_switch->setName(name.str());
+            control_switch->add(jump_condition);
+            ha->addControlSwitch(source.str(), control_switch, target.str());
+        }
+    }
+
+    ha->setCurrentControlMode("mode_0");
+    return ha;
+}
+
+#endif // HYBRID_AUTOMATON_BENCHMARK_AUTOMATON_H_
@@ -0,0 +1,5 @@
+#include <benchmark/benchmark.h>
+
+// Run with --benchmark_out=<file> --benchmark_out_format=json to compare results across commits
+// (e.g. with compare.py from the Google Benchmark tools).
+BENCHMARK_MAIN();
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkAutomaton.h"
+#include "hybrid_automaton/FrameOrientationSensor.h"
+#include "hybrid_automaton/FramePoseSensor.h"
+
+using namespace ha;
+
+// JumpCondition::isActive for every JumpCriterion; vector criteria use a joint sensor of dimension dof
+static void BM_JumpCriterion(benchmark::State& state) {
+    const JumpCondition::JumpCriterion criterion = (JumpCondition::JumpCriterion)state.range(0);
+    const int dof = state.range(1);
+
+    SimulatedSystem::Ptr system(new SimulatedSystem(dof));
+    system->setJointConfiguration(::Eigen::MatrixXd::Constant(dof, 1, 0.5));
+
+    Sensor::Ptr sensor;
+    ::Eigen::MatrixXd goal;
+    if (criterion == JumpCondition::NORM_ROTATION) {
+        sensor.reset(new FrameOrientationSensor("EE"));
+        goal = ::Eigen::MatrixXd::Identity(3, 3);
+    } else if (criterion == JumpCondition::NORM_TRANSFORM) {
+        sensor.reset(new FramePoseSensor("EE"));
+        goal = ::Eigen::MatrixXd::Identity(4, 4);
+    } else {
+        sensor.reset(new JointConfigurationSensor);
+        goal = ::Eigen::MatrixXd::Constant(dof, 1, 2.0);
+    }
+    sensor->setSystem(system);
+
+    JumpCondition::Ptr jump_condition(new JumpCondition);
+    jump_condition->setSensor(sensor);
+    jump_condition->setConstantGoal(goal);
+    jump_condition->setJumpCriterion(criterion);
+    jump_condition->setEpsilon(0.001);
+    jump_condition->initialize(0.0);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(jump_condition->isActive());
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void JumpCriterionArguments(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"criterion", "dof"});
+    const int vector_criteria[] = { JumpCondition::NORM_L1, JumpCondition::NORM_L2, JumpCondition::NORM_L_INF,
+                                    JumpCondition::THRESH_UPPER_BOUND, JumpCondition::THRESH_LOWER_BOUND };
+    const int dofs[] = { 1, 7, 32 };
+    for (int c = 0; c < 5; c++)
+        for (int d = 0; d < 3; d++)
+            b->Args({vector_criteria[c], dofs[d]});
+    b->Args({JumpCondition::NORM_ROTATION, 7});
+    b->Args({JumpCondition::NORM_TRANSFORM, 7});
+}
+BENCHMARK(BM_JumpCriterion)->Apply(JumpCriterionArguments);
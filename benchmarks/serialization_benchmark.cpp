@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkAutomaton.h"
+#include "hybrid_automaton/HybridAutomatonStringStream.h"
+#include "hybrid_automaton/DescriptionTreeXML.h"
+
+#include <string>
+
+using namespace ha;
+
+static std::string benchmarkXML(int num_modes, int fan_out) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    HybridAutomaton::Ptr ha = createBenchmarkAutomaton(system, num_modes, fan_out);
+    DescriptionTreeXML::Ptr tree(new DescriptionTreeXML);
+    DescriptionTreeNode::Ptr root = ha->serialize(tree);
+    tree->setRootNode(root);
+    return tree->writeTreeXML();
+}
+
+static void BM_StringStreamFormatMatrix(benchmark::State& state) {
+    const ::Eigen::MatrixXd m = ::Eigen::MatrixXd::Random(state.range(0), state.range(1));
+    for (auto _ : state) {
+        ha_stringstream ss;
+        ss << m;
+        benchmark::DoNotOptimize(ss.str());
+    }
+    state.SetItemsProcessed(state.iterations() * m.size());
+}
+BENCHMARK(BM_StringStreamFormatMatrix)->ArgNames({"rows", "cols"})->Args({7, 1})->Args({4, 4})->Args({32, 32});
+
+static void BM_StringStreamParseMatrix(benchmark::State& state) {
+    ha_stringstream out;
+    out << ::Eigen::MatrixXd::Random(state.range(0), state.range(1)).eval();
+    const std::string text = out.str();
+
+    ::Eigen::MatrixXd m;
+    for (auto _ : state) {
+        ha_stringstream ss(text);
+        ss >> m;
+        benchmark::DoNotOptimize(m.data());
+    }
+    state.SetItemsProcessed(state.iterations() * m.size());
+}
+BENCHMARK(BM_StringStreamParseMatrix)->ArgNames({"rows", "cols"})->Args({7, 1})->Args({4, 4})->Args({32, 32});
+
+static void BM_DescriptionTreeXMLParse(benchmark::State& state) {
+    const std::string xml = benchmarkXML(state.range(0), 4);
+    for (auto _ : state) {
+        DescriptionTreeXML tree(xml);
+        benchmark::DoNotOptimize(tree.getRootNode());
+    }
+    state.SetBytesProcessed(state.iterations() * xml.size());
+}
+BENCHMARK(BM_DescriptionTreeXMLParse)->ArgName("modes")->Arg(2)->Arg(16)->Arg(64);
+
+static void BM_DescriptionTreeXMLWrite(benchmark::State& state) {
+    DescriptionTreeXML tree(benchmarkXML(state.range(0), 4));
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        std::string xml = tree.writeTreeXML();
+        bytes += xml.size();
+        benchmark::DoNotOptimize(xml);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_DescriptionTreeXMLWrite)->ArgName("modes")->Arg(2)->Arg(16)->Arg(64);
+
+static void BM_HybridAutomatonDeserialize(benchmark::State& state) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    DescriptionTreeXML tree(benchmarkXML(state.range(0), 4));
+    for (auto _ : state) {
+        HybridAutomaton ha;
+        ha.setDeserializeDefaultEntities(true);
+        ha.deserialize(tree.getRootNode(), system);
+        benchmark::DoNotOptimize(ha.getCurrentControlMode());
+    }
+}
+BENCHMARK(BM_HybridAutomatonDeserialize)->ArgName("modes")->Arg(2)->Arg(16)->Arg(64);
+
+static void BM_HybridAutomatonSerialize(benchmark::State& state) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    HybridAutomaton::Ptr ha = createBenchmarkAutomaton(system, state.range(0), 4);
+    DescriptionTreeXML::Ptr tree(new DescriptionTreeXML);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ha->serialize(tree));
+}
+BENCHMARK(BM_HybridAutomatonSerialize)->ArgName("modes")->Arg(2)->Arg(16)->Arg(64);
+
+static void BM_HybridAutomatonClone(benchmark::State& state) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    HybridAutomaton::Ptr ha = createBenchmarkAutomaton(system, state.range(0), 4);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ha->clone());
+}
+BENCHMARK(BM_HybridAutomatonClone)->ArgName("modes")->Arg(2)->Arg(16)->Arg(64);
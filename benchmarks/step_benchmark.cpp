@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkAutomaton.h"
+
+using namespace ha;
+
+// HybridAutomaton::step without transitions over automata of varying size and fan-out
+static void BM_HybridAutomatonStep(benchmark::State& state) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    HybridAutomaton::Ptr ha = createBenchmarkAutomaton(system, state.range(0), state.range(1));
+    ha->initialize(0.0);
+
+    double t = 0.0;
+    for (auto _ : state) {
+        t += 0.001;
+        system->integrate(ha->step(t), 0.001);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HybridAutomatonStep)
+    ->ArgNames({"modes", "fan_out"})
+    ->Args({2, 1})->Args({8, 1})->Args({64, 1})
+    ->Args({8, 4})->Args({64, 4})->Args({64, 16});
+
+// HybridAutomaton::step with a transition every period ticks
+static void BM_HybridAutomatonStepWithTransitions(benchmark::State& state) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    HybridAutomaton::Ptr ha = createBenchmarkAutomaton(system, 8, 4, 0.001 * state.range(0));
+    ha->initialize(0.0);
+
+    double t = 0.0;
+    for (auto _ : state) {
+        t += 0.001;
+        system->integrate(ha->step(t), 0.001);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HybridAutomatonStepWithTransitions)->ArgName("period")->Arg(1)->Arg(10)->Arg(100);
+
+// ControlSwitch::step + isActive with a growing number of jump conditions - only the last one is never active,
+// so all of them are evaluated
+static void BM_ControlSwitchIsActive(benchmark::State& state) {
+    SimulatedSystem::Ptr system(new SimulatedSystem);
+    ControlSwitch::Ptr control_switch(new ControlSwitch);
+    for (int i = 0; i < state.range(0); i++) {
+        Sensor::Ptr sensor(new JointConfigurationSensor);
+        sensor->setSystem(system);
+        JumpCondition::Ptr jump_condition(new JumpCondition);
+        jump_condition->setSensor(sensor);
+        jump_condition->setConstantGoal(::Eigen::MatrixXd::Zero(system->getDof(), 1));
+        jump_condition->setJumpCriterion(JumpCondition::NORM_L_INF);
+        jump_condition->setEpsilon((i + 1 < state.range(0)) ? 10.0 : -1.0);
+        control_switch->add(jump_condition);
+    }
+    control_switch->initialize(0.0);
+
+    double t = 0.0;
+    for (auto _ : state) {
+        t += 0.001;
+        control_switch->step(t);
+        benchmark::DoNotOptimize(control_switch->isActive());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ControlSwitchIsActive)->ArgName("conditions")->Arg(1)->Arg(4)->Arg(16);
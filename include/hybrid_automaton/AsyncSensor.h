@@ -0,0 +1,194 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_ASYNC_SENSOR_H_
+#define HYBRID_AUTOMATON_ASYNC_SENSOR_H_
+
+#include "hybrid_automaton/Sensor.h"
+#include "hybrid_automaton/SensorSource.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class AsyncSensor;
+	typedef boost::shared_ptr<AsyncSensor> AsyncSensorPtr;
+	typedef boost::shared_ptr<const AsyncSensor> AsyncSensorConstPtr;
+
+	/**
+	 * @brief The latest sample of a SensorSource that is fed by another thread
+	 *
+	 * The source is looked up by name with System::getSensorSource() in initialize(). step() fetches the
+	 * latest sample from the source's mailbox without waiting or allocating, so the sensor can be read on
+	 * the control thread while e.g. a tracker publishes poses at its own rate. The mailbox is fetched once
+	 * per control cycle (SensorSource::fetchForCycle()), so any number of sensors can read the same source.
+	 * Subscribing to the producer is left to the source (see SensorSourceSubscriber) and never done from here.
+	 *
+	 * The sensor is inactive until the first sample arrived; its initial value is the first sample.
+	 *
+	 * Samples carry the time stamp of the producer, minus a known pipeline "latency" if the producer
+	 * stamps them on arrival. Attributes in the description tree:
+	 * - max_age: the sensor becomes inactive (its JumpConditions report unknown) while the latest sample
+	 *   is older than this many seconds, 0 (default) never
+	 * - latency: seconds between acquisition and the time stamp of a sample (default 0)
+	 * - extrapolate: extrapolate the latest sample to the time of the control cycle with the velocity
+	 *   between the last two samples (default false) - poses (4x4) along their twist, other values entry
+	 *   by entry
+	 *
+	 * @code
+	 *   <Sensor type="AsyncSensor" source="marker_pose" max_age="0.1" latency="0.03" extrapolate="1"/>
+	 * @endcode
+	 */
+	class AsyncSensor : public Sensor
+	{
+	public:
+
+		typedef boost::shared_ptr<AsyncSensor> Ptr;
+		typedef boost::shared_ptr<const AsyncSensor> ConstPtr;
+
+		AsyncSensor();
+
+		AsyncSensor(const std::string& source_name);
+
+		virtual ~AsyncSensor();
+
+		AsyncSensor(const AsyncSensor& ss);
+
+		AsyncSensorPtr clone() const
+		{
+			return (AsyncSensorPtr(_doClone()));
+		}
+
+		virtual void setSourceName(const std::string& source_name);
+
+		virtual const std::string& getSourceName() const;
+
+		/**
+		 * @brief The source found in initialize() (NULL before)
+		 */
+		virtual SensorSource::Ptr getSource() const;
+
+		/**
+		 * @brief Samples older than \a max_age seconds make the sensor inactive, 0 disables the limit
+		 */
+		virtual void setMaxAge(double max_age);
+		virtual double getMaxAge() const;
+
+		/**
+		 * @brief Seconds between the acquisition of a sample and its time stamp
+		 */
+		virtual void setLatency(double latency);
+		virtual double getLatency() const;
+
+		/**
+		 * @brief Extrapolate the latest sample to the time of the control cycle
+		 */
+		virtual void setExtrapolate(bool extrapolate);
+		virtual bool isExtrapolating() const;
+
+		/**
+		 * @brief Acquisition time of the latest sample: its time stamp minus the latency
+		 */
+		virtual bool getSampleTime(double& time) const;
+
+		/**
+		 * @brief True if the latest sample is older than the max age
+		 */
+		virtual bool isStale() const;
+
+		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
+
+		virtual void setSystem(const System::ConstPtr& system);
+
+		/**
+		 * @brief Look up the source - throws if the System does not know it
+		 */
+		virtual void initialize(const double& t);
+
+		/**
+		 * @brief Fetch the latest sample and extrapolate it to \a t
+		 */
+		virtual void step(const double& t);
+
+		/**
+		 * @brief True once a sample arrived and as long as it is not stale
+		 */
+		virtual bool isActive() const;
+
+		/**
+		 * @brief True if the last step() fetched a new sample, always true while the value is extrapolated
+		 */
+		virtual bool hasNewValue() const;
+
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
+
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
+
+		// required to enable deserialization of this sensor
+		HA_SENSOR_INSTANCE(node, system, ha) {
+			Sensor::Ptr sensor(new AsyncSensor());
+			sensor->deserialize(node, system, ha);
+			return sensor;
+		}
+
+	protected:
+		std::string _source_name;
+		SensorSource::Ptr _source;
+		bool _has_new_value;
+		// sequence number of the latest sample this sensor has seen
+		unsigned long long _last_sequence;
+
+		double _max_age;
+		double _latency;
+		bool _extrapolate;
+
+		// time of the last step() and whether the latest sample was too old then
+		double _time;
+		bool _is_stale;
+
+		// extrapolation: the latest sample, its rate of change (the body twist of poses) and the value at _time
+		bool _has_rate;
+		::Eigen::MatrixXd _sample;
+		double _sample_time;
+		::Eigen::MatrixXd _rate;
+		::Eigen::MatrixXd _value;
+
+		void _fetch();
+		void _updateRate(const ::Eigen::MatrixXd& sample, double sample_time);
+		void _extrapolateTo(double t);
+
+		virtual AsyncSensor* _doClone() const
+		{
+			return (new AsyncSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_ASYNC_SENSOR_H_
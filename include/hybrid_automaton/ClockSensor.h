@@ -65,10 +65,17 @@ namespace ha {
          * @brief Returns the current System time as a 1x1 matrix
          */
 		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
 
 		virtual void initialize(const double& t); 
 		virtual void step(const double& t);
 
+		virtual bool isClock() const {
+			return true;
+		}
+
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
 		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_CONDITION_BATCH_H_
+#define HYBRID_AUTOMATON_CONDITION_BATCH_H_
+
+#include "hybrid_automaton/JumpCondition.h"
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace ha {
+
+	class ControlSwitch;
+
+	/**
+	 * @brief Evaluates the JumpConditions of many ControlSwitches together, grouped by criterion and size
+	 *
+	 * Plain JumpConditions (no subclasses) with a constant goal and one of the criteria NORM_L1, NORM_L2, NORM_L_INF,
+	 * THRESH_UPPER_BOUND or THRESH_LOWER_BOUND are batched: conditions with the same criterion and goal
+	 * size form a group that keeps values, goals and weights as columns of one matrix each (structure of
+	 * arrays) and computes the criteria of all its conditions in one pass. The criteria are handed back to
+	 * the conditions, so hysteresis, getCriterion(), the ConditionView and traces work as after
+	 * JumpCondition::isActive(). All other conditions are evaluated by JumpCondition::isActive() when
+	 * the result of their switch is requested.
+	 *
+	 * Used by the HybridAutomaton if HybridAutomaton::setBatchEvaluation() is enabled:
+	 * @code
+	 *   batch.schedule(i);             // for every switch that is due in this cycle, after ControlSwitch::step()
+	 *   batch.evaluate();
+	 *   if (batch.isActive(i)) ...     // in the order of priority
+	 * @endcode
+	 *
+	 * Unlike ControlSwitch::isActive() the batched conditions of a switch are evaluated even if another
+	 * of its conditions is false.
+	 */
+	class ConditionBatch {
+	public:
+		ConditionBatch();
+
+		void clear();
+
+		/**
+		 * @brief Add the conditions of \a control_switch, returns the index of the switch in this batch
+		 *
+		 * Allocates the buffers of the groups - call it when a ControlMode is activated, not in step().
+		 */
+		std::size_t add(ControlSwitch* control_switch);
+
+		/**
+		 * @brief Evaluate the conditions of switch \a index with the next evaluate()
+		 */
+		void schedule(std::size_t index);
+
+		/**
+		 * @brief Compute the batched conditions of all scheduled switches - their sensors must have been stepped
+		 */
+		void evaluate();
+
+		/**
+		 * @brief Conjunction of the conditions of switch \a index: the results of the last evaluate() for
+		 * batched conditions, JumpCondition::isActive() for the others
+		 */
+		bool isActive(std::size_t index) const;
+
+		std::size_t getNumberOfSwitches() const;
+
+		/**
+		 * @brief Number of conditions that are evaluated in groups
+		 */
+		std::size_t getNumberOfBatchedConditions() const;
+
+		std::size_t getNumberOfGroups() const;
+
+	protected:
+		struct Group {
+			int criterion;
+			int rows, cols;
+			int size;
+			bool has_work;
+			// one column per condition
+			::Eigen::MatrixXd values;
+			::Eigen::MatrixXd goals;
+			::Eigen::MatrixXd weights;
+			::Eigen::MatrixXd scratch;
+			::Eigen::RowVectorXd criteria;
+		};
+
+		struct Entry {
+			JumpCondition* jump_condition;
+			// -1 if the condition is not batched
+			int group;
+			int column;
+			bool compute;
+			bool result;
+		};
+
+		struct Switch {
+			ControlSwitch* control_switch;
+			std::size_t begin, end;
+			bool scheduled;
+		};
+
+		static bool _isBatchable(const JumpCondition* jump_condition);
+		int _findGroup(const JumpCondition* jump_condition);
+		bool _gather(Entry& entry);
+		void _computeCriteria(Group& group);
+
+		std::vector<Group> _groups;
+		std::vector<Entry> _entries;
+		std::vector<Switch> _switches;
+		std::size_t _num_batched;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_CONDITION_BATCH_H_
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_CONDITION_VIEW_H_
+#define HYBRID_AUTOMATON_CONDITION_VIEW_H_
+
+#include "hybrid_automaton/JumpCondition.h"
+
+#include <vector>
+
+namespace ha {
+
+	class ControlSwitch;
+
+	/**
+	 * @brief Index based access to the criteria of all JumpConditions that leave the current ControlMode
+	 *
+	 * Rebuilt by the HybridAutomaton whenever a ControlMode is activated. Index i stays the same
+	 * JumpCondition until the next transition: the conditions are listed switch by switch in the order
+	 * in which the switches were added, and in the order of ControlSwitch::getJumpConditions() within
+	 * a switch. The values are read from the JumpConditions, which keep the criterion of their
+	 * last JumpCondition::isActive() - nothing is computed or copied.
+	 *
+	 * Usage:
+	 * @code
+	 *   const ConditionView& view = hybrid_automaton->getConditionView();
+	 *   for (std::size_t i = 0; i < view.size(); ++i)
+	 *     if (view.isCurrent(i, t))
+	 *       monitor(view.getJumpCondition(i), view.getMargin(i));
+	 * @endcode
+	 */
+	class ConditionView {
+	public:
+		ConditionView();
+
+		void clear();
+		void add(const ControlSwitch* control_switch, const JumpCondition* jump_condition);
+
+		std::size_t size() const {
+			return _entries.size();
+		}
+
+		const ControlSwitch* getControlSwitch(std::size_t index) const {
+			return _entries[index].control_switch;
+		}
+
+		const JumpCondition* getJumpCondition(std::size_t index) const {
+			return _entries[index].jump_condition;
+		}
+
+		/**
+		 * @brief True if the condition computed a criterion since the mode was activated
+		 */
+		bool hasCriterion(std::size_t index) const {
+			return _entries[index].jump_condition->hasCriterion();
+		}
+
+		/**
+		 * @brief True if the criterion was computed in the control cycle at time \a t
+		 *
+		 * Skipped or deferred switches and short-circuited conditions keep older criteria.
+		 */
+		bool isCurrent(std::size_t index, double t) const {
+			return hasCriterion(index) && _entries[index].jump_condition->getCriterionTime() == t;
+		}
+
+		/**
+		 * @see JumpCondition::getCriterion()
+		 */
+		double getCriterion(std::size_t index) const {
+			return _entries[index].jump_condition->getCriterion();
+		}
+
+		/**
+		 * @see JumpCondition::getMargin()
+		 */
+		double getMargin(std::size_t index) const {
+			return _entries[index].jump_condition->getMargin();
+		}
+
+		/**
+		 * @see JumpCondition::getCriterionTime()
+		 */
+		double getTime(std::size_t index) const {
+			return _entries[index].jump_condition->getCriterionTime();
+		}
+
+		/**
+		 * @see JumpCondition::getPredictedActivationTime()
+		 */
+		double getPredictedActivationTime(std::size_t index) const {
+			return _entries[index].jump_condition->getPredictedActivationTime();
+		}
+
+	protected:
+		struct Entry {
+			const ControlSwitch* control_switch;
+			const JumpCondition* jump_condition;
+		};
+
+		std::vector<Entry> _entries;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_CONDITION_VIEW_H_
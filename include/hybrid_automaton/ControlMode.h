@@ -73,6 +73,14 @@ namespace ha {
 				HA_THROW_ERROR("ControlSet.initialize", "No control set defined.");
 		}
 
+        /**
+         * @brief Prepare the next initialize() - is called by the HybridAutomaton before a likely switch to this mode
+         */
+		virtual void prepare() {
+			if (_control_set)
+				_control_set->prepare();
+		}
+
         /**
          * @brief Deactivate the controller for execution.
          *
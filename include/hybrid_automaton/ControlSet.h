@@ -70,6 +70,13 @@ namespace ha {
         */
 		virtual void initialize();
 
+        /**
+        * @brief Prepare the next initialize() outside of the control cycle that activates the ControlSet
+        *
+        * Override it to allocate or subscribe to what initialize() needs. Does nothing by default.
+        */
+		virtual void prepare();
+
         /**
         * @brief Deactivate the ControlSet after execution. Is called automatically from the ControlMode
         */
@@ -59,7 +59,7 @@ namespace ha {
     typedef boost::shared_ptr<ControlSwitch> Ptr;
 	typedef boost::shared_ptr<const ControlSwitch> ConstPtr;
 
-    ControlSwitch() {}
+    ControlSwitch() : _evaluation_period(0.0), _priority(0.0), _safety_critical(false), _prewarm_margin(0.0), _min_dwell_time(0.0), _prewarm_time(0.0), _max_evaluation_period(0.0), _step_time(0.0), _adaptive_ordering(false), _evaluations_since_reordering(0) {}
 
     virtual ~ControlSwitch() {}
 
@@ -73,6 +73,11 @@ namespace ha {
     */
 	virtual void initialize(const double& t);
 
+    /**
+    * @brief Prepare the next initialize() of all JumpConditions, see JumpCondition::prepare()
+    */
+	virtual void prepare();
+
     /**
     * @brief Deactivate the ControlSwitch. Is called automatically when the source ControlMode is deactivated.
     */
@@ -88,9 +93,41 @@ namespace ha {
     /**
      * @brief Check if all contained JumpConditions evaluate to true
      * Is called from the HybridAutomaton once within each control loop
+     *
+     * Stops at the first JumpCondition that is false. With adaptive ordering the JumpConditions
+     * are checked cheapest and most selective first, see setAdaptiveOrdering().
      */
     virtual bool isActive() const;
 
+    /**
+     * @brief Reorder the JumpConditions in isActive() by their measured cost and pass rate (default: false)
+     *
+     * Every REORDERING_PERIOD calls of isActive() the JumpConditions are sorted by cost / (1 - pass rate),
+     * which minimizes the expected cost of the conjunction. step() still steps all JumpConditions.
+     * By default the JumpConditions are checked in the order they were added.
+     *
+     * The cost is measured with CycleClock, so the order differs from run to run and from machine to machine.
+     * Which JumpConditions are short-circuited affects their hysteresis, the criteria in the ConditionView and
+     * the recorded trace - transitions of switches with adaptive ordering are therefore not exactly reproducible
+     * by a Replay. Enable it in XML with the attribute adaptive_ordering="true".
+     */
+	virtual void setAdaptiveOrdering(bool adaptive_ordering);
+	virtual bool getAdaptiveOrdering() const;
+
+    /**
+     * @brief Indices into getJumpConditions() in the order isActive() currently checks them
+     */
+	virtual const std::vector<std::size_t>& getEvaluationOrder() const;
+
+	enum { REORDERING_PERIOD = 64 };
+
+    /**
+     * @brief The time before which this ControlSwitch cannot become active - valid after initialize()
+     *
+     * The latest of JumpCondition::getEarliestActivationTime() of all JumpConditions, -infinity if unknown.
+     */
+    virtual double getEarliestActivationTime() const;
+
 	virtual void add(const JumpConditionPtr& jump_condition);
 	virtual const std::vector<JumpConditionPtr>& getJumpConditions();
 
@@ -100,6 +137,89 @@ namespace ha {
 	virtual void setName(const std::string& name);
 	virtual const std::string getName() const;
 
+    /**
+     * @brief Evaluate this ControlSwitch only every \a period seconds instead of every control cycle
+     *
+     * Use it for conditions on slow sensors, e.g. object poses from a perception pipeline.
+     * The HybridAutomaton spreads the evaluations of slow switches across control cycles.
+     * 0 (the default) evaluates the switch in every control cycle.
+     */
+	virtual void setEvaluationPeriod(double period);
+	virtual double getEvaluationPeriod() const;
+
+    /**
+     * @brief Order in which the HybridAutomaton evaluates the outgoing switches of a mode - higher first
+     *
+     * Switches with equal priority (default 0) are evaluated in the order they were added.
+     */
+	virtual void setPriority(double priority);
+	virtual double getPriority() const;
+
+    /**
+     * @brief Safety critical switches are evaluated in every control cycle, even if the budget of HybridAutomaton::step() is spent
+     */
+	virtual void setSafetyCritical(bool safety_critical);
+	virtual bool isSafetyCritical() const;
+
+    /**
+     * @brief Let the HybridAutomaton prepare the target mode once this switch is within \a margin of becoming active
+     *
+     * The HybridAutomaton then calls HybridAutomaton::prepareControlMode() for the target in a control cycle
+     * before the transition, which leaves less work for the cycle of the transition.
+     * The margin is in units of the JumpCondition criteria, 0 (the default) disables preparing.
+     *
+     * @see isNearlyActive()
+     */
+	virtual void setPrewarmMargin(double margin);
+	virtual double getPrewarmMargin() const;
+
+    /**
+     * @brief Let the HybridAutomaton prepare the target mode once this switch is predicted to become active within \a seconds
+     *
+     * Like setPrewarmMargin(), but in time and based on getPredictedActivationTime(). 0 (the default) disables it.
+     */
+	virtual void setPrewarmTime(double seconds);
+	virtual double getPrewarmTime() const;
+
+    /**
+     * @brief True if all JumpConditions evaluated since initialize() are within the prewarm margin of becoming active,
+     * or if the switch is predicted to become active within the prewarm time
+     *
+     * JumpConditions that were short-circuited by isActive() since initialize() are not considered.
+     */
+	virtual bool isNearlyActive() const;
+
+    /**
+     * @brief The time at which all JumpConditions are expected to be active, see JumpCondition::getPredictedActivationTime()
+     *
+     * The latest prediction of the JumpConditions: +infinity if one of them does not approach activation,
+     * -infinity (any time) if none of them has a prediction yet.
+     */
+	virtual double getPredictedActivationTime() const;
+
+    /**
+     * @brief Let the HybridAutomaton evaluate this switch less often while it is predicted to be far from activation
+     *
+     * The time between two evaluations then grows up to \a period, but stays below half the predicted time
+     * to activation. Switches that are not predicted to approach activation are evaluated every \a period.
+     * Must not be below getEvaluationPeriod() to take effect; 0 (the default) disables it. Safety critical
+     * switches are never evaluated less often.
+     *
+     * Independent of this setting, a slow switch (see setEvaluationPeriod()) is evaluated before its period
+     * is over if it is predicted to become active earlier.
+     */
+	virtual void setMaxEvaluationPeriod(double period);
+	virtual double getMaxEvaluationPeriod() const;
+
+    /**
+     * @brief The HybridAutomaton does not take this switch within \a min_dwell_time seconds after entering its source mode
+     *
+     * Keeps noisy conditions from switching back and forth between modes faster than their
+     * initialization pays off. 0 (the default) allows switching right away.
+     */
+	virtual void setMinDwellTime(double min_dwell_time);
+	virtual double getMinDwellTime() const;
+
 	void setHybridAutomaton(const HybridAutomaton* hybrid_automaton);
 
   protected:
@@ -113,6 +233,60 @@ namespace ha {
      */
 	std::string _name;
 
+    /**
+     * @brief Seconds between two evaluations, 0 for every control cycle
+     */
+	double _evaluation_period;
+
+    /**
+     * @brief Evaluation order within the source mode and whether the switch may be deferred
+     */
+	double _priority;
+	bool _safety_critical;
+
+    /**
+     * @brief Distance of the JumpCondition criteria from activation below which the target mode is prepared
+     */
+	double _prewarm_margin;
+
+    /**
+     * @brief Seconds after the activation of the source mode before which this switch is not evaluated
+     */
+	double _min_dwell_time;
+
+    /**
+     * @brief Predicted seconds to activation below which the target mode is prepared
+     */
+	double _prewarm_time;
+
+    /**
+     * @brief Longest time between two evaluations while the switch is predicted to be far from activation
+     */
+	double _max_evaluation_period;
+
+    /**
+     * @brief The time passed to the last step() or initialize()
+     */
+	double _step_time;
+
+    /**
+     * @brief Measured cost (CycleClock ticks) and pass rate of a JumpCondition, both exponentially averaged
+     */
+	struct ConditionStatistics {
+		ConditionStatistics() : cost(0.0), pass_rate(0.0), evaluations(0) {}
+		double cost;
+		double pass_rate;
+		unsigned long long evaluations;
+	};
+
+	void _reorder() const;
+
+	bool _adaptive_ordering;
+	mutable std::vector<std::size_t> _evaluation_order;
+	mutable std::vector<ConditionStatistics> _condition_statistics;
+	mutable std::vector<double> _ranks;
+	mutable unsigned int _evaluations_since_reordering;
+
     virtual ControlSwitch* _doClone() const
     {
       return (new ControlSwitch(*this));
@@ -93,6 +93,7 @@ namespace ha {
 				abs_goal = this->_goal;
 
 			this->_updateAbsoluteGoal(abs_goal);
+			this->_goalChanged();
 		}
 
         /**
@@ -146,6 +147,27 @@ namespace ha {
 		virtual Eigen::MatrixXd getGoal() const;
 		virtual void setGoal(const Eigen::MatrixXd& new_goal);
 
+		/**
+		* @brief The version of a goal that is not tracked, see getGoalVersion()
+		*/
+		enum { UNVERSIONED_GOAL = 0 };
+
+		/**
+		* @brief Changes whenever getGoal() may return a different goal - UNVERSIONED_GOAL unless enabled by setGoalVersioning()
+		*
+		* JumpConditions with a controller goal copy getGoal() only when the version changed, and in every
+		* evaluation if the goal is unversioned.
+		*/
+		virtual unsigned long getGoalVersion() const;
+
+		/**
+		* @brief Promise that the goal only changes in setGoal(), updateGoal() and deserialize() (default: false)
+		*
+		* Only enable it if getGoal() is not overridden and derived classes that write _goal call _goalChanged().
+		*/
+		virtual void setGoalVersioning(bool goal_versioning);
+		virtual bool getGoalVersioning() const;
+
 		/**
 		* Helper function to return the current via point of an interpolator.
 		* Overwrite it for interpolated controllers, ignore it for non-interpolated controllers.
@@ -286,6 +308,17 @@ namespace ha {
          */
 		Eigen::MatrixXd		_goal;
 
+        /**
+         * @brief Incremented by _goalChanged(), reported by getGoalVersion() if _goal_versioning is set
+         */
+		unsigned long		_goal_version;
+		bool				_goal_versioning;
+
+		void _goalChanged() {
+			if (++this->_goal_version == UNVERSIONED_GOAL)
+				++this->_goal_version;
+		}
+
         /**
          * @brief The goal of this Controller
          *
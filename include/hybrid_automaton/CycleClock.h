@@ -0,0 +1,87 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_CYCLE_CLOCK_H_
+#define HYBRID_AUTOMATON_CYCLE_CLOCK_H_
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+namespace ha {
+
+	/**
+	 * @brief A cheap, monotonic tick counter for measuring short durations inside the control loop
+	 *
+	 * On x86 the ticks are read from the time stamp counter, everywhere else they are nanoseconds of
+	 * the monotonic system clock. Use ticksPerSecond() (calibrated once, on first use) to convert
+	 * tick differences into seconds.
+	 */
+	class CycleClock {
+	public:
+		typedef unsigned long long Ticks;
+
+		/**
+		 * @brief Read the current tick count
+		 */
+		static inline Ticks now()
+		{
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+			return __rdtsc();
+#else
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return (Ticks)ts.tv_sec * 1000000000ULL + (Ticks)ts.tv_nsec;
+#endif
+		}
+
+		/**
+		 * @brief Number of ticks per second
+		 */
+		static double ticksPerSecond();
+
+		static inline double toSeconds(Ticks ticks)
+		{
+			return (double)ticks / ticksPerSecond();
+		}
+
+		static inline double toNanoseconds(Ticks ticks)
+		{
+			return 1e9 * (double)ticks / ticksPerSecond();
+		}
+
+		static inline Ticks fromSeconds(double seconds)
+		{
+			return (seconds <= 0.0) ? 0 : (Ticks)(seconds * ticksPerSecond());
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_CYCLE_CLOCK_H_
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_DERIVATIVE_SENSOR_H_
+#define HYBRID_AUTOMATON_DERIVATIVE_SENSOR_H_
+
+#include "hybrid_automaton/DerivedSensor.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class DerivativeSensor;
+	typedef boost::shared_ptr<DerivativeSensor> DerivativeSensorPtr;
+	typedef boost::shared_ptr<const DerivativeSensor> DerivativeSensorConstPtr;
+
+	/**
+	 * @brief Time derivative of its operand, from the samples of the last control cycles
+	 *
+	 * Every step() adds the value of the operand to a ring buffer of "window" samples (default 2). The
+	 * derivative is the slope of the least squares line through these samples: a finite difference for
+	 * a window of 2, a first order Savitzky-Golay filter for larger windows.
+	 *
+	 * If the operand is a 4x4 pose the value is its body twist (6x1): the linear velocity of the frame's
+	 * origin followed by the angular velocity, both expressed in the frame itself. The samples are
+	 * compared to the newest pose with the SE(3) logarithm. Other operands are differentiated entry by
+	 * entry, e.g. the rate of change of a wrench.
+	 *
+	 * The value is zero until two samples were taken. E.g. "came to rest":
+	 * @code
+	 *   <JumpCondition jump_criterion="1" norm_weights="[6,1]1;1;1;0;0;0" epsilon="0.001" goal="[6,1]0;0;0;0;0;0">
+	 *     <Sensor type="DerivativeSensor" window="5">
+	 *       <Sensor type="FramePoseSensor" frame_id="EE"/>
+	 *     </Sensor>
+	 *   </JumpCondition>
+	 * @endcode
+	 */
+	class DerivativeSensor : public DerivedSensor
+	{
+	public:
+
+		typedef boost::shared_ptr<DerivativeSensor> Ptr;
+		typedef boost::shared_ptr<const DerivativeSensor> ConstPtr;
+
+		DerivativeSensor();
+
+		virtual ~DerivativeSensor();
+
+		DerivativeSensor(const DerivativeSensor& ss);
+
+		DerivativeSensorPtr clone() const
+		{
+			return (DerivativeSensorPtr(_doClone()));
+		}
+
+		/**
+		 * @brief Number of samples the derivative is fitted to (at least 2) - takes effect with the next initialize()
+		 */
+		virtual void setWindowSize(int window_size);
+
+		virtual int getWindowSize() const;
+
+		virtual void initialize(const double& t);
+		virtual void step(const double& t);
+
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+
+		// required to enable deserialization of this sensor
+		HA_SENSOR_INSTANCE(node, system, ha) {
+			Sensor::Ptr sensor(new DerivativeSensor());
+			sensor->deserialize(node, system, ha);
+			return sensor;
+		}
+
+	protected:
+		int _window_size;
+
+		// ring buffer of the last samples (one column per sample, poses flattened to 16 entries)
+		bool _is_pose;
+		unsigned long long _samples;
+		int _next;
+		::Eigen::MatrixXd _window;
+		::Eigen::VectorXd _times;
+		double _time;
+
+		// scratch space of step(): samples as twists relative to the newest pose, weights of the fit
+		::Eigen::MatrixXd _twists;
+		::Eigen::VectorXd _weights;
+
+		::Eigen::MatrixXd _value;
+
+		void _push(const ::Eigen::MatrixXd& x, double t);
+		void _differentiate();
+
+		virtual std::size_t _getMinOperands() const;
+		virtual std::size_t _getMaxOperands() const;
+
+		virtual void _serializeAttributes(const DescriptionTreeNode::Ptr& tree) const;
+		virtual void _deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree);
+
+		virtual DerivativeSensor* _doClone() const
+		{
+			return (new DerivativeSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_DERIVATIVE_SENSOR_H_
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_DERIVED_SENSOR_H_
+#define HYBRID_AUTOMATON_DERIVED_SENSOR_H_
+
+#include "hybrid_automaton/Sensor.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace ha {
+
+	class DerivedSensor;
+	typedef boost::shared_ptr<DerivedSensor> DerivedSensorPtr;
+	typedef boost::shared_ptr<const DerivedSensor> DerivedSensorConstPtr;
+
+	/**
+	 * @brief A Sensor that computes its value from other sensors, its operands
+	 *
+	 * Derived sensors form an expression graph. The leaves are the sensors that read the System
+	 * (e.g. JointConfigurationSensor, JointVelocitySensor, FramePoseSensor, ForceTorqueSensor), the
+	 * inner nodes are operators like SubsetSensor, BlockSensor, FrameTransformSensor, DifferenceSensor,
+	 * NormSensor or FilterSensor. In the description tree the operands are the child Sensor nodes:
+	 * @code
+	 *   <Sensor type="NormSensor">
+	 *     <Sensor type="DifferenceSensor">
+	 *       <Sensor type="FrameDisplacementSensor" frame_id="EE"/>
+	 *       <Sensor type="FrameDisplacementSensor" frame_id="tool"/>
+	 *     </Sensor>
+	 *   </Sensor>
+	 * @endcode
+	 *
+	 * Operands are deserialized with HybridAutomaton::createSharedSensor(): a subexpression that occurs
+	 * in several JumpConditions (or twice in one expression) is a single node of the graph and is read
+	 * once per control cycle.
+	 *
+	 * Subclasses implement readCurrentValue() from the values of their operands (see _readOperand()).
+	 */
+	class DerivedSensor : public Sensor
+	{
+	public:
+
+		typedef boost::shared_ptr<DerivedSensor> Ptr;
+		typedef boost::shared_ptr<const DerivedSensor> ConstPtr;
+
+		DerivedSensor();
+
+		virtual ~DerivedSensor();
+
+		/**
+		 * Copy constructor - clones the operands
+		 */
+		DerivedSensor(const DerivedSensor& ss);
+
+		DerivedSensorPtr clone() const
+		{
+			return (DerivedSensorPtr(_doClone()));
+		}
+
+		virtual void addOperand(const Sensor::Ptr& operand);
+
+		virtual const std::vector<Sensor::Ptr>& getOperands() const;
+
+		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const = 0;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
+
+		virtual void setSystem(const System::ConstPtr& system);
+
+		/**
+		 * @brief Initializes the operands, then stores the initial value
+		 */
+		virtual void initialize(const double& t);
+		virtual void prepare();
+		virtual void terminate();
+		virtual void step(const double& t);
+
+		/**
+		 * @brief Active if all operands are active
+		 */
+		virtual bool isActive() const;
+
+		/**
+		 * @brief True if any operand has a new value
+		 */
+		virtual bool hasNewValue() const;
+
+		/**
+		 * @brief The oldest acquisition time of the operands that have one
+		 */
+		virtual bool getSampleTime(double& time) const;
+
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
+
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
+
+	protected:
+		std::vector<Sensor::Ptr> _operands;
+
+		// one buffer per operand, see _readOperand()
+		mutable std::vector< ::Eigen::MatrixXd> _operand_values;
+
+		/**
+		 * @brief Reads the current value of operand \a i into its buffer and returns the buffer
+		 */
+		const ::Eigen::MatrixXd& _readOperand(std::size_t i) const;
+
+		/**
+		 * @brief How many operands this operator takes - checked by deserialize()
+		 */
+		virtual std::size_t _getMinOperands() const = 0;
+		virtual std::size_t _getMaxOperands() const = 0;
+
+		/**
+		 * @brief Writes / reads the attributes of the operator (everything but type and operands)
+		 */
+		virtual void _serializeAttributes(const DescriptionTreeNode::Ptr& tree) const;
+		virtual void _deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree);
+
+		virtual DerivedSensor* _doClone() const = 0;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_DERIVED_SENSOR_H_
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_EXPRESSION_CONDITION_H_
+#define HYBRID_AUTOMATON_EXPRESSION_CONDITION_H_
+
+#include "hybrid_automaton/JumpCondition.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	class ExpressionCondition;
+	typedef boost::shared_ptr<ExpressionCondition> ExpressionConditionPtr;
+	typedef boost::shared_ptr<const ExpressionCondition> ExpressionConditionConstPtr;
+
+	/**
+	 * @brief A JumpCondition that combines other JumpConditions, its operands, with AND, OR or NOT
+	 *
+	 * A ControlSwitch is the conjunction of its JumpConditions. An ExpressionCondition adds disjunction
+	 * and negation, so that e.g. "grasp failed" becomes one switch instead of one switch per reason.
+	 * Operands are ordinary JumpConditions (the comparisons) or ExpressionConditions. In the description
+	 * tree the operands are the child JumpCondition nodes:
+	 * @code
+	 *   <JumpCondition expression="or">
+	 *     <JumpCondition jump_criterion="THRESH_UPPER_BOUND" goal="[1,1]10" epsilon="0">
+	 *       <Sensor type="ForceTorqueSensor" .../>
+	 *     </JumpCondition>
+	 *     <JumpCondition expression="not">
+	 *       <JumpCondition ...>...</JumpCondition>
+	 *     </JumpCondition>
+	 *   </JumpCondition>
+	 * @endcode
+	 *
+	 * The expression tree is compiled into a flat program when operands are added and on initialize():
+	 * one instruction per comparison with the instruction to continue with if it is true, false or
+	 * unknown (see JumpCondition::isUnknown()). isActive() runs the program from its entry, so it
+	 * only evaluates the comparisons that decide the result and NOT costs nothing. Unknown comparisons
+	 * follow three-valued logic: the expression is unknown (and not active) unless the known comparisons
+	 * decide it - negating a stale sensor does not make it active.
+	 */
+	class ExpressionCondition : public JumpCondition
+	{
+	public:
+		enum Operator { AND, OR, NOT };
+
+		typedef boost::shared_ptr<ExpressionCondition> Ptr;
+		typedef boost::shared_ptr<const ExpressionCondition> ConstPtr;
+
+		ExpressionCondition(Operator op = AND);
+
+		virtual ~ExpressionCondition();
+
+		/**
+		 * Copy constructor - clones the operands
+		 */
+		ExpressionCondition(const ExpressionCondition& ec);
+
+		ExpressionConditionPtr clone() const
+		{
+			return ExpressionConditionPtr(_doClone());
+		}
+
+		/**
+		 * @brief A JumpCondition for a JumpCondition node of the description tree - an ExpressionCondition
+		 * if the node has an "expression" attribute
+		 */
+		static JumpConditionPtr create(const DescriptionTreeNode::ConstPtr& tree);
+
+		static std::string operatorToString(Operator op);
+		static Operator operatorFromString(const std::string& op);
+
+		virtual void setOperator(Operator op);
+		virtual Operator getOperator() const;
+
+		virtual void addOperand(const JumpConditionPtr& operand);
+		virtual const std::vector<JumpConditionPtr>& getOperands() const;
+
+		virtual void initialize(const double& t);
+		virtual void prepare();
+		virtual void terminate();
+		virtual void step(const double& t);
+
+		virtual bool isActive() const;
+
+		/**
+		 * @brief AND: the latest of the operands, OR: the earliest, NOT: -infinity
+		 */
+		virtual double getEarliestActivationTime() const;
+
+		/**
+		 * @brief AND: the largest distance of the operands, OR: the smallest, NOT: infinity
+		 */
+		virtual double getDistanceToActivation() const;
+
+		/**
+		 * @brief AND: the latest prediction of the operands, OR: the earliest, NOT: -infinity
+		 */
+		virtual double getPredictedActivationTime() const;
+
+		virtual void setSourceModeName(const std::string& sourceModeName);
+
+		/**
+		 * @brief Also sets the paths of the operands to \a path "." index
+		 */
+		virtual void setPath(const std::string& path);
+
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
+
+		virtual std::string toString(bool use_latex=false);
+
+		/**
+		 * @brief Number of instructions of the compiled program
+		 */
+		std::size_t getProgramSize() const;
+
+		/**
+		 * @brief The comparisons of the expression (the operands that are no ExpressionConditions), each once
+		 */
+		const std::vector<JumpConditionPtr>& getComparisons() const;
+
+	protected:
+		// results of the program - instructions have indices >= 0
+		enum { RESULT_TRUE = -1, RESULT_FALSE = -2, RESULT_UNKNOWN = -3 };
+
+		struct Instruction {
+			const JumpCondition* comparison;
+			int on_true;
+			int on_false;
+			int on_unknown;
+		};
+
+		void _compile();
+		int _compile(const JumpConditionPtr& node, int on_true, int on_false, int on_unknown);
+		int _compile(Operator op, const std::vector<JumpConditionPtr>& operands, int on_true, int on_false, int on_unknown);
+		void _collectComparisons(const JumpConditionPtr& node);
+		void _check() const;
+
+		std::string _operandPath(std::size_t index) const;
+		virtual void _updateProfileName();
+
+		Operator _operator;
+		std::vector<JumpConditionPtr> _operands;
+
+		std::vector<JumpConditionPtr> _comparisons;
+		std::vector<Instruction> _program;
+		int _entry;
+
+		virtual ExpressionCondition* _doClone() const
+		{
+			return new ExpressionCondition(*this);
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_EXPRESSION_CONDITION_H_
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_FILTER_SENSOR_H_
+#define HYBRID_AUTOMATON_FILTER_SENSOR_H_
+
+#include "hybrid_automaton/DerivedSensor.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/StreamingFilter.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class FilterSensor;
+	typedef boost::shared_ptr<FilterSensor> FilterSensorPtr;
+	typedef boost::shared_ptr<const FilterSensor> FilterSensorConstPtr;
+
+	/**
+	 * @brief Filters its operand entry by entry with a StreamingFilter
+	 *
+	 * The filter starts at the value of the operand in initialize() and is updated in step(), so it runs
+	 * within the control cycle. Attributes in the description tree:
+	 * - filter: "low_pass" (default), "butterworth", "median", "min", "max" or "mean"
+	 * - time_constant: of low_pass in seconds, 0 (default) passes the operand through
+	 * - cutoff_frequency: of butterworth in Hz
+	 * - window: number of samples of median, min, max and mean (default 1)
+	 *
+	 * E.g. the median of the last 5 force/torque measurements:
+	 * @code
+	 *   <Sensor type="FilterSensor" filter="median" window="5">
+	 *     <Sensor type="ForceTorqueSensor" port="0"/>
+	 *   </Sensor>
+	 * @endcode
+	 */
+	class FilterSensor : public DerivedSensor
+	{
+	public:
+
+		typedef boost::shared_ptr<FilterSensor> Ptr;
+		typedef boost::shared_ptr<const FilterSensor> ConstPtr;
+
+		FilterSensor();
+
+		virtual ~FilterSensor();
+
+		FilterSensor(const FilterSensor& ss);
+
+		FilterSensorPtr clone() const
+		{
+			return (FilterSensorPtr(_doClone()));
+		}
+
+		/**
+		 * @brief Type and parameters of the filter - takes effect with the next initialize()
+		 */
+		virtual void setFilter(const StreamingFilter& filter);
+
+		virtual const StreamingFilter& getFilter() const;
+
+		/**
+		 * @brief Time constant of the low-pass filter in seconds
+		 */
+		virtual void setTimeConstant(double time_constant);
+
+		virtual double getTimeConstant() const;
+
+		virtual void initialize(const double& t);
+		virtual void step(const double& t);
+
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+
+		// required to enable deserialization of this sensor
+		HA_SENSOR_INSTANCE(node, system, ha) {
+			Sensor::Ptr sensor(new FilterSensor());
+			sensor->deserialize(node, system, ha);
+			return sensor;
+		}
+
+	protected:
+		// filter state and the time it was updated for
+		StreamingFilter _filter;
+		double _time;
+
+		virtual std::size_t _getMinOperands() const;
+		virtual std::size_t _getMaxOperands() const;
+
+		virtual void _serializeAttributes(const DescriptionTreeNode::Ptr& tree) const;
+		virtual void _deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree);
+
+		virtual FilterSensor* _doClone() const
+		{
+			return (new FilterSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_FILTER_SENSOR_H_
@@ -66,6 +66,9 @@ namespace ha {
 		* x ,y ,z ,rot_x, rot_y, rot_z
 		*/
 		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
 
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
@@ -117,6 +120,11 @@ namespace ha {
 		}
 
 		::Eigen::MatrixXd transformWrench(const ::Eigen::MatrixXd& wrench, const ::Eigen::MatrixXd& transform) const;
+
+		void transformWrenchInPlace(::Eigen::MatrixXd& wrench, const ::Eigen::Matrix3d& frameRot, const ::Eigen::Vector3d& frameTrans) const;
+
+		// pose of the EE frame, read when the wrench is transformed to the world frame
+		mutable ::Eigen::MatrixXd _ee_frame;
 	};
 
 }
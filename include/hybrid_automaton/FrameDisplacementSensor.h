@@ -68,6 +68,10 @@ namespace ha {
 		virtual ::Eigen::MatrixXd getCurrentValue() const;
 
 		virtual ::Eigen::MatrixXd getInitialValue() const;
+
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
 		
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
@@ -84,6 +88,12 @@ namespace ha {
 
 		std::string _frame_id;
 
+		// inverse of the initial pose, computed once in initialize()
+		::Eigen::MatrixXd _initial_inverse;
+
+		// pose read from the system in every control cycle
+		mutable ::Eigen::MatrixXd _pose;
+
 		virtual FrameDisplacementSensor* _doClone() const
 		{
 			return (new FrameDisplacementSensor(*this));
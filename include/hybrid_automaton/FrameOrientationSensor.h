@@ -69,6 +69,10 @@ namespace ha {
 		
 		virtual ::Eigen::MatrixXd getRelativeCurrentValue() const;
 
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
+
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
 		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
@@ -84,6 +88,12 @@ namespace ha {
 
 		std::string _frame_id;
 
+		// inverse of the initial pose, computed once in initialize()
+		::Eigen::MatrixXd _initial_inverse;
+
+		// pose read from the system in every control cycle
+		mutable ::Eigen::MatrixXd _pose;
+
 		virtual FrameOrientationSensor* _doClone() const
 		{
 			return (new FrameOrientationSensor(*this));
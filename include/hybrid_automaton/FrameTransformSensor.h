@@ -0,0 +1,114 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_FRAME_TRANSFORM_SENSOR_H_
+#define HYBRID_AUTOMATON_FRAME_TRANSFORM_SENSOR_H_
+
+#include "hybrid_automaton/DerivedSensor.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class FrameTransformSensor;
+	typedef boost::shared_ptr<FrameTransformSensor> FrameTransformSensorPtr;
+	typedef boost::shared_ptr<const FrameTransformSensor> FrameTransformSensorConstPtr;
+
+	/**
+	 * @brief Expresses the value of its first operand in another frame
+	 *
+	 * The target frame T (4x4) is given relative to the frame of the value:
+	 * T = frame, or T = pose * frame if there is a second operand that measures a pose (e.g. a
+	 * FramePoseSensor); with invert_pose it is T = pose^-1 * frame.
+	 *
+	 * Depending on its size the value is interpreted as
+	 * - 6x1 wrench (force, torque): f' = R^T f, m' = R^T (m - t x f)
+	 * - 3x1 point: p' = R^T (p - t)
+	 * - 4x4 pose: P' = T^-1 P
+	 *
+	 * E.g. the wrench of a ForceTorqueSensor in world coordinates is a FrameTransformSensor of the
+	 * measured wrench with the FramePoseSensor of "EE" as second operand and invert_pose.
+	 */
+	class FrameTransformSensor : public DerivedSensor
+	{
+	public:
+
+		typedef boost::shared_ptr<FrameTransformSensor> Ptr;
+		typedef boost::shared_ptr<const FrameTransformSensor> ConstPtr;
+
+		FrameTransformSensor();
+
+		virtual ~FrameTransformSensor();
+
+		FrameTransformSensor(const FrameTransformSensor& ss);
+
+		FrameTransformSensorPtr clone() const
+		{
+			return (FrameTransformSensorPtr(_doClone()));
+		}
+
+		/**
+		 * @brief Constant transformation (4x4) from the pose of the second operand (if any) to the target frame
+		 */
+		virtual void setFrame(const ::Eigen::MatrixXd& frame);
+
+		virtual ::Eigen::MatrixXd getFrame() const;
+
+		/**
+		 * @brief Use the inverse of the pose measured by the second operand
+		 */
+		virtual void setInvertPose(bool invert_pose);
+
+		virtual bool getInvertPose() const;
+
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+
+		// required to enable deserialization of this sensor
+		HA_SENSOR_INSTANCE(node, system, ha) {
+			Sensor::Ptr sensor(new FrameTransformSensor());
+			sensor->deserialize(node, system, ha);
+			return sensor;
+		}
+
+	protected:
+		::Eigen::MatrixXd _frame;
+		bool _invert_pose;
+
+		virtual std::size_t _getMinOperands() const;
+		virtual std::size_t _getMaxOperands() const;
+
+		virtual void _serializeAttributes(const DescriptionTreeNode::Ptr& tree) const;
+		virtual void _deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree);
+
+		virtual FrameTransformSensor* _doClone() const
+		{
+			return (new FrameTransformSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_FRAME_TRANSFORM_SENSOR_H_
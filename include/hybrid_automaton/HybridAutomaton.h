@@ -47,6 +47,13 @@
 
 namespace ha {
 
+	class ConditionBatch;
+	class ConditionView;
+	struct ControlCycle;
+	class SharedSensor;
+	class TraceRecorder;
+	typedef boost::shared_ptr<TraceRecorder> TraceRecorderPtr;
+
 	class HybridAutomaton;
 	typedef boost::shared_ptr<HybridAutomaton> HybridAutomatonPtr;
 	typedef boost::shared_ptr<const HybridAutomaton> HybridAutomatonConstPtr;
@@ -139,8 +146,79 @@ namespace ha {
          */
 		bool _active;
 
-		// helper function -- not virtual!
+        /**
+         * @brief records every step() if set and open
+         */
+		TraceRecorderPtr _trace_recorder;
+
+        /**
+         * @brief When an outgoing switch of the current mode is evaluated - step() skips it before (but still steps it)
+         */
+		struct SwitchSchedule {
+			SwitchHandle handle;
+			// ControlSwitch::getPriority() and ControlSwitch::isSafetyCritical()
+			double priority;
+			bool safety_critical;
+			// ControlSwitch::getEarliestActivationTime(), but not before ControlSwitch::getMinDwellTime() has passed
+			double earliest_activation;
+			// ControlSwitch::getEvaluationPeriod() and the time of the next evaluation
+			double period;
+			double next_evaluation;
+			// ControlSwitch::getMaxEvaluationPeriod()
+			double max_period;
+			// true if the switch was skipped in the last step() because the budget was spent
+			bool deferred;
+			// true once the target mode was prepared, see ControlSwitch::setPrewarmMargin()
+			bool prepared;
+			// index of the switch in _condition_batch, and true if it is part of the batch of the current step()
+			std::size_t batch_index;
+			bool batched;
+		};
+
+        /**
+         * @brief Schedules of the outgoing switches of the current mode (in evaluation order)
+         */
+		std::vector<SwitchSchedule> _switch_schedules;
+
+        /**
+         * @brief Number of switch evaluations that were deferred and of steps that deferred any
+         */
+		unsigned long long _num_deferrals;
+		unsigned long long _num_deferred_steps;
+
+        /**
+         * @brief The JumpConditions of the outgoing switches of the current mode
+         */
+		boost::shared_ptr<ConditionView> _condition_view;
+
+        /**
+         * @brief The JumpConditions of the outgoing switches of the current mode, grouped for setBatchEvaluation()
+         */
+		boost::shared_ptr<ConditionBatch> _condition_batch;
+
+		// helper functions -- not virtual!
 		void _activateCurrentControlMode(const double& t);
+		void _markReturningSwitches(const ModeHandle& previous_mode);
+		// see TraceRecorder::registerControlMode()
+		void _registerTraceChannels();
+		void _scheduleControlSwitch(const SwitchHandle& switch_handle, const double& t);
+		void _prepareControlMode(const ModeHandle& mode_handle);
+		/**
+		 * @brief Set the time of the next evaluation of a switch that was just evaluated at \a t
+		 *
+		 * Uses ControlSwitch::getPredictedActivationTime() to evaluate slow switches earlier when they are about
+		 * to become active and later (up to ControlSwitch::getMaxEvaluationPeriod()) when they are far from it.
+		 */
+		void _scheduleNextEvaluation(SwitchSchedule& schedule, const ControlSwitch& control_switch, const double& t);
+
+		/**
+		 * @brief True (and counted) if the switch is deferred because the budget of step(t, budget) is spent
+		 *
+		 * \a start and \a budget_ticks are CycleClock::Ticks.
+		 */
+		bool _deferSwitch(SwitchSchedule& schedule, unsigned long long start, unsigned long long budget_ticks);
+
+		static bool _hasHigherPriority(const SwitchSchedule& a, const SwitchSchedule& b);
 
 	private:  
 
@@ -162,8 +240,23 @@ namespace ha {
 
         bool _deserialize_default_entities; /**< if true deserialization will not try to find the actual controller etc., but deserialize them raw */
 
+        bool _share_sensors; /**< if true structurally equal sensors are deserialized into one SharedSensor */
+
+        bool _batch_evaluation; /**< if true step() evaluates the JumpConditions of all due switches in one batch */
+
+        /**
+         * @brief The sensors handed out by createSharedSensor(), by their System and description
+         */
+		mutable std::map<std::string, boost::shared_ptr<SharedSensor> > _shared_sensors;
+
+        /**
+         * @brief Counts the calls of step() and initialize() for the SharedSensors
+         */
+		boost::shared_ptr<ControlCycle> _control_cycle;
+
 	public:
 		HybridAutomaton();
+		HybridAutomaton(const HybridAutomaton& ha);
 		virtual ~HybridAutomaton();
 
 		/** 
@@ -187,6 +280,23 @@ namespace ha {
          */
 		static Sensor::Ptr createSensor(const DescriptionTreeNode::ConstPtr& node, const System::ConstPtr& system, const HybridAutomaton* ha);
 
+        /**
+         * @brief Instantiate a Sensor of given type - once per description within this HybridAutomaton
+         *
+         * Returns the same SharedSensor for all nodes with equal type, attributes and children and the same
+         * \a system, so that it is stepped and read only once per step() no matter how many JumpConditions
+         * use it. Used by JumpCondition::deserialize(), deserialize() starts over with no shared sensors.
+         * Falls back to createSensor() if sharing is disabled.
+         *
+         * @see setShareSensors()
+         */
+		Sensor::Ptr createSharedSensor(const DescriptionTreeNode::ConstPtr& node, const System::ConstPtr& system) const;
+
+        /**
+         * @brief Number of distinct sensors created by createSharedSensor()
+         */
+		std::size_t getNumberOfSharedSensors() const;
+
 		/**
          * @brief Register a Controller with the hybrid automaton
          *
@@ -287,6 +397,49 @@ namespace ha {
          */
 		::Eigen::MatrixXd step(const double& t);
 
+        /**
+         * @brief Like step(t), but spend at most \a budget seconds on evaluating the outgoing switches of the current mode
+         *
+         * Switches are evaluated in the order of ControlSwitch::getPriority(). Once the budget is spent, the remaining
+         * switches are deferred to the next step() - unless they are safety critical (ControlSwitch::isSafetyCritical())
+         * or were already deferred in the last step(). A switch is thus deferred by at most one control cycle.
+         * Deferred switches (like those waiting for their evaluation period or earliest activation) are still
+         * stepped, so that their sensors see every control cycle.
+         * The clock that measures the budget is calibrated in initialize().
+         *
+         * @param t the current time of your system
+         * @param budget seconds, 0 for no budget
+         * @return the control output to your hardware (usually a dim x 1 torque vector)
+         */
+		::Eigen::MatrixXd step(const double& t, const double& budget);
+
+        /**
+         * @brief Prepare \a control_mode and its outgoing switches for activation, see ControlMode::prepare()
+         *
+         * step() calls this for the target of every ControlSwitch that is nearly active (see ControlSwitch::setPrewarmMargin()),
+         * so that the control cycle of the transition only has to store the initial sensor values.
+         * Call it between two step()s to prepare a mode that you will set as current or that you expect to switch to.
+         */
+		void prepareControlMode(const std::string& control_mode);
+
+        /**
+         * @brief The criteria and margins of the JumpConditions that leave the current mode
+         *
+         * Valid until the next transition. Read it between two step()s, e.g. to monitor how close
+         * the automaton is to switching.
+         */
+		const ConditionView& getConditionView() const;
+
+        /**
+         * @brief Number of switch evaluations deferred by step(t, budget) since initialize()
+         */
+		unsigned long long getNumberOfDeferrals() const;
+
+        /**
+         * @brief Number of calls of step(t, budget) that deferred at least one switch since initialize()
+         */
+		unsigned long long getNumberOfDeferredSteps() const;
+
 		void setName(const std::string& name);
 		const std::string getName() const;
 
@@ -301,6 +454,14 @@ namespace ha {
 		ControlMode::Ptr getCurrentControlMode() const;
 		ControlSwitch::Ptr getLastActiveControlSwitch() const;
 
+        /**
+         * @brief Record all following calls of step() with \a trace_recorder (NULL to stop recording)
+         *
+         * Only ticks during which the recorder is open are recorded.
+         */
+		void setTraceRecorder(const TraceRecorderPtr& trace_recorder);
+		TraceRecorderPtr getTraceRecorder() const;
+
         /**
          * @brief write this HybridAutomaton into a DescriptionTreeNode.
          *
@@ -394,6 +555,35 @@ namespace ha {
             return _deserialize_default_entities;
         }
 
+        /**
+         * @brief If set to true (the default) deserialization shares structurally equal sensors between JumpConditions
+         *
+         * @see createSharedSensor()
+         */
+        virtual void setShareSensors(bool b) {
+            _share_sensors = b;
+        }
+        virtual bool getShareSensors() const {
+            return _share_sensors;
+        }
+
+        /**
+         * @brief If set to true step() evaluates the JumpConditions of all due switches together (default: false)
+         *
+         * Conditions with a constant goal and an L1, L2, L_INF or threshold criterion are grouped by
+         * criterion and size and computed in one pass per group, see ConditionBatch. This pays off for
+         * modes with many outgoing switches. All conditions of all due switches are computed in every
+         * step and a switch is no longer skipped once a switch of higher priority fired. The budget of
+         * step(t, budget) decides which switches are added to the batch - the batch itself and the
+         * conditions of its switches that cannot be batched are always evaluated in full.
+         */
+        virtual void setBatchEvaluation(bool b) {
+            _batch_evaluation = b;
+        }
+        virtual bool getBatchEvaluation() const {
+            return _batch_evaluation;
+        }
+
 		HybridAutomatonPtr clone() const {
 			return HybridAutomatonPtr(_doClone());
 		}
@@ -435,13 +435,22 @@ public:
                                                       const std::string& mode_name,
                                                       double max_time);
 
+    /**
+     * @brief Create a control switch that triggers when the force/torque exceeds some max value
+     *
+     * @param ft_hysteresis Once active, the F/T condition stays active until it is ft_hysteresis beyond epsilon (see JumpCondition::setHysteresis)
+     * @param min_dwell_time Seconds in the source mode before the switch may trigger (see ControlSwitch::setMinDwellTime)
+     * @return ha::ControlSwitch::Ptr The generated CS
+     */
     virtual ha::ControlSwitch::Ptr CreateMaxForceTorqueControlSwitch(const HybridAutomatonAbstractParams& params,
                                                              const std::string& name,
                                                              const Eigen::MatrixXd& ft_weights,
                                                              const Eigen::MatrixXd& ft_max_val,
                                                              const ha::JumpCondition::JumpCriterion ft_criterion,
                                                              const bool negate_ft_condition=false,
-                                                             const float epsilon=0.0);
+                                                             const float epsilon=0.0,
+                                                             const double ft_hysteresis=0.0,
+                                                             const double min_dwell_time=0.0);
 
     virtual void CreateMaxForceTorqueControlSwitch(const HybridAutomatonAbstractParams& p,
                                            const ha::ControlSwitch::Ptr& cs_ptr,
@@ -450,7 +459,9 @@ public:
                                            const Eigen::MatrixXd& ft_max_val,
                                            const ha::JumpCondition::JumpCriterion ft_criterion,
                                            const bool negate_ft_condition=false,
-                                           const float epsilon = 0.0);
+                                           const float epsilon = 0.0,
+                                           const double ft_hysteresis = 0.0,
+                                           const double min_dwell_time = 0.0);
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
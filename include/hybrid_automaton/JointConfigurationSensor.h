@@ -62,6 +62,9 @@ namespace ha {
          * @brief Return the current robot configuration as a dimx1-vector
          */
 		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
 
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
@@ -40,6 +40,8 @@ namespace ha {
 	class JumpCondition;
 	typedef boost::shared_ptr<JumpCondition> JumpConditionPtr;
 
+	class ConditionBatch;
+
 	/**
 	 * @brief A JumpCondition is a necessary condition for a ControlSwitch to become active.
 	 *
@@ -68,6 +70,9 @@ namespace ha {
          *
          * THRESH_LOWER_BOUND: evaluates to true if sensor_i > goal_i for all i - use with epsilon = 0
          *
+         * The criteria of the thresholds are signed: max_i weight_i * (goal_i - sensor_i) for THRESH_UPPER_BOUND,
+         * max_i weight_i * (sensor_i - goal_i) for THRESH_LOWER_BOUND.
+         *
          * NUM_CRITERIA must be always the last value of the enum to know the number of norms
          */
 		enum JumpCriterion {NORM_L1, NORM_L2, NORM_L_INF, NORM_ROTATION, NORM_TRANSFORM, THRESH_UPPER_BOUND, THRESH_LOWER_BOUND, NUM_CRITERIA}; 
@@ -106,6 +111,13 @@ namespace ha {
         */
 		virtual void initialize(const double& t);
 
+        /**
+        * @brief Prepare the next initialize(), e.g. subscribe to the goal and sensor topics. Is called from the ControlSwitch.
+        *
+        * The next initialize() then only stores the initial sensor value.
+        */
+		virtual void prepare();
+
         /**
         * @brief Deactivate the JumpCondition. Is called automatically when the ControlSwitch is deactivated.
         */
@@ -127,6 +139,72 @@ namespace ha {
         */
 		virtual bool isActive() const;
 
+        /**
+        * @brief True if the last isActive() returned false because its Sensor was inactive, e.g. its data was stale
+        */
+		virtual bool isUnknown() const;
+
+        /**
+        * @brief The time before which this JumpCondition cannot become active - valid after initialize()
+        *
+        * Known for constant goals on a Sensor that is a clock (see Sensor::isClock()), e.g. the
+        * max time conditions of the factories, as long as time passed to step() never decreases.
+        * Returns -infinity if the condition can become active at any time and +infinity if never.
+        */
+		virtual double getEarliestActivationTime() const;
+
+        /**
+        * @brief How much the criterion of the last isActive() has to change for the result to become true
+        *
+        * 0 if the last isActive() was true, +infinity if isActive() was not evaluated since initialize().
+        */
+		virtual double getDistanceToActivation() const;
+
+        /**
+        * @brief True if isActive() computed a criterion since initialize()
+        */
+		virtual bool hasCriterion() const;
+
+        /**
+        * @brief The criterion ||goal - sensor||_N of the last isActive() - valid if hasCriterion()
+        */
+		virtual double getCriterion() const;
+
+        /**
+        * @brief How far the criterion of the last isActive() was on the active side of epsilon - valid if hasCriterion()
+        *
+        * epsilon - criterion, or criterion - epsilon if negated. Negative if the condition was inactive
+        * (a negated condition with margin 0 is inactive as well).
+        */
+		virtual double getMargin() const;
+
+        /**
+        * @brief The time passed to step() before the last isActive() - compare it to the current time to check if getCriterion() is from this control cycle
+        */
+		virtual double getCriterionTime() const;
+
+        /**
+        * @brief How getPredictedActivationTime() extrapolates the criteria of the last control cycles
+        *
+        * LINEAR (the default) fits a line to the margins, EXPONENTIAL fits an exponential decay of the
+        * criterion towards the goal - the convergence of a proportional controller. EXPONENTIAL applies
+        * to conditions that are not negated and have an epsilon > 0, the others are fitted linearly.
+        */
+		enum ConvergenceModel { LINEAR, EXPONENTIAL };
+
+		virtual void setConvergenceModel(ConvergenceModel convergence_model);
+		virtual ConvergenceModel getConvergenceModel() const;
+
+        /**
+        * @brief The time at which this condition is expected to become active, fitted to the last HISTORY_SIZE criteria
+        *
+        * The time of the last criterion if the last isActive() was true, +infinity if the criteria do not
+        * approach epsilon and -infinity (any time) if fewer than two criteria were computed since initialize().
+        */
+		virtual double getPredictedActivationTime() const;
+
+		enum { HISTORY_SIZE = 8 };
+
 		/**
 		 * @brief Set a controller goal
 		 * 
@@ -217,12 +295,41 @@ namespace ha {
 		virtual void setEpsilon(double epsilon);
 		virtual double getEpsilon() const;
 
+		/**
+		 * @brief Set the width of the hysteresis band around epsilon (default 0)
+		 *
+		 * The condition becomes active at epsilon as usual, but once active it stays active until the
+		 * criterion leaves epsilon + hysteresis (epsilon - hysteresis if negated). This keeps noisy
+		 * sensors near epsilon from toggling the condition. The band is reset by initialize().
+		 *
+		 * Conditions of a switch back to the mode the HybridAutomaton just left become active only beyond
+		 * the other side of the band (see setReturning()), so a pair of switches A->B, B->A does not chatter.
+		 */
+		virtual void setHysteresis(double hysteresis);
+		virtual double getHysteresis() const;
+
+		/**
+		 * @brief Until the next initialize(), become active only at epsilon - hysteresis (epsilon + hysteresis if negated)
+		 *
+		 * Set by the HybridAutomaton for the switches that lead back to the mode it just left: the switch
+		 * that left that mode became active at epsilon, the way back needs the criterion to cross the band.
+		 */
+		virtual void setReturning(bool returning);
+		virtual bool isReturning() const;
+
 		/**
 		* @brief Set the name of the mode this jumpCondition emanates from. This function needs to be called
 		* before deserializing! 
 		*/
 		virtual void setSourceModeName(const std::string& sourceModeName);
 
+		/**
+		* @brief Identifies this condition within its ControlSwitch: its index, for operands of an ExpressionCondition
+		* the path of the expression and the index of the operand, e.g. "1.0". Is set by ControlSwitch::add().
+		*/
+		virtual void setPath(const std::string& path);
+		const std::string& getPath() const;
+
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
 		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
@@ -231,6 +338,8 @@ namespace ha {
 
 
 	protected:
+		// evaluates many conditions at once and hands the criteria back through _acceptCriterion()
+		friend class ConditionBatch;
 
 		GoalSource	_goalSource;
 		::Eigen::MatrixXd _goal;
@@ -253,12 +362,73 @@ namespace ha {
 		//Needed for deserialization
 		std::string _sourceModeName;
 
+		// see setPath(), and the name of the profiler scopes: the path and the sensor type
+		std::string _path;
+		std::string _profile_name;
+
 		bool	_is_goal_relative;
 
         bool _negate;
 
+		// width of the band beyond epsilon in which an active condition stays active
+		double _hysteresis;
+
+		// the condition leads back to the mode that was just left, see setReturning()
+		bool _is_returning;
+
+		// result of the last isActive(), reused while the sensor has no new value
+		mutable bool _has_cached_result;
+		mutable bool _cached_result;
+
+		// the sensor was inactive in the last isActive()
+		mutable bool _is_unknown;
+
+		// time passed to the last step() or initialize()
+		double _step_time;
+
+		// criterion of the last isActive(), its margin to epsilon and the time it was computed for
+		mutable bool _has_criterion;
+		mutable double _criterion;
+		mutable double _margin;
+		mutable double _criterion_time;
+
+		// buffers of isActive(), they keep their size so that reading the sensor does not allocate
+		mutable ::Eigen::MatrixXd _current_value;
+		mutable ::Eigen::MatrixXd _initial_value;
+		mutable ::Eigen::MatrixXd _relative_value;
+		mutable ::Eigen::MatrixXd _goal_value;
+
+		// the last criteria and their times in a ring, for getPredictedActivationTime()
+		ConvergenceModel _convergence_model;
+		mutable double _history_criteria[HISTORY_SIZE];
+		mutable double _history_times[HISTORY_SIZE];
+		mutable int _history_size;
+		mutable int _history_next;
+
+		// Controller::getGoalVersion() of the goal in _goal_value, valid if _has_goal_value
+		mutable bool _has_goal_value;
+		mutable unsigned long _goal_version;
+
+		// true if prepare() was called since the last initialize()
+		bool _is_prepared;
+
+		void _subscribeToGoal();
+
+		virtual void _updateProfileName();
+
+		// the goal used by isActive(): _goal in place, a versioned controller goal copied only when its version changed
+		const ::Eigen::MatrixXd& _resolveGoal() const;
+
+		// true if the goal cannot have changed since the last isActive()
+		bool _isGoalUnchanged() const;
+
 		double _computeJumpCriterion(const ::Eigen::MatrixXd& x, const ::Eigen::MatrixXd& y) const;
 
+		// keeps the criterion computed for \a value and returns the result of isActive()
+		bool _acceptCriterion(const ::Eigen::MatrixXd& value, double criterion) const;
+
+		double _getWeight(int i, int j) const;
+
 		virtual JumpCondition* _doClone() const
 		{
 			return (new JumpCondition(*this));
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_NORM_SENSOR_H_
+#define HYBRID_AUTOMATON_NORM_SENSOR_H_
+
+#include "hybrid_automaton/DerivedSensor.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class NormSensor;
+	typedef boost::shared_ptr<NormSensor> NormSensorPtr;
+	typedef boost::shared_ptr<const NormSensor> NormSensorConstPtr;
+
+	/**
+	 * @brief Norm of its operand as a 1x1 value
+	 *
+	 * The norm is "L1", "L2" (default) or "L_INF" over all entries of the operand.
+	 */
+	class NormSensor : public DerivedSensor
+	{
+	public:
+
+		typedef boost::shared_ptr<NormSensor> Ptr;
+		typedef boost::shared_ptr<const NormSensor> ConstPtr;
+
+		NormSensor();
+
+		virtual ~NormSensor();
+
+		NormSensor(const NormSensor& ss);
+
+		NormSensorPtr clone() const
+		{
+			return (NormSensorPtr(_doClone()));
+		}
+
+		enum Norm { L1, L2, L_INF };
+
+		virtual void setNorm(Norm norm);
+
+		virtual Norm getNorm() const;
+
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+
+		// required to enable deserialization of this sensor
+		HA_SENSOR_INSTANCE(node, system, ha) {
+			Sensor::Ptr sensor(new NormSensor());
+			sensor->deserialize(node, system, ha);
+			return sensor;
+		}
+
+	protected:
+		Norm _norm;
+
+		virtual std::size_t _getMinOperands() const;
+		virtual std::size_t _getMaxOperands() const;
+
+		virtual void _serializeAttributes(const DescriptionTreeNode::Ptr& tree) const;
+		virtual void _deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree);
+
+		virtual NormSensor* _doClone() const
+		{
+			return (new NormSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_NORM_SENSOR_H_
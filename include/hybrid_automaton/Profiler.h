@@ -0,0 +1,284 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_PROFILER_H_
+#define HYBRID_AUTOMATON_PROFILER_H_
+
+#include "hybrid_automaton/CycleClock.h"
+
+#include <boost/atomic.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Instrumentation macros of the step profiler
+ *
+ * The profiler is only compiled into the library if HA_ENABLE_PROFILING is defined
+ * (cmake -DPROFILING=ON). Otherwise all macros expand to nothing and cost nothing.
+ *
+ * HA_PROFILE_TICK(NAME) opens the root scope of one control cycle, HA_PROFILE_SCOPE(KIND, NAME)
+ * opens a nested scope. Both last until the end of the enclosing block. KIND must be a string literal,
+ * NAME is a std::string that identifies the profiled object (e.g. the name of the ControlSwitch).
+ * Scopes with the same KIND and NAME below the same parent share one node, so an automaton that is
+ * deserialized again is accumulated into the nodes of the previous one.
+ */
+#ifdef HA_ENABLE_PROFILING
+#define HA_PROFILE_CONCAT_(A, B) A ## B
+#define HA_PROFILE_CONCAT(A, B) HA_PROFILE_CONCAT_(A, B)
+#define HA_PROFILE_TICK(NAME) \
+	::ha::Profiler::TickScope HA_PROFILE_CONCAT(__ha_profile_tick_, __LINE__)(NAME)
+#define HA_PROFILE_SCOPE(KIND, NAME) \
+	::ha::Profiler::Scope HA_PROFILE_CONCAT(__ha_profile_scope_, __LINE__)(KIND, NAME)
+#else
+#define HA_PROFILE_TICK(NAME)
+#define HA_PROFILE_SCOPE(KIND, NAME)
+#endif
+
+namespace ha {
+
+	/**
+	 * @brief A log-linear latency histogram in the spirit of HdrHistogram
+	 *
+	 * Values are bucketed by their power of two and, within a power of two, linearly into
+	 * 2^SUB_BUCKET_BITS sub-buckets, which bounds the relative error of reported percentiles
+	 * to ~6%. Values below 2^SUB_BUCKET_BITS are stored exactly.
+	 *
+	 * All counters are atomics that are written by a single thread (the control thread)
+	 * without locks or read-modify-write instructions. Any other thread may read them at any time.
+	 */
+	class LatencyHistogram {
+	public:
+		typedef CycleClock::Ticks Ticks;
+
+		enum {
+			SUB_BUCKET_BITS = 4,
+			SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+			NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS
+		};
+
+		LatencyHistogram();
+
+		/**
+		 * @brief Add one sample - must only be called from one thread at a time
+		 */
+		void record(Ticks value);
+
+		void reset();
+
+		unsigned long long getCount() const;
+		Ticks getTotal() const;
+		Ticks getMin() const;
+		Ticks getMax() const;
+
+		/**
+		 * @brief Returns the (upper bound of the bucket of the) value below which \a percentile percent of the samples fall
+		 */
+		Ticks getPercentile(double percentile) const;
+
+		static int bucketIndex(Ticks value);
+		static Ticks bucketUpperBound(int index);
+
+	private:
+		LatencyHistogram(const LatencyHistogram&);
+		LatencyHistogram& operator=(const LatencyHistogram&);
+
+		boost::atomic<unsigned long long> _buckets[NUM_BUCKETS];
+		boost::atomic<unsigned long long> _count;
+		boost::atomic<Ticks> _total;
+		boost::atomic<Ticks> _min;
+		boost::atomic<Ticks> _max;
+	};
+
+	/**
+	 * @brief Hierarchical profiler of HybridAutomaton::step
+	 *
+	 * The profiler keeps a tree of scopes: the root of each tick is HybridAutomaton::step, below it
+	 * the evaluation of each ControlSwitch, each JumpCondition and each Sensor read, mode transitions
+	 * and ControlSet::step. Each node has its own LatencyHistogram.
+	 *
+	 * If a tick takes longer than the budget set with setTickBudget(), the profiler follows the most
+	 * expensive path of that tick down to a leaf and remembers it, so that overruns can be attributed
+	 * to a specific condition or sensor.
+	 *
+	 * The profiler must only be fed from one control thread. dump() and getStatistics() can be called
+	 * from any thread while the control loop is running. Replay::run() switches it off while it steps
+	 * automata in several threads.
+	 *
+	 * You do not use this class directly but through the HA_PROFILE_* macros.
+	 */
+	class Profiler {
+	public:
+		typedef CycleClock::Ticks Ticks;
+
+		enum { MAX_NODES = 1024, MAX_DEPTH = 32, MAX_OVERRUNS = 64 };
+
+		/**
+		 * @brief Timing summary of one node of the profile tree (all times in nanoseconds)
+		 */
+		struct NodeStatistics {
+			int id;
+			int parent;
+			int depth;
+			std::string label;
+			unsigned long long count;
+			double total;
+			double min;
+			double p50;
+			double p90;
+			double p99;
+			double p999;
+			double max;
+		};
+
+		/**
+		 * @brief A tick that took longer than the tick budget
+		 */
+		struct Overrun {
+			unsigned long long tick;
+			double duration;
+			int culprit;
+		};
+
+		/**
+		 * @brief RAII helper that profiles the enclosing block
+		 */
+		class Scope {
+		public:
+			Scope(const char* kind, const std::string& name) {
+				_node = Profiler::instance().enter(kind, name, _start);
+			}
+			~Scope() {
+				if (_node >= 0)
+					Profiler::instance().leave(_node, _start);
+			}
+		private:
+			int _node;
+			Ticks _start;
+		};
+
+		/**
+		 * @brief RAII helper that profiles one complete control cycle
+		 */
+		class TickScope {
+		public:
+			TickScope(const std::string& name) {
+				_node = Profiler::instance().beginTick(name, _start);
+			}
+			~TickScope() {
+				if (_node >= 0)
+					Profiler::instance().endTick(_node, _start);
+			}
+		private:
+			int _node;
+			Ticks _start;
+		};
+
+		static Profiler& instance();
+
+		/**
+		 * @brief Switch recording on or off at run time (default: on)
+		 */
+		void setEnabled(bool enabled);
+		bool isEnabled() const;
+
+		/**
+		 * @brief Ticks that take longer than \a seconds are reported as overruns (0 disables the check)
+		 */
+		void setTickBudget(double seconds);
+		double getTickBudget() const;
+
+		/**
+		 * @brief Drop all recorded data
+		 *
+		 * Must not be called while the control loop is running.
+		 */
+		void reset();
+
+		unsigned long long getTickCount() const;
+		unsigned long long getOverrunCount() const;
+
+		/**
+		 * @brief The last (at most MAX_OVERRUNS) overruns, oldest first
+		 */
+		void getOverruns(std::vector<Overrun>& overruns) const;
+
+		/**
+		 * @brief Statistics of all nodes in depth-first order
+		 */
+		void getStatistics(std::vector<NodeStatistics>& statistics) const;
+
+		/**
+		 * @brief The labels from the root to node \a id, separated by \a separator
+		 */
+		std::string getPath(int id, const std::string& separator = ";") const;
+
+		/**
+		 * @brief Write all statistics in the text format read by hybrid_automaton_profile
+		 */
+		void dump(std::ostream& out) const;
+		bool dump(const std::string& filename) const;
+
+		/**
+		 * @brief Write the self time of each node in the folded stack format of flamegraph.pl
+		 */
+		void dumpCollapsed(std::ostream& out) const;
+
+		// used by the scope helpers
+		int enter(const char* kind, const std::string& name, Ticks& start);
+		void leave(int node, Ticks start);
+		int beginTick(const std::string& name, Ticks& start);
+		void endTick(int node, Ticks start);
+
+	private:
+		struct Node;
+
+		Profiler();
+		~Profiler();
+		Profiler(const Profiler&);
+		Profiler& operator=(const Profiler&);
+
+		int _findOrCreate(int parent, const char* kind, const std::string& name);
+		void _link(int node);
+		Ticks _selfTime(int node) const;
+
+		Node* _nodes[MAX_NODES];
+		boost::atomic<int> _num_nodes;
+
+		int _stack[MAX_DEPTH];
+		int _depth;
+
+		bool _enabled;
+		Ticks _tick_budget;
+
+		boost::atomic<unsigned long long> _tick;
+		boost::atomic<unsigned long long> _num_overruns;
+		Overrun _overruns[MAX_OVERRUNS];
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_PROFILER_H_
@@ -61,6 +61,16 @@ namespace ha {
 
 		virtual void initialize(const double& t); 
 
+        /**
+         * @brief Checks once per control cycle if the topic was updated (System::isROSTopicUpdated)
+         */
+		virtual void step(const double& t);
+
+        /**
+         * @brief Subscribes to the topic
+         */
+		virtual void prepare();
+
         /**
          * @brief Return the value of the topic /a _ros_topic_name
          */
@@ -82,6 +92,11 @@ namespace ha {
 
 		virtual bool isActive() const;
 
+        /**
+         * @brief Only true if the topic was updated before the last step() or initialize()
+         */
+		virtual bool hasNewValue() const;
+
 		// required to enable deserialization of this sensor
 		HA_SENSOR_INSTANCE(node, system, ha) {
 			Sensor::Ptr sensor(new ROSTopicSensor());
@@ -98,6 +113,12 @@ namespace ha {
 
 		mutable ::Eigen::MatrixXd _last_pose;
 
+		// System::isROSTopicUpdated() of the last step() or initialize(), and whether the pose was read since
+		bool _is_updated;
+		mutable bool _is_update_read;
+
+		void _latchUpdate();
+
 		virtual ROSTopicSensor* _doClone() const
 		{
 			return (new ROSTopicSensor(*this));
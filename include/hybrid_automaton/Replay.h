@@ -0,0 +1,148 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_REPLAY_H_
+#define HYBRID_AUTOMATON_REPLAY_H_
+
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/ReplaySystem.h"
+#include "hybrid_automaton/TraceRecorder.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	class Replay;
+	typedef boost::shared_ptr<Replay> ReplayPtr;
+	typedef boost::shared_ptr<const Replay> ReplayConstPtr;
+
+	/**
+	 * @brief Re-executes HybridAutomata against a recorded trace as fast as possible
+	 *
+	 * The trace has to be recorded with a RecordingSystem (see TraceRecorder). Each automaton
+	 * is stepped with the recorded times while a ReplaySystem returns the recorded outputs, and
+	 * its transitions are compared against the recorded ones. Automata can be modified (e.g.
+	 * different epsilons or weights of the JumpConditions) to tune them offline:
+	 *
+	 * @code
+	 *   Replay replay;
+	 *   replay.load("run.hatrace");
+	 *   ReplaySystem::Ptr system = replay.createSystem();
+	 *   HybridAutomaton::Ptr ha(new HybridAutomaton);
+	 *   ha->deserialize(tree, system);
+	 *   Replay::Result result = replay.run(ha, system);
+	 * @endcode
+	 *
+	 * The loaded trace is read-only, so run() can be called from several threads.
+	 */
+	class Replay {
+	public:
+		typedef boost::shared_ptr<Replay> Ptr;
+		typedef boost::shared_ptr<const Replay> ConstPtr;
+
+		struct Transition {
+			unsigned long long tick;
+			double time;
+			std::string control_switch;
+			std::string target_mode;
+
+			bool operator==(const Transition& other) const;
+		};
+
+		struct Result {
+			unsigned long long ticks;
+			/** @brief true if all transitions happened in the same ticks as recorded */
+			bool matches;
+			/** @brief tick of the first transition that differs from the recording (only if !matches) */
+			unsigned long long first_mismatch;
+			std::vector<Transition> transitions;
+			/** @brief set if the automaton threw during replay (the message of strings and std::exceptions) */
+			std::string error;
+			/** @brief wall clock time of the replay in seconds */
+			double duration;
+		};
+
+		Replay();
+		virtual ~Replay();
+
+		/**
+		 * @brief Read the whole trace \a filename into memory
+		 */
+		virtual void load(const std::string& filename);
+
+		/**
+		 * @brief A new ReplaySystem that already holds the first recorded value of each output
+		 *
+		 * Deserialize each automaton with its own ReplaySystem.
+		 */
+		ReplaySystem::Ptr createSystem() const;
+
+		/**
+		 * @brief Step \a automaton through the whole trace
+		 */
+		Result run(const HybridAutomaton::Ptr& automaton, const ReplaySystem::Ptr& system) const;
+
+		/**
+		 * @brief Step all \a automata (each with the corresponding system) through the whole trace in parallel
+		 *
+		 * The Profiler is switched off while more than one thread runs.
+		 *
+		 * @param num_threads number of worker threads, 0 for one per core
+		 */
+		std::vector<Result> run(const std::vector<HybridAutomaton::Ptr>& automata, const std::vector<ReplaySystem::Ptr>& systems, int num_threads = 0) const;
+
+		const std::vector<Transition>& getRecordedTransitions() const;
+
+		unsigned long long getNumberOfTicks() const;
+
+		/**
+		 * @brief The recorded system values of each tick, to be passed to ReplaySystem::setValues()
+		 */
+		const std::vector<TraceReader::Tick>& getTicks() const;
+
+		/**
+		 * @brief Number of ticks that were dropped while recording - such traces cannot be replayed exactly
+		 */
+		unsigned long long getDroppedTicks() const;
+
+	protected:
+		void _runJobs(const std::vector<HybridAutomaton::Ptr>* automata, const std::vector<ReplaySystem::Ptr>* systems,
+			std::vector<Result>* results, boost::atomic<std::size_t>* next) const;
+
+		std::map<int, TraceReader::Channel> _channels;
+		std::vector<TraceReader::Tick> _ticks;
+		std::vector<TraceReader::Value> _initial_values;
+		std::vector<Transition> _transitions;
+		unsigned long long _dropped_ticks;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_REPLAY_H_
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_REPLAY_SYSTEM_H_
+#define HYBRID_AUTOMATON_REPLAY_SYSTEM_H_
+
+#include "hybrid_automaton/System.h"
+#include "hybrid_automaton/SensorSource.h"
+#include "hybrid_automaton/TraceRecorder.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <Eigen/Dense>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	class RecordingSystem;
+	typedef boost::shared_ptr<RecordingSystem> RecordingSystemPtr;
+	typedef boost::shared_ptr<const RecordingSystem> RecordingSystemConstPtr;
+
+	class ReplaySystem;
+	typedef boost::shared_ptr<ReplaySystem> ReplaySystemPtr;
+	typedef boost::shared_ptr<const ReplaySystem> ReplaySystemConstPtr;
+
+	/**
+	 * @brief A System that forwards to your System and records all outputs into the current trace
+	 *
+	 * Deserialize your HybridAutomaton with a RecordingSystem and set a TraceRecorder to record
+	 * everything that is needed to re-execute the automaton with a ReplaySystem.
+	 *
+	 * getSensorSource() wraps the sources of your System and records every sample fetched from them
+	 * (value, time stamp and sequence number). AsyncSensors fetch a source once per tick (see
+	 * SensorSource::fetchForCycle()), so all of them see the recorded sample in the replay as well.
+	 *
+	 * @see Replay
+	 */
+	class RecordingSystem : public System {
+	public:
+		typedef boost::shared_ptr<RecordingSystem> Ptr;
+		typedef boost::shared_ptr<const RecordingSystem> ConstPtr;
+
+		RecordingSystem(const System::ConstPtr& system);
+
+		virtual ~RecordingSystem();
+
+		virtual int getDof() const;
+		virtual ::Eigen::MatrixXd getJointConfiguration() const;
+		virtual ::Eigen::MatrixXd getJointVelocity() const;
+		virtual ::Eigen::MatrixXd getForceTorqueMeasurement(const int& port = DEFAULT_FT_PORT) const;
+		virtual ::Eigen::MatrixXd getFramePose(const std::string& frame_id) const;
+
+		virtual bool subscribeToROSMessage(const std::string& topic) const;
+		virtual bool subscribeToTransform(const std::string& frame, const std::string& parent) const;
+		virtual bool isROSTopicAvailable(const std::string& topic_name) const;
+		virtual bool isROSTopicUpdated(const std::string& topic_name) const;
+		virtual bool getROSPose(const std::string& topic_name, const std::string& topic_type, ::Eigen::MatrixXd& pose) const;
+		virtual bool getROSTfPose(const std::string& child, const std::string& parent, ::Eigen::MatrixXd& pose) const;
+		virtual SensorSourcePtr getSensorSource(const std::string& name) const;
+
+		System::ConstPtr getSystem() const;
+
+	protected:
+		System::ConstPtr _system;
+
+		// recording wrappers of the sources of _system, one per name
+		mutable std::map<std::string, SensorSource::Ptr> _sources;
+	};
+
+	/**
+	 * @brief A System that returns the outputs recorded by a RecordingSystem
+	 *
+	 * Values are sample-and-hold: setValues() only replaces the outputs that were read in a tick.
+	 * Reading an output that was never recorded throws.
+	 *
+	 * getSensorSource() hands out a SensorSource for any name that republishes the recorded samples
+	 * in the ticks in which they were fetched.
+	 *
+	 * @see Replay
+	 */
+	class ReplaySystem : public System {
+	public:
+		typedef boost::shared_ptr<ReplaySystem> Ptr;
+		typedef boost::shared_ptr<const ReplaySystem> ConstPtr;
+
+		/**
+		 * @param channels the channels of the trace (TraceReader::getChannels())
+		 */
+		ReplaySystem(const std::map<int, TraceReader::Channel>& channels);
+
+		virtual ~ReplaySystem();
+
+		/**
+		 * @brief Replace the outputs with the system values recorded in \a tick
+		 */
+		void setValues(const TraceReader::Tick& tick);
+
+		/**
+		 * @brief Replace the output recorded in \a channel
+		 */
+		void setValue(int channel, const ::Eigen::MatrixXd& value);
+
+		virtual int getDof() const;
+		virtual ::Eigen::MatrixXd getJointConfiguration() const;
+		virtual ::Eigen::MatrixXd getJointVelocity() const;
+		virtual ::Eigen::MatrixXd getForceTorqueMeasurement(const int& port = DEFAULT_FT_PORT) const;
+		virtual ::Eigen::MatrixXd getFramePose(const std::string& frame_id) const;
+
+		virtual bool subscribeToROSMessage(const std::string& topic) const;
+		virtual bool subscribeToTransform(const std::string& frame, const std::string& parent) const;
+		virtual bool isROSTopicAvailable(const std::string& topic_name) const;
+		virtual bool isROSTopicUpdated(const std::string& topic_name) const;
+		virtual bool getROSPose(const std::string& topic_name, const std::string& topic_type, ::Eigen::MatrixXd& pose) const;
+		virtual bool getROSTfPose(const std::string& child, const std::string& parent, ::Eigen::MatrixXd& pose) const;
+		virtual SensorSourcePtr getSensorSource(const std::string& name) const;
+
+	protected:
+		struct ReplaySource {
+			SensorSource::Ptr source;
+			// sequence number of the last republished sample
+			double sequence;
+		};
+
+		const ::Eigen::MatrixXd* _find(const std::string& name) const;
+		const ::Eigen::MatrixXd& _get(const std::string& name) const;
+		void _republish(ReplaySource& source) const;
+
+		std::map<std::string, int> _channel_ids;
+		std::vector< ::Eigen::MatrixXd> _values;
+		std::vector<bool> _valid;
+		mutable std::map<std::string, ReplaySource> _sources;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_REPLAY_SYSTEM_H_
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_RIGID_BODY_MOTION_H_
+#define HYBRID_AUTOMATON_RIGID_BODY_MOTION_H_
+
+#include <Eigen/Dense>
+
+namespace ha {
+
+	/**
+	 * @brief Logarithm of the rigid body transformation \a pose (4x4) as twist (translation; rotation)
+	 *
+	 * The twist that moves the identity to \a pose in unit time, expressed in the moving frame.
+	 */
+	void logPose(const ::Eigen::Matrix4d& pose, ::Eigen::Matrix<double, 6, 1>& twist);
+
+	/**
+	 * @brief Exponential of \a twist (translation; rotation), the inverse of logPose()
+	 */
+	void expTwist(const ::Eigen::Matrix<double, 6, 1>& twist, ::Eigen::Matrix4d& pose);
+
+}
+
+#endif // HYBRID_AUTOMATON_RIGID_BODY_MOTION_H_
@@ -84,6 +84,27 @@ namespace ha {
 
 		virtual ::Eigen::MatrixXd getInitialValue() const;
 
+        /**
+        * @brief Writes the current value of this sensor into \a value
+        *
+        * Same as getCurrentValue(), but reuses the memory of \a value: once it has the right size,
+        * reading does not allocate. JumpCondition reads sensors this way in every control cycle.
+        *
+        * The default implementation copies getCurrentValue() - override it (and readRelativeCurrentValue(),
+        * readInitialValue() if you override their get* counterparts) to avoid the copies.
+        */
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+
+        /**
+        * @brief Writes the value of getRelativeCurrentValue() into \a value
+        */
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+
+        /**
+        * @brief Writes the value of getInitialValue() into \a value
+        */
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
+
 		virtual void setSystem(const System::ConstPtr& system);
 
         /**
@@ -91,6 +112,14 @@ namespace ha {
         */
 		virtual void initialize(const double& t); 
 
+        /**
+        * @brief Prepares an activation that is likely to happen soon, e.g. by subscribing - is called from the JumpCondition
+        *
+        * Everything done here does not need to be done in initialize() anymore, which then only stores the
+        * initial sensor value. By default there is nothing to prepare.
+        */
+		virtual void prepare();
+
         /**
         * @brief Deactivates the sensor - is called from the JumpCondition
         */
@@ -112,6 +141,35 @@ namespace ha {
 			return true;
 		}
 
+		/**
+		 * @brief True if getCurrentValue() is the (1x1) time that was passed to step()
+		 *
+		 * Lets a JumpCondition compute when it can become active at the earliest.
+		 */
+		virtual bool isClock() const {
+			return false;
+		}
+
+		/**
+		 * @brief False if getCurrentValue() cannot have changed since it was last read
+		 *
+		 * Event driven sensors override this so that their JumpConditions reuse the last
+		 * result instead of evaluating again. By default the value can change at any time.
+		 */
+		virtual bool hasNewValue() const {
+			return true;
+		}
+
+		/**
+		 * @brief Acquisition time of getCurrentValue(), for sensors whose samples arrive with a delay
+		 *
+		 * Returns false for sensors that are read in the control cycle - their values are as old as the
+		 * time passed to step().
+		 */
+		virtual bool getSampleTime(double& time) const {
+			return false;
+		}
+
 	protected:
 		System::ConstPtr _system;
 
@@ -130,6 +188,11 @@ namespace ha {
 		 */
 		mutable ::Eigen::MatrixXd _initial_sensor_value;
 
+		/**
+		 * @brief Default implementation of readRelativeCurrentValue(): current value - initial value
+		 */
+		void _readDifferenceToInitialValue(::Eigen::MatrixXd& value) const;
+
 	};
 
 }
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_SENSOR_SOURCE_H_
+#define HYBRID_AUTOMATON_SENSOR_SOURCE_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <Eigen/Dense>
+
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	class SensorSource;
+	typedef boost::shared_ptr<SensorSource> SensorSourcePtr;
+	typedef boost::shared_ptr<const SensorSource> SensorSourceConstPtr;
+
+	/**
+	 * @brief Hands the latest sample from one producer thread to one consumer thread
+	 *
+	 * A triple buffer: the producer writes into its own buffer and swaps it with the middle one, the
+	 * consumer swaps the middle buffer with its own if it holds a newer sample. Both sides are wait-free
+	 * and never see a partially written sample; samples the consumer did not fetch in time are
+	 * overwritten. Neither side allocates as long as the size of the samples does not change.
+	 */
+	class SensorMailbox {
+	public:
+		struct Sample {
+			Sample() : time(0.0), sequence(0) {}
+
+			::Eigen::MatrixXd value;
+			double time;
+			// 1 for the first published sample, 0 if nothing was published yet
+			unsigned long long sequence;
+		};
+
+		/**
+		 * @param rows, cols size of the samples, used to preallocate the buffers
+		 */
+		SensorMailbox(int rows = 0, int cols = 0);
+
+		virtual ~SensorMailbox();
+
+		/**
+		 * @brief Producer: make \a value, taken at \a time, the latest sample
+		 */
+		void publish(const ::Eigen::MatrixXd& value, double time);
+
+		/**
+		 * @brief Consumer: move to the latest sample, returns false if there is nothing newer
+		 */
+		bool fetch();
+
+		/**
+		 * @brief Consumer: the sample of the last successful fetch()
+		 */
+		const Sample& getSample() const;
+
+	protected:
+		enum { INDEX_MASK = 3, NEW_SAMPLE = 4 };
+
+		Sample _buffers[3];
+		// index of the middle buffer, NEW_SAMPLE if the consumer did not fetch it yet
+		boost::atomic<unsigned int> _middle;
+		unsigned int _back;
+		unsigned int _front;
+		unsigned long long _published;
+
+	private:
+		SensorMailbox(const SensorMailbox&);
+		SensorMailbox& operator=(const SensorMailbox&);
+	};
+
+	/**
+	 * @brief A named signal whose samples are pushed by an external thread, e.g. a camera or a ROS callback
+	 *
+	 * The producer calls publish(), the control thread reads the latest sample with fetchForCycle() and
+	 * getValue() without waiting (see AsyncSensor). Connecting to the producer is done by subscribe(),
+	 * which is never called from the control thread - override _connect() to subscribe to middleware
+	 * and use a SensorSourceSubscriber to retry until it succeeds.
+	 *
+	 * Usage:
+	 * @code
+	 *   SensorSource::Ptr marker(new SensorSource("marker_pose", 4, 4));
+	 *   simulated_system->addSensorSource(marker);
+	 *   // in the tracking thread
+	 *   marker->publish(pose, timestamp);
+	 * @endcode
+	 */
+	class SensorSource {
+	public:
+		typedef boost::shared_ptr<SensorSource> Ptr;
+		typedef boost::shared_ptr<const SensorSource> ConstPtr;
+
+		/**
+		 * @param rows, cols size of the samples, used to preallocate the mailbox
+		 */
+		SensorSource(const std::string& name, int rows = 0, int cols = 0);
+
+		virtual ~SensorSource();
+
+		const std::string& getName() const;
+
+		/**
+		 * @brief Connect to the producer - returns true on success or if already subscribed
+		 */
+		bool subscribe();
+
+		void unsubscribe();
+
+		bool isSubscribed() const;
+
+		/**
+		 * @brief Called by the producer thread
+		 */
+		void publish(const ::Eigen::MatrixXd& value, double time);
+
+		/**
+		 * @brief Called by the control thread: move to the latest sample, false if there is nothing newer
+		 *
+		 * Overridden by sources that forward to another source, e.g. for recording.
+		 */
+		virtual bool fetch();
+
+		/**
+		 * @brief Called by the control thread: fetch() once per control cycle, identified by its \a time
+		 *
+		 * Further calls with the same \a time keep the sample, so all readers of the source see the same
+		 * sample during a control cycle. Readers find new samples by comparing getSequence() with the
+		 * sequence they read last - the return value of fetch() is only seen by the first of them.
+		 */
+		void fetchForCycle(const double& time);
+
+		/**
+		 * @brief The latest fetched sample (empty until the first sample was fetched)
+		 */
+		const ::Eigen::MatrixXd& getValue() const;
+
+		/**
+		 * @brief Time stamp the producer gave to the latest fetched sample
+		 */
+		double getTime() const;
+
+		/**
+		 * @brief Number of the latest fetched sample - 0 if none was received yet
+		 */
+		unsigned long long getSequence() const;
+
+	protected:
+		/**
+		 * @brief Subscribe to the producer, e.g. a middleware topic - nothing to do for in-process producers
+		 */
+		virtual bool _connect();
+
+		virtual void _disconnect();
+
+		std::string _name;
+		SensorMailbox _mailbox;
+		// control cycle of the last fetchForCycle()
+		bool _has_fetched_cycle;
+		double _fetched_cycle;
+		boost::atomic<bool> _subscribed;
+		boost::mutex _subscription_mutex;
+
+	private:
+		SensorSource(const SensorSource&);
+		SensorSource& operator=(const SensorSource&);
+	};
+
+	/**
+	 * @brief Subscribes SensorSources from a background thread and retries until they succeed
+	 *
+	 * Keeps subscription management off the control thread.
+	 */
+	class SensorSourceSubscriber {
+	public:
+		typedef boost::shared_ptr<SensorSourceSubscriber> Ptr;
+
+		/**
+		 * @param retry_period seconds between two attempts to subscribe the remaining sources
+		 */
+		SensorSourceSubscriber(double retry_period = 0.1);
+
+		virtual ~SensorSourceSubscriber();
+
+		void add(const SensorSource::Ptr& source);
+
+		/**
+		 * @brief Try to subscribe all sources once, returns the number of sources that are still not subscribed
+		 */
+		int subscribeAll();
+
+		/**
+		 * @brief Start the background thread
+		 */
+		void start();
+
+		/**
+		 * @brief Stop the background thread - the sources stay subscribed
+		 */
+		void stop();
+
+	protected:
+		void _loop();
+
+		double _retry_period;
+		boost::mutex _mutex;
+		std::vector<SensorSource::Ptr> _sources;
+		boost::shared_ptr<boost::thread> _thread;
+		boost::atomic<bool> _stop;
+
+	private:
+		SensorSourceSubscriber(const SensorSourceSubscriber&);
+		SensorSourceSubscriber& operator=(const SensorSourceSubscriber&);
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_SENSOR_SOURCE_H_
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_SHARED_SENSOR_H_
+#define HYBRID_AUTOMATON_SHARED_SENSOR_H_
+
+#include "hybrid_automaton/Sensor.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class SharedSensor;
+	typedef boost::shared_ptr<SharedSensor> SharedSensorPtr;
+	typedef boost::shared_ptr<const SharedSensor> SharedSensorConstPtr;
+
+	/**
+	 * @brief The control cycles of a HybridAutomaton, shared with its SharedSensors
+	 */
+	struct ControlCycle
+	{
+		typedef boost::shared_ptr<ControlCycle> Ptr;
+		typedef boost::shared_ptr<const ControlCycle> ConstPtr;
+
+		/**
+		 * @brief Starts a new cycle on construction and ends it on destruction
+		 */
+		class Scope {
+		public:
+			explicit Scope(ControlCycle& cycle) : _cycle(cycle) { ++_cycle.count; _cycle.running = true; }
+			~Scope() { _cycle.running = false; }
+		private:
+			ControlCycle& _cycle;
+		};
+
+		ControlCycle() : count(0), running(false) {}
+
+		/** @brief number of the current (or last) cycle */
+		unsigned long long count;
+		/** @brief true while the HybridAutomaton is in step() or initialize() */
+		bool running;
+	};
+
+	/**
+	 * @brief One Sensor used by several JumpConditions
+	 *
+	 * HybridAutomaton::createSharedSensor() hands out one SharedSensor for all structurally equal
+	 * sensor descriptions of an automaton. Within one control cycle of the automaton (one call of
+	 * HybridAutomaton::step() or initialize()) the wrapped sensor is initialized once, stepped once
+	 * and read once - all JumpConditions get the value of the first read after step().
+	 *
+	 * Outside of a control cycle, or without one, all calls go through to the wrapped sensor.
+	 *
+	 * Serializes as the wrapped sensor, so a deserialized and serialized automaton does not change.
+	 */
+	class SharedSensor : public Sensor
+	{
+	public:
+
+		typedef boost::shared_ptr<SharedSensor> Ptr;
+		typedef boost::shared_ptr<const SharedSensor> ConstPtr;
+
+		explicit SharedSensor(const Sensor::Ptr& sensor, const ControlCycle::ConstPtr& cycle = ControlCycle::ConstPtr());
+
+		virtual ~SharedSensor();
+
+		SharedSensor(const SharedSensor& ss);
+
+		SharedSensorPtr clone() const
+		{
+			return (SharedSensorPtr(_doClone()));
+		}
+
+		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual ::Eigen::MatrixXd getRelativeCurrentValue() const;
+		virtual ::Eigen::MatrixXd getInitialValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
+
+		virtual const std::string getType() const;
+		virtual void setType(const std::string& new_type);
+		virtual void setSystem(const System::ConstPtr& system);
+
+		virtual void initialize(const double& t);
+		virtual void prepare();
+		virtual void terminate();
+		virtual void step(const double& t);
+
+		virtual bool isActive() const;
+		virtual bool isClock() const;
+		virtual bool hasNewValue() const;
+
+		virtual bool getSampleTime(double& time) const;
+
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha);
+
+		/**
+		 * @brief The sensor that does the work
+		 */
+		Sensor::Ptr getSensor() const;
+
+	protected:
+		Sensor::Ptr _sensor;
+		ControlCycle::ConstPtr _cycle;
+
+		// guards against initializing and stepping the wrapped sensor once per JumpCondition
+		bool _initialized;
+		unsigned long long _initialize_cycle;
+		bool _stepped;
+		unsigned long long _step_cycle;
+
+		// values of the current control cycle
+		mutable bool _has_current_value;
+		mutable unsigned long long _current_value_cycle;
+		mutable ::Eigen::MatrixXd _current_value;
+		mutable bool _has_relative_current_value;
+		mutable unsigned long long _relative_current_value_cycle;
+		mutable ::Eigen::MatrixXd _relative_current_value;
+
+		bool _inCycle() const;
+		void _invalidate();
+
+		virtual SharedSensor* _doClone() const
+		{
+			return (new SharedSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_SHARED_SENSOR_H_
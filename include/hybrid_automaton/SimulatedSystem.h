@@ -0,0 +1,205 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_SIMULATED_SYSTEM_H_
+#define HYBRID_AUTOMATON_SIMULATED_SYSTEM_H_
+
+#include "hybrid_automaton/System.h"
+#include "hybrid_automaton/SensorSource.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <Eigen/Dense>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	class SimulatedSystem;
+	typedef boost::shared_ptr<SimulatedSystem> SimulatedSystemPtr;
+	typedef boost::shared_ptr<const SimulatedSystem> SimulatedSystemConstPtr;
+
+	/**
+	 * @brief A deterministic, simulated serial-chain robot
+	 *
+	 * The kinematic model is a chain of revolute joints: the pose of link i is
+	 * pose(i-1) * translation(offset_i) * rotation(axis_i, q_i). The frames "base",
+	 * "link_<i>" and "EE" (the last link times the tool offset) and any frame added with
+	 * addFrame() can be read with getFramePose().
+	 *
+	 * integrate() applies the output of HybridAutomaton::step() - either as joint torques
+	 * acting on a unit inertia with viscous damping or directly as joint velocities - so
+	 * that convergence conditions actually fire:
+	 *
+	 * @code
+	 *   SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	 *   // ... deserialize hybrid_automaton with robot ...
+	 *   for (double t = 0.0; t < 10.0; t += 0.001) {
+	 *       robot->integrate(hybrid_automaton->step(t), 0.001);
+	 *   }
+	 * @endcode
+	 *
+	 * An optional contact plane produces a spring force at the EE frame that is returned by
+	 * getForceTorqueMeasurement() (in the EE frame, like a wrist sensor) and acts on the joints.
+	 */
+	class SimulatedSystem : public System {
+	public:
+		typedef boost::shared_ptr<SimulatedSystem> Ptr;
+		typedef boost::shared_ptr<const SimulatedSystem> ConstPtr;
+
+		enum InputMode { TORQUE_INPUT, VELOCITY_INPUT };
+
+		/**
+		 * @brief A chain with \a dof joints alternating about z and y, each \a link_length above the previous one
+		 */
+		SimulatedSystem(int dof = 7, double link_length = 0.2);
+
+		virtual ~SimulatedSystem();
+
+		/**
+		 * @brief Remove all joints (and frames attached to them)
+		 */
+		void clearJoints();
+
+		/**
+		 * @brief Append a revolute joint about \a axis, located at \a offset from the previous link
+		 */
+		void addJoint(const ::Eigen::Vector3d& axis, const ::Eigen::Vector3d& offset);
+
+		/**
+		 * @brief Add a frame \a name at \a offset (4x4) from link \a joint (-1 for the base)
+		 */
+		void addFrame(const std::string& name, int joint, const ::Eigen::MatrixXd& offset);
+
+		/**
+		 * @brief Transformation (4x4) from the last link to the EE frame
+		 */
+		void setToolOffset(const ::Eigen::MatrixXd& offset);
+
+		void setJointConfiguration(const ::Eigen::MatrixXd& q);
+		void setJointVelocity(const ::Eigen::MatrixXd& qd);
+
+		void setInputMode(InputMode input_mode);
+		InputMode getInputMode() const;
+
+		/**
+		 * @brief Inertia and viscous damping of every joint (TORQUE_INPUT only)
+		 */
+		void setDynamics(double inertia, double damping);
+
+		/**
+		 * @brief Add a plane {x : normal^T x = offset} that the EE frame cannot penetrate without a spring force
+		 *
+		 * @param stiffness spring constant in N/m
+		 */
+		void setContactPlane(const ::Eigen::Vector3d& normal, double offset, double stiffness = 1000.0);
+		void removeContactPlane();
+
+		/**
+		 * @brief Make \a source available to AsyncSensors under its name - a stand-in for external publishers
+		 */
+		void addSensorSource(const SensorSource::Ptr& source);
+
+		/**
+		 * @brief Add gaussian noise with standard deviation \a stddev to the measured joint configuration
+		 *
+		 * The noise is drawn in integrate() from a generator seeded with \a seed, so runs are reproducible.
+		 */
+		void setMeasurementNoise(double stddev, unsigned int seed = 0);
+
+		/**
+		 * @brief Advance the simulation by \a dt seconds with \a command (dof x 1, torques or velocities)
+		 */
+		void integrate(const ::Eigen::MatrixXd& command, double dt);
+
+		/**
+		 * @brief The simulated time, i.e. the sum of all dt passed to integrate()
+		 */
+		double getTime() const;
+
+		/**
+		 * @brief Contact force at the EE frame in world coordinates (3x1)
+		 */
+		::Eigen::Vector3d getContactForce() const;
+
+		virtual int getDof() const;
+		virtual ::Eigen::MatrixXd getJointConfiguration() const;
+		virtual ::Eigen::MatrixXd getJointVelocity() const;
+		virtual ::Eigen::MatrixXd getForceTorqueMeasurement(const int& port = DEFAULT_FT_PORT) const;
+		virtual ::Eigen::MatrixXd getFramePose(const std::string& frame_id) const;
+
+		virtual void readJointConfiguration(::Eigen::MatrixXd& q) const;
+		virtual void readJointVelocity(::Eigen::MatrixXd& qd) const;
+		virtual void readForceTorqueMeasurement(const int& port, ::Eigen::MatrixXd& wrench) const;
+		virtual void readFramePose(const std::string& frame_id, ::Eigen::MatrixXd& pose) const;
+
+		virtual SensorSourcePtr getSensorSource(const std::string& name) const;
+
+	protected:
+		struct Joint {
+			::Eigen::Vector3d axis;
+			::Eigen::Vector3d offset;
+		};
+
+		struct Frame {
+			int joint;
+			::Eigen::MatrixXd offset;
+		};
+
+		void _updateKinematics();
+
+		std::vector<Joint> _joints;
+		std::map<std::string, Frame> _frames;
+		std::map<std::string, SensorSource::Ptr> _sources;
+		::Eigen::MatrixXd _tool_offset;
+
+		::Eigen::VectorXd _q;
+		::Eigen::VectorXd _qd;
+		::Eigen::VectorXd _measured_q;
+		double _time;
+
+		InputMode _input_mode;
+		double _inertia;
+		double _damping;
+
+		bool _has_contact;
+		::Eigen::Vector3d _contact_normal;
+		double _contact_offset;
+		double _contact_stiffness;
+
+		double _noise;
+		boost::random::mt19937 _generator;
+
+		// pose of every link (4x4), index 0 is the base
+		std::vector< ::Eigen::MatrixXd> _link_poses;
+		::Eigen::MatrixXd _ee_pose;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_SIMULATED_SYSTEM_H_
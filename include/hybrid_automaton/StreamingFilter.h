@@ -0,0 +1,161 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_STREAMING_FILTER_H_
+#define HYBRID_AUTOMATON_STREAMING_FILTER_H_
+
+#include <Eigen/Dense>
+
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	/**
+	 * @brief Filters a stream of matrices sample by sample, every entry is a channel of its own
+	 *
+	 * - LOW_PASS: exponential moving average with time constant tau, y += (1 - exp(-dt / tau)) * (x - y)
+	 * - BUTTERWORTH: second order Butterworth low-pass (biquad) with the given cutoff frequency
+	 * - MEDIAN: median of the last window samples
+	 * - WINDOW_MIN, WINDOW_MAX, WINDOW_MEAN: minimum, maximum and mean of the last window samples
+	 *
+	 * All state is allocated in reset(), update() does not allocate. LOW_PASS and BUTTERWORTH update
+	 * all channels at once, the windowed minimum and maximum use monotonic queues (O(1) per sample).
+	 *
+	 * Usage:
+	 * @code
+	 *   StreamingFilter filter;
+	 *   filter.setType(StreamingFilter::MEDIAN);
+	 *   filter.setWindowSize(5);
+	 *   filter.reset(wrench);
+	 *   // every control cycle
+	 *   filter.update(wrench, dt);
+	 *   filtered_wrench = filter.getValue();
+	 * @endcode
+	 */
+	class StreamingFilter
+	{
+	public:
+		enum Type { LOW_PASS, BUTTERWORTH, MEDIAN, WINDOW_MIN, WINDOW_MAX, WINDOW_MEAN };
+
+		StreamingFilter();
+
+		virtual ~StreamingFilter();
+
+		/**
+		 * @brief The type as used in the description tree: "low_pass", "butterworth", "median", "min", "max" or "mean"
+		 */
+		static std::string typeToString(Type type);
+
+		/**
+		 * @brief Inverse of typeToString() - throws for unknown names
+		 */
+		static Type typeFromString(const std::string& name);
+
+		/**
+		 * @brief Changing the type restarts the filter with the next update()
+		 */
+		void setType(Type type);
+		Type getType() const;
+
+		/**
+		 * @brief Time constant of LOW_PASS in seconds, 0 passes the input through
+		 */
+		void setTimeConstant(double time_constant);
+		double getTimeConstant() const;
+
+		/**
+		 * @brief Cutoff frequency of BUTTERWORTH in Hz, 0 (or above the Nyquist frequency) passes the input through
+		 */
+		void setCutoffFrequency(double cutoff_frequency);
+		double getCutoffFrequency() const;
+
+		/**
+		 * @brief Number of samples of MEDIAN, WINDOW_MIN, WINDOW_MAX and WINDOW_MEAN - changing it restarts the filter
+		 */
+		void setWindowSize(int window_size);
+		int getWindowSize() const;
+
+		/**
+		 * @brief Restart the filter at \a x, allocates the state for the size of \a x
+		 */
+		void reset(const ::Eigen::MatrixXd& x);
+
+		/**
+		 * @brief Filter the sample \a x that was taken \a dt seconds after the previous one
+		 *
+		 * Restarts the filter if it was not reset or \a x changed its size. Samples with dt <= 0 are ignored.
+		 */
+		void update(const ::Eigen::MatrixXd& x, double dt);
+
+		/**
+		 * @brief False until the filter was reset (or after its type or window size changed)
+		 */
+		bool hasValue() const;
+
+		/**
+		 * @brief The filtered value, same size as the samples
+		 */
+		const ::Eigen::MatrixXd& getValue() const;
+
+	protected:
+		Type _type;
+		double _time_constant;
+		double _cutoff_frequency;
+		int _window_size;
+
+		bool _has_value;
+		::Eigen::MatrixXd _value;
+		int _channels;
+
+		// BUTTERWORTH: coefficients for the sample period _dt (0 until the first update) and the state
+		// of the transposed direct form II. The coefficients are recomputed when dt differs from _dt by
+		// more than SAMPLE_PERIOD_TOLERANCE (relative), the state then restarts from the current output.
+		static const double SAMPLE_PERIOD_TOLERANCE;
+		double _dt;
+		double _b0, _b1, _b2, _a1, _a2;
+		::Eigen::ArrayXd _z1, _z2;
+
+		// windowed filters: the last samples of all channels as a ring buffer (channels x window_size)
+		unsigned long long _samples;
+		int _next;
+		::Eigen::MatrixXd _window;
+		::Eigen::VectorXd _sum;
+		::Eigen::VectorXd _sorted;
+
+		// WINDOW_MIN / WINDOW_MAX: one monotonic queue per channel, stored as ring buffers
+		::Eigen::MatrixXd _queue_values;
+		std::vector<unsigned long long> _queue_samples;
+		std::vector<int> _queue_front;
+		std::vector<int> _queue_size;
+
+		void _updateCoefficients(double dt);
+		void _push(const ::Eigen::MatrixXd& x);
+		void _pushToQueues(const ::Eigen::MatrixXd& x);
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_STREAMING_FILTER_H_
@@ -77,6 +77,9 @@ namespace ha {
         }
 
 		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
 
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
@@ -98,6 +101,9 @@ namespace ha {
 
         std::vector<int> _index;
 
+		// joint configuration of the whole robot, the subset is gathered from it
+		mutable ::Eigen::MatrixXd _joints;
+
 	};
 
 }
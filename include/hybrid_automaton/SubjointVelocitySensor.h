@@ -95,6 +95,9 @@ namespace ha {
          * the output value of this Sensor will be (q_dot[index[0]], ... q_dot[index[n]])^T
          */
 		virtual ::Eigen::MatrixXd getCurrentValue() const;
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readRelativeCurrentValue(::Eigen::MatrixXd& value) const;
+		virtual void readInitialValue(::Eigen::MatrixXd& value) const;
 
 		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const;
 
@@ -116,6 +119,9 @@ namespace ha {
 
         std::vector<int> _index;
 
+		// joint velocity of the whole robot, the subset is gathered from it
+		mutable ::Eigen::MatrixXd _joints;
+
 	};
 
 }
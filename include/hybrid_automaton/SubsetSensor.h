@@ -0,0 +1,96 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_SUBSET_SENSOR_H_
+#define HYBRID_AUTOMATON_SUBSET_SENSOR_H_
+
+#include "hybrid_automaton/DerivedSensor.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace ha {
+
+	class SubsetSensor;
+	typedef boost::shared_ptr<SubsetSensor> SubsetSensorPtr;
+	typedef boost::shared_ptr<const SubsetSensor> SubsetSensorConstPtr;
+
+	/**
+	 * @brief Entries of its operand: value = (x[index[0]], ..., x[index[n]])^T
+	 *
+	 * Gathers e.g. a subset of the joints of a JointConfigurationSensor or JointVelocitySensor.
+	 * Matrices are indexed in column-major order.
+	 */
+	class SubsetSensor : public DerivedSensor
+	{
+	public:
+
+		typedef boost::shared_ptr<SubsetSensor> Ptr;
+		typedef boost::shared_ptr<const SubsetSensor> ConstPtr;
+
+		SubsetSensor();
+
+		virtual ~SubsetSensor();
+
+		SubsetSensor(const SubsetSensor& ss);
+
+		SubsetSensorPtr clone() const
+		{
+			return (SubsetSensorPtr(_doClone()));
+		}
+
+		virtual void setIndex(const std::vector<int>& index);
+
+		virtual std::vector<int> getIndex() const;
+
+		virtual void readCurrentValue(::Eigen::MatrixXd& value) const;
+
+		// required to enable deserialization of this sensor
+		HA_SENSOR_INSTANCE(node, system, ha) {
+			Sensor::Ptr sensor(new SubsetSensor());
+			sensor->deserialize(node, system, ha);
+			return sensor;
+		}
+
+	protected:
+		std::vector<int> _index;
+
+		virtual std::size_t _getMinOperands() const;
+		virtual std::size_t _getMaxOperands() const;
+
+		virtual void _serializeAttributes(const DescriptionTreeNode::Ptr& tree) const;
+		virtual void _deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree);
+
+		virtual SubsetSensor* _doClone() const
+		{
+			return (new SubsetSensor(*this));
+		}
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_SUBSET_SENSOR_H_
@@ -38,6 +38,9 @@
 
 namespace ha {
 
+	class SensorSource;
+	typedef boost::shared_ptr<SensorSource> SensorSourcePtr;
+
 	class System;
 	typedef boost::shared_ptr<System> SystemPtr;
 	typedef boost::shared_ptr<const System> SystemConstPtr;
@@ -86,6 +89,45 @@ namespace ha {
         */
 		virtual ::Eigen::MatrixXd getFramePose(const std::string& frame_id) const = 0;
 
+        /**
+        * @brief Write the current joint configuration into \a q
+        *
+        * The read* methods are used by the Sensors in every control cycle. Overload them to copy into
+        * \a q without allocating - it already has the right size after the first call. By default they
+        * copy the result of the corresponding get* method.
+        */
+		virtual void readJointConfiguration(::Eigen::MatrixXd& q) const {
+			q = getJointConfiguration();
+		}
+
+        /**
+        * @brief Write the current joint velocity into \a qd
+        */
+		virtual void readJointVelocity(::Eigen::MatrixXd& qd) const {
+			qd = getJointVelocity();
+		}
+
+        /**
+        * @brief Write the current Force-torque measurement of port \a port into \a wrench
+        */
+		virtual void readForceTorqueMeasurement(const int& port, ::Eigen::MatrixXd& wrench) const {
+			wrench = getForceTorqueMeasurement(port);
+		}
+
+        /**
+        * @brief Write the pose of the frame with id \a frame_id into \a pose
+        */
+		virtual void readFramePose(const std::string& frame_id, ::Eigen::MatrixXd& pose) const {
+			pose = getFramePose(frame_id);
+		}
+
+        /**
+        * @brief Return the asynchronous source \a name (see AsyncSensor), NULL if there is none
+        */
+		virtual SensorSourcePtr getSensorSource(const std::string& name) const {
+			return SensorSourcePtr();
+		}
+
 		virtual bool subscribeToROSMessage(const std::string& topic) const {
 			HA_THROW_ERROR("System.subscribeToROSMessage", "Not implemented");
 		}
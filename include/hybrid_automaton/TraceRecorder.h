@@ -0,0 +1,356 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef HYBRID_AUTOMATON_TRACE_RECORDER_H_
+#define HYBRID_AUTOMATON_TRACE_RECORDER_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <Eigen/Dense>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ha {
+
+	class ControlMode;
+	class ControlSwitch;
+	class JumpCondition;
+	class Sensor;
+
+	class TraceRecorder;
+	typedef boost::shared_ptr<TraceRecorder> TraceRecorderPtr;
+	typedef boost::shared_ptr<const TraceRecorder> TraceRecorderConstPtr;
+
+	/**
+	 * @brief Records the execution of a HybridAutomaton into a compact binary trace file
+	 *
+	 * Per tick the recorder captures the time, the current ControlMode, the value of each evaluated
+	 * Sensor, the criterion value of each evaluated JumpCondition and any transition.
+	 *
+	 * The control thread only encodes into a preallocated ring buffer; a background thread writes
+	 * the buffer to disk. If the ring buffer is full the tick is dropped (and counted) - the control
+	 * thread never blocks on I/O. Matrices are delta encoded against the previous sample of the same
+	 * channel, either quantized (default) or lossless (XOR of the IEEE bits, for data that has to be
+	 * reproduced bit by bit).
+	 *
+	 * Usage:
+	 * @code
+	 *   TraceRecorder::Ptr recorder(new TraceRecorder);
+	 *   recorder->open("run.hatrace");
+	 *   hybrid_automaton->setTraceRecorder(recorder);
+	 *   // ... control loop ...
+	 *   recorder->close();
+	 * @endcode
+	 *
+	 * A recorder must only be fed by one control thread.
+	 *
+	 * @see TraceReader
+	 */
+	class TraceRecorder {
+	public:
+		typedef boost::shared_ptr<TraceRecorder> Ptr;
+		typedef boost::shared_ptr<const TraceRecorder> ConstPtr;
+
+		/**
+		 * @brief What a channel of the trace contains
+		 */
+		enum ChannelKind { MODE_CHANNEL, SWITCH_CHANNEL, SENSOR_CHANNEL, CRITERION_CHANNEL, SYSTEM_CHANNEL };
+
+		/**
+		 * @brief How the values of a channel are encoded
+		 */
+		enum Encoding { QUANTIZED, LOSSLESS };
+
+		/**
+		 * @brief Record tags of the file format
+		 */
+		enum Tag { TAG_TICK = 1, TAG_VALUE = 2, TAG_TRANSITION = 3, TAG_DROPPED = 4, TAG_DEFINE = 5, TAG_INITIALIZE = 6 };
+
+		/**
+		 * @brief Sets the recorder of the current thread for the duration of one tick
+		 */
+		class TickScope {
+		public:
+			TickScope(TraceRecorder* recorder, const double& t, const ControlMode* mode);
+			~TickScope();
+		private:
+			TraceRecorder* _recorder;
+		};
+
+		/**
+		 * @param buffer_size size of the ring buffer in bytes
+		 * @param quantum resolution of quantized channels
+		 */
+		TraceRecorder(std::size_t buffer_size = 1 << 22, double quantum = 1e-6);
+
+		virtual ~TraceRecorder();
+
+		/**
+		 * @brief Open \a filename for writing and start the background writer thread
+		 *
+		 * @param flush_period how often (in seconds) the writer thread empties the ring buffer
+		 */
+		virtual bool open(const std::string& filename, double flush_period = 0.01);
+
+		/**
+		 * @brief Write everything that is still buffered, stop the writer thread and close the file
+		 */
+		virtual void close();
+
+		virtual bool isOpen() const;
+
+		/**
+		 * @brief Write the buffered ticks to the file - do not call this from the control thread
+		 */
+		virtual void flush();
+
+		/**
+		 * @brief The recorder of the tick that is currently executed in this thread (NULL if none)
+		 *
+		 * Used by JumpCondition to record sensor and criterion values.
+		 */
+		static TraceRecorder* current();
+
+		/**
+		 * @brief Set up the channels of \a mode before it is executed
+		 *
+		 * Channels are identified by the names of the modes and switches and the paths of the JumpConditions
+		 * (see JumpCondition::setPath()), never by address, so that a recorder can outlive an automaton.
+		 * The HybridAutomaton calls this and registerControlSwitch() for each outgoing switch when it activates
+		 * \a mode, so that the ticks in \a mode find their channels without allocating. Channels of objects that
+		 * were not registered are set up in the first tick they are recorded in.
+		 */
+		virtual void registerControlMode(const ControlMode* mode);
+		virtual void registerControlSwitch(ControlSwitch* control_switch, const ControlMode* target_mode);
+
+		// called from the control thread
+		virtual void beginTick(const double& t, const ControlMode* mode);
+		virtual void endTick();
+		virtual void beginSwitch(ControlSwitch* control_switch);
+		virtual void recordSensorValue(const JumpCondition* jump_condition, const Sensor* sensor, const ::Eigen::MatrixXd& value);
+		virtual void recordCriterion(const JumpCondition* jump_condition, double criterion);
+		virtual void recordTransition(const ControlSwitch* control_switch, const ControlMode* target_mode);
+
+		/**
+		 * @brief Mark the current tick as HybridAutomaton::initialize() instead of step()
+		 */
+		virtual void recordInitialize();
+
+		/**
+		 * @brief Record a value under an arbitrary \a name (encoded losslessly)
+		 *
+		 * Only the first value per tick and name is recorded.
+		 *
+		 * @see RecordingSystem
+		 */
+		virtual void recordSystemValue(const std::string& name, const ::Eigen::MatrixXd& value);
+
+		double getQuantum() const;
+
+		/**
+		 * @brief Number of ticks that made it into the ring buffer
+		 */
+		unsigned long long getRecordedTicks() const;
+
+		/**
+		 * @brief Number of ticks that were dropped because the ring buffer was full
+		 */
+		unsigned long long getDroppedTicks() const;
+
+	protected:
+		struct Channel {
+			int id;
+			int kind;
+			int encoding;
+			int parent;
+			std::string name;
+			bool defined;
+			bool keyframe;
+			unsigned long long last_tick;
+			int rows, cols;
+			std::vector<long long> quantized;
+			std::vector<unsigned long long> bits;
+		};
+
+		// channels by kind and name
+		typedef std::pair<int, std::string> ChannelKey;
+
+		// channel of an object of the current mode by its address, only valid until the next registerControlMode()
+		struct CachedChannel {
+			int kind;
+			const void* key;
+			int id;
+		};
+
+		int _findChannel(ChannelKind kind, const void* key) const;
+		int _channel(ChannelKind kind, const void* key, int parent, const std::string& name);
+		int _addChannel(ChannelKind kind, int parent, const std::string& name, Encoding encoding);
+		int _modeChannel(const ControlMode* mode);
+		int _switchChannel(const ControlSwitch* control_switch);
+		int _sensorChannel(const ControlSwitch* control_switch, const JumpCondition* jump_condition, const Sensor* sensor);
+		int _criterionChannel(const ControlSwitch* control_switch, const JumpCondition* jump_condition);
+		void _registerJumpCondition(const ControlSwitch* control_switch, const JumpCondition* jump_condition);
+		void _define(Channel& channel);
+		void _encodeValue(Channel& channel, const double* data, int rows, int cols);
+		void _commit();
+		void _writerLoop(double flush_period);
+
+		void _put(unsigned char byte);
+		void _putVarint(unsigned long long value);
+		void _putZigZag(long long value);
+		void _putXor(unsigned long long bits, unsigned long long previous);
+
+		double _quantum;
+
+		// ring buffer between control thread and writer thread
+		std::vector<unsigned char> _ring;
+		std::size_t _mask;
+		boost::atomic<std::size_t> _head;
+		boost::atomic<std::size_t> _tail;
+
+		// encoding state of the control thread
+		std::vector<unsigned char> _scratch;
+		std::map<ChannelKey, int> _channel_ids;
+		std::vector<CachedChannel> _cached_channels;
+		std::map<std::string, int> _system_channel_ids;
+		std::vector<Channel> _channels;
+		std::vector<int> _defined_in_tick;
+		bool _in_tick;
+		unsigned long long _tick;
+		unsigned long long _previous_time;
+		unsigned long long _tick_time;
+		ControlSwitch* _current_switch;
+		unsigned long long _pending_drops;
+
+		boost::atomic<unsigned long long> _recorded_ticks;
+		boost::atomic<unsigned long long> _dropped_ticks;
+
+		// writer thread
+		std::FILE* _file;
+		boost::mutex _file_mutex;
+		boost::shared_ptr<boost::thread> _writer;
+		boost::atomic<bool> _stop;
+
+	private:
+		TraceRecorder(const TraceRecorder&);
+		TraceRecorder& operator=(const TraceRecorder&);
+	};
+
+	/**
+	 * @brief Reads trace files written by TraceRecorder tick by tick
+	 */
+	class TraceReader {
+	public:
+		typedef boost::shared_ptr<TraceReader> Ptr;
+
+		struct Channel {
+			int id;
+			int kind;
+			int encoding;
+			int parent;
+			std::string name;
+		};
+
+		struct Value {
+			int channel;
+			::Eigen::MatrixXd value;
+		};
+
+		struct Transition {
+			int control_switch;
+			int target_mode;
+		};
+
+		struct Tick {
+			double time;
+			int mode;
+			unsigned long long dropped_before;
+			bool initialize;
+			std::vector<Value> values;
+			std::vector<Transition> transitions;
+		};
+
+		TraceReader();
+		virtual ~TraceReader();
+
+		/**
+		 * @brief Open a trace file - throws if it is not a trace
+		 */
+		virtual void open(const std::string& filename);
+
+		/**
+		 * @brief Read the next tick, returns false at the end of the file
+		 */
+		virtual bool readTick(Tick& tick);
+
+		/**
+		 * @brief All channels defined so far (channels are defined on first use)
+		 */
+		const std::map<int, Channel>& getChannels() const;
+
+		/**
+		 * @brief The id of the channel with given kind and name, -1 if it was not defined (yet)
+		 */
+		int findChannel(int kind, const std::string& name) const;
+
+		/**
+		 * @brief Name of channel \a id, empty if unknown
+		 */
+		std::string getChannelName(int id) const;
+
+		double getQuantum() const;
+
+	protected:
+		struct State {
+			State() : rows(0), cols(0) {}
+			int rows, cols;
+			std::vector<long long> quantized;
+			std::vector<unsigned long long> bits;
+		};
+
+		int _get();
+		unsigned long long _getVarint();
+		long long _getZigZag();
+		unsigned long long _getXor(unsigned long long previous);
+		void _readValue(Value& value);
+
+		std::ifstream _file;
+		double _quantum;
+		unsigned long long _previous_time;
+		std::map<int, Channel> _channels;
+		std::map<int, State> _states;
+		int _pending_tag;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_TRACE_RECORDER_H_
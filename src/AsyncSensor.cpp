@@ -0,0 +1,308 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/AsyncSensor.h"
+#include "hybrid_automaton/RigidBodyMotion.h"
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("AsyncSensor", AsyncSensor);
+
+	AsyncSensor::AsyncSensor()
+		: _has_new_value(false), _last_sequence(0), _max_age(0.0), _latency(0.0), _extrapolate(false),
+		_time(0.0), _is_stale(false), _has_rate(false), _sample_time(0.0)
+	{
+	}
+
+	AsyncSensor::AsyncSensor(const std::string& source_name)
+		: _source_name(source_name), _has_new_value(false), _last_sequence(0), _max_age(0.0), _latency(0.0), _extrapolate(false),
+		_time(0.0), _is_stale(false), _has_rate(false), _sample_time(0.0)
+	{
+	}
+
+	AsyncSensor::~AsyncSensor()
+	{
+	}
+
+	AsyncSensor::AsyncSensor(const AsyncSensor& ss)
+		: Sensor(ss), _source_name(ss._source_name), _source(ss._source), _has_new_value(false), _last_sequence(0),
+		_max_age(ss._max_age), _latency(ss._latency), _extrapolate(ss._extrapolate),
+		_time(0.0), _is_stale(false), _has_rate(false), _sample_time(0.0)
+	{
+	}
+
+	void AsyncSensor::setSourceName(const std::string& source_name)
+	{
+		_source_name = source_name;
+		_source.reset();
+	}
+
+	const std::string& AsyncSensor::getSourceName() const
+	{
+		return _source_name;
+	}
+
+	SensorSource::Ptr AsyncSensor::getSource() const
+	{
+		return _source;
+	}
+
+	void AsyncSensor::setMaxAge(double max_age)
+	{
+		if (max_age < 0.0)
+			HA_THROW_ERROR("AsyncSensor.setMaxAge", "Max age must not be negative, got " << max_age << "!");
+		_max_age = max_age;
+	}
+
+	double AsyncSensor::getMaxAge() const
+	{
+		return _max_age;
+	}
+
+	void AsyncSensor::setLatency(double latency)
+	{
+		_latency = latency;
+	}
+
+	double AsyncSensor::getLatency() const
+	{
+		return _latency;
+	}
+
+	void AsyncSensor::setExtrapolate(bool extrapolate)
+	{
+		_extrapolate = extrapolate;
+	}
+
+	bool AsyncSensor::isExtrapolating() const
+	{
+		return _extrapolate;
+	}
+
+	bool AsyncSensor::getSampleTime(double& time) const
+	{
+		if (!_source || _source->getSequence() == 0)
+			return false;
+		time = _source->getTime() - _latency;
+		return true;
+	}
+
+	bool AsyncSensor::isStale() const
+	{
+		return _is_stale;
+	}
+
+	::Eigen::MatrixXd AsyncSensor::getCurrentValue() const
+	{
+		::Eigen::MatrixXd value;
+		readCurrentValue(value);
+		return value;
+	}
+
+	void AsyncSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		if (!_source) {
+			value.resize(0, 0);
+			return;
+		}
+		if (_extrapolate && _sample.size() > 0) {
+			value = _value;
+			return;
+		}
+		value = _source->getValue();
+	}
+
+	void AsyncSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		// nothing arrived yet
+		if (this->_initial_sensor_value.size() == 0) {
+			readCurrentValue(value);
+			return;
+		}
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void AsyncSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
+	void AsyncSensor::setSystem(const System::ConstPtr& system)
+	{
+		Sensor::setSystem(system);
+		_source.reset();
+	}
+
+	void AsyncSensor::initialize(const double& t)
+	{
+		if (!_source) {
+			if (!_system)
+				HA_THROW_ERROR("AsyncSensor.initialize", "No System to look up source '" << _source_name << "'!");
+			_source = _system->getSensorSource(_source_name);
+			if (!_source)
+				HA_THROW_ERROR("AsyncSensor.initialize", "The System has no sensor source '" << _source_name << "'!");
+		}
+
+		this->_initial_sensor_value.resize(0, 0);
+		_sample.resize(0, 0);
+		_has_rate = false;
+		_last_sequence = 0;
+		_time = t;
+		_fetch();
+		if (_source->getSequence() > 0)
+			readCurrentValue(this->_initial_sensor_value);
+	}
+
+	void AsyncSensor::step(const double& t)
+	{
+		_time = t;
+		if (_source)
+			_fetch();
+	}
+
+	void AsyncSensor::_fetch()
+	{
+		// other sensors may read the same source: fetch once per control cycle and compare with the
+		// sample this sensor saw last instead of consuming the mailbox
+		_source->fetchForCycle(_time);
+		const unsigned long long sequence = _source->getSequence();
+		_has_new_value = (sequence != _last_sequence);
+		_last_sequence = sequence;
+		if (sequence == 0) {
+			_is_stale = false;
+			return;
+		}
+
+		const double sample_time = _source->getTime() - _latency;
+		_is_stale = (_max_age > 0.0 && _time - sample_time > _max_age);
+
+		if (_extrapolate) {
+			if (_has_new_value || _sample.size() == 0)
+				_updateRate(_source->getValue(), sample_time);
+			_extrapolateTo(_time);
+		}
+
+		// no sample at initialize() - the first one becomes the initial value
+		if (_has_new_value && this->_initial_sensor_value.size() == 0)
+			readCurrentValue(this->_initial_sensor_value);
+	}
+
+	void AsyncSensor::_updateRate(const ::Eigen::MatrixXd& sample, double sample_time)
+	{
+		_has_rate = false;
+		const double dt = sample_time - _sample_time;
+		if (_sample.size() > 0 && sample.rows() == _sample.rows() && sample.cols() == _sample.cols() && dt > 0.0) {
+			if (sample.rows() == 4 && sample.cols() == 4) {
+				// body twist from the previous to the latest pose
+				const ::Eigen::Matrix4d previous = _sample;
+				const ::Eigen::Matrix4d latest = sample;
+				::Eigen::Matrix<double, 6, 1> twist;
+				logPose(previous.inverse() * latest, twist);
+				_rate.resize(6, 1);
+				_rate = twist / dt;
+			} else {
+				_rate = sample - _sample;
+				_rate /= dt;
+			}
+			_has_rate = true;
+		}
+		_sample = sample;
+		_sample_time = sample_time;
+	}
+
+	void AsyncSensor::_extrapolateTo(double t)
+	{
+		if (!_has_rate) {
+			_value = _sample;
+			return;
+		}
+
+		const double horizon = t - _sample_time;
+		if (_sample.rows() == 4 && _sample.cols() == 4) {
+			const ::Eigen::Matrix<double, 6, 1> twist = horizon * _rate;
+			::Eigen::Matrix4d motion;
+			expTwist(twist, motion);
+			const ::Eigen::Matrix4d sample = _sample;
+			_value.resize(4, 4);
+			_value.noalias() = sample * motion;
+		} else {
+			_value = _sample + horizon * _rate;
+		}
+	}
+
+	bool AsyncSensor::isActive() const
+	{
+		return _source && _source->getSequence() > 0 && !_is_stale;
+	}
+
+	bool AsyncSensor::hasNewValue() const
+	{
+		// the extrapolated value moves with every control cycle
+		return _has_new_value || (_extrapolate && _has_rate);
+	}
+
+	DescriptionTreeNode::Ptr AsyncSensor::serialize(const DescriptionTree::ConstPtr& factory) const
+	{
+		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
+
+		tree->setAttribute<std::string>(std::string("type"), this->getType());
+		tree->setAttribute<std::string>(std::string("source"), _source_name);
+		if (_max_age != 0.0)
+			tree->setAttribute<double>(std::string("max_age"), _max_age);
+		if (_latency != 0.0)
+			tree->setAttribute<double>(std::string("latency"), _latency);
+		if (_extrapolate)
+			tree->setAttribute<bool>(std::string("extrapolate"), _extrapolate);
+
+		return tree;
+	}
+
+	void AsyncSensor::deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha)
+	{
+		if (tree->getType() != "Sensor") {
+			HA_THROW_ERROR("AsyncSensor.deserialize", "DescriptionTreeNode must have type 'Sensor', not '" << tree->getType() << "'!");
+		}
+		tree->getAttribute<std::string>("type", _type, "");
+
+		if (_type == "" || !HybridAutomaton::isSensorRegistered(_type)) {
+			HA_THROW_ERROR("AsyncSensor.deserialize", "Sensor type '" << _type << "' "
+				<< "invalid - empty or not registered with HybridAutomaton!");
+		}
+
+		if (!tree->getAttribute<std::string>("source", _source_name)) {
+			HA_THROW_ERROR("AsyncSensor.deserialize", "Attribute 'source' is missing!");
+		}
+
+		double max_age;
+		tree->getAttribute<double>("max_age", max_age, 0.0);
+		setMaxAge(max_age);
+		tree->getAttribute<double>("latency", _latency, 0.0);
+		tree->getAttribute<bool>("extrapolate", _extrapolate, false);
+
+		_system = system;
+		_source.reset();
+	}
+
+}
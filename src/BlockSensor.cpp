@@ -0,0 +1,116 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/BlockSensor.h"
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("BlockSensor", BlockSensor);
+
+	BlockSensor::BlockSensor()
+		: _start_row(0), _start_col(0), _rows(0), _cols(0)
+	{
+	}
+
+	BlockSensor::~BlockSensor()
+	{
+	}
+
+	BlockSensor::BlockSensor(const BlockSensor& ss)
+		: DerivedSensor(ss), _start_row(ss._start_row), _start_col(ss._start_col), _rows(ss._rows), _cols(ss._cols)
+	{
+	}
+
+	void BlockSensor::setBlock(int start_row, int start_col, int rows, int cols)
+	{
+		if (start_row < 0 || start_col < 0 || rows < 0 || cols < 0)
+			HA_THROW_ERROR("BlockSensor.setBlock", "Block (" << start_row << ", " << start_col << ", " << rows << ", " << cols << ") must not be negative!");
+
+		_start_row = start_row;
+		_start_col = start_col;
+		_rows = rows;
+		_cols = cols;
+	}
+
+	int BlockSensor::getStartRow() const
+	{
+		return _start_row;
+	}
+
+	int BlockSensor::getStartCol() const
+	{
+		return _start_col;
+	}
+
+	int BlockSensor::getRows() const
+	{
+		return _rows;
+	}
+
+	int BlockSensor::getCols() const
+	{
+		return _cols;
+	}
+
+	void BlockSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		const ::Eigen::MatrixXd& x = _readOperand(0);
+
+		if (_start_row + _rows > x.rows() || _start_col + _cols > x.cols())
+			HA_THROW_ERROR("BlockSensor.readCurrentValue", "Block (" << _start_row << ", " << _start_col << ", " << _rows << ", " << _cols << ") "
+				<< "out of range - operand is " << x.rows() << "x" << x.cols() << "!");
+
+		value = x.block(_start_row, _start_col, _rows, _cols);
+	}
+
+	std::size_t BlockSensor::_getMinOperands() const
+	{
+		return 1;
+	}
+
+	std::size_t BlockSensor::_getMaxOperands() const
+	{
+		return 1;
+	}
+
+	void BlockSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+		tree->setAttribute<int>(std::string("start_row"), _start_row);
+		tree->setAttribute<int>(std::string("start_col"), _start_col);
+		tree->setAttribute<int>(std::string("rows"), _rows);
+		tree->setAttribute<int>(std::string("cols"), _cols);
+	}
+
+	void BlockSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		int start_row, start_col, rows, cols;
+		tree->getAttribute<int>("start_row", start_row, 0);
+		tree->getAttribute<int>("start_col", start_col, 0);
+		if (!tree->getAttribute<int>("rows", rows) || !tree->getAttribute<int>("cols", cols))
+			HA_THROW_ERROR("BlockSensor.deserialize", "This type of sensor needs the values 'rows' and 'cols'!");
+		setBlock(start_row, start_col, rows, cols);
+	}
+
+}
@@ -51,6 +51,22 @@ namespace ha
 		return ret;
 	}
 
+	void ClockSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		value.resize(1,1);
+		value(0,0) = this->_current_time;
+	}
+
+	void ClockSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void ClockSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
 	void ClockSensor::initialize(const double& t) 
 	{
 		this->_current_time = t;
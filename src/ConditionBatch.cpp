@@ -0,0 +1,295 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/ConditionBatch.h"
+#include "hybrid_automaton/ControlSwitch.h"
+#include "hybrid_automaton/TraceRecorder.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <typeinfo>
+
+namespace ha {
+
+	ConditionBatch::ConditionBatch()
+		: _num_batched(0)
+	{
+	}
+
+	void ConditionBatch::clear()
+	{
+		_groups.clear();
+		_entries.clear();
+		_switches.clear();
+		_num_batched = 0;
+	}
+
+	bool ConditionBatch::_isBatchable(const JumpCondition* jump_condition)
+	{
+		// subclasses may override isActive(), the batch only computes what JumpCondition::isActive() would
+		if (typeid(*jump_condition) != typeid(JumpCondition))
+			return false;
+
+		if (!jump_condition->_sensor || jump_condition->_goalSource != JumpCondition::CONSTANT || jump_condition->_goal.size() == 0)
+			return false;
+
+		switch (jump_condition->_jump_criterion) {
+			case JumpCondition::NORM_L1:
+			case JumpCondition::NORM_L2:
+			case JumpCondition::NORM_L_INF:
+			case JumpCondition::THRESH_UPPER_BOUND:
+			case JumpCondition::THRESH_LOWER_BOUND:
+				break;
+			default:
+				return false;
+		}
+
+		const ::Eigen::MatrixXd& weights = jump_condition->_norm_weights;
+		return weights.rows() == 0 || (weights.rows() == jump_condition->_goal.rows() && weights.cols() == jump_condition->_goal.cols());
+	}
+
+	int ConditionBatch::_findGroup(const JumpCondition* jump_condition)
+	{
+		const int criterion = jump_condition->_jump_criterion;
+		const int rows = (int)jump_condition->_goal.rows();
+		const int cols = (int)jump_condition->_goal.cols();
+		for (std::size_t i = 0; i < _groups.size(); ++i) {
+			if (_groups[i].criterion == criterion && _groups[i].rows == rows && _groups[i].cols == cols)
+				return (int)i;
+		}
+
+		Group group;
+		group.criterion = criterion;
+		group.rows = rows;
+		group.cols = cols;
+		group.size = 0;
+		group.has_work = false;
+		_groups.push_back(group);
+		return (int)_groups.size() - 1;
+	}
+
+	std::size_t ConditionBatch::add(ControlSwitch* control_switch)
+	{
+		Switch s;
+		s.control_switch = control_switch;
+		s.begin = _entries.size();
+		s.scheduled = false;
+
+		const std::vector<JumpConditionPtr>& jump_conditions = control_switch->getJumpConditions();
+		for (std::vector<JumpConditionPtr>::const_iterator it = jump_conditions.begin(); it != jump_conditions.end(); ++it) {
+			Entry entry;
+			entry.jump_condition = it->get();
+			entry.group = -1;
+			entry.column = -1;
+			entry.compute = false;
+			entry.result = false;
+
+			if (_isBatchable(entry.jump_condition)) {
+				entry.group = this->_findGroup(entry.jump_condition);
+				Group& group = _groups[entry.group];
+				entry.column = group.size++;
+
+				// grow the columns here so that evaluate() does not allocate
+				const int dimension = group.rows * group.cols;
+				group.values.conservativeResize(dimension, group.size);
+				group.goals.conservativeResize(dimension, group.size);
+				group.weights.conservativeResize(dimension, group.size);
+				group.scratch.resize(dimension, group.size);
+				group.criteria.resize(group.size);
+				group.values.col(entry.column).setZero();
+				group.goals.col(entry.column).setZero();
+				group.weights.col(entry.column).setOnes();
+				++_num_batched;
+			}
+			_entries.push_back(entry);
+		}
+
+		s.end = _entries.size();
+		_switches.push_back(s);
+		return _switches.size() - 1;
+	}
+
+	void ConditionBatch::schedule(std::size_t index)
+	{
+		_switches[index].scheduled = true;
+	}
+
+	bool ConditionBatch::_gather(Entry& entry)
+	{
+		JumpCondition* jump_condition = entry.jump_condition;
+		entry.compute = false;
+
+		// the goal or the weights may have been changed since add()
+		Group& group = _groups[entry.group];
+		const ::Eigen::MatrixXd& goal = jump_condition->_goal;
+		if (!_isBatchable(jump_condition) || jump_condition->_jump_criterion != group.criterion
+			|| goal.rows() != group.rows || goal.cols() != group.cols)
+			return false;
+
+		// the same shortcuts as JumpCondition::isActive()
+		if (!jump_condition->_sensor->isActive()) {
+			jump_condition->_is_unknown = true;
+			jump_condition->_has_cached_result = false;
+			entry.result = false;
+			return true;
+		}
+		jump_condition->_is_unknown = false;
+
+		if (jump_condition->_has_cached_result && !jump_condition->_sensor->hasNewValue()) {
+			jump_condition->_criterion_time = jump_condition->_step_time;
+			entry.result = jump_condition->_cached_result;
+			return true;
+		}
+
+		jump_condition->_sensor->readCurrentValue(jump_condition->_current_value);
+		const ::Eigen::MatrixXd* value = &jump_condition->_current_value;
+		if (jump_condition->_is_goal_relative) {
+			jump_condition->_sensor->readInitialValue(jump_condition->_initial_value);
+			if (jump_condition->_initial_value.rows() != value->rows() || jump_condition->_initial_value.cols() != value->cols())
+				return false;
+			jump_condition->_sensor->readRelativeCurrentValue(jump_condition->_relative_value);
+			value = &jump_condition->_relative_value;
+		}
+		if (value->rows() != group.rows || value->cols() != group.cols)
+			return false;
+
+		const int dimension = group.rows * group.cols;
+		group.values.col(entry.column) = ::Eigen::Map<const ::Eigen::VectorXd>(value->data(), dimension);
+		group.goals.col(entry.column) = ::Eigen::Map<const ::Eigen::VectorXd>(goal.data(), dimension);
+		if (jump_condition->_norm_weights.rows() == 0)
+			group.weights.col(entry.column).setOnes();
+		else
+			group.weights.col(entry.column) = ::Eigen::Map<const ::Eigen::VectorXd>(jump_condition->_norm_weights.data(), dimension);
+
+		entry.compute = true;
+		group.has_work = true;
+		return true;
+	}
+
+	void ConditionBatch::_computeCriteria(Group& group)
+	{
+		// all columns at once - the columns of conditions that are not due only cost a few flops
+		group.scratch = group.values - group.goals;
+		switch (group.criterion) {
+			case JumpCondition::NORM_L1:
+				group.scratch = group.weights.cwiseProduct(group.scratch.cwiseAbs());
+				group.criteria = group.scratch.colwise().sum();
+				break;
+			case JumpCondition::NORM_L2:
+				group.scratch = group.weights.cwiseProduct(group.scratch.cwiseAbs2());
+				group.criteria = group.scratch.colwise().sum().cwiseSqrt();
+				break;
+			case JumpCondition::NORM_L_INF:
+				group.scratch = group.weights.cwiseProduct(group.scratch.cwiseAbs());
+				group.criteria = group.scratch.colwise().maxCoeff().cwiseMax(0.0);
+				break;
+			case JumpCondition::THRESH_UPPER_BOUND:
+				group.scratch = -group.weights.cwiseProduct(group.scratch);
+				group.criteria = group.scratch.colwise().maxCoeff();
+				break;
+			case JumpCondition::THRESH_LOWER_BOUND:
+				group.scratch = group.weights.cwiseProduct(group.scratch);
+				group.criteria = group.scratch.colwise().maxCoeff();
+				break;
+			default:
+				HA_THROW_ERROR("ConditionBatch._computeCriteria", "Criterion cannot be batched: " << group.criterion);
+		}
+	}
+
+	void ConditionBatch::evaluate()
+	{
+		// gather the values of all due conditions into their groups
+		for (std::vector<Switch>::iterator s = _switches.begin(); s != _switches.end(); ++s) {
+			if (!s->scheduled)
+				continue;
+			for (std::size_t i = s->begin; i < s->end; ++i) {
+				Entry& entry = _entries[i];
+				if (entry.group >= 0 && !this->_gather(entry)) {
+					// JumpCondition::isActive() handles (and reports) everything that does not fit the group
+					entry.group = -1;
+					--_num_batched;
+				}
+			}
+		}
+
+		for (std::vector<Group>::iterator group = _groups.begin(); group != _groups.end(); ++group) {
+			if (group->has_work) {
+				this->_computeCriteria(*group);
+				group->has_work = false;
+			}
+		}
+
+		// hand the criteria back in the order of the switches
+		TraceRecorder* trace_recorder = TraceRecorder::current();
+		for (std::vector<Switch>::iterator s = _switches.begin(); s != _switches.end(); ++s) {
+			if (!s->scheduled)
+				continue;
+			s->scheduled = false;
+			if (trace_recorder)
+				trace_recorder->beginSwitch(s->control_switch);
+			for (std::size_t i = s->begin; i < s->end; ++i) {
+				Entry& entry = _entries[i];
+				if (!entry.compute)
+					continue;
+				const JumpCondition* jump_condition = entry.jump_condition;
+				const ::Eigen::MatrixXd& value = jump_condition->_is_goal_relative ? jump_condition->_relative_value : jump_condition->_current_value;
+				entry.result = jump_condition->_acceptCriterion(value, _groups[entry.group].criteria(entry.column));
+				entry.compute = false;
+			}
+		}
+	}
+
+	bool ConditionBatch::isActive(std::size_t index) const
+	{
+		const Switch& s = _switches[index];
+
+		// the batched results are known already, the other conditions are only evaluated if needed
+		for (std::size_t i = s.begin; i < s.end; ++i) {
+			if (_entries[i].group >= 0 && !_entries[i].result)
+				return false;
+		}
+		for (std::size_t i = s.begin; i < s.end; ++i) {
+			if (_entries[i].group < 0 && !_entries[i].jump_condition->isActive())
+				return false;
+		}
+		HA_INFO("ControlSwitch.isActive", "Jump condition: " << s.control_switch->getName());
+		return true;
+	}
+
+	std::size_t ConditionBatch::getNumberOfSwitches() const
+	{
+		return _switches.size();
+	}
+
+	std::size_t ConditionBatch::getNumberOfBatchedConditions() const
+	{
+		return _num_batched;
+	}
+
+	std::size_t ConditionBatch::getNumberOfGroups() const
+	{
+		return _groups.size();
+	}
+
+}
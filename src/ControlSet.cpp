@@ -43,6 +43,9 @@ namespace ha {
 		HA_THROW_ERROR("ControlSet.initialize", "Not implemented");
 	}
 
+	void ControlSet::prepare() {
+	}
+
 	void ControlSet::terminate() {
 		HA_THROW_ERROR("ControlSet.terminate", "Not implemented");
 	}
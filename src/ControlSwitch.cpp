@@ -24,11 +24,42 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include "hybrid_automaton/ControlSwitch.h"
+#include "hybrid_automaton/CycleClock.h"
+#include "hybrid_automaton/ExpressionCondition.h"
 #include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/Profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
 
 namespace ha {
+
+	namespace {
+		// weight of the newest sample in the averaged cost and pass rate
+		const double STATISTICS_WEIGHT = 1.0 / 16.0;
+
+		// orders JumpConditions by expected cost per rejection, ties by insertion order
+		struct CheaperRejection {
+			CheaperRejection(const std::vector<double>& ranks) : _ranks(ranks) {}
+			bool operator()(std::size_t a, std::size_t b) const {
+				if (_ranks[a] != _ranks[b])
+					return _ranks[a] < _ranks[b];
+				return a < b;
+			}
+			const std::vector<double>& _ranks;
+		};
+	}
+
 	void ControlSwitch::add(const JumpConditionPtr& jump_condition)
 	{
+		std::stringstream path;
+		path << _jump_conditions.size();
+		jump_condition->setPath(path.str());
+
+		_evaluation_order.push_back(_jump_conditions.size());
+		_condition_statistics.push_back(ConditionStatistics());
+		_ranks.push_back(0.0);
 		_jump_conditions.push_back(jump_condition);
 	}
 
@@ -39,21 +70,98 @@ namespace ha {
 
 	bool ControlSwitch::isActive() const 
 	{
+		HA_PROFILE_SCOPE("ControlSwitch::isActive", _name);
+
+		if (!_adaptive_ordering || _jump_conditions.size() < 2) {
+			for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
+				if (!(*it)->isActive())
+					return false;
+			}
+			HA_INFO("ControlSwitch.isActive", "Jump condition: "<<this->getName());
+			return true;
+		}
+
+		bool active = true;
+		for (std::vector<std::size_t>::const_iterator it = _evaluation_order.begin(); it != _evaluation_order.end(); ++it) {
+			CycleClock::Ticks start = CycleClock::now();
+			bool condition_active = _jump_conditions[*it]->isActive();
+			double cost = (double)(CycleClock::now() - start);
+
+			ConditionStatistics& statistics = _condition_statistics[*it];
+			if (statistics.evaluations++ == 0) {
+				statistics.cost = cost;
+				statistics.pass_rate = condition_active ? 1.0 : 0.0;
+			} else {
+				statistics.cost += STATISTICS_WEIGHT * (cost - statistics.cost);
+				statistics.pass_rate += STATISTICS_WEIGHT * ((condition_active ? 1.0 : 0.0) - statistics.pass_rate);
+			}
+
+			if (!condition_active) {
+				active = false;
+				break;
+			}
+		}
+
+		if (++_evaluations_since_reordering >= REORDERING_PERIOD)
+			_reorder();
+
+		if (active)
+			HA_INFO("ControlSwitch.isActive", "Jump condition: "<<this->getName());
+		return active;
+	}
+
+	void ControlSwitch::_reorder() const
+	{
+		_evaluations_since_reordering = 0;
+
+		// a conjunction is cheapest if conditions are checked in ascending order of cost / (1 - pass rate),
+		// conditions that were never checked have no cost yet and move to the front to get measured
+		for (std::size_t i = 0; i < _condition_statistics.size(); ++i) {
+			const ConditionStatistics& statistics = _condition_statistics[i];
+			_ranks[i] = statistics.cost / std::max(1.0 - statistics.pass_rate, 1e-3);
+		}
+		std::sort(_evaluation_order.begin(), _evaluation_order.end(), CheaperRejection(_ranks));
+	}
+
+	void ControlSwitch::setAdaptiveOrdering(bool adaptive_ordering)
+	{
+		_adaptive_ordering = adaptive_ordering;
+	}
+
+	bool ControlSwitch::getAdaptiveOrdering() const
+	{
+		return _adaptive_ordering;
+	}
+
+	const std::vector<std::size_t>& ControlSwitch::getEvaluationOrder() const
+	{
+		return _evaluation_order;
+	}
+
+	double ControlSwitch::getEarliestActivationTime() const
+	{
+		double earliest = -std::numeric_limits<double>::infinity();
 		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
-			if (!(*it)->isActive())
-				return false;
+			earliest = std::max(earliest, (*it)->getEarliestActivationTime());
 		}
-		HA_INFO("ControlSwitch.isActive", "Jump condition: "<<this->getName());
-		return true;
+		return earliest;
 	}
 
 	void ControlSwitch::initialize(const double& t) 
 	{
+		_step_time = t;
 		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
 			(*it)->initialize(t);
 		}
 	}
 
+	void ControlSwitch::prepare() 
+	{
+		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
+			(*it)->prepare();
+		}
+	}
+
 	void ControlSwitch::terminate() 
 	{
 		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
@@ -63,6 +171,10 @@ namespace ha {
 
 	void ControlSwitch::step(const double& t) 
 	{
+		HA_PROFILE_SCOPE("ControlSwitch::step", _name);
+
+		_step_time = t;
+
 		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) 
 		{
 			(*it)->step(t);
@@ -79,12 +191,140 @@ namespace ha {
 		return _name;
 	}
 
+	void ControlSwitch::setEvaluationPeriod(double period)
+	{
+		if (period < 0.0)
+			HA_THROW_ERROR("ControlSwitch.setEvaluationPeriod", "Evaluation period of control switch '" << _name << "' must not be negative: " << period);
+		_evaluation_period = period;
+	}
+
+	double ControlSwitch::getEvaluationPeriod() const
+	{
+		return _evaluation_period;
+	}
+
+	void ControlSwitch::setPrewarmMargin(double margin)
+	{
+		if (margin < 0.0)
+			HA_THROW_ERROR("ControlSwitch.setPrewarmMargin", "Prewarm margin of control switch '" << _name << "' must not be negative: " << margin);
+		_prewarm_margin = margin;
+	}
+
+	double ControlSwitch::getPrewarmMargin() const
+	{
+		return _prewarm_margin;
+	}
+
+	void ControlSwitch::setPrewarmTime(double seconds)
+	{
+		if (seconds < 0.0)
+			HA_THROW_ERROR("ControlSwitch.setPrewarmTime", "Prewarm time of control switch '" << _name << "' must not be negative: " << seconds);
+		_prewarm_time = seconds;
+	}
+
+	double ControlSwitch::getPrewarmTime() const
+	{
+		return _prewarm_time;
+	}
+
+	double ControlSwitch::getPredictedActivationTime() const
+	{
+		double predicted = -std::numeric_limits<double>::infinity();
+		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
+			predicted = std::max(predicted, (*it)->getPredictedActivationTime());
+		}
+		return predicted;
+	}
+
+	void ControlSwitch::setMaxEvaluationPeriod(double period)
+	{
+		if (period < 0.0)
+			HA_THROW_ERROR("ControlSwitch.setMaxEvaluationPeriod", "Maximum evaluation period of control switch '" << _name << "' must not be negative: " << period);
+		_max_evaluation_period = period;
+	}
+
+	double ControlSwitch::getMaxEvaluationPeriod() const
+	{
+		return _max_evaluation_period;
+	}
+
+	bool ControlSwitch::isNearlyActive() const
+	{
+		if (_prewarm_time > 0.0) {
+			const double predicted = this->getPredictedActivationTime();
+			if (predicted != -std::numeric_limits<double>::infinity() && predicted <= _step_time + _prewarm_time)
+				return true;
+		}
+
+		if (_prewarm_margin <= 0.0)
+			return false;
+
+		bool evaluated = false;
+		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
+			double distance = (*it)->getDistanceToActivation();
+			if (distance == std::numeric_limits<double>::infinity())
+				continue;
+			if (distance > _prewarm_margin)
+				return false;
+			evaluated = true;
+		}
+		return evaluated;
+	}
+
+	void ControlSwitch::setMinDwellTime(double min_dwell_time)
+	{
+		if (min_dwell_time < 0.0)
+			HA_THROW_ERROR("ControlSwitch.setMinDwellTime", "Minimum dwell time of control switch '" << _name << "' must not be negative: " << min_dwell_time);
+		_min_dwell_time = min_dwell_time;
+	}
+
+	double ControlSwitch::getMinDwellTime() const
+	{
+		return _min_dwell_time;
+	}
+
+	void ControlSwitch::setPriority(double priority)
+	{
+		_priority = priority;
+	}
+
+	double ControlSwitch::getPriority() const
+	{
+		return _priority;
+	}
+
+	void ControlSwitch::setSafetyCritical(bool safety_critical)
+	{
+		_safety_critical = safety_critical;
+	}
+
+	bool ControlSwitch::isSafetyCritical() const
+	{
+		return _safety_critical;
+	}
+
 	DescriptionTreeNode::Ptr ControlSwitch::serialize(const DescriptionTree::ConstPtr& factory) const 
 	{
 		DescriptionTreeNode::Ptr tree_node = factory->createNode("ControlSwitch");
 		tree_node->setAttribute<std::string>(std::string("name"), this->getName());
 		tree_node->setAttribute<std::string>(std::string("source"), _hybrid_automaton->getSourceControlMode(this->_name)->getName());
 		tree_node->setAttribute<std::string>(std::string("target"), _hybrid_automaton->getTargetControlMode(this->_name)->getName());
+		if (_evaluation_period > 0.0)
+			tree_node->setAttribute<double>(std::string("evaluation_period"), _evaluation_period);
+		if (_priority != 0.0)
+			tree_node->setAttribute<double>(std::string("priority"), _priority);
+		if (_safety_critical)
+			tree_node->setAttribute<bool>(std::string("safety_critical"), _safety_critical);
+		if (_prewarm_margin > 0.0)
+			tree_node->setAttribute<double>(std::string("prewarm_margin"), _prewarm_margin);
+		if (_min_dwell_time > 0.0)
+			tree_node->setAttribute<double>(std::string("min_dwell_time"), _min_dwell_time);
+		if (_prewarm_time > 0.0)
+			tree_node->setAttribute<double>(std::string("prewarm_time"), _prewarm_time);
+		if (_max_evaluation_period > 0.0)
+			tree_node->setAttribute<double>(std::string("max_evaluation_period"), _max_evaluation_period);
+		if (_adaptive_ordering)
+			tree_node->setAttribute<bool>(std::string("adaptive_ordering"), _adaptive_ordering);
 		
 		for (std::vector<JumpConditionPtr>::const_iterator it = _jump_conditions.begin(); it != _jump_conditions.end(); ++it) {
 			tree_node->addChildNode((*it)->serialize(factory));
@@ -101,6 +341,30 @@ namespace ha {
 
 		tree->getAttribute<std::string>("name", _name, "");
 
+		double evaluation_period;
+		tree->getAttribute<double>("evaluation_period", evaluation_period, 0.0);
+		this->setEvaluationPeriod(evaluation_period);
+		tree->getAttribute<double>("priority", _priority, 0.0);
+		tree->getAttribute<bool>("safety_critical", _safety_critical, false);
+
+		double prewarm_margin;
+		tree->getAttribute<double>("prewarm_margin", prewarm_margin, 0.0);
+		this->setPrewarmMargin(prewarm_margin);
+
+		double min_dwell_time;
+		tree->getAttribute<double>("min_dwell_time", min_dwell_time, 0.0);
+		this->setMinDwellTime(min_dwell_time);
+
+		double prewarm_time;
+		tree->getAttribute<double>("prewarm_time", prewarm_time, 0.0);
+		this->setPrewarmTime(prewarm_time);
+
+		double max_evaluation_period;
+		tree->getAttribute<double>("max_evaluation_period", max_evaluation_period, 0.0);
+		this->setMaxEvaluationPeriod(max_evaluation_period);
+
+		tree->getAttribute<bool>("adaptive_ordering", _adaptive_ordering, false);
+
 		DescriptionTreeNode::ConstNodeList jump_conditions;
 		tree->getChildrenNodes("JumpCondition", jump_conditions);
 
@@ -110,7 +374,7 @@ namespace ha {
 
 		DescriptionTreeNode::ConstNodeList::iterator js_it;
 		for (js_it = jump_conditions.begin(); js_it != jump_conditions.end(); ++js_it) {
-			JumpCondition::Ptr js(new JumpCondition);
+			JumpCondition::Ptr js = ExpressionCondition::create(*js_it);
 
 			//We need to set the controller pointer before calling deserialize!
 			std::string source_control_mode_name;
@@ -31,6 +31,8 @@ namespace ha {
 
 	Controller::Controller()
 		:_goal(),
+		_goal_version(1),
+		_goal_versioning(false),
 		_goal_is_relative(false),
 		_kp(),
 		_kv(),
@@ -51,6 +53,8 @@ namespace ha {
 	Controller::Controller(const ha::Controller &controller)
 	{
 		this->_goal = controller._goal;
+		this->_goal_version = controller._goal_version;
+		this->_goal_versioning = controller._goal_versioning;
 		this->_goal_is_relative = controller._goal_is_relative;		
 		this->_kp = controller._kp;
 		this->_kv = controller._kv;
@@ -109,6 +113,7 @@ namespace ha {
 
 		if(!tree->getAttribute<Eigen::MatrixXd>(std::string("goal"), this->_goal))
 			HA_WARN("Controller.deserialize", "No \"goal\" parameter given in Controller "<<_name<<" - using default value (" << _goal << ")");
+		this->_goalChanged();
 		
 		if(!tree->getAttribute<bool>(std::string("goal_is_relative"), this->_goal_is_relative, false))
 			HA_WARN("Controller.deserialize", "No \"goal_is_relative\" parameter given in Controller "<<_name<<" - using default value (" << _goal_is_relative << ")");
@@ -162,6 +167,22 @@ namespace ha {
 	void Controller::setGoal(const Eigen::MatrixXd& new_goal)
 	{
 		this->_goal = new_goal;
+		this->_goalChanged();
+	}
+
+	unsigned long Controller::getGoalVersion() const
+	{
+		return this->_goal_versioning ? this->_goal_version : (unsigned long)UNVERSIONED_GOAL;
+	}
+
+	void Controller::setGoalVersioning(bool goal_versioning)
+	{
+		this->_goal_versioning = goal_versioning;
+	}
+
+	bool Controller::getGoalVersioning() const
+	{
+		return this->_goal_versioning;
 	}
 
 	bool Controller::getGoalIsRelative() const
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/CycleClock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace ha {
+
+	namespace {
+
+		// wall clock in seconds, only used to calibrate the tick counter
+		double wallTime()
+		{
+#ifdef _WIN32
+			LARGE_INTEGER count, frequency;
+			QueryPerformanceCounter(&count);
+			QueryPerformanceFrequency(&frequency);
+			return (double)count.QuadPart / (double)frequency.QuadPart;
+#else
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+		}
+
+		double calibrate()
+		{
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+			// busy wait for 20ms and count the ticks in between
+			const double t_start = wallTime();
+			const CycleClock::Ticks c_start = CycleClock::now();
+			double t_end = t_start;
+			while (t_end - t_start < 0.02)
+				t_end = wallTime();
+			const CycleClock::Ticks c_end = CycleClock::now();
+			return (double)(c_end - c_start) / (t_end - t_start);
+#else
+			return 1e9;
+#endif
+		}
+
+	}
+
+	double CycleClock::ticksPerSecond()
+	{
+		static const double ticks_per_second = calibrate();
+		return ticks_per_second;
+	}
+
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/DerivativeSensor.h"
+#include "hybrid_automaton/RigidBodyMotion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("DerivativeSensor", DerivativeSensor);
+
+	DerivativeSensor::DerivativeSensor()
+		: _window_size(2), _is_pose(false), _samples(0), _next(0), _time(0.0)
+	{
+	}
+
+	DerivativeSensor::~DerivativeSensor()
+	{
+	}
+
+	DerivativeSensor::DerivativeSensor(const DerivativeSensor& ss)
+		: DerivedSensor(ss), _window_size(ss._window_size), _is_pose(false), _samples(0), _next(0), _time(0.0)
+	{
+	}
+
+	void DerivativeSensor::setWindowSize(int window_size)
+	{
+		if (window_size < 2)
+			HA_THROW_ERROR("DerivativeSensor.setWindowSize", "Window size must be at least 2, got " << window_size << "!");
+		_window_size = window_size;
+	}
+
+	int DerivativeSensor::getWindowSize() const
+	{
+		return _window_size;
+	}
+
+	void DerivativeSensor::initialize(const double& t)
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->initialize(t);
+
+		const ::Eigen::MatrixXd& x = _readOperand(0);
+		_is_pose = (x.rows() == 4 && x.cols() == 4);
+		_window.resize(x.size(), _window_size);
+		_times.resize(_window_size);
+		_weights.resize(_window_size);
+		if (_is_pose) {
+			_twists.resize(6, _window_size);
+			_value.setZero(6, 1);
+		} else {
+			_value.setZero(x.rows(), x.cols());
+		}
+
+		_samples = 0;
+		_next = 0;
+		_push(x, t);
+		this->_initial_sensor_value = _value;
+	}
+
+	void DerivativeSensor::step(const double& t)
+	{
+		DerivedSensor::step(t);
+
+		// one sample per control cycle
+		if (_samples == 0 || t <= _time)
+			return;
+
+		const ::Eigen::MatrixXd& x = _readOperand(0);
+		if (x.size() != _window.rows())
+			HA_THROW_ERROR("DerivativeSensor.step", "Operand changed its size from " << _window.rows() << " to " << x.size() << " entries!");
+		_push(x, t);
+		_differentiate();
+	}
+
+	void DerivativeSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		// not running yet - nothing moved so far
+		if (_samples == 0) {
+			const ::Eigen::MatrixXd& x = _readOperand(0);
+			if (x.rows() == 4 && x.cols() == 4)
+				value.setZero(6, 1);
+			else
+				value.setZero(x.rows(), x.cols());
+			return;
+		}
+		value = _value;
+	}
+
+	void DerivativeSensor::_push(const ::Eigen::MatrixXd& x, double t)
+	{
+		_window.col(_next) = ::Eigen::Map<const ::Eigen::VectorXd>(x.data(), x.size());
+		_times(_next) = t;
+		_time = t;
+		_next = (_next + 1) % _window_size;
+		_samples++;
+	}
+
+	void DerivativeSensor::_differentiate()
+	{
+		// until the ring buffer is full only its first count columns are used
+		const int count = static_cast<int>(std::min<unsigned long long>(_samples, _window_size));
+		const int newest = (_next + _window_size - 1) % _window_size;
+
+		// slope of the least squares line: sum_i w_i * x_i with w_i = (t_i - mean(t)) / sum_j (t_j - mean(t))^2,
+		// the order of the samples does not matter. Times are taken relative to the newest sample.
+		_weights.head(count) = _times.head(count).array() - _times(newest);
+		_weights.head(count).array() -= _weights.head(count).mean();
+		_weights.head(count) /= _weights.head(count).squaredNorm();
+
+		if (!_is_pose) {
+			// the weights sum up to zero only up to rounding - subtract the newest sample to not amplify
+			// that error with the magnitude of x
+			::Eigen::Map< ::Eigen::VectorXd> value(_value.data(), _value.size());
+			value.noalias() = _window.leftCols(count) * _weights.head(count);
+			value -= _weights.head(count).sum() * _window.col(newest);
+			return;
+		}
+
+		// express all poses relative to the newest one, the slope is the twist in the newest frame
+		const ::Eigen::Matrix4d newest_inverse = ::Eigen::Map<const ::Eigen::Matrix4d>(_window.col(newest).data()).inverse();
+		::Eigen::Matrix<double, 6, 1> twist;
+		for (int i = 0; i < count; i++) {
+			if (i == newest) {
+				_twists.col(i).setZero();
+				continue;
+			}
+			logPose(newest_inverse * ::Eigen::Map<const ::Eigen::Matrix4d>(_window.col(i).data()), twist);
+			_twists.col(i) = twist;
+		}
+		_value.noalias() = _twists.leftCols(count) * _weights.head(count);
+	}
+
+	std::size_t DerivativeSensor::_getMinOperands() const
+	{
+		return 1;
+	}
+
+	std::size_t DerivativeSensor::_getMaxOperands() const
+	{
+		return 1;
+	}
+
+	void DerivativeSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+		if (_window_size != 2)
+			tree->setAttribute<int>(std::string("window"), _window_size);
+	}
+
+	void DerivativeSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		int window;
+		tree->getAttribute<int>("window", window, 2);
+		setWindowSize(window);
+	}
+
+}
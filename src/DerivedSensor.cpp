@@ -0,0 +1,200 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/DerivedSensor.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+
+namespace ha {
+
+	DerivedSensor::DerivedSensor()
+	{
+	}
+
+	DerivedSensor::~DerivedSensor()
+	{
+	}
+
+	DerivedSensor::DerivedSensor(const DerivedSensor& ss)
+		: Sensor(ss)
+	{
+		for (std::size_t i = 0; i < ss._operands.size(); i++)
+			addOperand(ss._operands[i]->clone());
+	}
+
+	void DerivedSensor::addOperand(const Sensor::Ptr& operand)
+	{
+		if (!operand)
+			HA_THROW_ERROR("DerivedSensor.addOperand", "Operand of " << getType() << " must not be NULL!");
+
+		_operands.push_back(operand);
+		_operand_values.resize(_operands.size());
+	}
+
+	const std::vector<Sensor::Ptr>& DerivedSensor::getOperands() const
+	{
+		return _operands;
+	}
+
+	::Eigen::MatrixXd DerivedSensor::getCurrentValue() const
+	{
+		::Eigen::MatrixXd value;
+		this->readCurrentValue(value);
+		return value;
+	}
+
+	void DerivedSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void DerivedSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
+	void DerivedSensor::setSystem(const System::ConstPtr& system)
+	{
+		Sensor::setSystem(system);
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->setSystem(system);
+	}
+
+	void DerivedSensor::initialize(const double& t)
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->initialize(t);
+		this->readCurrentValue(this->_initial_sensor_value);
+	}
+
+	void DerivedSensor::prepare()
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->prepare();
+	}
+
+	void DerivedSensor::terminate()
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->terminate();
+	}
+
+	void DerivedSensor::step(const double& t)
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->step(t);
+	}
+
+	bool DerivedSensor::isActive() const
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++) {
+			if (!_operands[i]->isActive())
+				return false;
+		}
+		return true;
+	}
+
+	bool DerivedSensor::hasNewValue() const
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++) {
+			if (_operands[i]->hasNewValue())
+				return true;
+		}
+		return false;
+	}
+
+	bool DerivedSensor::getSampleTime(double& time) const
+	{
+		bool has_time = false;
+		double operand_time;
+		for (std::size_t i = 0; i < _operands.size(); i++) {
+			if (!_operands[i]->getSampleTime(operand_time))
+				continue;
+			if (!has_time || operand_time < time)
+				time = operand_time;
+			has_time = true;
+		}
+		return has_time;
+	}
+
+	DescriptionTreeNode::Ptr DerivedSensor::serialize(const DescriptionTree::ConstPtr& factory) const
+	{
+		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
+		tree->setAttribute<std::string>(std::string("type"), this->getType());
+		this->_serializeAttributes(tree);
+
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			tree->addChildNode(_operands[i]->serialize(factory));
+
+		return tree;
+	}
+
+	void DerivedSensor::deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha)
+	{
+		if (tree->getType() != "Sensor") {
+			HA_THROW_ERROR("DerivedSensor.deserialize", "DescriptionTreeNode must have type 'Sensor', not '" << tree->getType() << "'!");
+		}
+		tree->getAttribute<std::string>("type", _type, "");
+		if (_type == "" || !HybridAutomaton::isSensorRegistered(_type)) {
+			HA_THROW_ERROR("DerivedSensor.deserialize", "SensorType type '" << _type << "' "
+				<< "invalid - empty or not registered with HybridAutomaton!");
+		}
+
+		this->_deserializeAttributes(tree);
+
+		DescriptionTreeNode::ConstNodeList operand_nodes;
+		tree->getChildrenNodes("Sensor", operand_nodes);
+		if (operand_nodes.size() < _getMinOperands() || operand_nodes.size() > _getMaxOperands()) {
+			HA_THROW_ERROR("DerivedSensor.deserialize", _type << " needs between " << _getMinOperands() << " and "
+				<< _getMaxOperands() << " operands (child Sensor nodes), got " << operand_nodes.size() << "!");
+		}
+
+		_operands.clear();
+		_operand_values.clear();
+		for (DescriptionTreeNode::ConstNodeList::const_iterator it = operand_nodes.begin(); it != operand_nodes.end(); ++it) {
+			// structurally equal subexpressions become one node of the graph
+			if (ha)
+				addOperand(ha->createSharedSensor(*it, system));
+			else
+				addOperand(HybridAutomaton::createSensor(*it, system, ha));
+		}
+
+		_system = system;
+	}
+
+	const ::Eigen::MatrixXd& DerivedSensor::_readOperand(std::size_t i) const
+	{
+		_operands[i]->readCurrentValue(_operand_values[i]);
+		return _operand_values[i];
+	}
+
+	void DerivedSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+	}
+
+	void DerivedSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+	}
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/DifferenceSensor.h"
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("DifferenceSensor", DifferenceSensor);
+
+	DifferenceSensor::DifferenceSensor()
+	{
+	}
+
+	DifferenceSensor::~DifferenceSensor()
+	{
+	}
+
+	DifferenceSensor::DifferenceSensor(const DifferenceSensor& ss)
+		: DerivedSensor(ss)
+	{
+	}
+
+	void DifferenceSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		const ::Eigen::MatrixXd& x0 = _readOperand(0);
+		const ::Eigen::MatrixXd& x1 = _readOperand(1);
+
+		if (x0.rows() != x1.rows() || x0.cols() != x1.cols())
+			HA_THROW_ERROR("DifferenceSensor.readCurrentValue", "Dimension mismatch in operands: "
+				<< x0.rows() << "x" << x0.cols() << " and " << x1.rows() << "x" << x1.cols() << "!");
+
+		value = x0 - x1;
+	}
+
+	std::size_t DifferenceSensor::_getMinOperands() const
+	{
+		return 2;
+	}
+
+	std::size_t DifferenceSensor::_getMaxOperands() const
+	{
+		return 2;
+	}
+
+}
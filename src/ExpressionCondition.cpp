@@ -0,0 +1,372 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/ExpressionCondition.h"
+#include "hybrid_automaton/Profiler.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace ha {
+
+	ExpressionCondition::ExpressionCondition(Operator op)
+		: _operator(op), _entry(RESULT_FALSE)
+	{
+		this->_updateProfileName();
+		this->_compile();
+	}
+
+	ExpressionCondition::~ExpressionCondition()
+	{
+	}
+
+	ExpressionCondition::ExpressionCondition(const ExpressionCondition& ec)
+		: JumpCondition(ec), _operator(ec._operator), _entry(RESULT_FALSE)
+	{
+		for (std::size_t i = 0; i < ec._operands.size(); ++i)
+			_operands.push_back(ec._operands[i]->clone());
+		this->_compile();
+	}
+
+	JumpConditionPtr ExpressionCondition::create(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		std::string expression;
+		if (tree->getAttribute<std::string>("expression", expression))
+			return JumpConditionPtr(new ExpressionCondition(operatorFromString(expression)));
+		return JumpConditionPtr(new JumpCondition);
+	}
+
+	std::string ExpressionCondition::operatorToString(Operator op)
+	{
+		switch (op) {
+			case AND: return "and";
+			case OR: return "or";
+			case NOT: return "not";
+		}
+		HA_THROW_ERROR("ExpressionCondition.operatorToString", "Unknown operator: " << op);
+	}
+
+	ExpressionCondition::Operator ExpressionCondition::operatorFromString(const std::string& op)
+	{
+		if (op == "and")
+			return AND;
+		if (op == "or")
+			return OR;
+		if (op == "not")
+			return NOT;
+		HA_THROW_ERROR("ExpressionCondition.operatorFromString", "Unknown operator '" << op << "' - use 'and', 'or' or 'not'");
+	}
+
+	void ExpressionCondition::setOperator(Operator op)
+	{
+		_operator = op;
+		this->_updateProfileName();
+		this->_compile();
+	}
+
+	ExpressionCondition::Operator ExpressionCondition::getOperator() const
+	{
+		return _operator;
+	}
+
+	void ExpressionCondition::addOperand(const JumpConditionPtr& operand)
+	{
+		if (!operand)
+			HA_THROW_ERROR("ExpressionCondition.addOperand", "Operand must not be null");
+		operand->setPath(_operandPath(_operands.size()));
+		_operands.push_back(operand);
+		this->_compile();
+	}
+
+	const std::vector<JumpConditionPtr>& ExpressionCondition::getOperands() const
+	{
+		return _operands;
+	}
+
+	void ExpressionCondition::_check() const
+	{
+		if (_operator == NOT && _operands.size() != 1)
+			HA_THROW_ERROR("ExpressionCondition._check", "Expression 'not' needs exactly one operand, not " << _operands.size());
+		if (_operands.empty())
+			HA_THROW_ERROR("ExpressionCondition._check", "Expression '" << operatorToString(_operator) << "' has no operands");
+
+		for (std::size_t i = 0; i < _operands.size(); ++i) {
+			const ExpressionCondition* expression = dynamic_cast<const ExpressionCondition*>(_operands[i].get());
+			if (expression)
+				expression->_check();
+		}
+	}
+
+	void ExpressionCondition::_collectComparisons(const JumpConditionPtr& node)
+	{
+		const ExpressionCondition* expression = dynamic_cast<const ExpressionCondition*>(node.get());
+		if (!expression) {
+			if (std::find(_comparisons.begin(), _comparisons.end(), node) == _comparisons.end())
+				_comparisons.push_back(node);
+			return;
+		}
+		for (std::size_t i = 0; i < expression->_operands.size(); ++i)
+			this->_collectComparisons(expression->_operands[i]);
+	}
+
+	void ExpressionCondition::_compile()
+	{
+		_program.clear();
+		_comparisons.clear();
+		for (std::size_t i = 0; i < _operands.size(); ++i)
+			this->_collectComparisons(_operands[i]);
+
+		// nested expressions are compiled into this program - only comparisons remain
+		_entry = this->_compile(_operator, _operands, RESULT_TRUE, RESULT_FALSE, RESULT_UNKNOWN);
+	}
+
+	int ExpressionCondition::_compile(const JumpConditionPtr& node, int on_true, int on_false, int on_unknown)
+	{
+		const ExpressionCondition* expression = dynamic_cast<const ExpressionCondition*>(node.get());
+		if (!expression) {
+			Instruction instruction;
+			instruction.comparison = node.get();
+			instruction.on_true = on_true;
+			instruction.on_false = on_false;
+			instruction.on_unknown = on_unknown;
+			_program.push_back(instruction);
+			return (int)_program.size() - 1;
+		}
+
+		return this->_compile(expression->_operator, expression->_operands, on_true, on_false, on_unknown);
+	}
+
+	int ExpressionCondition::_compile(Operator op, const std::vector<JumpConditionPtr>& operands, int on_true, int on_false, int on_unknown)
+	{
+		// NOT of several operands is NOT of their conjunction
+		const bool conjunction = (op != OR);
+		if (op == NOT)
+			std::swap(on_true, on_false);
+
+		// the program is emitted backwards, every operand continues with the code of the next one.
+		// Once an operand was unknown the rest decides between the short-circuit result and unknown,
+		// so each operand is compiled a second time for that case.
+		int known = conjunction ? on_true : on_false;
+		int unknown = on_unknown;
+		for (int i = (int)operands.size() - 1; i >= 0; --i) {
+			const int next_unknown = (i > 0) ? (conjunction
+				? this->_compile(operands[i], unknown, on_false, unknown)
+				: this->_compile(operands[i], on_true, unknown, unknown)) : unknown;
+			known = conjunction
+				? this->_compile(operands[i], known, on_false, unknown)
+				: this->_compile(operands[i], on_true, known, unknown);
+			unknown = next_unknown;
+		}
+		return known;
+	}
+
+	std::size_t ExpressionCondition::getProgramSize() const
+	{
+		return _program.size();
+	}
+
+	const std::vector<JumpConditionPtr>& ExpressionCondition::getComparisons() const
+	{
+		return _comparisons;
+	}
+
+	void ExpressionCondition::initialize(const double& t)
+	{
+		this->_check();
+		this->_compile();
+
+		this->_is_unknown = false;
+		this->_step_time = t;
+		for (std::vector<JumpConditionPtr>::const_iterator it = _comparisons.begin(); it != _comparisons.end(); ++it)
+			(*it)->initialize(t);
+	}
+
+	void ExpressionCondition::prepare()
+	{
+		for (std::vector<JumpConditionPtr>::const_iterator it = _comparisons.begin(); it != _comparisons.end(); ++it)
+			(*it)->prepare();
+	}
+
+	void ExpressionCondition::terminate()
+	{
+		for (std::vector<JumpConditionPtr>::const_iterator it = _comparisons.begin(); it != _comparisons.end(); ++it)
+			(*it)->terminate();
+	}
+
+	void ExpressionCondition::step(const double& t)
+	{
+		this->_step_time = t;
+		for (std::vector<JumpConditionPtr>::const_iterator it = _comparisons.begin(); it != _comparisons.end(); ++it)
+			(*it)->step(t);
+	}
+
+	bool ExpressionCondition::isActive() const
+	{
+		HA_PROFILE_SCOPE("ExpressionCondition::isActive", this->_profile_name);
+
+		int next = _entry;
+		while (next >= 0) {
+			const Instruction& instruction = _program[next];
+			if (instruction.comparison->isActive())
+				next = instruction.on_true;
+			else
+				next = instruction.comparison->isUnknown() ? instruction.on_unknown : instruction.on_false;
+		}
+
+		this->_is_unknown = (next == RESULT_UNKNOWN);
+		return next == RESULT_TRUE;
+	}
+
+	double ExpressionCondition::getEarliestActivationTime() const
+	{
+		const double any_time = -std::numeric_limits<double>::infinity();
+		if (_operator == NOT || _operands.empty())
+			return any_time;
+
+		double earliest = _operands[0]->getEarliestActivationTime();
+		for (std::size_t i = 1; i < _operands.size(); ++i) {
+			const double operand = _operands[i]->getEarliestActivationTime();
+			earliest = (_operator == AND) ? std::max(earliest, operand) : std::min(earliest, operand);
+		}
+		return earliest;
+	}
+
+	double ExpressionCondition::getDistanceToActivation() const
+	{
+		const double unknown = std::numeric_limits<double>::infinity();
+		if (_operator == NOT)
+			return unknown;
+
+		// like ControlSwitch::isNearlyActive(), operands without a criterion do not count
+		bool has_distance = false;
+		double distance = (_operator == AND) ? 0.0 : unknown;
+		for (std::size_t i = 0; i < _operands.size(); ++i) {
+			const double operand = _operands[i]->getDistanceToActivation();
+			if (operand == unknown)
+				continue;
+			distance = (_operator == AND) ? std::max(distance, operand) : std::min(distance, operand);
+			has_distance = true;
+		}
+		return has_distance ? distance : unknown;
+	}
+
+	double ExpressionCondition::getPredictedActivationTime() const
+	{
+		const double any_time = -std::numeric_limits<double>::infinity();
+		if (_operator == NOT || _operands.empty())
+			return any_time;
+
+		double predicted = _operands[0]->getPredictedActivationTime();
+		for (std::size_t i = 1; i < _operands.size(); ++i) {
+			const double operand = _operands[i]->getPredictedActivationTime();
+			predicted = (_operator == AND) ? std::max(predicted, operand) : std::min(predicted, operand);
+		}
+		return predicted;
+	}
+
+	void ExpressionCondition::setSourceModeName(const std::string& sourceModeName)
+	{
+		JumpCondition::setSourceModeName(sourceModeName);
+		for (std::size_t i = 0; i < _operands.size(); ++i)
+			_operands[i]->setSourceModeName(sourceModeName);
+	}
+
+	void ExpressionCondition::setPath(const std::string& path)
+	{
+		JumpCondition::setPath(path);
+		for (std::size_t i = 0; i < _operands.size(); ++i)
+			_operands[i]->setPath(_operandPath(i));
+	}
+
+	std::string ExpressionCondition::_operandPath(std::size_t index) const
+	{
+		std::stringstream ss;
+		if (!_path.empty())
+			ss << _path << ".";
+		ss << index;
+		return ss.str();
+	}
+
+	void ExpressionCondition::_updateProfileName()
+	{
+		_profile_name = _path;
+		_profile_name += (_path.empty() ? "" : " ") + operatorToString(_operator);
+	}
+
+	DescriptionTreeNode::Ptr ExpressionCondition::serialize(const DescriptionTree::ConstPtr& factory) const
+	{
+		DescriptionTreeNode::Ptr tree = factory->createNode("JumpCondition");
+		tree->setAttribute<std::string>(std::string("expression"), operatorToString(_operator));
+		for (std::size_t i = 0; i < _operands.size(); ++i)
+			tree->addChildNode(_operands[i]->serialize(factory));
+		return tree;
+	}
+
+	void ExpressionCondition::deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha)
+	{
+		if (tree->getType() != "JumpCondition") {
+			HA_THROW_ERROR("ExpressionCondition.deserialize", "ExpressionCondition must have type 'JumpCondition', not '" << tree->getType() << "'!");
+		}
+
+		std::string expression;
+		if (!tree->getAttribute<std::string>("expression", expression)) {
+			HA_THROW_ERROR("ExpressionCondition.deserialize", "No \"expression\" attribute given!");
+		}
+		_operator = operatorFromString(expression);
+		this->_updateProfileName();
+
+		DescriptionTreeNode::ConstNodeList operands;
+		tree->getChildrenNodes("JumpCondition", operands);
+
+		_operands.clear();
+		for (DescriptionTreeNode::ConstNodeList::iterator it = operands.begin(); it != operands.end(); ++it) {
+			JumpConditionPtr operand = ExpressionCondition::create(*it);
+			operand->setSourceModeName(_sourceModeName);
+			operand->deserialize(*it, system, ha);
+			operand->setPath(_operandPath(_operands.size()));
+			_operands.push_back(operand);
+		}
+		this->_check();
+		this->_compile();
+	}
+
+	std::string ExpressionCondition::toString(bool use_latex)
+	{
+		std::stringstream ss;
+		if (_operator == NOT)
+			ss << "!";
+		ss << "(";
+		for (std::size_t i = 0; i < _operands.size(); ++i) {
+			if (i > 0)
+				ss << (_operator == OR ? " | " : " & ");
+			ss << _operands[i]->toString(use_latex);
+		}
+		ss << ")";
+		return ss.str();
+	}
+
+}
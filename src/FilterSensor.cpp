@@ -0,0 +1,144 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/FilterSensor.h"
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("FilterSensor", FilterSensor);
+
+	FilterSensor::FilterSensor()
+		: _time(0.0)
+	{
+	}
+
+	FilterSensor::~FilterSensor()
+	{
+	}
+
+	FilterSensor::FilterSensor(const FilterSensor& ss)
+		: DerivedSensor(ss), _time(0.0)
+	{
+		// copy the parameters, not the state
+		setFilter(ss._filter);
+	}
+
+	void FilterSensor::setFilter(const StreamingFilter& filter)
+	{
+		_filter = StreamingFilter();
+		_filter.setType(filter.getType());
+		_filter.setTimeConstant(filter.getTimeConstant());
+		_filter.setCutoffFrequency(filter.getCutoffFrequency());
+		_filter.setWindowSize(filter.getWindowSize());
+	}
+
+	const StreamingFilter& FilterSensor::getFilter() const
+	{
+		return _filter;
+	}
+
+	void FilterSensor::setTimeConstant(double time_constant)
+	{
+		_filter.setTimeConstant(time_constant);
+	}
+
+	double FilterSensor::getTimeConstant() const
+	{
+		return _filter.getTimeConstant();
+	}
+
+	void FilterSensor::initialize(const double& t)
+	{
+		for (std::size_t i = 0; i < _operands.size(); i++)
+			_operands[i]->initialize(t);
+
+		_filter.reset(_readOperand(0));
+		_time = t;
+		this->_initial_sensor_value = _filter.getValue();
+	}
+
+	void FilterSensor::step(const double& t)
+	{
+		DerivedSensor::step(t);
+
+		_filter.update(_readOperand(0), t - _time);
+		_time = t;
+	}
+
+	void FilterSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		// not running yet - there is nothing to filter
+		if (!_filter.hasValue()) {
+			value = _readOperand(0);
+			return;
+		}
+		value = _filter.getValue();
+	}
+
+	std::size_t FilterSensor::_getMinOperands() const
+	{
+		return 1;
+	}
+
+	std::size_t FilterSensor::_getMaxOperands() const
+	{
+		return 1;
+	}
+
+	void FilterSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+		tree->setAttribute<std::string>(std::string("filter"), StreamingFilter::typeToString(_filter.getType()));
+		switch (_filter.getType()) {
+			case StreamingFilter::LOW_PASS:
+				tree->setAttribute<double>(std::string("time_constant"), _filter.getTimeConstant());
+				break;
+			case StreamingFilter::BUTTERWORTH:
+				tree->setAttribute<double>(std::string("cutoff_frequency"), _filter.getCutoffFrequency());
+				break;
+			default:
+				tree->setAttribute<int>(std::string("window"), _filter.getWindowSize());
+				break;
+		}
+	}
+
+	void FilterSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		std::string filter;
+		double time_constant, cutoff_frequency;
+		int window;
+		tree->getAttribute<std::string>("filter", filter, "low_pass");
+		tree->getAttribute<double>("time_constant", time_constant, 0.0);
+		tree->getAttribute<double>("cutoff_frequency", cutoff_frequency, 0.0);
+		tree->getAttribute<int>("window", window, 1);
+
+		StreamingFilter parameters;
+		parameters.setType(StreamingFilter::typeFromString(filter));
+		parameters.setTimeConstant(time_constant);
+		parameters.setCutoffFrequency(cutoff_frequency);
+		parameters.setWindowSize(window);
+		setFilter(parameters);
+	}
+
+}
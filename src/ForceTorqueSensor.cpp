@@ -44,41 +44,56 @@ namespace ha
 	}
 	::Eigen::MatrixXd ForceTorqueSensor::transformWrench(const ::Eigen::MatrixXd& wrench, const ::Eigen::MatrixXd& transform) const
 	{
-		::Eigen::Matrix3d frameRot = transform.block(0,0,3,3);
-		::Eigen::Vector3d frameTrans(transform(0,3), transform(1,3), transform(2,3));
+		Eigen::MatrixXd wrenchOut = wrench;
+		transformWrenchInPlace(wrenchOut, transform.block<3,3>(0,0), transform.block<3,1>(0,3));
+		return wrenchOut;
+	}
+
+	void ForceTorqueSensor::transformWrenchInPlace(::Eigen::MatrixXd& wrench, const ::Eigen::Matrix3d& frameRot, const ::Eigen::Vector3d& frameTrans) const
+	{
 		::Eigen::Vector3d forcePart(wrench(0,0), wrench(1,0),wrench(2,0));
 		::Eigen::Vector3d momentPart(wrench(3,0), wrench(4,0),wrench(5,0));
 
 		forcePart = frameRot.transpose()*forcePart;
 		momentPart = frameRot.transpose()*(momentPart - frameTrans.cross(forcePart));
 
-		Eigen::MatrixXd wrenchOut(6,1);
-		wrenchOut(0) = forcePart(0); wrenchOut(1) = forcePart(1); wrenchOut(2) = forcePart(2);
-		wrenchOut(3) = momentPart(0); wrenchOut(4) = momentPart(1); wrenchOut(5) = momentPart(2);
-		return wrenchOut;
+		wrench(0) = forcePart(0); wrench(1) = forcePart(1); wrench(2) = forcePart(2);
+		wrench(3) = momentPart(0); wrench(4) = momentPart(1); wrench(5) = momentPart(2);
 	}
 
 	::Eigen::MatrixXd ForceTorqueSensor::getCurrentValue() const
+	{
+		::Eigen::MatrixXd ftOut;
+		this->readCurrentValue(ftOut);
+		return ftOut;
+	}
+
+	void ForceTorqueSensor::readCurrentValue(::Eigen::MatrixXd& value) const
 	{
 		//This is the F/T wrench from the hardware - It must be in EE frame
-		::Eigen::MatrixXd forceTorque = _system->getForceTorqueMeasurement(_port);
-		Eigen::MatrixXd ftOut = forceTorque;
+		_system->readForceTorqueMeasurement(_port, value);
 		
 		if(_frame_id == "world")
 		{
-			::Eigen::MatrixXd eeFrame = _system->getFramePose("EE");
+			_system->readFramePose("EE", _ee_frame);
 
 			//Transform FT wrench to world frame
-			ftOut = transformWrench(forceTorque, eeFrame.inverse());
+			const ::Eigen::Matrix4d eeFrameInverse = ::Eigen::Matrix4d(_ee_frame).inverse();
+			transformWrenchInPlace(value, eeFrameInverse.block<3,3>(0,0), eeFrameInverse.block<3,1>(0,3));
 		}
 
 		//Transform FT wrench to given frame
-		ftOut = transformWrench(ftOut, _frame);
+		transformWrenchInPlace(value, _frame.block<3,3>(0,0), _frame.block<3,1>(0,3));
+	}
 
-		//if((k++)%2000 == 0)
-		//	HA_INFO("ForceTorqueSensor.getCurrentValue","ftout: "<<ftOut.transpose());
+	void ForceTorqueSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
 
-		return ftOut;
+	void ForceTorqueSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
 	}
 
 	DescriptionTreeNode::Ptr ForceTorqueSensor::serialize(const DescriptionTree::ConstPtr& factory) const
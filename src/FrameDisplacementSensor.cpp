@@ -40,39 +40,53 @@ namespace ha
 	}
 
 	FrameDisplacementSensor::FrameDisplacementSensor(const FrameDisplacementSensor& ss)
-		:Sensor(ss)
+		:Sensor(ss), _initial_inverse(ss._initial_inverse)
 	{
 	}
 
 	void FrameDisplacementSensor::initialize(const double& t) 
 	{
-		this->_initial_sensor_value = this->_system->getFramePose(this->_frame_id);
+		this->_system->readFramePose(this->_frame_id, this->_initial_sensor_value);
+		this->_initial_inverse = this->_initial_sensor_value.inverse();
 	}
 
 	::Eigen::MatrixXd FrameDisplacementSensor::getCurrentValue() const
 	{
-		::Eigen::MatrixXd pose = this->_system->getFramePose(this->_frame_id);
-		pose = pose.col(3);
-		pose.conservativeResize(3,1);
-		return pose;
+		::Eigen::MatrixXd position;
+		this->readCurrentValue(position);
+		return position;
 	}
 
 	::Eigen::MatrixXd FrameDisplacementSensor::getInitialValue() const
 	{
-		::Eigen::MatrixXd ret = this->_initial_sensor_value.col(3);
-		ret.conservativeResize(3,1);
+		::Eigen::MatrixXd ret;
+		this->readInitialValue(ret);
 		return ret;
 	}
 
 	::Eigen::MatrixXd FrameDisplacementSensor::getRelativeCurrentValue() const
 	{
-		
-		::Eigen::MatrixXd pose = this->_system->getFramePose(this->_frame_id);
-		pose=_initial_sensor_value.inverse()*pose;
-		pose = pose.col(3);
-		pose.conservativeResize(3,1);
-		
-		return pose;
+		::Eigen::MatrixXd position;
+		this->readRelativeCurrentValue(position);
+		return position;
+	}
+
+	void FrameDisplacementSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readFramePose(this->_frame_id, _pose);
+		value = _pose.block(0,3,3,1);
+	}
+
+	void FrameDisplacementSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		// translation of initial^-1 * pose
+		this->_system->readFramePose(this->_frame_id, _pose);
+		value.noalias() = _initial_inverse.topRows(3) * _pose.col(3);
+	}
+
+	void FrameDisplacementSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value.block(0,3,3,1);
 	}
 
 	DescriptionTreeNode::Ptr FrameDisplacementSensor::serialize(const DescriptionTree::ConstPtr& factory) const
@@ -40,21 +40,20 @@ namespace ha
 	}
 
 	FrameOrientationSensor::FrameOrientationSensor(const FrameOrientationSensor& ss)
-		:Sensor(ss)
+		:Sensor(ss), _initial_inverse(ss._initial_inverse)
 	{
 	}
 
 	void FrameOrientationSensor::initialize(const double& t) 
 	{
-		::Eigen::MatrixXd pose = this->_system->getFramePose(this->_frame_id);
-		pose.conservativeResize(3,3);
-		this->_initial_sensor_value = pose;
+		this->readCurrentValue(this->_initial_sensor_value);
+		this->_initial_inverse = this->_initial_sensor_value.inverse();
 	}
 
 	::Eigen::MatrixXd FrameOrientationSensor::getCurrentValue() const
 	{
-		::Eigen::MatrixXd pose = this->_system->getFramePose(this->_frame_id);
-		pose.conservativeResize(3,3);
+		::Eigen::MatrixXd pose;
+		this->readCurrentValue(pose);
 		return pose;
 	}
 	
@@ -65,12 +64,28 @@ namespace ha
 
 	::Eigen::MatrixXd FrameOrientationSensor::getRelativeCurrentValue() const
 	{
-		::Eigen::MatrixXd pose = this->_system->getFramePose(this->_frame_id);
-		pose.conservativeResize(3,3);
-		pose = _initial_sensor_value.inverse()*pose;
+		::Eigen::MatrixXd pose;
+		this->readRelativeCurrentValue(pose);
 		return pose;
 	}
 
+	void FrameOrientationSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readFramePose(this->_frame_id, _pose);
+		value = _pose.topLeftCorner(3,3);
+	}
+
+	void FrameOrientationSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readFramePose(this->_frame_id, _pose);
+		value.noalias() = _initial_inverse * _pose.topLeftCorner(3,3);
+	}
+
+	void FrameOrientationSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
 	DescriptionTreeNode::Ptr FrameOrientationSensor::serialize(const DescriptionTree::ConstPtr& factory) const
 	{
 		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
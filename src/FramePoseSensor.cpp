@@ -40,14 +40,15 @@ namespace ha
 	}
 
 	FramePoseSensor::FramePoseSensor(const FramePoseSensor& ss)
-		:Sensor(ss)
+		:Sensor(ss), _initial_inverse(ss._initial_inverse)
 	{
 	}
 
 
 	void FramePoseSensor::initialize(const double& t) 
 	{
-		this->_initial_sensor_value = this->_system->getFramePose(this->_frame_id);
+		this->_system->readFramePose(this->_frame_id, this->_initial_sensor_value);
+		this->_initial_inverse = this->_initial_sensor_value.inverse();
 	}
 
 	::Eigen::MatrixXd FramePoseSensor::getCurrentValue() const
@@ -57,14 +58,30 @@ namespace ha
 
 	::Eigen::MatrixXd FramePoseSensor::getRelativeCurrentValue() const
 	{
-		::Eigen::MatrixXd pose = this->_system->getFramePose(this->_frame_id);
-    if(_reference_frame == "world")
-      pose = pose*_initial_sensor_value.inverse();
-    else
-      pose = _initial_sensor_value.inverse()*pose;
+		::Eigen::MatrixXd pose;
+		this->readRelativeCurrentValue(pose);
 		return pose;
 	}
 
+	void FramePoseSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readFramePose(this->_frame_id, value);
+	}
+
+	void FramePoseSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readFramePose(this->_frame_id, _pose);
+		if(_reference_frame == "world")
+			value.noalias() = _pose*_initial_inverse;
+		else
+			value.noalias() = _initial_inverse*_pose;
+	}
+
+	void FramePoseSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
 	::Eigen::MatrixXd FramePoseSensor::getInitialValue() const
 	{
 		return this->_initial_sensor_value;
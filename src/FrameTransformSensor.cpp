@@ -0,0 +1,133 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/FrameTransformSensor.h"
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("FrameTransformSensor", FrameTransformSensor);
+
+	FrameTransformSensor::FrameTransformSensor()
+		: _frame(::Eigen::MatrixXd::Identity(4, 4)), _invert_pose(false)
+	{
+	}
+
+	FrameTransformSensor::~FrameTransformSensor()
+	{
+	}
+
+	FrameTransformSensor::FrameTransformSensor(const FrameTransformSensor& ss)
+		: DerivedSensor(ss), _frame(ss._frame), _invert_pose(ss._invert_pose)
+	{
+	}
+
+	void FrameTransformSensor::setFrame(const ::Eigen::MatrixXd& frame)
+	{
+		if (frame.rows() != 4 || frame.cols() != 4)
+			HA_THROW_ERROR("FrameTransformSensor.setFrame", "Frame must be 4x4, not " << frame.rows() << "x" << frame.cols() << "!");
+		_frame = frame;
+	}
+
+	::Eigen::MatrixXd FrameTransformSensor::getFrame() const
+	{
+		return _frame;
+	}
+
+	void FrameTransformSensor::setInvertPose(bool invert_pose)
+	{
+		_invert_pose = invert_pose;
+	}
+
+	bool FrameTransformSensor::getInvertPose() const
+	{
+		return _invert_pose;
+	}
+
+	void FrameTransformSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		::Eigen::Matrix4d transform = _frame;
+		if (_operands.size() > 1) {
+			const ::Eigen::MatrixXd& pose = _readOperand(1);
+			if (pose.rows() != 4 || pose.cols() != 4)
+				HA_THROW_ERROR("FrameTransformSensor.readCurrentValue", "Second operand must be a pose (4x4), not " << pose.rows() << "x" << pose.cols() << "!");
+
+			const ::Eigen::Matrix4d frame_pose = pose;
+			if (_invert_pose)
+				transform = frame_pose.inverse() * transform;
+			else
+				transform = frame_pose * transform;
+		}
+
+		const ::Eigen::Matrix3d rotation = transform.block<3,3>(0,0);
+		const ::Eigen::Vector3d translation = transform.block<3,1>(0,3);
+
+		const ::Eigen::MatrixXd& x = _readOperand(0);
+		if (x.rows() == 6 && x.cols() == 1) {
+			// the moment about the origin of the target frame, both in the frame of the value
+			const ::Eigen::Vector3d force = x.block<3,1>(0,0);
+			const ::Eigen::Vector3d moment = x.block<3,1>(3,0) - translation.cross(force);
+			value.resize(6, 1);
+			value.block<3,1>(0,0) = rotation.transpose() * force;
+			value.block<3,1>(3,0) = rotation.transpose() * moment;
+		} else if (x.rows() == 3 && x.cols() == 1) {
+			const ::Eigen::Vector3d point = x;
+			value.noalias() = rotation.transpose() * (point - translation);
+		} else if (x.rows() == 4 && x.cols() == 4) {
+			const ::Eigen::Matrix4d inverse = transform.inverse();
+			value.noalias() = inverse * x;
+		} else {
+			HA_THROW_ERROR("FrameTransformSensor.readCurrentValue", "Cannot transform a " << x.rows() << "x" << x.cols() << " value "
+				<< "- need a wrench (6x1), a point (3x1) or a pose (4x4)!");
+		}
+	}
+
+	std::size_t FrameTransformSensor::_getMinOperands() const
+	{
+		return 1;
+	}
+
+	std::size_t FrameTransformSensor::_getMaxOperands() const
+	{
+		return 2;
+	}
+
+	void FrameTransformSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+		tree->setAttribute< ::Eigen::MatrixXd>(std::string("frame"), _frame);
+		if (_invert_pose)
+			tree->setAttribute<bool>(std::string("invert_pose"), _invert_pose);
+	}
+
+	void FrameTransformSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		::Eigen::MatrixXd frame;
+		if (tree->getAttribute< ::Eigen::MatrixXd>("frame", frame))
+			setFrame(frame);
+		else
+			_frame = ::Eigen::MatrixXd::Identity(4, 4);
+		tree->getAttribute<bool>("invert_pose", _invert_pose, false);
+	}
+
+}
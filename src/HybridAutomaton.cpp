@@ -25,21 +25,40 @@
  */
 #include "hybrid_automaton/HybridAutomaton.h"
 
+#include "hybrid_automaton/ConditionBatch.h"
+#include "hybrid_automaton/ConditionView.h"
+#include "hybrid_automaton/CycleClock.h"
 #include "hybrid_automaton/DescriptionTreeNode.h"
 #include "hybrid_automaton/error_handling.h"
+#include "hybrid_automaton/Profiler.h"
+#include "hybrid_automaton/SharedSensor.h"
+#include "hybrid_automaton/TraceRecorder.h"
 
 #include <boost/graph/graphviz.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 namespace ha {
 
 	HybridAutomaton::HybridAutomaton()
-        : _active(false), _deserialize_default_entities(false)
+        : _active(false), _num_deferrals(0), _num_deferred_steps(0), _condition_view(new ConditionView), _condition_batch(new ConditionBatch),
+		_deserialize_default_entities(false), _share_sensors(true), _batch_evaluation(false), _control_cycle(new ControlCycle)
     {
     }
 
+	HybridAutomaton::HybridAutomaton(const HybridAutomaton& ha)
+		: Serializable(ha), _graph(ha._graph), _current_control_mode(ha._current_control_mode), _last_active_control_switch(ha._last_active_control_switch),
+		_switchMap(ha._switchMap), _name(ha._name), _active(ha._active), _trace_recorder(ha._trace_recorder),
+		_switch_schedules(ha._switch_schedules), _num_deferrals(ha._num_deferrals), _num_deferred_steps(ha._num_deferred_steps),
+		_condition_view(new ConditionView(*ha._condition_view)), _condition_batch(new ConditionBatch(*ha._condition_batch)),
+		_deserialize_default_entities(ha._deserialize_default_entities), _share_sensors(ha._share_sensors), _batch_evaluation(ha._batch_evaluation),
+		_shared_sensors(ha._shared_sensors), _control_cycle(ha._control_cycle)
+	{
+	}
+
 	HybridAutomaton::~HybridAutomaton()
 	{
 	}
@@ -176,6 +195,50 @@ namespace ha {
 	}
 
 
+	namespace {
+		// type, attributes and children of a node - length prefixed so that different nodes never collide
+		void appendDescription(const DescriptionTreeNode::ConstPtr& node, std::ostringstream& description)
+		{
+			const std::string type = node->getType();
+			description << type.size() << ":" << type << "{";
+
+			std::map<std::string, std::string> attributes;
+			node->getAllAttributes(attributes);
+			for (std::map<std::string, std::string>::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+				description << it->first.size() << ":" << it->first << "=" << it->second.size() << ":" << it->second << ";";
+
+			DescriptionTreeNode::ConstNodeList children;
+			node->getChildrenNodes(children);
+			for (DescriptionTreeNode::ConstNodeList::const_iterator it = children.begin(); it != children.end(); ++it)
+				appendDescription(*it, description);
+
+			description << "}";
+		}
+	}
+
+	Sensor::Ptr HybridAutomaton::createSharedSensor(const DescriptionTreeNode::ConstPtr& node, const System::ConstPtr& system) const
+	{
+		if (!_share_sensors)
+			return createSensor(node, system, this);
+
+		std::ostringstream description;
+		description << system.get() << ";";
+		appendDescription(node, description);
+
+		std::map<std::string, SharedSensor::Ptr>::const_iterator it = _shared_sensors.find(description.str());
+		if (it != _shared_sensors.end())
+			return it->second;
+
+		SharedSensor::Ptr sensor(new SharedSensor(createSensor(node, system, this), _control_cycle));
+		_shared_sensors.insert(std::make_pair(description.str(), sensor));
+		return sensor;
+	}
+
+	std::size_t HybridAutomaton::getNumberOfSharedSensors() const
+	{
+		return _shared_sensors.size();
+	}
+
     void HybridAutomaton::addControlMode(const ControlMode::Ptr& control_mode)
 	{
         AdjacencyListGraph& g = _graph.graph();
@@ -192,6 +255,13 @@ namespace ha {
         g[sh] = control_switch;
 
 		_switchMap.insert(std::pair<std::string, SwitchHandle>(control_switch->getName(), sh));
+
+		// a switch added to the running mode is evaluated from the next step() on
+		if (_active && _current_control_mode && _current_control_mode->getName() == source_mode) {
+			_scheduleControlSwitch(sh, -std::numeric_limits<double>::infinity());
+			_switch_schedules.back().earliest_activation = -std::numeric_limits<double>::infinity();
+			std::stable_sort(_switch_schedules.begin(), _switch_schedules.end(), &HybridAutomaton::_hasHigherPriority);
+		}
 	}
 
 	void HybridAutomaton::addControlSwitchAndMode(const std::string& source_mode, const ControlSwitch::Ptr& control_switch, const ControlMode::Ptr& target_mode) 
@@ -204,18 +274,77 @@ namespace ha {
 
 	::Eigen::MatrixXd HybridAutomaton::step(const double& t) 
 	{
+		return step(t, 0.0);
+	}
+
+	::Eigen::MatrixXd HybridAutomaton::step(const double& t, const double& budget) 
+	{
+		HA_PROFILE_TICK(_name);
+
 		if (_active)
 		{
-			// check if any out-going jump condition is true
-			::std::pair<OutEdgeIterator, OutEdgeIterator> out_edges = ::boost::out_edges(_graph.vertex(_current_control_mode->getName()), _graph);
-			for(; out_edges.first != out_edges.second; ++out_edges.first) {
-				SwitchHandle switch_handle = *out_edges.first;
+			TraceRecorder::TickScope trace_scope(_trace_recorder.get(), t, _current_control_mode.get());
+			ControlCycle::Scope cycle_scope(*_control_cycle);
+
+			const CycleClock::Ticks budget_ticks = CycleClock::fromSeconds(budget);
+			const CycleClock::Ticks start = (budget_ticks > 0) ? CycleClock::now() : 0;
+			bool deferred = false;
+
+			// All switches are stepped in every control cycle, only their evaluation is skipped below:
+			// stateful sensors (filters, derivatives) need their samples at the rate of the control loop.
+			for (std::vector<SwitchSchedule>::iterator it = _switch_schedules.begin(); it != _switch_schedules.end(); ++it)
+				_graph[it->handle]->step(t);
+
+			// compute the batched conditions of the switches that are due all at once,
+			// the budget decides which switches take part
+			if (_batch_evaluation) {
+				for (std::vector<SwitchSchedule>::iterator it = _switch_schedules.begin(); it != _switch_schedules.end(); ++it) {
+					if (t < it->earliest_activation || t < it->next_evaluation)
+						continue;
+					if (_deferSwitch(*it, start, budget_ticks)) {
+						deferred = true;
+						continue;
+					}
+					_condition_batch->schedule(it->batch_index);
+					it->batched = true;
+				}
+				_condition_batch->evaluate();
+			}
+
+			// check if any out-going jump condition is true - in the order of their priority
+			for (std::size_t index = 0; index < _switch_schedules.size(); ++index) {
+				SwitchSchedule& schedule = _switch_schedules[index];
+
+				// switches that wait for a timeout cannot be active yet
+				if (t < schedule.earliest_activation)
+					continue;
+
+				// slow switches are only evaluated once per period (or later, while far from activation)
+				if (t < schedule.next_evaluation)
+					continue;
+
+				if (_batch_evaluation) {
+					// deferred before the batch was computed
+					if (!schedule.batched)
+						continue;
+					schedule.batched = false;
+				} else if (_deferSwitch(schedule, start, budget_ticks)) {
+					deferred = true;
+					continue;
+				}
+
+				SwitchHandle switch_handle = schedule.handle;
 				ControlSwitch::Ptr control_switch = _graph[switch_handle];
 
-				control_switch->step(t);
+				if (_trace_recorder)
+					_trace_recorder->beginSwitch(control_switch.get());
 
-				if (control_switch->isActive())
+				const bool active = _batch_evaluation ? _condition_batch->isActive(schedule.batch_index) : control_switch->isActive();
+
+				if (active)
 				{
+					HA_PROFILE_SCOPE("HybridAutomaton::transition", control_switch->getName());
+
 					// Copy the pointer to return it if someone asks for it
 					_last_active_control_switch = control_switch;
 
@@ -223,6 +352,9 @@ namespace ha {
 					ModeHandle mode_handle = boost::target(switch_handle, _graph);
 
 					ha::ControlMode::Ptr next_control_mode = _graph.graph()[mode_handle];					
+					if (_trace_recorder)
+						_trace_recorder->recordTransition(control_switch.get(), next_control_mode.get());
+
 					//switchControlMode realizes smooth transitions between control modes
 					next_control_mode->switchControlMode(_current_control_mode);
 					
@@ -231,10 +363,25 @@ namespace ha {
 					_current_control_mode = next_control_mode;
 					
 					_activateCurrentControlMode(t);
+					_markReturningSwitches(boost::source(switch_handle, _graph));
 
 					break;
 				}
+
+				// get the likely next mode ready while there is no transition
+				if (!schedule.prepared && control_switch->isNearlyActive()) {
+					HA_PROFILE_SCOPE("HybridAutomaton::prepare", control_switch->getName());
+					schedule.prepared = true;
+					_prepareControlMode(boost::target(switch_handle, _graph));
+				}
+
+				_scheduleNextEvaluation(schedule, *control_switch, t);
 			}
+
+			if (deferred)
+				_num_deferred_steps++;
+
+			HA_PROFILE_SCOPE("ControlSet::step", _current_control_mode->getName());
 			return _current_control_mode->step(t); 
 		}
 		HA_THROW_ERROR("HybridAutomaton.step", "No current control mode defined.");
@@ -272,6 +419,8 @@ namespace ha {
 
 		tree->getAttribute<std::string>("name", _name);
 
+		_shared_sensors.clear();
+
 		// control modes
 		DescriptionTreeNode::ConstNodeList control_modes;
 		tree->getChildrenNodes("ControlMode", control_modes);
@@ -339,6 +488,18 @@ namespace ha {
 		if (!_current_control_mode) {
 			HA_THROW_ERROR("HybridAutomaton.initialize", "No current control mode defined!");
 		}
+
+		TraceRecorder::TickScope trace_scope(_trace_recorder.get(), t, _current_control_mode.get());
+		ControlCycle::Scope cycle_scope(*_control_cycle);
+		if (_trace_recorder)
+			_trace_recorder->recordInitialize();
+
+		_num_deferrals = 0;
+		_num_deferred_steps = 0;
+
+		// the first call calibrates the clock by busy waiting - do it here rather than in the first budgeted step()
+		CycleClock::ticksPerSecond();
+
 		_activateCurrentControlMode(t);
 		_active = true;
 	}
@@ -388,16 +549,186 @@ namespace ha {
 		return _last_active_control_switch;
 	}
 
+	void HybridAutomaton::setTraceRecorder(const TraceRecorder::Ptr& trace_recorder)
+	{
+		_trace_recorder = trace_recorder;
+		if (_active)
+			_registerTraceChannels();
+	}
+
+	TraceRecorder::Ptr HybridAutomaton::getTraceRecorder() const
+	{
+		return _trace_recorder;
+	}
+
 	void HybridAutomaton::_activateCurrentControlMode(const double& t) 
 	{
+		HA_PROFILE_SCOPE("HybridAutomaton::activate", _current_control_mode->getName());
+
 		HA_INFO("HybridAutomaton._activeCurrentControlMode", "Current mode: "<< _current_control_mode->getName());
 		_current_control_mode->initialize();
 
 		// initialize all outgoing edges
+		_switch_schedules.clear();
+		_condition_view->clear();
+		_condition_batch->clear();
+		int num_slow_switches = 0;
 		::std::pair<OutEdgeIterator, OutEdgeIterator> out_edges = ::boost::out_edges(_graph.vertex(_current_control_mode->getName()), _graph);
 		for(; out_edges.first != out_edges.second; ++out_edges.first) {
 			_graph[*out_edges.first]->initialize(t);
+			_scheduleControlSwitch(*out_edges.first, t);
+
+			if (_switch_schedules.back().period > 0.0)
+				num_slow_switches++;
+		}
+
+		// evaluation order, equal priorities keep the order in which the switches were added
+		std::stable_sort(_switch_schedules.begin(), _switch_schedules.end(), &HybridAutomaton::_hasHigherPriority);
+
+		// spread the evaluations of slow switches evenly across their periods
+		int slot = 0;
+		for (std::vector<SwitchSchedule>::iterator it = _switch_schedules.begin(); it != _switch_schedules.end(); ++it) {
+			if (it->period > 0.0)
+				it->next_evaluation = t + it->period * slot++ / num_slow_switches;
 		}
+
+		_registerTraceChannels();
+	}
+
+	void HybridAutomaton::_registerTraceChannels()
+	{
+		if (!_trace_recorder || !_current_control_mode)
+			return;
+
+		_trace_recorder->registerControlMode(_current_control_mode.get());
+		::std::pair<OutEdgeIterator, OutEdgeIterator> out_edges = ::boost::out_edges(_graph.vertex(_current_control_mode->getName()), _graph);
+		for(; out_edges.first != out_edges.second; ++out_edges.first) {
+			const ModeHandle target = ::boost::target(*out_edges.first, _graph);
+			_trace_recorder->registerControlSwitch(_graph[*out_edges.first].get(), _graph.graph()[target].get());
+		}
+	}
+
+	void HybridAutomaton::_markReturningSwitches(const ModeHandle& previous_mode)
+	{
+		// the way back needs the criteria to cross the hysteresis band, see JumpCondition::setReturning()
+		for (std::vector<SwitchSchedule>::iterator it = _switch_schedules.begin(); it != _switch_schedules.end(); ++it) {
+			if (boost::target(it->handle, _graph) != previous_mode)
+				continue;
+			const std::vector<JumpConditionPtr>& jump_conditions = _graph[it->handle]->getJumpConditions();
+			for (std::vector<JumpConditionPtr>::const_iterator jc = jump_conditions.begin(); jc != jump_conditions.end(); ++jc)
+				(*jc)->setReturning(true);
+		}
+	}
+
+	void HybridAutomaton::prepareControlMode(const std::string& control_mode)
+	{
+		if (!existsControlMode(control_mode)) {
+			HA_THROW_ERROR("HybridAutomaton.prepareControlMode", "Control mode '" << control_mode << "' does not exist!");
+		}
+		_prepareControlMode(_graph.vertex(control_mode));
+	}
+
+	void HybridAutomaton::_prepareControlMode(const ModeHandle& mode_handle)
+	{
+		_graph.graph()[mode_handle]->prepare();
+
+		::std::pair<OutEdgeIterator, OutEdgeIterator> out_edges = ::boost::out_edges(mode_handle, _graph);
+		for(; out_edges.first != out_edges.second; ++out_edges.first) {
+			_graph[*out_edges.first]->prepare();
+		}
+	}
+
+	void HybridAutomaton::_scheduleControlSwitch(const SwitchHandle& switch_handle, const double& t)
+	{
+		ControlSwitch::Ptr control_switch = _graph[switch_handle];
+
+		const std::vector<JumpConditionPtr>& jump_conditions = control_switch->getJumpConditions();
+		for (std::vector<JumpConditionPtr>::const_iterator it = jump_conditions.begin(); it != jump_conditions.end(); ++it)
+			_condition_view->add(control_switch.get(), it->get());
+
+		SwitchSchedule schedule;
+		schedule.handle = switch_handle;
+		schedule.priority = control_switch->getPriority();
+		schedule.safety_critical = control_switch->isSafetyCritical();
+		schedule.earliest_activation = std::max(control_switch->getEarliestActivationTime(), t + control_switch->getMinDwellTime());
+		schedule.period = control_switch->getEvaluationPeriod();
+		schedule.max_period = control_switch->getMaxEvaluationPeriod();
+		schedule.next_evaluation = t;
+		schedule.deferred = false;
+		schedule.prepared = false;
+		schedule.batched = false;
+		schedule.batch_index = _condition_batch->add(control_switch.get());
+		_switch_schedules.push_back(schedule);
+	}
+
+	void HybridAutomaton::_scheduleNextEvaluation(SwitchSchedule& schedule, const ControlSwitch& control_switch, const double& t)
+	{
+		double next_evaluation = t;
+		if (schedule.period > 0.0) {
+			next_evaluation = schedule.next_evaluation + schedule.period;
+			if (next_evaluation <= t)
+				next_evaluation = t + schedule.period;
+		}
+
+		// switches that are evaluated in every step gain nothing from a prediction
+		if (schedule.period <= 0.0 && schedule.max_period <= 0.0) {
+			schedule.next_evaluation = next_evaluation;
+			return;
+		}
+
+		const double predicted = control_switch.getPredictedActivationTime();
+		const double any_time = -std::numeric_limits<double>::infinity();
+
+		// far from activation: wait up to half the predicted time, but at most the maximum period
+		if (!schedule.safety_critical && schedule.max_period > schedule.period && predicted != any_time) {
+			const double stretch = std::min(schedule.max_period, 0.5 * (predicted - t));
+			if (stretch > schedule.period)
+				next_evaluation = std::max(next_evaluation, t + stretch);
+		}
+
+		// about to fire: do not wait for the end of the period, nor to prepare the target mode
+		if (predicted != any_time) {
+			double wake_up = predicted;
+			if (!schedule.prepared)
+				wake_up -= control_switch.getPrewarmTime();
+			if (wake_up < next_evaluation)
+				next_evaluation = std::max(wake_up, t);
+		}
+
+		schedule.next_evaluation = next_evaluation;
+	}
+
+	bool HybridAutomaton::_deferSwitch(SwitchSchedule& schedule, unsigned long long start, unsigned long long budget_ticks)
+	{
+		// once the budget is spent, defer everything that is neither safety critical nor deferred already
+		if (budget_ticks > 0 && !schedule.safety_critical && !schedule.deferred
+			&& CycleClock::now() - start > budget_ticks) {
+			schedule.deferred = true;
+			_num_deferrals++;
+			return true;
+		}
+		schedule.deferred = false;
+		return false;
+	}
+
+	bool HybridAutomaton::_hasHigherPriority(const SwitchSchedule& a, const SwitchSchedule& b)
+	{
+		return a.priority > b.priority;
+	}
+
+	const ConditionView& HybridAutomaton::getConditionView() const
+	{
+		return *_condition_view;
+	}
+
+	unsigned long long HybridAutomaton::getNumberOfDeferrals() const
+	{
+		return _num_deferrals;
+	}
+
+	unsigned long long HybridAutomaton::getNumberOfDeferredSteps() const
+	{
+		return _num_deferred_steps;
 	}
 
 	bool HybridAutomaton::existsControlMode(const std::string& control_mode) const 
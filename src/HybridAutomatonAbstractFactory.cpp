@@ -347,10 +347,12 @@ ha::ControlSwitch::Ptr HybridAutomatonAbstractFactory::CreateMaxForceTorqueContr
                                                                                  const Eigen::MatrixXd& ft_max_val,
                                                                                  const ha::JumpCondition::JumpCriterion ft_criterion,
                                                                                  const bool negate_ft_condition,
-                                                                                 const float epsilon)
+                                                                                 const float epsilon,
+                                                                                 const double ft_hysteresis,
+                                                                                 const double min_dwell_time)
 {
     ha::ControlSwitch::Ptr max_ft_cs(new ha::ControlSwitch());
-    CreateMaxForceTorqueControlSwitch(p, max_ft_cs, name, ft_weights, ft_max_val, ft_criterion, negate_ft_condition,epsilon);
+    CreateMaxForceTorqueControlSwitch(p, max_ft_cs, name, ft_weights, ft_max_val, ft_criterion, negate_ft_condition,epsilon, ft_hysteresis, min_dwell_time);
     return max_ft_cs;
 }
 
@@ -361,9 +363,13 @@ void HybridAutomatonAbstractFactory::CreateMaxForceTorqueControlSwitch(const Hyb
                                                                const Eigen::MatrixXd& ft_max_val,
                                                                const ha::JumpCondition::JumpCriterion ft_criterion,
                                                                const bool negate_ft_condition,
-                                                               const float epsilon)
+                                                               const float epsilon,
+                                                               const double ft_hysteresis,
+                                                               const double min_dwell_time)
 {
     cs_ptr->setName(name + std::string("_max_ft_cs"));
+    cs_ptr->setSafetyCritical(true);
+    cs_ptr->setMinDwellTime(min_dwell_time);
     ha::JumpConditionPtr max_ft_jc(new ha::JumpCondition());
     ha::ForceTorqueSensorPtr ft_sensor(new ha::ForceTorqueSensor());
     max_ft_jc->setSensor(ft_sensor);
@@ -372,6 +378,7 @@ void HybridAutomatonAbstractFactory::CreateMaxForceTorqueControlSwitch(const Hyb
     max_ft_jc->setJumpCriterion(ft_criterion ,ft_weights);
     max_ft_jc->setEpsilon(epsilon);
     max_ft_jc->setNegate(negate_ft_condition);
+    max_ft_jc->setHysteresis(ft_hysteresis);
     cs_ptr->add(max_ft_jc);
 }
 
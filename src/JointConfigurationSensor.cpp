@@ -48,6 +48,21 @@ namespace ha
 		return this->_system->getJointConfiguration();
 	}
 
+	void JointConfigurationSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readJointConfiguration(value);
+	}
+
+	void JointConfigurationSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void JointConfigurationSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
 	DescriptionTreeNode::Ptr JointConfigurationSensor::serialize(const DescriptionTree::ConstPtr& factory) const
 	{
 		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
@@ -48,6 +48,21 @@ namespace ha
 		return this->_system->getJointVelocity();
 	}
 
+	void JointVelocitySensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readJointVelocity(value);
+	}
+
+	void JointVelocitySensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void JointVelocitySensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
 	DescriptionTreeNode::Ptr JointVelocitySensor::serialize(const DescriptionTree::ConstPtr& factory) const
 	{
 		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
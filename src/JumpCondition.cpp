@@ -25,6 +25,11 @@
  */
 #include "hybrid_automaton/JumpCondition.h"
 #include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/Profiler.h"
+#include "hybrid_automaton/TraceRecorder.h"
+
+#include <algorithm>
+#include <limits>
 
 namespace ha {
 
@@ -33,7 +38,23 @@ namespace ha {
 		_jump_criterion(NORM_L1),
 		_epsilon(0.0),
         _is_goal_relative(false),
-        _negate(false)
+        _negate(false),
+		_hysteresis(0.0),
+		_is_returning(false),
+		_has_cached_result(false),
+		_cached_result(false),
+		_is_unknown(false),
+		_step_time(0.0),
+		_has_criterion(false),
+		_criterion(0.0),
+		_margin(0.0),
+		_criterion_time(0.0),
+		_convergence_model(LINEAR),
+		_history_size(0),
+		_history_next(0),
+		_has_goal_value(false),
+		_goal_version(0),
+		_is_prepared(false)
 	{
 
 	}
@@ -49,17 +70,57 @@ namespace ha {
 		this->_goal = jc._goal;
 		this->_controller = jc._controller;
 		this->_sensor = jc._sensor;
+		this->_path = jc._path;
+		this->_profile_name = jc._profile_name;
 		this->_jump_criterion = jc._jump_criterion;
 		this->_norm_weights = jc._norm_weights;
 		this->_epsilon = jc._epsilon;
 		this->_ros_topic_goal_name = jc._ros_topic_goal_name;
 		this->_ros_topic_goal_type = jc._ros_topic_goal_type;
         this->_negate=jc._negate;
+		this->_hysteresis = jc._hysteresis;
+		this->_is_returning = false;
+		this->_has_cached_result = false;
+		this->_cached_result = false;
+		this->_is_unknown = false;
+		this->_step_time = jc._step_time;
+		this->_has_criterion = false;
+		this->_criterion = 0.0;
+		this->_margin = 0.0;
+		this->_criterion_time = 0.0;
+		this->_convergence_model = jc._convergence_model;
+		this->_history_size = 0;
+		this->_history_next = 0;
+		this->_has_goal_value = false;
+		this->_goal_version = 0;
+		this->_is_prepared = false;
 	}
 
 	void JumpCondition::initialize(const double& t) 
 	{
+		this->_is_returning = false;
+		this->_has_cached_result = false;
+		this->_has_criterion = false;
+		this->_is_unknown = false;
+		this->_has_goal_value = false;
+		this->_history_size = 0;
+		this->_history_next = 0;
+		this->_step_time = t;
 		this->_sensor->initialize(t); 
+		if (!this->_is_prepared)
+			this->_subscribeToGoal();
+		this->_is_prepared = false;
+	}
+
+	void JumpCondition::prepare() 
+	{
+		this->_sensor->prepare();
+		this->_subscribeToGoal();
+		this->_is_prepared = true;
+	}
+
+	void JumpCondition::_subscribeToGoal() 
+	{
 		if (this->_goalSource == ROSTOPIC) {
 			_system->subscribeToROSMessage(_ros_topic_goal_name);
 		}
@@ -75,18 +136,40 @@ namespace ha {
 
 	void JumpCondition::step(const double& t) 
 	{
+		HA_PROFILE_SCOPE("JumpCondition::step", this->_profile_name);
+
+		this->_step_time = t;
 		this->_sensor->step(t);
 	}
 
 	bool JumpCondition::isActive() const 
 	{
+		HA_PROFILE_SCOPE("JumpCondition::isActive", this->_profile_name);
+
+		// no (fresh) sensor value: neither true nor false, forget the last result
 		if (!this->_sensor->isActive()) {
+			this->_is_unknown = true;
+			this->_has_cached_result = false;
 			return false;
 		}
+		this->_is_unknown = false;
 
-		::Eigen::MatrixXd current = this->_sensor->getCurrentValue();
-		::Eigen::MatrixXd initial = this->_sensor->getInitialValue();
-		::Eigen::MatrixXd desired = this->getGoal();
+		// event driven sensor without a new value - the result cannot have changed
+		if (this->_has_cached_result && !this->_sensor->hasNewValue() && this->_isGoalUnchanged()) {
+			this->_criterion_time = this->_step_time;
+			return this->_cached_result;
+		}
+
+		// the values are read into buffers of this condition that keep their size between control cycles
+		::Eigen::MatrixXd& current = this->_current_value;
+		{
+			HA_PROFILE_SCOPE("Sensor::getCurrentValue", this->_profile_name);
+			this->_sensor->readCurrentValue(current);
+		}
+		::Eigen::MatrixXd& initial = this->_initial_value;
+		this->_sensor->readInitialValue(initial);
+
+		const ::Eigen::MatrixXd& desired = this->_resolveGoal();
 
 		if(desired.cols()== 0 && desired.rows() ==0)
 		{
@@ -112,37 +195,238 @@ namespace ha {
 			<<current.rows()<<"x"<<current.cols()<<", current: "<<initial.rows()<<"x"<<initial.cols()<<"!");
 		}
 		 
+		// the absolute value has been read above already
 		if(this->_is_goal_relative)
 		{
-            if (!_negate){
-                return (this->_computeJumpCriterion(this->_sensor->getRelativeCurrentValue(), desired) <= _epsilon);
-            } else {
-                return (this->_computeJumpCriterion(this->_sensor->getRelativeCurrentValue(), desired) > _epsilon);
-            }
-		}else{
-            if (!_negate){
-                return (this->_computeJumpCriterion( this->_sensor->getCurrentValue(), desired) <= _epsilon);
-            } else {
-                return (this->_computeJumpCriterion( this->_sensor->getCurrentValue(), desired) > _epsilon);
-            }
+			HA_PROFILE_SCOPE("Sensor::getCurrentValue", this->_profile_name);
+			this->_sensor->readRelativeCurrentValue(this->_relative_value);
+		}
+		const ::Eigen::MatrixXd& value = this->_is_goal_relative ? this->_relative_value : current;
 
+		return this->_acceptCriterion(value, this->_computeJumpCriterion(value, desired));
+	}
+
+	const ::Eigen::MatrixXd& JumpCondition::_resolveGoal() const
+	{
+		switch (this->_goalSource) {
+			case CONSTANT:
+				return this->_goal;
+
+			case CONTROLLER: {
+				// an unversioned goal may change at any time
+				const unsigned long version = this->_controller->getGoalVersion();
+				if (version == Controller::UNVERSIONED_GOAL || !this->_has_goal_value || version != this->_goal_version) {
+					this->_goal_value = this->_controller->getGoal();
+					this->_goal_version = version;
+					this->_has_goal_value = true;
+				}
+				return this->_goal_value;
+			}
+
+			default:
+				this->_goal_value = this->getGoal();
+				return this->_goal_value;
 		}
 	}
 
-	double JumpCondition::_computeJumpCriterion(const ::Eigen::MatrixXd& x, const ::Eigen::MatrixXd& y) const
+	bool JumpCondition::_isGoalUnchanged() const
 	{
-		//First check if weights are given - otherwise use default weights (=1.0)
-		::Eigen::MatrixXd weights;
-		if(_norm_weights.rows() == 0)
-		{
-			weights.resize(x.rows(), x.cols());
-			weights.setConstant(1.0);
+		if (this->_goalSource == CONSTANT)
+			return true;
+		if (this->_goalSource == CONTROLLER) {
+			const unsigned long version = this->_controller->getGoalVersion();
+			return version != Controller::UNVERSIONED_GOAL && this->_has_goal_value && version == this->_goal_version;
 		}
-		else
-		{
-			weights = _norm_weights;
+		return false;
+	}
+
+	bool JumpCondition::_acceptCriterion(const ::Eigen::MatrixXd& value, double criterion) const
+	{
+		this->_criterion = criterion;
+		this->_margin = this->_negate ? criterion - this->_epsilon : this->_epsilon - criterion;
+		this->_criterion_time = this->_step_time;
+		this->_has_criterion = true;
+
+		// one criterion per control cycle for getPredictedActivationTime()
+		const int last = (this->_history_next + HISTORY_SIZE - 1) % HISTORY_SIZE;
+		if (this->_history_size > 0 && this->_history_times[last] == this->_step_time) {
+			this->_history_criteria[last] = criterion;
+		} else {
+			this->_history_criteria[this->_history_next] = criterion;
+			this->_history_times[this->_history_next] = this->_step_time;
+			this->_history_next = (this->_history_next + 1) % HISTORY_SIZE;
+			if (this->_history_size < HISTORY_SIZE)
+				this->_history_size++;
 		}
-		
+
+		TraceRecorder* trace_recorder = TraceRecorder::current();
+		if (trace_recorder) {
+			trace_recorder->recordSensorValue(this, this->_sensor.get(), value);
+			trace_recorder->recordCriterion(this, criterion);
+		}
+
+		// once active, the condition only becomes inactive again beyond the hysteresis band - and a
+		// switch back to the mode that was just left only becomes active beyond it on the other side
+		const bool was_active = this->_has_cached_result && this->_cached_result;
+		double threshold = _epsilon;
+		if (was_active)
+			threshold = _negate ? _epsilon - _hysteresis : _epsilon + _hysteresis;
+		else if (_is_returning)
+			threshold = _negate ? _epsilon + _hysteresis : _epsilon - _hysteresis;
+		if (!_negate){
+			this->_cached_result = (criterion <= threshold);
+		} else {
+			this->_cached_result = (criterion > threshold);
+		}
+		this->_has_cached_result = true;
+		return this->_cached_result;
+	}
+
+	bool JumpCondition::isUnknown() const
+	{
+		return this->_is_unknown;
+	}
+
+	double JumpCondition::getEarliestActivationTime() const
+	{
+		const double any_time = -std::numeric_limits<double>::infinity();
+
+		if (!this->_sensor || !this->_sensor->isClock() || this->_goalSource != CONSTANT || this->_goal.size() != 1)
+			return any_time;
+
+		double weight = 1.0;
+		if (this->_norm_weights.size() == 1)
+			weight = this->_norm_weights(0,0);
+		else if (this->_norm_weights.size() != 0)
+			return any_time;
+
+		if (weight <= 0.0)
+			return any_time;
+		if (this->_jump_criterion == NORM_L2)
+			weight = sqrt(weight);
+
+		// the clock only moves forward: conditions that need it to reach a threshold are inactive until then
+		double threshold;
+		switch (this->_jump_criterion) {
+			case NORM_L1:
+			case NORM_L2:
+			case NORM_L_INF:
+			case THRESH_UPPER_BOUND:
+				if (this->_negate)
+					return any_time;
+				// norms are never negative, the signed thresholds can be
+				if (this->_epsilon < 0.0 && this->_jump_criterion != THRESH_UPPER_BOUND)
+					return std::numeric_limits<double>::infinity();
+				threshold = this->_goal(0,0) - this->_epsilon / weight;
+				break;
+			case THRESH_LOWER_BOUND:
+				if (!this->_negate)
+					return any_time;
+				threshold = this->_goal(0,0) + this->_epsilon / weight;
+				break;
+			default:
+				return any_time;
+		}
+
+		if (this->_is_goal_relative) {
+			const ::Eigen::MatrixXd initial = this->_sensor->getInitialValue();
+			if (initial.size() != 1)
+				return any_time;
+			threshold += initial(0,0);
+		}
+
+		// stay below the threshold that isActive() computes with different rounding
+		return threshold - 1e-9 * (1.0 + fabs(threshold));
+	}
+
+	double JumpCondition::getDistanceToActivation() const
+	{
+		if (!this->_has_criterion)
+			return std::numeric_limits<double>::infinity();
+		return std::max(-this->_margin, 0.0);
+	}
+
+	bool JumpCondition::hasCriterion() const
+	{
+		return this->_has_criterion;
+	}
+
+	double JumpCondition::getCriterion() const
+	{
+		return this->_criterion;
+	}
+
+	double JumpCondition::getMargin() const
+	{
+		return this->_margin;
+	}
+
+	double JumpCondition::getCriterionTime() const
+	{
+		return this->_criterion_time;
+	}
+
+	void JumpCondition::setConvergenceModel(ConvergenceModel convergence_model)
+	{
+		_convergence_model = convergence_model;
+	}
+
+	JumpCondition::ConvergenceModel JumpCondition::getConvergenceModel() const
+	{
+		return _convergence_model;
+	}
+
+	double JumpCondition::getPredictedActivationTime() const
+	{
+		if (this->_has_criterion && this->_has_cached_result && this->_cached_result)
+			return this->_criterion_time;
+		if (this->_history_size < 2)
+			return -std::numeric_limits<double>::infinity();
+
+		const int newest = (this->_history_next + HISTORY_SIZE - 1) % HISTORY_SIZE;
+		const double newest_time = this->_history_times[newest];
+		const double newest_criterion = this->_history_criteria[newest];
+
+		// an exponential decay towards the goal is a line in the log of the criterion
+		bool exponential = (this->_convergence_model == EXPONENTIAL && !this->_negate && this->_epsilon > 0.0);
+		for (int i = 0; i < this->_history_size && exponential; ++i) {
+			if (this->_history_criteria[i] <= 0.0)
+				exponential = false;
+		}
+
+		// least squares slope, times relative to the newest criterion
+		double sum_t = 0.0, sum_y = 0.0, sum_tt = 0.0, sum_ty = 0.0;
+		for (int i = 0; i < this->_history_size; ++i) {
+			const double t = this->_history_times[i] - newest_time;
+			const double criterion = this->_history_criteria[i];
+			const double y = exponential ? log(criterion) : (this->_negate ? criterion - this->_epsilon : this->_epsilon - criterion);
+			sum_t += t;
+			sum_y += y;
+			sum_tt += t * t;
+			sum_ty += t * y;
+		}
+		const double n = (double)this->_history_size;
+		const double denominator = n * sum_tt - sum_t * sum_t;
+		if (denominator <= 0.0)
+			return -std::numeric_limits<double>::infinity();
+		const double slope = (n * sum_ty - sum_t * sum_y) / denominator;
+
+		if (exponential) {
+			if (slope >= 0.0)
+				return std::numeric_limits<double>::infinity();
+			return newest_time + std::max(log(this->_epsilon / newest_criterion) / slope, 0.0);
+		}
+
+		// the margin has to grow to 0
+		if (slope <= 0.0)
+			return std::numeric_limits<double>::infinity();
+		const double margin = this->_negate ? newest_criterion - this->_epsilon : this->_epsilon - newest_criterion;
+		return newest_time + std::max(-margin / slope, 0.0);
+	}
+
+	double JumpCondition::_computeJumpCriterion(const ::Eigen::MatrixXd& x, const ::Eigen::MatrixXd& y) const
+	{
+		// weights are looked up by _getWeight() - default weights are 1.0
 		double ret = 0;
 		switch(_jump_criterion) {
 			case NORM_L1: 
@@ -150,7 +434,7 @@ namespace ha {
 				{
 					for(int j = 0; j<y.cols(); j++)
 					{ 
-						ret += weights(i,j) * fabs(x(i,j) - y(i,j));
+						ret += _getWeight(i,j) * fabs(x(i,j) - y(i,j));
 					}
 				}
 				break;
@@ -160,7 +444,7 @@ namespace ha {
 				{
 					for(int j = 0; j<y.cols(); j++)
 					{
-						ret += weights(i,j) * pow(fabs(x(i,j) - y(i,j)),2);
+						ret += _getWeight(i,j) * pow(fabs(x(i,j) - y(i,j)),2);
 					}
 				}
 				ret = sqrt(ret);
@@ -171,7 +455,7 @@ namespace ha {
 				{
 					for(int j = 0; j<y.cols(); j++)
 					{
-						ret = std::max(ret, weights(i,j) * fabs(x(i,j) - y(i,j)));
+						ret = std::max(ret, _getWeight(i,j) * fabs(x(i,j) - y(i,j)));
 					}
 				}
 				break;
@@ -184,7 +468,9 @@ namespace ha {
 					}
 
 					//Compute relative Rotation from x0 to xf
-					Eigen::Matrix3d xRot = x.inverse()*y;
+					const Eigen::Matrix3d x0 = x;
+					const Eigen::Matrix3d xf = y;
+					Eigen::Matrix3d xRot = x0.inverse()*xf;
 
 					//Conver to angle axis to get angle
 					Eigen::AngleAxisd xRotAA;
@@ -204,7 +490,9 @@ namespace ha {
 					}
 
 					//Compute relative Rotation from x0 to xf
-					Eigen::Matrix3d xRot = x.block(0,0,3,3).inverse()*y.block(0,0,3,3);
+					const Eigen::Matrix3d x0 = x.block<3,3>(0,0);
+					const Eigen::Matrix3d xf = y.block<3,3>(0,0);
+					Eigen::Matrix3d xRot = x0.inverse()*xf;
 
 					//Conver to angle axis to get angle
 					Eigen::AngleAxisd xRotAA;
@@ -216,17 +504,19 @@ namespace ha {
 
 					
 					
-					Eigen::Vector3d xDisp = x.block(0,3,3,1)-y.block(0,3,3,1);
+					Eigen::Vector3d xDisp = x.block<3,1>(0,3)-y.block<3,1>(0,3);
 					double disp_diff = xDisp.norm();
 
-					if(_norm_weights.cols() !=1 || _norm_weights.rows() !=2)
+					double rotation_weight = 0.1;
+					double translation_weight = 1.;
+					if(_norm_weights.cols() ==1 && _norm_weights.rows() ==2)
 					{
-						//HA_THROW_ERROR("JumpCondition._computeJumpCriterion", "We need 2 weights for the estimation of the norm between 2 HTransforms, " <<
-						//	"one for rotation and one for translation. weights dim = " <<weights.cols()<<" " << weights.rows());
-						weights = Eigen::MatrixXd(2,1);
-						weights << 0.1, 1.;
+						rotation_weight = _norm_weights(0,0);
+						translation_weight = _norm_weights(1,0);
 					}
-					ret = weights(0,0) * angle_diff + weights(1,0) * disp_diff;
+					//else HA_THROW_ERROR("JumpCondition._computeJumpCriterion", "We need 2 weights for the estimation of the norm between 2 HTransforms, " <<
+					//	"one for rotation and one for translation. weights dim = " <<weights.cols()<<" " << weights.rows());
+					ret = rotation_weight * angle_diff + translation_weight * disp_diff;
 
 					if(rate_print++%500 == 0)
 					{
@@ -237,25 +527,28 @@ namespace ha {
 				}
 				break;
 
+			// the thresholds are signed distances: negative once all entries passed the goal, so that
+			// a returning condition (see setReturning()) can cross a hysteresis band below epsilon = 0
 			case THRESH_UPPER_BOUND:
-				
+				ret = -std::numeric_limits<double>::infinity();
 				for(int i = 0; i<x.rows(); i++)
 				{
 					for(int j = 0; j<y.cols(); j++)
 					{
 						//std::cout << "upper bound" << weights(i,j)*(y(i,j) - x(i,j)) << std::endl;
-						ret = std::max(ret, weights(i,j)*(y(i,j) - x(i,j)));
+						ret = std::max(ret, _getWeight(i,j)*(y(i,j) - x(i,j)));
 					}
 				}
 				break;
 
 			case THRESH_LOWER_BOUND:
+				ret = -std::numeric_limits<double>::infinity();
 				for(int i = 0; i<x.rows(); i++)
 				{
 					for(int j = 0; j<y.cols(); j++)
 					{
 						//std::cout << weights(i,j)*(x(i,j) - y(i,j)) << std::endl;
-						ret = std::max(ret, weights(i,j)*(x(i,j) - y(i,j)));
+						ret = std::max(ret, _getWeight(i,j)*(x(i,j) - y(i,j)));
 					}
 				}
 				break;
@@ -266,16 +559,27 @@ namespace ha {
 		return ret;
 	}
 
+	double JumpCondition::_getWeight(int i, int j) const
+	{
+		// without weights all entries count the same
+		if(_norm_weights.rows() == 0)
+			return 1.0;
+		return _norm_weights(i,j);
+	}
+
 	void JumpCondition::setControllerGoal(const Controller::ConstPtr& controller)
 	{
 		_goalSource = CONTROLLER;
 		_controller = controller;
+		_has_cached_result = false;
+		_has_goal_value = false;
 	}
 
 	void JumpCondition::setConstantGoal(const ::Eigen::MatrixXd goal)
 	{
 		_goalSource = CONSTANT;
 		_goal = goal;
+		_has_cached_result = false;
 	}
 
 	void JumpCondition::setConstantGoal(double goal)
@@ -283,6 +587,7 @@ namespace ha {
 		_goalSource = CONSTANT;
 		_goal.resize(1,1);
 		_goal<<goal;
+		_has_cached_result = false;
 	}
 
 	void JumpCondition::setROSTopicGoal(const std::string& topic, const std::string& topic_type) {
@@ -338,6 +643,8 @@ namespace ha {
 	void JumpCondition::setSensor(const Sensor::Ptr sensor) 
 	{
 		_sensor = sensor;
+		_has_cached_result = false;
+		this->_updateProfileName();
 	}
 
 	Sensor::ConstPtr JumpCondition::getSensor() const 
@@ -351,6 +658,7 @@ namespace ha {
 //			HA_WARN("JumpCondition::setJumpCriterion", "No value given for weights. Using default weights of 1.");
 		_jump_criterion = jump_criterion;
 		_norm_weights = weights;
+		_has_cached_result = false;
 	}
 	
 	JumpCondition::JumpCriterion JumpCondition::getJumpCriterion() const
@@ -366,6 +674,7 @@ namespace ha {
 	void JumpCondition::setEpsilon(double epsilon)
 	{
 		_epsilon = epsilon;
+		_has_cached_result = false;
 	}
 
 	double JumpCondition::getEpsilon() const
@@ -378,6 +687,25 @@ namespace ha {
 		_sourceModeName = sourceModeName;
 	}
 
+	void JumpCondition::setPath(const std::string& path)
+	{
+		_path = path;
+		this->_updateProfileName();
+	}
+
+	const std::string& JumpCondition::getPath() const
+	{
+		return _path;
+	}
+
+	void JumpCondition::_updateProfileName()
+	{
+		// built once, so that the profiler scopes do not copy the sensor type in every control cycle
+		_profile_name = _path;
+		if (_sensor)
+			_profile_name += (_path.empty() ? "" : " ") + _sensor->getType();
+	}
+
 	DescriptionTreeNode::Ptr JumpCondition::serialize(const DescriptionTree::ConstPtr& factory) const 
 	{ 
 		DescriptionTreeNode::Ptr tree = factory->createNode("JumpCondition");
@@ -421,6 +749,12 @@ namespace ha {
 
         tree->setAttribute<bool>(std::string("negate"), this->_negate);
 
+		if (this->_hysteresis > 0.0)
+			tree->setAttribute<double>(std::string("hysteresis"), this->_hysteresis);
+
+		if (this->_convergence_model == EXPONENTIAL)
+			tree->setAttribute<std::string>(std::string("convergence"), std::string("exponential"));
+
 		tree->addChildNode(this->_sensor->serialize(factory));
 
 		return tree;
@@ -447,7 +781,11 @@ namespace ha {
 		}
 
 		DescriptionTreeNode::ConstPtr first = * (sensorList.begin());
-		this->_sensor = HybridAutomaton::createSensor(first, system, ha);
+		if (ha)
+			this->_sensor = ha->createSharedSensor(first, system);
+		else
+			this->_sensor = HybridAutomaton::createSensor(first, system, ha);
+		this->_updateProfileName();
 
 		this->_system = system;
 
@@ -561,6 +899,19 @@ namespace ha {
         if(!tree->getAttribute<bool>("negate", _negate))
             HA_WARN("JumpCondition.deserialize", "No \"negate\" parameter given in JumpCondition - using default values");
 
+		double hysteresis;
+		tree->getAttribute<double>("hysteresis", hysteresis, 0.0);
+		this->setHysteresis(hysteresis);
+
+		std::string convergence;
+		tree->getAttribute<std::string>("convergence", convergence, "linear");
+		if (convergence == "linear")
+			this->setConvergenceModel(LINEAR);
+		else if (convergence == "exponential")
+			this->setConvergenceModel(EXPONENTIAL);
+		else
+			HA_THROW_ERROR("JumpCondition.deserialize", "Unknown convergence '" << convergence << "' - use 'linear' or 'exponential'");
+
 	}
 
     std::string JumpCondition::toString(bool ) {
@@ -644,11 +995,13 @@ namespace ha {
 	void JumpCondition::setGoalRelative()
 	{
 		this->_is_goal_relative = true;
+		_has_cached_result = false;
 	}
 
 	void JumpCondition::setGoalAbsolute()
 	{
 		this->_is_goal_relative = false;
+		_has_cached_result = false;
 	}
 
 	bool JumpCondition::isGoalRelative() const
@@ -658,10 +1011,35 @@ namespace ha {
 
     void JumpCondition::setNegate(bool negate){
         this->_negate=negate;
+        this->_has_cached_result = false;
     }
 
     bool JumpCondition::isNegate() const
     {
         return this->_negate;
     }
+
+	void JumpCondition::setHysteresis(double hysteresis)
+	{
+		if (hysteresis < 0.0)
+			HA_THROW_ERROR("JumpCondition.setHysteresis", "Hysteresis must not be negative: " << hysteresis);
+		this->_hysteresis = hysteresis;
+		this->_has_cached_result = false;
+	}
+
+	double JumpCondition::getHysteresis() const
+	{
+		return this->_hysteresis;
+	}
+
+	void JumpCondition::setReturning(bool returning)
+	{
+		this->_is_returning = returning;
+		this->_has_cached_result = false;
+	}
+
+	bool JumpCondition::isReturning() const
+	{
+		return this->_is_returning;
+	}
 }
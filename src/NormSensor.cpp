@@ -0,0 +1,113 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/NormSensor.h"
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("NormSensor", NormSensor);
+
+	NormSensor::NormSensor()
+		: _norm(L2)
+	{
+	}
+
+	NormSensor::~NormSensor()
+	{
+	}
+
+	NormSensor::NormSensor(const NormSensor& ss)
+		: DerivedSensor(ss), _norm(ss._norm)
+	{
+	}
+
+	void NormSensor::setNorm(Norm norm)
+	{
+		_norm = norm;
+	}
+
+	NormSensor::Norm NormSensor::getNorm() const
+	{
+		return _norm;
+	}
+
+	void NormSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		const ::Eigen::MatrixXd& x = _readOperand(0);
+
+		value.resize(1, 1);
+		switch (_norm) {
+			case L1:
+				value(0,0) = x.cwiseAbs().sum();
+				break;
+			case L2:
+				value(0,0) = x.norm();
+				break;
+			case L_INF:
+				value(0,0) = (x.size() == 0) ? 0.0 : x.cwiseAbs().maxCoeff();
+				break;
+		}
+	}
+
+	std::size_t NormSensor::_getMinOperands() const
+	{
+		return 1;
+	}
+
+	std::size_t NormSensor::_getMaxOperands() const
+	{
+		return 1;
+	}
+
+	void NormSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+		switch (_norm) {
+			case L1:
+				tree->setAttribute<std::string>(std::string("norm"), "L1");
+				break;
+			case L2:
+				tree->setAttribute<std::string>(std::string("norm"), "L2");
+				break;
+			case L_INF:
+				tree->setAttribute<std::string>(std::string("norm"), "L_INF");
+				break;
+		}
+	}
+
+	void NormSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		std::string norm;
+		tree->getAttribute<std::string>("norm", norm, "L2");
+		if (norm == "L1")
+			_norm = L1;
+		else if (norm == "L2")
+			_norm = L2;
+		else if (norm == "L_INF")
+			_norm = L_INF;
+		else
+			HA_THROW_ERROR("NormSensor.deserialize", "Unknown norm '" << norm << "' - use L1, L2 or L_INF!");
+	}
+
+}
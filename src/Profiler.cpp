@@ -0,0 +1,473 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/Profiler.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ha {
+
+	namespace {
+
+		// index of the most significant bit, value must be > 0
+		int highestBit(unsigned long long value)
+		{
+#if defined(__GNUC__)
+			return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			unsigned long index;
+			_BitScanReverse64(&index, value);
+			return (int)index;
+#else
+			int index = 0;
+			while (value >>= 1)
+				++index;
+			return index;
+#endif
+		}
+
+	}
+
+	LatencyHistogram::LatencyHistogram()
+	{
+		reset();
+	}
+
+	void LatencyHistogram::reset()
+	{
+		for (int i = 0; i < NUM_BUCKETS; ++i)
+			_buckets[i].store(0, boost::memory_order_relaxed);
+		_count.store(0, boost::memory_order_relaxed);
+		_total.store(0, boost::memory_order_relaxed);
+		_min.store(~0ULL, boost::memory_order_relaxed);
+		_max.store(0, boost::memory_order_relaxed);
+	}
+
+	int LatencyHistogram::bucketIndex(Ticks value)
+	{
+		if (value < (Ticks)SUB_BUCKETS)
+			return (int)value;
+
+		const int magnitude = highestBit(value);
+		const int shift = magnitude - SUB_BUCKET_BITS;
+		const int sub_bucket = (int)(value >> shift) - SUB_BUCKETS;
+		return (shift + 1) * SUB_BUCKETS + sub_bucket;
+	}
+
+	LatencyHistogram::Ticks LatencyHistogram::bucketUpperBound(int index)
+	{
+		if (index < SUB_BUCKETS)
+			return (Ticks)index;
+
+		const int shift = index / SUB_BUCKETS - 1;
+		const Ticks lower = ((Ticks)(SUB_BUCKETS + index % SUB_BUCKETS)) << shift;
+		return lower + ((1ULL << shift) - 1);
+	}
+
+	void LatencyHistogram::record(Ticks value)
+	{
+		// single writer: plain load/store is enough and avoids locked instructions
+		boost::atomic<unsigned long long>& bucket = _buckets[bucketIndex(value)];
+		bucket.store(bucket.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+		_total.store(_total.load(boost::memory_order_relaxed) + value, boost::memory_order_relaxed);
+		if (value < _min.load(boost::memory_order_relaxed))
+			_min.store(value, boost::memory_order_relaxed);
+		if (value > _max.load(boost::memory_order_relaxed))
+			_max.store(value, boost::memory_order_relaxed);
+		_count.store(_count.load(boost::memory_order_relaxed) + 1, boost::memory_order_release);
+	}
+
+	unsigned long long LatencyHistogram::getCount() const
+	{
+		return _count.load(boost::memory_order_acquire);
+	}
+
+	LatencyHistogram::Ticks LatencyHistogram::getTotal() const
+	{
+		return _total.load(boost::memory_order_relaxed);
+	}
+
+	LatencyHistogram::Ticks LatencyHistogram::getMin() const
+	{
+		return (getCount() == 0) ? 0 : _min.load(boost::memory_order_relaxed);
+	}
+
+	LatencyHistogram::Ticks LatencyHistogram::getMax() const
+	{
+		return _max.load(boost::memory_order_relaxed);
+	}
+
+	LatencyHistogram::Ticks LatencyHistogram::getPercentile(double percentile) const
+	{
+		const unsigned long long count = getCount();
+		if (count == 0)
+			return 0;
+
+		unsigned long long rank = (unsigned long long)std::ceil(percentile / 100.0 * (double)count);
+		rank = std::max(1ULL, std::min(rank, count));
+
+		unsigned long long seen = 0;
+		for (int i = 0; i < NUM_BUCKETS; ++i) {
+			seen += _buckets[i].load(boost::memory_order_relaxed);
+			if (seen >= rank)
+				return std::min(bucketUpperBound(i), getMax());
+		}
+		return getMax();
+	}
+
+	struct Profiler::Node {
+		Node(const char* kind, const std::string& name, int parent, int depth)
+			: kind(kind), name(name), label(kind), parent(parent), depth(depth),
+			  first_child(-1), next_sibling(-1), tick(~0ULL), tick_ticks(0)
+		{
+			if (!name.empty())
+				label += " " + name;
+
+			// ';' separates the frames of the collapsed stack format
+			std::replace(label.begin(), label.end(), ';', ':');
+			std::replace(label.begin(), label.end(), '\n', ' ');
+		}
+
+		const char* kind;
+		std::string name;
+		std::string label;
+		int parent;
+		int depth;
+
+		boost::atomic<int> first_child;
+		boost::atomic<int> next_sibling;
+
+		LatencyHistogram histogram;
+
+		// time spent in this node during the last tick it was active in
+		unsigned long long tick;
+		Ticks tick_ticks;
+	};
+
+	Profiler& Profiler::instance()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	Profiler::Profiler()
+		: _num_nodes(0), _depth(0), _enabled(true), _tick_budget(0), _tick(0), _num_overruns(0)
+	{
+		for (int i = 0; i < MAX_NODES; ++i)
+			_nodes[i] = NULL;
+
+		// virtual root that holds the ticks of all automata
+		_nodes[0] = new Node("", "", -1, 0);
+		_num_nodes.store(1);
+	}
+
+	Profiler::~Profiler()
+	{
+		for (int i = 0; i < MAX_NODES; ++i)
+			delete _nodes[i];
+	}
+
+	void Profiler::setEnabled(bool enabled)
+	{
+		_enabled = enabled;
+	}
+
+	bool Profiler::isEnabled() const
+	{
+		return _enabled;
+	}
+
+	void Profiler::setTickBudget(double seconds)
+	{
+		_tick_budget = CycleClock::fromSeconds(seconds);
+		if (seconds > 0.0 && _tick_budget == 0)
+			_tick_budget = 1;
+	}
+
+	double Profiler::getTickBudget() const
+	{
+		return CycleClock::toSeconds(_tick_budget);
+	}
+
+	void Profiler::reset()
+	{
+		const int num_nodes = _num_nodes.load();
+		for (int i = 1; i < num_nodes; ++i) {
+			delete _nodes[i];
+			_nodes[i] = NULL;
+		}
+		_nodes[0]->first_child.store(-1);
+		_num_nodes.store(1);
+		_depth = 0;
+		_tick.store(0);
+		_num_overruns.store(0);
+	}
+
+	unsigned long long Profiler::getTickCount() const
+	{
+		return _tick.load(boost::memory_order_relaxed);
+	}
+
+	unsigned long long Profiler::getOverrunCount() const
+	{
+		return _num_overruns.load(boost::memory_order_acquire);
+	}
+
+	int Profiler::_findOrCreate(int parent, const char* kind, const std::string& name)
+	{
+		// by name and not by address: objects that are deserialized again may reuse (or not) the old addresses
+		for (int child = _nodes[parent]->first_child.load(boost::memory_order_relaxed); child >= 0;
+			 child = _nodes[child]->next_sibling.load(boost::memory_order_relaxed)) {
+			if (_nodes[child]->name == name && std::strcmp(_nodes[child]->kind, kind) == 0)
+				return child;
+		}
+
+		const int num_nodes = _num_nodes.load(boost::memory_order_relaxed);
+		if (num_nodes >= MAX_NODES)
+			return -1;
+
+		// this allocates -- but only the first time a scope is entered
+		_nodes[num_nodes] = new Node(kind, name, parent, _nodes[parent]->depth + 1);
+		_num_nodes.store(num_nodes + 1, boost::memory_order_release);
+		_link(num_nodes);
+		return num_nodes;
+	}
+
+	void Profiler::_link(int node)
+	{
+		// publish the node to readers by appending it to the children of its parent
+		Node* n = _nodes[node];
+		Node* parent = _nodes[n->parent];
+		int child = parent->first_child.load(boost::memory_order_relaxed);
+		if (child < 0) {
+			parent->first_child.store(node, boost::memory_order_release);
+			return;
+		}
+		while (_nodes[child]->next_sibling.load(boost::memory_order_relaxed) >= 0)
+			child = _nodes[child]->next_sibling.load(boost::memory_order_relaxed);
+		_nodes[child]->next_sibling.store(node, boost::memory_order_release);
+	}
+
+	int Profiler::enter(const char* kind, const std::string& name, Ticks& start)
+	{
+		if (!_enabled || _depth >= MAX_DEPTH)
+			return -1;
+
+		const int parent = (_depth > 0) ? _stack[_depth - 1] : 0;
+		const int node = _findOrCreate(parent, kind, name);
+		if (node < 0)
+			return -1;
+
+		_stack[_depth++] = node;
+		start = CycleClock::now();
+		return node;
+	}
+
+	void Profiler::leave(int node, Ticks start)
+	{
+		const Ticks duration = CycleClock::now() - start;
+
+		Node* n = _nodes[node];
+		n->histogram.record(duration);
+
+		const unsigned long long tick = _tick.load(boost::memory_order_relaxed);
+		if (n->tick != tick) {
+			n->tick = tick;
+			n->tick_ticks = 0;
+		}
+		n->tick_ticks += duration;
+
+		// scopes are strictly nested, so this is the top of the stack
+		if (_depth > 0)
+			--_depth;
+	}
+
+	int Profiler::beginTick(const std::string& name, Ticks& start)
+	{
+		if (!_enabled)
+			return -1;
+
+		_depth = 0;
+		_tick.store(_tick.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+		return enter("HybridAutomaton::step", name, start);
+	}
+
+	void Profiler::endTick(int node, Ticks start)
+	{
+		leave(node, start);
+
+		const Ticks duration = _nodes[node]->tick_ticks;
+		if (_tick_budget == 0 || duration <= _tick_budget)
+			return;
+
+		// follow the most expensive path of this tick
+		const unsigned long long tick = _tick.load(boost::memory_order_relaxed);
+		int culprit = node;
+		for (;;) {
+			int heaviest = -1;
+			for (int child = _nodes[culprit]->first_child.load(boost::memory_order_relaxed); child >= 0;
+				 child = _nodes[child]->next_sibling.load(boost::memory_order_relaxed)) {
+				if (_nodes[child]->tick == tick && (heaviest < 0 || _nodes[child]->tick_ticks > _nodes[heaviest]->tick_ticks))
+					heaviest = child;
+			}
+			if (heaviest < 0)
+				break;
+			culprit = heaviest;
+		}
+
+		const unsigned long long num_overruns = _num_overruns.load(boost::memory_order_relaxed);
+		Overrun& overrun = _overruns[num_overruns % MAX_OVERRUNS];
+		overrun.tick = tick;
+		overrun.duration = CycleClock::toNanoseconds(duration);
+		overrun.culprit = culprit;
+		_num_overruns.store(num_overruns + 1, boost::memory_order_release);
+	}
+
+	void Profiler::getOverruns(std::vector<Overrun>& overruns) const
+	{
+		overruns.clear();
+		const unsigned long long num_overruns = getOverrunCount();
+		const unsigned long long first = (num_overruns > MAX_OVERRUNS) ? num_overruns - MAX_OVERRUNS : 0;
+		for (unsigned long long i = first; i < num_overruns; ++i)
+			overruns.push_back(_overruns[i % MAX_OVERRUNS]);
+	}
+
+	Profiler::Ticks Profiler::_selfTime(int node) const
+	{
+		Ticks self = _nodes[node]->histogram.getTotal();
+		for (int child = _nodes[node]->first_child.load(boost::memory_order_acquire); child >= 0;
+			 child = _nodes[child]->next_sibling.load(boost::memory_order_acquire)) {
+			const Ticks child_total = _nodes[child]->histogram.getTotal();
+			self = (child_total < self) ? self - child_total : 0;
+		}
+		return self;
+	}
+
+	void Profiler::getStatistics(std::vector<NodeStatistics>& statistics) const
+	{
+		statistics.clear();
+
+		// iterative depth-first traversal, children in the order they were first entered
+		std::vector<int> stack;
+		for (int child = _nodes[0]->first_child.load(boost::memory_order_acquire); child >= 0;
+			 child = _nodes[child]->next_sibling.load(boost::memory_order_acquire))
+			stack.insert(stack.begin(), child);
+
+		while (!stack.empty()) {
+			const int id = stack.back();
+			stack.pop_back();
+
+			const Node* n = _nodes[id];
+			NodeStatistics s;
+			s.id = id;
+			s.parent = n->parent;
+			s.depth = n->depth;
+			s.label = n->label;
+			s.count = n->histogram.getCount();
+			s.total = CycleClock::toNanoseconds(n->histogram.getTotal());
+			s.min = CycleClock::toNanoseconds(n->histogram.getMin());
+			s.p50 = CycleClock::toNanoseconds(n->histogram.getPercentile(50.0));
+			s.p90 = CycleClock::toNanoseconds(n->histogram.getPercentile(90.0));
+			s.p99 = CycleClock::toNanoseconds(n->histogram.getPercentile(99.0));
+			s.p999 = CycleClock::toNanoseconds(n->histogram.getPercentile(99.9));
+			s.max = CycleClock::toNanoseconds(n->histogram.getMax());
+			statistics.push_back(s);
+
+			std::vector<int> children;
+			for (int child = n->first_child.load(boost::memory_order_acquire); child >= 0;
+				 child = _nodes[child]->next_sibling.load(boost::memory_order_acquire))
+				children.push_back(child);
+			stack.insert(stack.end(), children.rbegin(), children.rend());
+		}
+	}
+
+	std::string Profiler::getPath(int id, const std::string& separator) const
+	{
+		if (id <= 0 || id >= _num_nodes.load(boost::memory_order_acquire))
+			return "";
+
+		std::string path = _nodes[id]->label;
+		for (int parent = _nodes[id]->parent; parent > 0; parent = _nodes[parent]->parent)
+			path = _nodes[parent]->label + separator + path;
+		return path;
+	}
+
+	void Profiler::dump(std::ostream& out) const
+	{
+		std::vector<NodeStatistics> statistics;
+		getStatistics(statistics);
+
+		out << "# hybrid automaton step profile, times in ns" << std::endl;
+		out << "ticks_per_second " << CycleClock::ticksPerSecond() << std::endl;
+		out << "ticks " << getTickCount() << std::endl;
+		out << "tick_budget " << 1e9 * getTickBudget() << std::endl;
+
+		// node <id> <parent> <count> <total> <min> <p50> <p90> <p99> <p99.9> <max> <label>
+		for (std::vector<NodeStatistics>::const_iterator it = statistics.begin(); it != statistics.end(); ++it) {
+			out << "node " << it->id << " " << it->parent << " " << it->count << " " << it->total
+				<< " " << it->min << " " << it->p50 << " " << it->p90 << " " << it->p99
+				<< " " << it->p999 << " " << it->max << " " << it->label << std::endl;
+		}
+
+		// overrun <tick> <duration> <culprit>
+		std::vector<Overrun> overruns;
+		getOverruns(overruns);
+		out << "overruns " << getOverrunCount() << std::endl;
+		for (std::vector<Overrun>::const_iterator it = overruns.begin(); it != overruns.end(); ++it)
+			out << "overrun " << it->tick << " " << it->duration << " " << it->culprit << std::endl;
+	}
+
+	bool Profiler::dump(const std::string& filename) const
+	{
+		std::ofstream file(filename.c_str());
+		if (!file.is_open()) {
+			HA_ERROR("Profiler.dump", "Unable to open file " << filename);
+			return false;
+		}
+		dump(file);
+		return true;
+	}
+
+	void Profiler::dumpCollapsed(std::ostream& out) const
+	{
+		std::vector<NodeStatistics> statistics;
+		getStatistics(statistics);
+
+		for (std::vector<NodeStatistics>::const_iterator it = statistics.begin(); it != statistics.end(); ++it) {
+			const Ticks self = _selfTime(it->id);
+			if (self > 0)
+				out << getPath(it->id) << " " << (unsigned long long)CycleClock::toNanoseconds(self) << std::endl;
+		}
+	}
+
+}
@@ -30,26 +30,31 @@ namespace ha
 
 	HA_SENSOR_REGISTER("ROSTopicSensor", ROSTopicSensor);
 
-	ROSTopicSensor::ROSTopicSensor() :Sensor(), _is_subscribed(false) {}
+	ROSTopicSensor::ROSTopicSensor() :Sensor(), _is_subscribed(false), _is_updated(false), _is_update_read(false) {}
 
 	ROSTopicSensor::~ROSTopicSensor() {}
 
 	ROSTopicSensor::ROSTopicSensor(const ROSTopicSensor& ss)
-		:Sensor(ss)
+		:Sensor(ss), _is_updated(false), _is_update_read(false)
 	{
 	}
 
-	void ROSTopicSensor::initialize(const double& t) {
+	void ROSTopicSensor::prepare() {
 		// connect to topic
-		_last_pose.resize(0,0);
 		if (!_is_subscribed) {
 			if (!_system->subscribeToROSMessage(_ros_topic_name)) {
-				HA_WARN("ROSTopicSensor.initialize", "Unable to connect to topic " << _ros_topic_name);
+				HA_WARN("ROSTopicSensor.prepare", "Unable to connect to topic " << _ros_topic_name);
 			}else{
-				HA_INFO("ROSTopicSensor.initialize", "Successfully subscribed to topic " << _ros_topic_name << "");
+				HA_INFO("ROSTopicSensor.prepare", "Successfully subscribed to topic " << _ros_topic_name << "");
 				_is_subscribed = true;
 			}
 		}
+	}
+
+	void ROSTopicSensor::initialize(const double& t) {
+		_last_pose.resize(0,0);
+		this->prepare();
+		_latchUpdate();
 
 		// needs to be executed after connecting to topic because
 		// it queries getCurrentValue
@@ -75,10 +80,28 @@ namespace ha
 		return (available && _last_pose.rows() != 0);
 	}
 
+	void ROSTopicSensor::step(const double& t) {
+		Sensor::step(t);
+		_latchUpdate();
+	}
+
+	void ROSTopicSensor::_latchUpdate() {
+		// the update flag of the System may be consumed on read: ask once per control cycle
+		_is_updated = this->_system->isROSTopicUpdated(this->_ros_topic_name);
+		_is_update_read = false;
+	}
+
+	bool ROSTopicSensor::hasNewValue() const {
+		if (!this->_is_subscribed || _last_pose.rows() == 0)
+			return true;
+		return _is_updated;
+	}
+
 	::Eigen::MatrixXd ROSTopicSensor::getCurrentValue() const
 	{
 
-		if (this->_system->isROSTopicUpdated(this->_ros_topic_name)) {
+		if (_is_updated && !_is_update_read) {
+			_is_update_read = true;
 			::Eigen::MatrixXd pose;
 			if (!this->_system->getROSPose(this->_ros_topic_name, this->_ros_topic_type, pose)) {
 				HA_WARN("ROSTopicSensor.getCurrentValue", "Unable to get Pose from topic " << _ros_topic_name << "! Is the topic still being published?");
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/Replay.h"
+#include "hybrid_automaton/CycleClock.h"
+#include "hybrid_automaton/error_handling.h"
+#include "hybrid_automaton/Profiler.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace ha {
+
+	namespace {
+
+		// the Profiler is fed by a single thread: switch it off while several threads step automata
+		class ProfilerPause {
+		public:
+			ProfilerPause(bool pause) : _was_enabled(Profiler::instance().isEnabled()), _paused(pause && _was_enabled) {
+				if (_paused)
+					Profiler::instance().setEnabled(false);
+			}
+			~ProfilerPause() {
+				if (_paused)
+					Profiler::instance().setEnabled(_was_enabled);
+			}
+		private:
+			bool _was_enabled;
+			bool _paused;
+		};
+
+	}
+
+	bool Replay::Transition::operator==(const Transition& other) const
+	{
+		return tick == other.tick && time == other.time && control_switch == other.control_switch && target_mode == other.target_mode;
+	}
+
+	Replay::Replay()
+		: _dropped_ticks(0)
+	{
+	}
+
+	Replay::~Replay()
+	{
+	}
+
+	void Replay::load(const std::string& filename)
+	{
+		TraceReader reader;
+		reader.open(filename);
+
+		_ticks.clear();
+		_initial_values.clear();
+		_transitions.clear();
+		_dropped_ticks = 0;
+
+		std::vector<bool> seen;
+		TraceReader::Tick tick;
+		while (reader.readTick(tick)) {
+			_dropped_ticks += tick.dropped_before;
+
+			for (std::vector<TraceReader::Transition>::const_iterator it = tick.transitions.begin(); it != tick.transitions.end(); ++it) {
+				Transition transition;
+				transition.tick = _ticks.size();
+				transition.time = tick.time;
+				transition.control_switch = reader.getChannelName(it->control_switch);
+				transition.target_mode = reader.getChannelName(it->target_mode);
+				_transitions.push_back(transition);
+			}
+
+			// only the system outputs are needed for replay
+			std::vector<TraceReader::Value> values;
+			for (std::vector<TraceReader::Value>::const_iterator it = tick.values.begin(); it != tick.values.end(); ++it) {
+				if (reader.getChannels().find(it->channel)->second.kind != TraceRecorder::SYSTEM_CHANNEL)
+					continue;
+				values.push_back(*it);
+
+				if ((int)seen.size() <= it->channel)
+					seen.resize(it->channel + 1, false);
+				if (!seen[it->channel]) {
+					seen[it->channel] = true;
+					_initial_values.push_back(*it);
+				}
+			}
+			tick.values.swap(values);
+			tick.transitions.clear();
+			_ticks.push_back(tick);
+		}
+
+		_channels = reader.getChannels();
+
+		if (_dropped_ticks > 0)
+			HA_WARN("Replay.load", _dropped_ticks << " ticks were dropped while recording " << filename << " - replay will not be exact");
+	}
+
+	ReplaySystem::Ptr Replay::createSystem() const
+	{
+		ReplaySystem::Ptr system(new ReplaySystem(_channels));
+		for (std::vector<TraceReader::Value>::const_iterator it = _initial_values.begin(); it != _initial_values.end(); ++it)
+			system->setValue(it->channel, it->value);
+		return system;
+	}
+
+	Replay::Result Replay::run(const HybridAutomaton::Ptr& automaton, const ReplaySystem::Ptr& system) const
+	{
+		Result result;
+		result.ticks = 0;
+		result.matches = true;
+		result.first_mismatch = 0;
+		result.duration = 0.0;
+
+		const CycleClock::Ticks start = CycleClock::now();
+		try {
+			for (std::size_t i = 0; i < _ticks.size(); ++i) {
+				const TraceReader::Tick& tick = _ticks[i];
+				system->setValues(tick);
+
+				if (tick.initialize || !automaton->isActive()) {
+					std::map<int, TraceReader::Channel>::const_iterator mode = _channels.find(tick.mode);
+					if (mode != _channels.end() && automaton->existsControlMode(mode->second.name))
+						automaton->setCurrentControlMode(mode->second.name);
+					automaton->initialize(tick.time);
+					if (tick.initialize) {
+						++result.ticks;
+						continue;
+					}
+				}
+
+				const ControlMode::Ptr previous_mode = automaton->getCurrentControlMode();
+				automaton->step(tick.time);
+				if (automaton->getCurrentControlMode() != previous_mode) {
+					Transition transition;
+					transition.tick = i;
+					transition.time = tick.time;
+					transition.control_switch = automaton->getLastActiveControlSwitch()->getName();
+					transition.target_mode = automaton->getCurrentControlMode()->getName();
+					result.transitions.push_back(transition);
+				}
+				++result.ticks;
+			}
+		} catch (const std::string& error) {
+			result.error = error;
+		} catch (const std::exception& error) {
+			result.error = error.what();
+			if (result.error.empty())
+				result.error = "unknown std::exception";
+		} catch (...) {
+			result.error = "unknown exception";
+		}
+		result.duration = CycleClock::toSeconds(CycleClock::now() - start);
+
+		// the first transition that differs from the recording
+		const std::size_t common = std::min(result.transitions.size(), _transitions.size());
+		std::size_t i = 0;
+		while (i < common && result.transitions[i] == _transitions[i])
+			++i;
+		if (i < common) {
+			result.matches = false;
+			result.first_mismatch = std::min(result.transitions[i].tick, _transitions[i].tick);
+		} else if (i < result.transitions.size()) {
+			result.matches = false;
+			result.first_mismatch = result.transitions[i].tick;
+		} else if (i < _transitions.size() && (result.error.empty() || _transitions[i].tick < result.ticks)) {
+			result.matches = false;
+			result.first_mismatch = _transitions[i].tick;
+		}
+
+		if (!result.error.empty() && result.matches) {
+			result.matches = false;
+			result.first_mismatch = result.ticks;
+		}
+
+		return result;
+	}
+
+	void Replay::_runJobs(const std::vector<HybridAutomaton::Ptr>* automata, const std::vector<ReplaySystem::Ptr>* systems,
+		std::vector<Result>* results, boost::atomic<std::size_t>* next) const
+	{
+		for (std::size_t i = (*next)++; i < automata->size(); i = (*next)++)
+			(*results)[i] = run((*automata)[i], (*systems)[i]);
+	}
+
+	std::vector<Replay::Result> Replay::run(const std::vector<HybridAutomaton::Ptr>& automata, const std::vector<ReplaySystem::Ptr>& systems, int num_threads) const
+	{
+		if (automata.size() != systems.size())
+			HA_THROW_ERROR("Replay.run", "Number of automata (" << automata.size() << ") and systems (" << systems.size() << ") differ");
+
+		if (num_threads <= 0)
+			num_threads = std::max(1u, boost::thread::hardware_concurrency());
+		num_threads = std::min(num_threads, (int)automata.size());
+
+		std::vector<Result> results(automata.size());
+		boost::atomic<std::size_t> next(0);
+
+		ProfilerPause profiler_pause(num_threads > 1);
+		boost::thread_group workers;
+		for (int i = 0; i < num_threads; ++i)
+			workers.create_thread(boost::bind(&Replay::_runJobs, this, &automata, &systems, &results, &next));
+		workers.join_all();
+
+		return results;
+	}
+
+	const std::vector<Replay::Transition>& Replay::getRecordedTransitions() const
+	{
+		return _transitions;
+	}
+
+	unsigned long long Replay::getNumberOfTicks() const
+	{
+		return _ticks.size();
+	}
+
+	const std::vector<TraceReader::Tick>& Replay::getTicks() const
+	{
+		return _ticks;
+	}
+
+	unsigned long long Replay::getDroppedTicks() const
+	{
+		return _dropped_ticks;
+	}
+
+}
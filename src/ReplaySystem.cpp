@@ -0,0 +1,376 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/ReplaySystem.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ha {
+
+	namespace {
+
+		// names of the system channels, shared by RecordingSystem and ReplaySystem
+		std::string forceTorqueName(const int& port)
+		{
+			std::ostringstream name;
+			name << "force_torque/" << port;
+			return name.str();
+		}
+
+		void record(const std::string& name, const ::Eigen::MatrixXd& value)
+		{
+			TraceRecorder* trace_recorder = TraceRecorder::current();
+			if (trace_recorder)
+				trace_recorder->recordSystemValue(name, value);
+		}
+
+		void record(const std::string& name, bool value)
+		{
+			TraceRecorder* trace_recorder = TraceRecorder::current();
+			if (trace_recorder)
+				trace_recorder->recordSystemValue(name, ::Eigen::MatrixXd::Constant(1, 1, value ? 1.0 : 0.0));
+		}
+
+		// the value of the latest sample of a SensorSource, and its time stamp and sequence number
+		std::string sourceValueName(const std::string& name)
+		{
+			return "sensor_source/" + name;
+		}
+
+		std::string sourceSampleName(const std::string& name)
+		{
+			return "sensor_source_sample/" + name;
+		}
+
+		// forwards to a source of the recorded System and records the latest sample whenever it is fetched
+		class RecordingSensorSource : public SensorSource {
+		public:
+			RecordingSensorSource(const SensorSource::Ptr& source)
+				: SensorSource(source->getName(), source->getValue().rows(), source->getValue().cols()), _source(source),
+				_value_name(sourceValueName(source->getName())), _sample_name(sourceSampleName(source->getName())), _sample(2, 1)
+			{
+				if (_source->getSequence() > 0)
+					_copySample();
+			}
+
+			virtual bool fetch()
+			{
+				const bool fetched = _source->fetch();
+				if (fetched)
+					_copySample();
+
+				if (getSequence() > 0) {
+					_sample(0, 0) = getTime();
+					_sample(1, 0) = (double)getSequence();
+					record(_value_name, getValue());
+					record(_sample_name, _sample);
+				}
+				return fetched;
+			}
+
+		protected:
+			virtual bool _connect()
+			{
+				return _source->subscribe();
+			}
+
+			virtual void _disconnect()
+			{
+				_source->unsubscribe();
+			}
+
+			void _copySample()
+			{
+				publish(_source->getValue(), _source->getTime());
+				SensorSource::fetch();
+			}
+
+			SensorSource::Ptr _source;
+			std::string _value_name;
+			std::string _sample_name;
+			::Eigen::MatrixXd _sample;
+		};
+	}
+
+	RecordingSystem::RecordingSystem(const System::ConstPtr& system)
+		: _system(system)
+	{
+		if (!_system)
+			HA_THROW_ERROR("RecordingSystem.RecordingSystem", "System must not be NULL");
+	}
+
+	RecordingSystem::~RecordingSystem()
+	{
+	}
+
+	System::ConstPtr RecordingSystem::getSystem() const
+	{
+		return _system;
+	}
+
+	int RecordingSystem::getDof() const
+	{
+		const int dof = _system->getDof();
+		record("dof", ::Eigen::MatrixXd::Constant(1, 1, dof));
+		return dof;
+	}
+
+	::Eigen::MatrixXd RecordingSystem::getJointConfiguration() const
+	{
+		::Eigen::MatrixXd value = _system->getJointConfiguration();
+		record("joint_configuration", value);
+		return value;
+	}
+
+	::Eigen::MatrixXd RecordingSystem::getJointVelocity() const
+	{
+		::Eigen::MatrixXd value = _system->getJointVelocity();
+		record("joint_velocity", value);
+		return value;
+	}
+
+	::Eigen::MatrixXd RecordingSystem::getForceTorqueMeasurement(const int& port) const
+	{
+		::Eigen::MatrixXd value = _system->getForceTorqueMeasurement(port);
+		record(forceTorqueName(port), value);
+		return value;
+	}
+
+	::Eigen::MatrixXd RecordingSystem::getFramePose(const std::string& frame_id) const
+	{
+		::Eigen::MatrixXd value = _system->getFramePose(frame_id);
+		record("frame_pose/" + frame_id, value);
+		return value;
+	}
+
+	bool RecordingSystem::subscribeToROSMessage(const std::string& topic) const
+	{
+		const bool value = _system->subscribeToROSMessage(topic);
+		record("ros_subscribe/" + topic, value);
+		return value;
+	}
+
+	bool RecordingSystem::subscribeToTransform(const std::string& frame, const std::string& parent) const
+	{
+		const bool value = _system->subscribeToTransform(frame, parent);
+		record("tf_subscribe/" + frame + "/" + parent, value);
+		return value;
+	}
+
+	bool RecordingSystem::isROSTopicAvailable(const std::string& topic_name) const
+	{
+		const bool value = _system->isROSTopicAvailable(topic_name);
+		record("ros_available/" + topic_name, value);
+		return value;
+	}
+
+	bool RecordingSystem::isROSTopicUpdated(const std::string& topic_name) const
+	{
+		const bool value = _system->isROSTopicUpdated(topic_name);
+		record("ros_updated/" + topic_name, value);
+		return value;
+	}
+
+	bool RecordingSystem::getROSPose(const std::string& topic_name, const std::string& topic_type, ::Eigen::MatrixXd& pose) const
+	{
+		// an empty matrix marks a failed read
+		const bool value = _system->getROSPose(topic_name, topic_type, pose);
+		record("ros_pose/" + topic_name, value ? pose : ::Eigen::MatrixXd());
+		return value;
+	}
+
+	bool RecordingSystem::getROSTfPose(const std::string& child, const std::string& parent, ::Eigen::MatrixXd& pose) const
+	{
+		const bool value = _system->getROSTfPose(child, parent, pose);
+		record("ros_tf_pose/" + child + "/" + parent, value ? pose : ::Eigen::MatrixXd());
+		return value;
+	}
+
+	SensorSourcePtr RecordingSystem::getSensorSource(const std::string& name) const
+	{
+		std::map<std::string, SensorSource::Ptr>::const_iterator it = _sources.find(name);
+		if (it != _sources.end())
+			return it->second;
+
+		SensorSource::Ptr source = _system->getSensorSource(name);
+		if (!source)
+			return SensorSourcePtr();
+
+		SensorSource::Ptr recording_source(new RecordingSensorSource(source));
+		_sources[name] = recording_source;
+		return recording_source;
+	}
+
+	ReplaySystem::ReplaySystem(const std::map<int, TraceReader::Channel>& channels)
+	{
+		int size = 0;
+		for (std::map<int, TraceReader::Channel>::const_iterator it = channels.begin(); it != channels.end(); ++it) {
+			if (it->second.kind != TraceRecorder::SYSTEM_CHANNEL)
+				continue;
+			_channel_ids[it->second.name] = it->first;
+			size = std::max(size, it->first + 1);
+		}
+		_values.resize(size);
+		_valid.resize(size, false);
+	}
+
+	ReplaySystem::~ReplaySystem()
+	{
+	}
+
+	void ReplaySystem::setValues(const TraceReader::Tick& tick)
+	{
+		for (std::vector<TraceReader::Value>::const_iterator it = tick.values.begin(); it != tick.values.end(); ++it) {
+			if (it->channel < (int)_values.size())
+				setValue(it->channel, it->value);
+		}
+
+		for (std::map<std::string, ReplaySource>::iterator it = _sources.begin(); it != _sources.end(); ++it)
+			_republish(it->second);
+	}
+
+	void ReplaySystem::setValue(int channel, const ::Eigen::MatrixXd& value)
+	{
+		if (channel < 0 || channel >= (int)_values.size())
+			HA_THROW_ERROR("ReplaySystem.setValue", "Unknown channel " << channel);
+		_values[channel] = value;
+		_valid[channel] = true;
+	}
+
+	const ::Eigen::MatrixXd* ReplaySystem::_find(const std::string& name) const
+	{
+		std::map<std::string, int>::const_iterator it = _channel_ids.find(name);
+		if (it == _channel_ids.end() || !_valid[it->second])
+			return NULL;
+		return &_values[it->second];
+	}
+
+	const ::Eigen::MatrixXd& ReplaySystem::_get(const std::string& name) const
+	{
+		const ::Eigen::MatrixXd* value = _find(name);
+		if (!value)
+			HA_THROW_ERROR("ReplaySystem.get", "No recorded value for " << name);
+		return *value;
+	}
+
+	int ReplaySystem::getDof() const
+	{
+		const ::Eigen::MatrixXd* dof = _find("dof");
+		if (dof)
+			return (int)(*dof)(0, 0);
+		return (int)_get("joint_configuration").rows();
+	}
+
+	::Eigen::MatrixXd ReplaySystem::getJointConfiguration() const
+	{
+		return _get("joint_configuration");
+	}
+
+	::Eigen::MatrixXd ReplaySystem::getJointVelocity() const
+	{
+		return _get("joint_velocity");
+	}
+
+	::Eigen::MatrixXd ReplaySystem::getForceTorqueMeasurement(const int& port) const
+	{
+		return _get(forceTorqueName(port));
+	}
+
+	::Eigen::MatrixXd ReplaySystem::getFramePose(const std::string& frame_id) const
+	{
+		return _get("frame_pose/" + frame_id);
+	}
+
+	bool ReplaySystem::subscribeToROSMessage(const std::string& topic) const
+	{
+		// subscriptions that were not recorded have been successful
+		const ::Eigen::MatrixXd* value = _find("ros_subscribe/" + topic);
+		return !value || (*value)(0, 0) != 0.0;
+	}
+
+	bool ReplaySystem::subscribeToTransform(const std::string& frame, const std::string& parent) const
+	{
+		const ::Eigen::MatrixXd* value = _find("tf_subscribe/" + frame + "/" + parent);
+		return !value || (*value)(0, 0) != 0.0;
+	}
+
+	bool ReplaySystem::isROSTopicAvailable(const std::string& topic_name) const
+	{
+		return _get("ros_available/" + topic_name)(0, 0) != 0.0;
+	}
+
+	bool ReplaySystem::isROSTopicUpdated(const std::string& topic_name) const
+	{
+		return _get("ros_updated/" + topic_name)(0, 0) != 0.0;
+	}
+
+	bool ReplaySystem::getROSPose(const std::string& topic_name, const std::string& topic_type, ::Eigen::MatrixXd& pose) const
+	{
+		const ::Eigen::MatrixXd& value = _get("ros_pose/" + topic_name);
+		if (value.size() == 0)
+			return false;
+		pose = value;
+		return true;
+	}
+
+	bool ReplaySystem::getROSTfPose(const std::string& child, const std::string& parent, ::Eigen::MatrixXd& pose) const
+	{
+		const ::Eigen::MatrixXd& value = _get("ros_tf_pose/" + child + "/" + parent);
+		if (value.size() == 0)
+			return false;
+		pose = value;
+		return true;
+	}
+
+	SensorSourcePtr ReplaySystem::getSensorSource(const std::string& name) const
+	{
+		std::map<std::string, ReplaySource>::iterator it = _sources.find(name);
+		if (it == _sources.end()) {
+			ReplaySource source;
+			source.source.reset(new SensorSource(name));
+			source.sequence = 0.0;
+			it = _sources.insert(std::make_pair(name, source)).first;
+			_republish(it->second);
+		}
+		return it->second.source;
+	}
+
+	void ReplaySystem::_republish(ReplaySource& source) const
+	{
+		const ::Eigen::MatrixXd* sample = _find(sourceSampleName(source.source->getName()));
+		if (!sample || (*sample)(1, 0) <= source.sequence)
+			return;
+
+		const ::Eigen::MatrixXd* value = _find(sourceValueName(source.source->getName()));
+		if (!value)
+			return;
+
+		source.source->publish(*value, (*sample)(0, 0));
+		source.sequence = (*sample)(1, 0);
+	}
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/RigidBodyMotion.h"
+
+#include <cmath>
+
+namespace ha
+{
+	namespace {
+		void skew(const ::Eigen::Vector3d& v, ::Eigen::Matrix3d& v_hat)
+		{
+			v_hat << 0.0, -v(2), v(1),
+				v(2), 0.0, -v(0),
+				-v(1), v(0), 0.0;
+		}
+	}
+
+	void logPose(const ::Eigen::Matrix4d& pose, ::Eigen::Matrix<double, 6, 1>& twist)
+	{
+		const ::Eigen::Matrix3d rotation = pose.topLeftCorner<3, 3>();
+		const ::Eigen::AngleAxisd angle_axis(rotation);
+		const double theta = angle_axis.angle();
+		const ::Eigen::Vector3d omega = theta * angle_axis.axis();
+
+		::Eigen::Matrix3d omega_hat;
+		skew(omega, omega_hat);
+
+		// inverse of the left Jacobian of SO(3), series expansion for small angles
+		double c = 1.0 / 12.0;
+		if (theta > 1e-6)
+			c = (1.0 - theta * sin(theta) / (2.0 * (1.0 - cos(theta)))) / (theta * theta);
+		const ::Eigen::Matrix3d v_inverse = ::Eigen::Matrix3d::Identity() - 0.5 * omega_hat + c * omega_hat * omega_hat;
+
+		twist.head<3>().noalias() = v_inverse * pose.topRightCorner<3, 1>();
+		twist.tail<3>() = omega;
+	}
+
+	void expTwist(const ::Eigen::Matrix<double, 6, 1>& twist, ::Eigen::Matrix4d& pose)
+	{
+		const ::Eigen::Vector3d omega = twist.tail<3>();
+		const double theta = omega.norm();
+
+		::Eigen::Matrix3d omega_hat;
+		skew(omega, omega_hat);
+		const ::Eigen::Matrix3d omega_hat2 = omega_hat * omega_hat;
+
+		// Rodrigues' formula and the left Jacobian of SO(3), series expansions for small angles
+		double a = 1.0, b = 0.5, c = 1.0 / 6.0;
+		if (theta > 1e-6) {
+			a = sin(theta) / theta;
+			b = (1.0 - cos(theta)) / (theta * theta);
+			c = (theta - sin(theta)) / (theta * theta * theta);
+		}
+
+		pose.setIdentity();
+		pose.topLeftCorner<3, 3>() += a * omega_hat + b * omega_hat2;
+		const ::Eigen::Matrix3d v = ::Eigen::Matrix3d::Identity() + b * omega_hat + c * omega_hat2;
+		pose.topRightCorner<3, 1>().noalias() = v * twist.head<3>();
+	}
+
+}
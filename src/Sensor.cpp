@@ -60,7 +60,11 @@ namespace ha{
 
 	void Sensor::initialize(const double& t) 
 	{
-		this->_initial_sensor_value = this->getCurrentValue();
+		this->readCurrentValue(this->_initial_sensor_value);
+	}
+
+	void Sensor::prepare() 
+	{
 	}
 
 	void Sensor::terminate() 
@@ -81,4 +85,25 @@ namespace ha{
 		return (this->getCurrentValue() - this->_initial_sensor_value);
 	}
 
+	void Sensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->getCurrentValue();
+	}
+
+	void Sensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->getRelativeCurrentValue();
+	}
+
+	void Sensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->getInitialValue();
+	}
+
+	void Sensor::_readDifferenceToInitialValue(::Eigen::MatrixXd& value) const
+	{
+		this->readCurrentValue(value);
+		value -= this->_initial_sensor_value;
+	}
+
 }
\ No newline at end of file
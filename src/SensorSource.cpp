@@ -0,0 +1,204 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/SensorSource.h"
+
+#include <boost/bind.hpp>
+
+namespace ha
+{
+	SensorMailbox::SensorMailbox(int rows, int cols)
+		: _middle(1), _back(0), _front(2), _published(0)
+	{
+		for (int i = 0; i < 3; i++)
+			_buffers[i].value.setZero(rows, cols);
+	}
+
+	SensorMailbox::~SensorMailbox()
+	{
+	}
+
+	void SensorMailbox::publish(const ::Eigen::MatrixXd& value, double time)
+	{
+		Sample& sample = _buffers[_back];
+		sample.value = value;
+		sample.time = time;
+		sample.sequence = ++_published;
+
+		const unsigned int previous = _middle.exchange(_back | NEW_SAMPLE, boost::memory_order_acq_rel);
+		_back = previous & INDEX_MASK;
+	}
+
+	bool SensorMailbox::fetch()
+	{
+		if (!(_middle.load(boost::memory_order_relaxed) & NEW_SAMPLE))
+			return false;
+
+		const unsigned int previous = _middle.exchange(_front, boost::memory_order_acq_rel);
+		_front = previous & INDEX_MASK;
+		return true;
+	}
+
+	const SensorMailbox::Sample& SensorMailbox::getSample() const
+	{
+		return _buffers[_front];
+	}
+
+	SensorSource::SensorSource(const std::string& name, int rows, int cols)
+		: _name(name), _mailbox(rows, cols), _has_fetched_cycle(false), _fetched_cycle(0.0), _subscribed(false)
+	{
+	}
+
+	SensorSource::~SensorSource()
+	{
+	}
+
+	const std::string& SensorSource::getName() const
+	{
+		return _name;
+	}
+
+	bool SensorSource::subscribe()
+	{
+		boost::mutex::scoped_lock lock(_subscription_mutex);
+		if (!_subscribed && _connect())
+			_subscribed = true;
+		return _subscribed;
+	}
+
+	void SensorSource::unsubscribe()
+	{
+		boost::mutex::scoped_lock lock(_subscription_mutex);
+		if (_subscribed)
+			_disconnect();
+		_subscribed = false;
+	}
+
+	bool SensorSource::isSubscribed() const
+	{
+		return _subscribed;
+	}
+
+	void SensorSource::publish(const ::Eigen::MatrixXd& value, double time)
+	{
+		_mailbox.publish(value, time);
+	}
+
+	bool SensorSource::fetch()
+	{
+		return _mailbox.fetch();
+	}
+
+	void SensorSource::fetchForCycle(const double& time)
+	{
+		if (_has_fetched_cycle && time == _fetched_cycle)
+			return;
+		_has_fetched_cycle = true;
+		_fetched_cycle = time;
+		fetch();
+	}
+
+	const ::Eigen::MatrixXd& SensorSource::getValue() const
+	{
+		return _mailbox.getSample().value;
+	}
+
+	double SensorSource::getTime() const
+	{
+		return _mailbox.getSample().time;
+	}
+
+	unsigned long long SensorSource::getSequence() const
+	{
+		return _mailbox.getSample().sequence;
+	}
+
+	bool SensorSource::_connect()
+	{
+		return true;
+	}
+
+	void SensorSource::_disconnect()
+	{
+	}
+
+	SensorSourceSubscriber::SensorSourceSubscriber(double retry_period)
+		: _retry_period(retry_period), _stop(false)
+	{
+	}
+
+	SensorSourceSubscriber::~SensorSourceSubscriber()
+	{
+		stop();
+	}
+
+	void SensorSourceSubscriber::add(const SensorSource::Ptr& source)
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		_sources.push_back(source);
+	}
+
+	int SensorSourceSubscriber::subscribeAll()
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+		int remaining = 0;
+		for (std::size_t i = 0; i < _sources.size(); i++) {
+			if (!_sources[i]->subscribe())
+				remaining++;
+		}
+		return remaining;
+	}
+
+	void SensorSourceSubscriber::start()
+	{
+		if (_thread)
+			return;
+		_stop = false;
+		_thread.reset(new boost::thread(boost::bind(&SensorSourceSubscriber::_loop, this)));
+	}
+
+	void SensorSourceSubscriber::stop()
+	{
+		if (!_thread)
+			return;
+		_stop = true;
+		_thread->interrupt();
+		_thread->join();
+		_thread.reset();
+	}
+
+	void SensorSourceSubscriber::_loop()
+	{
+		const boost::posix_time::microseconds period((long)(_retry_period * 1e6));
+		try {
+			while (!_stop) {
+				subscribeAll();
+				boost::this_thread::sleep(period);
+			}
+		} catch (const boost::thread_interrupted&) {
+		}
+	}
+
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/SharedSensor.h"
+
+namespace ha {
+
+	SharedSensor::SharedSensor(const Sensor::Ptr& sensor, const ControlCycle::ConstPtr& cycle)
+		: _sensor(sensor), _cycle(cycle), _initialized(false), _initialize_cycle(0), _stepped(false), _step_cycle(0),
+		_has_current_value(false), _current_value_cycle(0), _has_relative_current_value(false), _relative_current_value_cycle(0)
+	{
+		if (!_sensor)
+			HA_THROW_ERROR("SharedSensor.SharedSensor", "Cannot share a NULL sensor!");
+	}
+
+	SharedSensor::~SharedSensor()
+	{
+	}
+
+	SharedSensor::SharedSensor(const SharedSensor& ss)
+		: Sensor(ss), _sensor(ss._sensor->clone()), _cycle(ss._cycle), _initialized(false), _initialize_cycle(0), _stepped(false), _step_cycle(0),
+		_has_current_value(false), _current_value_cycle(0), _has_relative_current_value(false), _relative_current_value_cycle(0)
+	{
+	}
+
+	::Eigen::MatrixXd SharedSensor::getCurrentValue() const
+	{
+		::Eigen::MatrixXd value;
+		readCurrentValue(value);
+		return value;
+	}
+
+	::Eigen::MatrixXd SharedSensor::getRelativeCurrentValue() const
+	{
+		::Eigen::MatrixXd value;
+		readRelativeCurrentValue(value);
+		return value;
+	}
+
+	::Eigen::MatrixXd SharedSensor::getInitialValue() const
+	{
+		return _sensor->getInitialValue();
+	}
+
+	void SharedSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		if (!_inCycle()) {
+			_sensor->readCurrentValue(value);
+			return;
+		}
+
+		if (!_has_current_value || _current_value_cycle != _cycle->count) {
+			_sensor->readCurrentValue(_current_value);
+			_has_current_value = true;
+			_current_value_cycle = _cycle->count;
+		}
+		value = _current_value;
+	}
+
+	void SharedSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		if (!_inCycle()) {
+			_sensor->readRelativeCurrentValue(value);
+			return;
+		}
+
+		if (!_has_relative_current_value || _relative_current_value_cycle != _cycle->count) {
+			_sensor->readRelativeCurrentValue(_relative_current_value);
+			_has_relative_current_value = true;
+			_relative_current_value_cycle = _cycle->count;
+		}
+		value = _relative_current_value;
+	}
+
+	void SharedSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		_sensor->readInitialValue(value);
+	}
+
+	const std::string SharedSensor::getType() const
+	{
+		return _sensor->getType();
+	}
+
+	void SharedSensor::setType(const std::string& new_type)
+	{
+		_sensor->setType(new_type);
+	}
+
+	void SharedSensor::setSystem(const System::ConstPtr& system)
+	{
+		_sensor->setSystem(system);
+	}
+
+	void SharedSensor::initialize(const double& t)
+	{
+		// all JumpConditions of a mode are initialized in the same cycle
+		if (_inCycle() && _initialized && _initialize_cycle == _cycle->count)
+			return;
+
+		_sensor->initialize(t);
+		_initialized = true;
+		_initialize_cycle = _cycle ? _cycle->count : 0;
+		_invalidate();
+	}
+
+	void SharedSensor::prepare()
+	{
+		_sensor->prepare();
+	}
+
+	void SharedSensor::terminate()
+	{
+		if (!_initialized)
+			return;
+
+		_sensor->terminate();
+		_initialized = false;
+		_stepped = false;
+		_invalidate();
+	}
+
+	void SharedSensor::step(const double& t)
+	{
+		if (_inCycle() && _stepped && _step_cycle == _cycle->count)
+			return;
+
+		_sensor->step(t);
+		_stepped = true;
+		_step_cycle = _cycle ? _cycle->count : 0;
+		_invalidate();
+	}
+
+	bool SharedSensor::isActive() const
+	{
+		return _sensor->isActive();
+	}
+
+	bool SharedSensor::isClock() const
+	{
+		return _sensor->isClock();
+	}
+
+	bool SharedSensor::hasNewValue() const
+	{
+		return _sensor->hasNewValue();
+	}
+
+	bool SharedSensor::getSampleTime(double& time) const
+	{
+		return _sensor->getSampleTime(time);
+	}
+
+	DescriptionTreeNode::Ptr SharedSensor::serialize(const DescriptionTree::ConstPtr& factory) const
+	{
+		return _sensor->serialize(factory);
+	}
+
+	void SharedSensor::deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha)
+	{
+		_sensor->deserialize(tree, system, ha);
+		_initialized = false;
+		_stepped = false;
+		_invalidate();
+	}
+
+	Sensor::Ptr SharedSensor::getSensor() const
+	{
+		return _sensor;
+	}
+
+	bool SharedSensor::_inCycle() const
+	{
+		return _cycle && _cycle->running;
+	}
+
+	void SharedSensor::_invalidate()
+	{
+		_has_current_value = false;
+		_has_relative_current_value = false;
+	}
+
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <boost/random/normal_distribution.hpp>
+
+#include <sstream>
+
+namespace ha {
+
+	SimulatedSystem::SimulatedSystem(int dof, double link_length)
+		: _tool_offset(::Eigen::MatrixXd::Identity(4, 4)), _time(0.0), _input_mode(TORQUE_INPUT), _inertia(1.0), _damping(10.0),
+		  _has_contact(false), _contact_normal(::Eigen::Vector3d::UnitZ()), _contact_offset(0.0), _contact_stiffness(0.0), _noise(0.0)
+	{
+		for (int i = 0; i < dof; ++i)
+			addJoint((i % 2 == 0) ? ::Eigen::Vector3d::UnitZ() : ::Eigen::Vector3d::UnitY(), ::Eigen::Vector3d(0.0, 0.0, (i == 0) ? 0.0 : link_length));
+		_updateKinematics();
+	}
+
+	SimulatedSystem::~SimulatedSystem()
+	{
+	}
+
+	void SimulatedSystem::clearJoints()
+	{
+		_joints.clear();
+		for (std::map<std::string, Frame>::iterator it = _frames.begin(); it != _frames.end(); ) {
+			if (it->second.joint >= 0)
+				_frames.erase(it++);
+			else
+				++it;
+		}
+		_q.resize(0);
+		_qd.resize(0);
+		_measured_q.resize(0);
+		_updateKinematics();
+	}
+
+	void SimulatedSystem::addJoint(const ::Eigen::Vector3d& axis, const ::Eigen::Vector3d& offset)
+	{
+		if (axis.norm() == 0.0)
+			HA_THROW_ERROR("SimulatedSystem.addJoint", "Joint axis must not be zero");
+
+		Joint joint;
+		joint.axis = axis.normalized();
+		joint.offset = offset;
+		_joints.push_back(joint);
+
+		const int dof = (int)_joints.size();
+		_q.conservativeResize(dof);
+		_qd.conservativeResize(dof);
+		_q(dof - 1) = 0.0;
+		_qd(dof - 1) = 0.0;
+		_measured_q = _q;
+		_updateKinematics();
+	}
+
+	void SimulatedSystem::addFrame(const std::string& name, int joint, const ::Eigen::MatrixXd& offset)
+	{
+		if (joint < -1 || joint >= (int)_joints.size())
+			HA_THROW_ERROR("SimulatedSystem.addFrame", "Frame " << name << " refers to unknown joint " << joint);
+		if (offset.rows() != 4 || offset.cols() != 4)
+			HA_THROW_ERROR("SimulatedSystem.addFrame", "Offset of frame " << name << " must be 4x4, not " << offset.rows() << "x" << offset.cols());
+
+		Frame frame;
+		frame.joint = joint;
+		frame.offset = offset;
+		_frames[name] = frame;
+	}
+
+	void SimulatedSystem::setToolOffset(const ::Eigen::MatrixXd& offset)
+	{
+		if (offset.rows() != 4 || offset.cols() != 4)
+			HA_THROW_ERROR("SimulatedSystem.setToolOffset", "Tool offset must be 4x4, not " << offset.rows() << "x" << offset.cols());
+		_tool_offset = offset;
+		_updateKinematics();
+	}
+
+	void SimulatedSystem::setJointConfiguration(const ::Eigen::MatrixXd& q)
+	{
+		if (q.rows() != getDof() || q.cols() != 1)
+			HA_THROW_ERROR("SimulatedSystem.setJointConfiguration", "Expected " << getDof() << "x1, not " << q.rows() << "x" << q.cols());
+		_q = q;
+		_measured_q = _q;
+		_updateKinematics();
+	}
+
+	void SimulatedSystem::setJointVelocity(const ::Eigen::MatrixXd& qd)
+	{
+		if (qd.rows() != getDof() || qd.cols() != 1)
+			HA_THROW_ERROR("SimulatedSystem.setJointVelocity", "Expected " << getDof() << "x1, not " << qd.rows() << "x" << qd.cols());
+		_qd = qd;
+	}
+
+	void SimulatedSystem::setInputMode(InputMode input_mode)
+	{
+		_input_mode = input_mode;
+	}
+
+	SimulatedSystem::InputMode SimulatedSystem::getInputMode() const
+	{
+		return _input_mode;
+	}
+
+	void SimulatedSystem::setDynamics(double inertia, double damping)
+	{
+		if (inertia <= 0.0)
+			HA_THROW_ERROR("SimulatedSystem.setDynamics", "Inertia must be positive, not " << inertia);
+		_inertia = inertia;
+		_damping = damping;
+	}
+
+	void SimulatedSystem::setContactPlane(const ::Eigen::Vector3d& normal, double offset, double stiffness)
+	{
+		if (normal.norm() == 0.0)
+			HA_THROW_ERROR("SimulatedSystem.setContactPlane", "Plane normal must not be zero");
+		_has_contact = true;
+		_contact_normal = normal.normalized();
+		_contact_offset = offset;
+		_contact_stiffness = stiffness;
+	}
+
+	void SimulatedSystem::removeContactPlane()
+	{
+		_has_contact = false;
+	}
+
+	void SimulatedSystem::addSensorSource(const SensorSource::Ptr& source)
+	{
+		_sources[source->getName()] = source;
+	}
+
+	SensorSourcePtr SimulatedSystem::getSensorSource(const std::string& name) const
+	{
+		std::map<std::string, SensorSource::Ptr>::const_iterator it = _sources.find(name);
+		if (it == _sources.end())
+			return SensorSourcePtr();
+		return it->second;
+	}
+
+	void SimulatedSystem::setMeasurementNoise(double stddev, unsigned int seed)
+	{
+		_noise = stddev;
+		_generator.seed(seed);
+	}
+
+	void SimulatedSystem::integrate(const ::Eigen::MatrixXd& command, double dt)
+	{
+		const int dof = getDof();
+		if (command.rows() != dof || command.cols() != 1)
+			HA_THROW_ERROR("SimulatedSystem.integrate", "Expected a " << dof << "x1 command, not " << command.rows() << "x" << command.cols());
+
+		if (_input_mode == VELOCITY_INPUT) {
+			_qd = command;
+		} else {
+			// joint torques of the contact force: tau = J_v^T f
+			::Eigen::VectorXd tau = command;
+			const ::Eigen::Vector3d force = getContactForce();
+			if (force.squaredNorm() > 0.0) {
+				const ::Eigen::Vector3d p_ee = _ee_pose.block(0, 3, 3, 1);
+				for (int i = 0; i < dof; ++i) {
+					const ::Eigen::Vector3d axis = _link_poses[i + 1].block(0, 0, 3, 3) * _joints[i].axis;
+					const ::Eigen::Vector3d p_joint = _link_poses[i + 1].block(0, 3, 3, 1);
+					tau(i) += axis.cross(p_ee - p_joint).dot(force);
+				}
+			}
+
+			// semi-implicit Euler
+			_qd += dt * (tau - _damping * _qd) / _inertia;
+		}
+		_q += dt * _qd;
+		_time += dt;
+
+		_measured_q = _q;
+		if (_noise > 0.0) {
+			boost::random::normal_distribution<double> distribution(0.0, _noise);
+			for (int i = 0; i < dof; ++i)
+				_measured_q(i) += distribution(_generator);
+		}
+
+		_updateKinematics();
+	}
+
+	double SimulatedSystem::getTime() const
+	{
+		return _time;
+	}
+
+	::Eigen::Vector3d SimulatedSystem::getContactForce() const
+	{
+		if (!_has_contact)
+			return ::Eigen::Vector3d::Zero();
+
+		const ::Eigen::Vector3d p_ee = _ee_pose.block(0, 3, 3, 1);
+		const double penetration = _contact_offset - _contact_normal.dot(p_ee);
+		if (penetration <= 0.0)
+			return ::Eigen::Vector3d::Zero();
+		return _contact_stiffness * penetration * _contact_normal;
+	}
+
+	void SimulatedSystem::_updateKinematics()
+	{
+		const int dof = getDof();
+		_link_poses.resize(dof + 1);
+		_link_poses[0] = ::Eigen::MatrixXd::Identity(4, 4);
+		for (int i = 0; i < dof; ++i) {
+			::Eigen::MatrixXd joint_transform = ::Eigen::MatrixXd::Identity(4, 4);
+			joint_transform.block(0, 0, 3, 3) = ::Eigen::AngleAxisd(_q(i), _joints[i].axis).toRotationMatrix();
+			joint_transform.block(0, 3, 3, 1) = _joints[i].offset;
+			_link_poses[i + 1] = _link_poses[i] * joint_transform;
+		}
+		_ee_pose = _link_poses[dof] * _tool_offset;
+	}
+
+	int SimulatedSystem::getDof() const
+	{
+		return (int)_joints.size();
+	}
+
+	::Eigen::MatrixXd SimulatedSystem::getJointConfiguration() const
+	{
+		return _measured_q;
+	}
+
+	::Eigen::MatrixXd SimulatedSystem::getJointVelocity() const
+	{
+		return _qd;
+	}
+
+	::Eigen::MatrixXd SimulatedSystem::getForceTorqueMeasurement(const int& port) const
+	{
+		::Eigen::MatrixXd wrench;
+		readForceTorqueMeasurement(port, wrench);
+		return wrench;
+	}
+
+	::Eigen::MatrixXd SimulatedSystem::getFramePose(const std::string& frame_id) const
+	{
+		::Eigen::MatrixXd pose;
+		readFramePose(frame_id, pose);
+		return pose;
+	}
+
+	void SimulatedSystem::readJointConfiguration(::Eigen::MatrixXd& q) const
+	{
+		q = _measured_q;
+	}
+
+	void SimulatedSystem::readJointVelocity(::Eigen::MatrixXd& qd) const
+	{
+		qd = _qd;
+	}
+
+	void SimulatedSystem::readForceTorqueMeasurement(const int& port, ::Eigen::MatrixXd& wrench) const
+	{
+		// the sensor sits in the EE frame, the contact point is its origin
+		wrench.setZero(6, 1);
+		wrench.topRows<3>().noalias() = _ee_pose.topLeftCorner<3, 3>().transpose() * getContactForce();
+	}
+
+	void SimulatedSystem::readFramePose(const std::string& frame_id, ::Eigen::MatrixXd& pose) const
+	{
+		if (frame_id == "EE") {
+			pose = _ee_pose;
+			return;
+		}
+		if (frame_id == "base") {
+			pose = _link_poses[0];
+			return;
+		}
+
+		std::map<std::string, Frame>::const_iterator it = _frames.find(frame_id);
+		if (it != _frames.end()) {
+			pose.noalias() = _link_poses[it->second.joint + 1] * it->second.offset;
+			return;
+		}
+
+		if (frame_id.compare(0, 5, "link_") == 0) {
+			std::istringstream ss(frame_id.substr(5));
+			int joint;
+			if (ss >> joint && ss.eof() && joint >= 0 && joint < getDof()) {
+				pose = _link_poses[joint + 1];
+				return;
+			}
+		}
+
+		HA_THROW_ERROR("SimulatedSystem.getFramePose", "Unknown frame " << frame_id);
+	}
+
+}
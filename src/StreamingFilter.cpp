@@ -0,0 +1,317 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/StreamingFilter.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ha
+{
+	const double StreamingFilter::SAMPLE_PERIOD_TOLERANCE = 0.05;
+
+	StreamingFilter::StreamingFilter()
+		: _type(LOW_PASS), _time_constant(0.0), _cutoff_frequency(0.0), _window_size(1),
+		_has_value(false), _channels(0),
+		_dt(0.0), _b0(1.0), _b1(0.0), _b2(0.0), _a1(0.0), _a2(0.0),
+		_samples(0), _next(0)
+	{
+	}
+
+	StreamingFilter::~StreamingFilter()
+	{
+	}
+
+	std::string StreamingFilter::typeToString(Type type)
+	{
+		switch (type) {
+			case LOW_PASS: return "low_pass";
+			case BUTTERWORTH: return "butterworth";
+			case MEDIAN: return "median";
+			case WINDOW_MIN: return "min";
+			case WINDOW_MAX: return "max";
+			case WINDOW_MEAN: return "mean";
+		}
+		HA_THROW_ERROR("StreamingFilter.typeToString", "Unknown filter type " << type << "!");
+	}
+
+	StreamingFilter::Type StreamingFilter::typeFromString(const std::string& name)
+	{
+		if (name == "low_pass") return LOW_PASS;
+		if (name == "butterworth") return BUTTERWORTH;
+		if (name == "median") return MEDIAN;
+		if (name == "min") return WINDOW_MIN;
+		if (name == "max") return WINDOW_MAX;
+		if (name == "mean") return WINDOW_MEAN;
+		HA_THROW_ERROR("StreamingFilter.typeFromString", "Unknown filter '" << name << "' - use low_pass, butterworth, median, min, max or mean!");
+	}
+
+	void StreamingFilter::setType(Type type)
+	{
+		if (type != _type)
+			_has_value = false;
+		_type = type;
+	}
+
+	StreamingFilter::Type StreamingFilter::getType() const
+	{
+		return _type;
+	}
+
+	void StreamingFilter::setTimeConstant(double time_constant)
+	{
+		if (time_constant < 0.0)
+			HA_THROW_ERROR("StreamingFilter.setTimeConstant", "Time constant must not be negative, got " << time_constant << "!");
+		_time_constant = time_constant;
+	}
+
+	double StreamingFilter::getTimeConstant() const
+	{
+		return _time_constant;
+	}
+
+	void StreamingFilter::setCutoffFrequency(double cutoff_frequency)
+	{
+		if (cutoff_frequency < 0.0)
+			HA_THROW_ERROR("StreamingFilter.setCutoffFrequency", "Cutoff frequency must not be negative, got " << cutoff_frequency << "!");
+		_cutoff_frequency = cutoff_frequency;
+		// recompute the coefficients with the next sample
+		_dt = -1.0;
+	}
+
+	double StreamingFilter::getCutoffFrequency() const
+	{
+		return _cutoff_frequency;
+	}
+
+	void StreamingFilter::setWindowSize(int window_size)
+	{
+		if (window_size < 1)
+			HA_THROW_ERROR("StreamingFilter.setWindowSize", "Window size must be at least 1, got " << window_size << "!");
+		if (window_size != _window_size)
+			_has_value = false;
+		_window_size = window_size;
+	}
+
+	int StreamingFilter::getWindowSize() const
+	{
+		return _window_size;
+	}
+
+	bool StreamingFilter::hasValue() const
+	{
+		return _has_value;
+	}
+
+	const ::Eigen::MatrixXd& StreamingFilter::getValue() const
+	{
+		return _value;
+	}
+
+	void StreamingFilter::reset(const ::Eigen::MatrixXd& x)
+	{
+		_channels = static_cast<int>(x.size());
+		_value = x;
+		_has_value = true;
+		_samples = 0;
+		_next = 0;
+
+		switch (_type) {
+			case LOW_PASS:
+				break;
+			case BUTTERWORTH:
+				// the state is set to the steady state of x once the sample period is known
+				_dt = 0.0;
+				_z1.resize(_channels);
+				_z2.resize(_channels);
+				break;
+			case MEDIAN:
+				_window.resize(_channels, _window_size);
+				_sorted.resize(_window_size);
+				_push(x);
+				break;
+			case WINDOW_MEAN:
+				_window.resize(_channels, _window_size);
+				_sum.setZero(_channels);
+				_push(x);
+				break;
+			case WINDOW_MIN:
+			case WINDOW_MAX:
+				_queue_values.resize(_channels, _window_size);
+				_queue_samples.assign(_channels * _window_size, 0);
+				_queue_front.assign(_channels, 0);
+				_queue_size.assign(_channels, 0);
+				_push(x);
+				break;
+		}
+	}
+
+	void StreamingFilter::update(const ::Eigen::MatrixXd& x, double dt)
+	{
+		if (!_has_value || x.rows() != _value.rows() || x.cols() != _value.cols()) {
+			reset(x);
+			return;
+		}
+		if (dt <= 0.0)
+			return;
+
+		switch (_type) {
+			case LOW_PASS: {
+				const double alpha = (_time_constant > 0.0) ? 1.0 - exp(-dt / _time_constant) : 1.0;
+				_value += alpha * (x - _value);
+				break;
+			}
+			case BUTTERWORTH: {
+				::Eigen::Map< ::Eigen::ArrayXd> y(_value.data(), _channels);
+				const ::Eigen::Map<const ::Eigen::ArrayXd> u(x.data(), _channels);
+				// small jitter of the sample period keeps the coefficients, tan() is only evaluated when it changes noticeably
+				if (_dt <= 0.0 || fabs(dt - _dt) > SAMPLE_PERIOD_TOLERANCE * _dt)
+					_updateCoefficients(dt);
+				y = _b0 * u + _z1;
+				_z1 = _b1 * u - _a1 * y + _z2;
+				_z2 = _b2 * u - _a2 * y;
+				break;
+			}
+			case MEDIAN:
+			case WINDOW_MIN:
+			case WINDOW_MAX:
+			case WINDOW_MEAN:
+				_push(x);
+				break;
+		}
+	}
+
+	void StreamingFilter::_updateCoefficients(double dt)
+	{
+		_dt = dt;
+
+		if (_cutoff_frequency <= 0.0 || _cutoff_frequency * dt >= 0.5) {
+			// at or above the Nyquist frequency (or without cutoff) the filter passes its input through
+			_b0 = 1.0;
+			_b1 = _b2 = _a1 = _a2 = 0.0;
+		} else {
+			// bilinear transform of the analog second order Butterworth filter (with prewarping)
+			const double pi = 3.14159265358979323846;
+			const double sqrt2 = 1.41421356237309504880;
+			const double k = tan(pi * _cutoff_frequency * dt);
+			const double k2 = k * k;
+			const double norm = 1.0 / (1.0 + sqrt2 * k + k2);
+			_b0 = k2 * norm;
+			_b1 = 2.0 * _b0;
+			_b2 = _b0;
+			_a1 = 2.0 * (k2 - 1.0) * norm;
+			_a2 = (1.0 - sqrt2 * k + k2) * norm;
+		}
+
+		// The state of the old coefficients does not fit the new ones (e.g. after a gap that passed the
+		// input through): continue from the steady state of the current output.
+		const ::Eigen::Map<const ::Eigen::ArrayXd> y(_value.data(), _channels);
+		_z1 = (1.0 - _b0) * y;
+		_z2 = (_b2 - _a2) * y;
+	}
+
+	void StreamingFilter::_push(const ::Eigen::MatrixXd& x)
+	{
+		const ::Eigen::Map<const ::Eigen::VectorXd> sample(x.data(), _channels);
+		const int count = static_cast<int>(std::min<unsigned long long>(_samples + 1, _window_size));
+
+		switch (_type) {
+			case MEDIAN: {
+				_window.col(_next) = sample;
+				// until the window is full only its first count columns are used
+				const int middle = count / 2;
+				for (int c = 0; c < _channels; c++) {
+					_sorted.head(count) = _window.row(c).head(count).transpose();
+					double* begin = _sorted.data();
+					std::nth_element(begin, begin + middle, begin + count);
+					double median = _sorted(middle);
+					if (count % 2 == 0)
+						median = 0.5 * (median + *std::max_element(begin, begin + middle));
+					_value(c) = median;
+				}
+				break;
+			}
+			case WINDOW_MEAN: {
+				if (_samples >= static_cast<unsigned long long>(_window_size))
+					_sum -= _window.col(_next);
+				_window.col(_next) = sample;
+				_sum += sample;
+				// sum up the window again once per turn so that rounding errors do not accumulate
+				if (_next == _window_size - 1)
+					_sum.noalias() = _window.rowwise().sum();
+				for (int c = 0; c < _channels; c++)
+					_value(c) = _sum(c) / count;
+				break;
+			}
+			case WINDOW_MIN:
+			case WINDOW_MAX:
+				_pushToQueues(x);
+				break;
+			default:
+				break;
+		}
+
+		_next = (_next + 1) % _window_size;
+		_samples++;
+	}
+
+	void StreamingFilter::_pushToQueues(const ::Eigen::MatrixXd& x)
+	{
+		// Every channel keeps the samples of the window that can still become its extremum: their values
+		// are monotonic from the front (the current extremum) to the back (the newest sample).
+		const bool minimum = (_type == WINDOW_MIN);
+		const int n = _window_size;
+
+		for (int c = 0; c < _channels; c++) {
+			const double v = x(c);
+			int& front = _queue_front[c];
+			int& size = _queue_size[c];
+			unsigned long long* samples = &_queue_samples[c * n];
+
+			// drop the sample that leaves the window
+			if (size > 0 && samples[front] + n <= _samples) {
+				front = (front + 1) % n;
+				size--;
+			}
+
+			// drop the samples that can never be the extremum again
+			while (size > 0) {
+				const double back = _queue_values(c, (front + size - 1) % n);
+				if (minimum ? (back < v) : (back > v))
+					break;
+				size--;
+			}
+
+			const int slot = (front + size) % n;
+			_queue_values(c, slot) = v;
+			samples[slot] = _samples;
+			size++;
+
+			_value(c) = _queue_values(c, front);
+		}
+	}
+
+}
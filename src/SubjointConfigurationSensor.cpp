@@ -45,14 +45,29 @@ namespace ha
 
     ::Eigen::MatrixXd SubjointConfigurationSensor::getCurrentValue() const
 	{
-        ::Eigen::MatrixXd cfg = this->_system->getJointConfiguration();
-        ::Eigen::MatrixXd subcfg(_index.size(), 1);
-        for(size_t i=0; i< _index.size(); i++)
-            subcfg(i) = cfg(_index[i]);
-
+        ::Eigen::MatrixXd subcfg;
+        this->readCurrentValue(subcfg);
         return subcfg;
 	}
 
+	void SubjointConfigurationSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readJointConfiguration(_joints);
+		value.resize(_index.size(), 1);
+		for(size_t i=0; i< _index.size(); i++)
+			value(i) = _joints(_index[i]);
+	}
+
+	void SubjointConfigurationSensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void SubjointConfigurationSensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
     DescriptionTreeNode::Ptr SubjointConfigurationSensor::serialize(const DescriptionTree::ConstPtr& factory) const
 	{
 		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
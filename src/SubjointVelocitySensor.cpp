@@ -45,14 +45,29 @@ namespace ha
 
     ::Eigen::MatrixXd SubjointVelocitySensor::getCurrentValue() const
 	{
-        ::Eigen::MatrixXd cfg = this->_system->getJointVelocity();
-        ::Eigen::MatrixXd subcfg(_index.size(), 1);
-        for(size_t i=0; i< _index.size(); i++)
-            subcfg(i) = cfg(_index[i]);
-
+        ::Eigen::MatrixXd subcfg;
+        this->readCurrentValue(subcfg);
         return subcfg;
 	}
 
+	void SubjointVelocitySensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_system->readJointVelocity(_joints);
+		value.resize(_index.size(), 1);
+		for(size_t i=0; i< _index.size(); i++)
+			value(i) = _joints(_index[i]);
+	}
+
+	void SubjointVelocitySensor::readRelativeCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		this->_readDifferenceToInitialValue(value);
+	}
+
+	void SubjointVelocitySensor::readInitialValue(::Eigen::MatrixXd& value) const
+	{
+		value = this->_initial_sensor_value;
+	}
+
     DescriptionTreeNode::Ptr SubjointVelocitySensor::serialize(const DescriptionTree::ConstPtr& factory) const
 	{
 		DescriptionTreeNode::Ptr tree = factory->createNode("Sensor");
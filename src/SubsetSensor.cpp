@@ -0,0 +1,106 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/SubsetSensor.h"
+
+#include <cmath>
+
+namespace ha
+{
+	HA_SENSOR_REGISTER("SubsetSensor", SubsetSensor);
+
+	SubsetSensor::SubsetSensor()
+	{
+	}
+
+	SubsetSensor::~SubsetSensor()
+	{
+	}
+
+	SubsetSensor::SubsetSensor(const SubsetSensor& ss)
+		: DerivedSensor(ss), _index(ss._index)
+	{
+	}
+
+	void SubsetSensor::setIndex(const std::vector<int>& index)
+	{
+		for (std::size_t i = 0; i < index.size(); i++) {
+			if (index[i] < 0)
+				HA_THROW_ERROR("SubsetSensor.setIndex", "Negative index " << index[i] << "!");
+		}
+		_index = index;
+	}
+
+	std::vector<int> SubsetSensor::getIndex() const
+	{
+		return _index;
+	}
+
+	void SubsetSensor::readCurrentValue(::Eigen::MatrixXd& value) const
+	{
+		const ::Eigen::MatrixXd& x = _readOperand(0);
+
+		value.resize(_index.size(), 1);
+		for (std::size_t i = 0; i < _index.size(); i++) {
+			if (_index[i] >= x.size())
+				HA_THROW_ERROR("SubsetSensor.readCurrentValue", "Index " << _index[i] << " out of range - operand has " << x.size() << " entries!");
+			value(i) = x(_index[i]);
+		}
+	}
+
+	std::size_t SubsetSensor::_getMinOperands() const
+	{
+		return 1;
+	}
+
+	std::size_t SubsetSensor::_getMaxOperands() const
+	{
+		return 1;
+	}
+
+	void SubsetSensor::_serializeAttributes(const DescriptionTreeNode::Ptr& tree) const
+	{
+		::Eigen::MatrixXd index_mat(_index.size(), 1);
+		for (std::size_t i = 0; i < _index.size(); i++)
+			index_mat(i) = _index[i];
+		tree->setAttribute< ::Eigen::MatrixXd>(std::string("index"), index_mat);
+	}
+
+	void SubsetSensor::_deserializeAttributes(const DescriptionTreeNode::ConstPtr& tree)
+	{
+		::Eigen::MatrixXd index_mat;
+		if (!tree->getAttribute< ::Eigen::MatrixXd>("index", index_mat))
+			HA_THROW_ERROR("SubsetSensor.deserialize", "This type of sensor needs a value 'index'!");
+
+		std::vector<int> index(index_mat.size());
+		for (std::size_t i = 0; i < index.size(); i++) {
+			if (fabs(index_mat(i) - floor(index_mat(i))) > 0.01)
+				HA_THROW_ERROR("SubsetSensor.deserialize", "Value in index not an integer - instead it's " << index_mat(i) << " !");
+			index[i] = (int)floor(index_mat(i));
+		}
+		setIndex(index);
+	}
+
+}
@@ -0,0 +1,798 @@
+/*
+ * Copyright 2015-2017, Robotics and Biology Lab, TU Berlin
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the 
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF 
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS 
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "hybrid_automaton/TraceRecorder.h"
+#include "hybrid_automaton/ControlMode.h"
+#include "hybrid_automaton/ControlSwitch.h"
+#include "hybrid_automaton/ExpressionCondition.h"
+#include "hybrid_automaton/JumpCondition.h"
+#include "hybrid_automaton/Sensor.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <boost/bind.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#ifdef _MSC_VER
+#define HA_THREAD_LOCAL __declspec(thread)
+#else
+#define HA_THREAD_LOCAL __thread
+#endif
+
+namespace ha {
+
+	namespace {
+
+		const char TRACE_MAGIC[8] = { 'H', 'A', 'T', 'R', 'A', 'C', 'E', 1 };
+
+		HA_THREAD_LOCAL TraceRecorder* current_recorder = NULL;
+
+		unsigned long long doubleToBits(double value)
+		{
+			unsigned long long bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		double bitsToDouble(unsigned long long bits)
+		{
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		// largest magnitude that still fits the zig-zag varint encoding after quantization
+		const double MAX_QUANTIZED = 4.0e18;
+	}
+
+	TraceRecorder::TickScope::TickScope(TraceRecorder* recorder, const double& t, const ControlMode* mode)
+		: _recorder(recorder)
+	{
+		if (_recorder) {
+			current_recorder = _recorder;
+			_recorder->beginTick(t, mode);
+		}
+	}
+
+	TraceRecorder::TickScope::~TickScope()
+	{
+		if (_recorder) {
+			_recorder->endTick();
+			current_recorder = NULL;
+		}
+	}
+
+	TraceRecorder* TraceRecorder::current()
+	{
+		return current_recorder;
+	}
+
+	TraceRecorder::TraceRecorder(std::size_t buffer_size, double quantum)
+		: _quantum(quantum), _head(0), _tail(0), _in_tick(false), _tick(0), _previous_time(0), _tick_time(0),
+		  _current_switch(NULL), _pending_drops(0), _recorded_ticks(0), _dropped_ticks(0), _file(NULL), _stop(false)
+	{
+		if (quantum <= 0.0)
+			HA_THROW_ERROR("TraceRecorder.TraceRecorder", "Quantum must be positive, not " << quantum);
+
+		// round up to a power of two so that positions can be masked
+		std::size_t size = 1024;
+		while (size < buffer_size)
+			size <<= 1;
+		_ring.resize(size);
+		_mask = size - 1;
+
+		_scratch.reserve(4096);
+		_defined_in_tick.reserve(64);
+		_channels.reserve(256);
+		_cached_channels.reserve(256);
+	}
+
+	TraceRecorder::~TraceRecorder()
+	{
+		close();
+	}
+
+	bool TraceRecorder::open(const std::string& filename, double flush_period)
+	{
+		close();
+
+		boost::mutex::scoped_lock lock(_file_mutex);
+		_file = std::fopen(filename.c_str(), "wb");
+		if (!_file) {
+			HA_ERROR("TraceRecorder.open", "Unable to open trace file " << filename);
+			return false;
+		}
+
+		// header: magic, version, quantum
+		std::fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), _file);
+		std::fwrite(&_quantum, sizeof(_quantum), 1, _file);
+
+		// a new file needs all channels to be defined again
+		for (std::vector<Channel>::iterator it = _channels.begin(); it != _channels.end(); ++it) {
+			it->defined = false;
+			it->keyframe = true;
+		}
+		_previous_time = 0;
+
+		if (flush_period > 0.0) {
+			_stop = false;
+			_writer.reset(new boost::thread(boost::bind(&TraceRecorder::_writerLoop, this, flush_period)));
+		}
+		return true;
+	}
+
+	void TraceRecorder::close()
+	{
+		if (_writer) {
+			_stop = true;
+			_writer->join();
+			_writer.reset();
+		}
+
+		flush();
+
+		boost::mutex::scoped_lock lock(_file_mutex);
+		if (_file) {
+			std::fclose(_file);
+			_file = NULL;
+		}
+	}
+
+	bool TraceRecorder::isOpen() const
+	{
+		return _file != NULL;
+	}
+
+	void TraceRecorder::flush()
+	{
+		boost::mutex::scoped_lock lock(_file_mutex);
+
+		const std::size_t tail = _tail.load(boost::memory_order_relaxed);
+		const std::size_t head = _head.load(boost::memory_order_acquire);
+		if (head == tail)
+			return;
+
+		if (_file) {
+			const std::size_t begin = tail & _mask;
+			const std::size_t length = head - tail;
+			const std::size_t first = std::min(length, _ring.size() - begin);
+			std::fwrite(&_ring[begin], 1, first, _file);
+			if (first < length)
+				std::fwrite(&_ring[0], 1, length - first, _file);
+			std::fflush(_file);
+		}
+
+		_tail.store(head, boost::memory_order_release);
+	}
+
+	void TraceRecorder::_writerLoop(double flush_period)
+	{
+		const boost::posix_time::microseconds period((long)(flush_period * 1e6));
+		while (!_stop) {
+			flush();
+			boost::this_thread::sleep(period);
+		}
+	}
+
+	double TraceRecorder::getQuantum() const
+	{
+		return _quantum;
+	}
+
+	unsigned long long TraceRecorder::getRecordedTicks() const
+	{
+		return _recorded_ticks.load(boost::memory_order_relaxed);
+	}
+
+	unsigned long long TraceRecorder::getDroppedTicks() const
+	{
+		return _dropped_ticks.load(boost::memory_order_relaxed);
+	}
+
+	void TraceRecorder::_put(unsigned char byte)
+	{
+		_scratch.push_back(byte);
+	}
+
+	void TraceRecorder::_putVarint(unsigned long long value)
+	{
+		while (value >= 0x80) {
+			_put((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		_put((unsigned char)value);
+	}
+
+	void TraceRecorder::_putZigZag(long long value)
+	{
+		_putVarint(((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+	}
+
+	void TraceRecorder::_putXor(unsigned long long bits, unsigned long long previous)
+	{
+		// header byte: 0 if unchanged, otherwise 0x80 | trailing zero bytes << 3 | (significant bytes - 1)
+		unsigned long long x = bits ^ previous;
+		if (x == 0) {
+			_put(0);
+			return;
+		}
+		int trailing = 0;
+		while ((x & 0xFF) == 0) {
+			x >>= 8;
+			++trailing;
+		}
+		int significant = 0;
+		for (unsigned long long y = x; y != 0; y >>= 8)
+			++significant;
+		_put((unsigned char)(0x80 | (trailing << 3) | (significant - 1)));
+		for (int i = 0; i < significant; ++i, x >>= 8)
+			_put((unsigned char)(x & 0xFF));
+	}
+
+	int TraceRecorder::_findChannel(ChannelKind kind, const void* key) const
+	{
+		// a handful of objects per mode: a linear search does not allocate
+		for (std::vector<CachedChannel>::const_iterator it = _cached_channels.begin(); it != _cached_channels.end(); ++it) {
+			if (it->key == key && it->kind == kind)
+				return it->id;
+		}
+		return -1;
+	}
+
+	int TraceRecorder::_channel(ChannelKind kind, const void* key, int parent, const std::string& name)
+	{
+		int id;
+		std::map<ChannelKey, int>::const_iterator it = _channel_ids.find(ChannelKey(kind, name));
+		if (it == _channel_ids.end()) {
+			id = _addChannel(kind, parent, name, QUANTIZED);
+			_channel_ids[ChannelKey(kind, name)] = id;
+		} else {
+			id = it->second;
+		}
+
+		CachedChannel cached;
+		cached.kind = kind;
+		cached.key = key;
+		cached.id = id;
+		_cached_channels.push_back(cached);
+		return id;
+	}
+
+	int TraceRecorder::_addChannel(ChannelKind kind, int parent, const std::string& name, Encoding encoding)
+	{
+		Channel channel;
+		channel.id = (int)_channels.size();
+		channel.kind = kind;
+		channel.encoding = encoding;
+		channel.parent = parent;
+		channel.name = name;
+		channel.defined = false;
+		channel.keyframe = true;
+		channel.last_tick = 0;
+		channel.rows = channel.cols = 0;
+		_channels.push_back(channel);
+		return channel.id;
+	}
+
+	int TraceRecorder::_modeChannel(const ControlMode* mode)
+	{
+		int id = _findChannel(MODE_CHANNEL, mode);
+		if (id < 0)
+			id = _channel(MODE_CHANNEL, mode, -1, mode->getName());
+		return id;
+	}
+
+	int TraceRecorder::_switchChannel(const ControlSwitch* control_switch)
+	{
+		int id = _findChannel(SWITCH_CHANNEL, control_switch);
+		if (id < 0)
+			id = _channel(SWITCH_CHANNEL, control_switch, -1, control_switch->getName());
+		return id;
+	}
+
+	int TraceRecorder::_sensorChannel(const ControlSwitch* control_switch, const JumpCondition* jump_condition, const Sensor* sensor)
+	{
+		// one channel per condition, even if conditions share their sensor
+		int id = _findChannel(SENSOR_CHANNEL, jump_condition);
+		if (id < 0) {
+			const int parent = control_switch ? _switchChannel(control_switch) : -1;
+			std::ostringstream name;
+			name << (control_switch ? control_switch->getName() : std::string("?")) << "/" << jump_condition->getPath() << "/" << sensor->getType();
+			id = _channel(SENSOR_CHANNEL, jump_condition, parent, name.str());
+		}
+		return id;
+	}
+
+	int TraceRecorder::_criterionChannel(const ControlSwitch* control_switch, const JumpCondition* jump_condition)
+	{
+		int id = _findChannel(CRITERION_CHANNEL, jump_condition);
+		if (id < 0) {
+			const int parent = control_switch ? _switchChannel(control_switch) : -1;
+			std::ostringstream name;
+			name << (control_switch ? control_switch->getName() : std::string("?")) << "/" << jump_condition->getPath();
+			id = _channel(CRITERION_CHANNEL, jump_condition, parent, name.str());
+		}
+		return id;
+	}
+
+	void TraceRecorder::registerControlMode(const ControlMode* mode)
+	{
+		// the objects of the previous mode may not exist anymore
+		_cached_channels.clear();
+		if (mode)
+			_modeChannel(mode);
+	}
+
+	void TraceRecorder::registerControlSwitch(ControlSwitch* control_switch, const ControlMode* target_mode)
+	{
+		const std::vector<JumpConditionPtr>& jump_conditions = control_switch->getJumpConditions();
+		_channels.reserve(_channels.size() + 2 * jump_conditions.size() + 2);
+
+		_switchChannel(control_switch);
+		if (target_mode)
+			_modeChannel(target_mode);
+
+		for (std::vector<JumpConditionPtr>::const_iterator it = jump_conditions.begin(); it != jump_conditions.end(); ++it)
+			_registerJumpCondition(control_switch, it->get());
+	}
+
+	void TraceRecorder::_registerJumpCondition(const ControlSwitch* control_switch, const JumpCondition* jump_condition)
+	{
+		// expressions record the values of their comparisons
+		const ExpressionCondition* expression = dynamic_cast<const ExpressionCondition*>(jump_condition);
+		if (expression) {
+			const std::vector<JumpConditionPtr>& comparisons = expression->getComparisons();
+			for (std::vector<JumpConditionPtr>::const_iterator it = comparisons.begin(); it != comparisons.end(); ++it)
+				_registerJumpCondition(control_switch, it->get());
+			return;
+		}
+
+		if (jump_condition->getSensor())
+			_sensorChannel(control_switch, jump_condition, jump_condition->getSensor().get());
+		_criterionChannel(control_switch, jump_condition);
+	}
+
+	void TraceRecorder::_define(Channel& channel)
+	{
+		if (channel.defined)
+			return;
+		if (channel.parent >= 0)
+			_define(_channels[channel.parent]);
+
+		// define: id, kind, encoding, parent + 1, name
+		_put(TAG_DEFINE);
+		_putVarint(channel.id);
+		_put((unsigned char)channel.kind);
+		_put((unsigned char)channel.encoding);
+		_putVarint(channel.parent + 1);
+		_putVarint(channel.name.size());
+		_scratch.insert(_scratch.end(), channel.name.begin(), channel.name.end());
+
+		channel.defined = true;
+		_defined_in_tick.push_back(channel.id);
+	}
+
+	void TraceRecorder::_encodeValue(Channel& channel, const double* data, int rows, int cols)
+	{
+		const int size = rows * cols;
+
+		bool lossless = (channel.encoding == LOSSLESS);
+		if (!lossless) {
+			for (int i = 0; i < size; ++i) {
+				if (!(boost::math::isfinite)(data[i]) || std::fabs(data[i] / _quantum) > MAX_QUANTIZED) {
+					lossless = true;
+					break;
+				}
+			}
+		}
+
+		// lossless records of quantized channels are always keyframes
+		const bool keyframe = channel.keyframe || rows != channel.rows || cols != channel.cols || (lossless && channel.encoding != LOSSLESS);
+		if (keyframe) {
+			channel.rows = rows;
+			channel.cols = cols;
+			// only allocates if the channel grows
+			channel.quantized.resize(size);
+			channel.bits.resize(size);
+		}
+
+		// value: channel, flags (1: keyframe, 2: lossless), [rows, cols], elements
+		_put(TAG_VALUE);
+		_putVarint(channel.id);
+		_put((unsigned char)((keyframe ? 1 : 0) | (lossless ? 2 : 0)));
+		if (keyframe) {
+			_putVarint(channel.rows);
+			_putVarint(channel.cols);
+		}
+
+		if (lossless) {
+			for (int i = 0; i < size; ++i) {
+				const unsigned long long bits = doubleToBits(data[i]);
+				_putXor(bits, keyframe ? 0ULL : channel.bits[i]);
+				channel.bits[i] = bits;
+			}
+			// quantized history is stale now
+			channel.keyframe = (channel.encoding != LOSSLESS);
+		} else {
+			for (int i = 0; i < size; ++i) {
+				const long long q = (long long)std::floor(data[i] / _quantum + 0.5);
+				_putZigZag(keyframe ? q : q - channel.quantized[i]);
+				channel.quantized[i] = q;
+			}
+			channel.keyframe = false;
+		}
+	}
+
+	void TraceRecorder::beginTick(const double& t, const ControlMode* mode)
+	{
+		if (!_file)
+			return;
+
+		_in_tick = true;
+		++_tick;
+		_scratch.clear();
+		_defined_in_tick.clear();
+		_current_switch = NULL;
+
+		const int mode_id = mode ? _modeChannel(mode) : -1;
+		if (mode_id >= 0)
+			_define(_channels[mode_id]);
+
+		// tick: time (XOR against previous tick), mode + 1
+		_tick_time = doubleToBits(t);
+		_put(TAG_TICK);
+		_putXor(_tick_time, _previous_time);
+		_putVarint(mode_id + 1);
+
+		if (_pending_drops > 0) {
+			_put(TAG_DROPPED);
+			_putVarint(_pending_drops);
+		}
+	}
+
+	void TraceRecorder::beginSwitch(ControlSwitch* control_switch)
+	{
+		_current_switch = control_switch;
+	}
+
+	void TraceRecorder::recordSensorValue(const JumpCondition* jump_condition, const Sensor* sensor, const ::Eigen::MatrixXd& value)
+	{
+		if (!_in_tick)
+			return;
+
+		const int id = _sensorChannel(_current_switch, jump_condition, sensor);
+
+		// a condition may read its sensor twice, it is recorded once per tick
+		Channel& channel = _channels[id];
+		if (channel.last_tick == _tick)
+			return;
+		channel.last_tick = _tick;
+
+		_define(channel);
+		_encodeValue(channel, value.data(), (int)value.rows(), (int)value.cols());
+	}
+
+	void TraceRecorder::recordCriterion(const JumpCondition* jump_condition, double criterion)
+	{
+		if (!_in_tick)
+			return;
+
+		const int id = _criterionChannel(_current_switch, jump_condition);
+
+		Channel& channel = _channels[id];
+		channel.last_tick = _tick;
+		_define(channel);
+
+		_encodeValue(channel, &criterion, 1, 1);
+	}
+
+	void TraceRecorder::recordTransition(const ControlSwitch* control_switch, const ControlMode* target_mode)
+	{
+		if (!_in_tick)
+			return;
+
+		const int switch_id = _switchChannel(control_switch);
+		const int mode_id = _modeChannel(target_mode);
+		_define(_channels[switch_id]);
+		_define(_channels[mode_id]);
+
+		// transition: switch, target mode
+		_put(TAG_TRANSITION);
+		_putVarint(switch_id);
+		_putVarint(mode_id);
+	}
+
+	void TraceRecorder::recordInitialize()
+	{
+		if (!_in_tick)
+			return;
+		_put(TAG_INITIALIZE);
+	}
+
+	void TraceRecorder::recordSystemValue(const std::string& name, const ::Eigen::MatrixXd& value)
+	{
+		if (!_in_tick)
+			return;
+
+		int id;
+		std::map<std::string, int>::const_iterator it = _system_channel_ids.find(name);
+		if (it == _system_channel_ids.end()) {
+			id = _addChannel(SYSTEM_CHANNEL, -1, name, LOSSLESS);
+			_system_channel_ids[name] = id;
+		} else {
+			id = it->second;
+		}
+
+		Channel& channel = _channels[id];
+		if (channel.last_tick == _tick)
+			return;
+		channel.last_tick = _tick;
+
+		_define(channel);
+		_encodeValue(channel, value.data(), (int)value.rows(), (int)value.cols());
+	}
+
+	void TraceRecorder::endTick()
+	{
+		if (!_in_tick)
+			return;
+		_in_tick = false;
+		_current_switch = NULL;
+		_commit();
+	}
+
+	void TraceRecorder::_commit()
+	{
+		const std::size_t head = _head.load(boost::memory_order_relaxed);
+		const std::size_t tail = _tail.load(boost::memory_order_acquire);
+		const std::size_t length = _scratch.size();
+
+		if (length > _ring.size() - (head - tail)) {
+			// drop the whole tick: everything encoded in it has to be repeated later
+			for (std::vector<int>::const_iterator it = _defined_in_tick.begin(); it != _defined_in_tick.end(); ++it)
+				_channels[*it].defined = false;
+			for (std::vector<Channel>::iterator it = _channels.begin(); it != _channels.end(); ++it)
+				it->keyframe = true;
+			++_pending_drops;
+			_dropped_ticks.store(_dropped_ticks.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+			return;
+		}
+
+		const std::size_t begin = head & _mask;
+		const std::size_t first = std::min(length, _ring.size() - begin);
+		std::memcpy(&_ring[begin], &_scratch[0], first);
+		if (first < length)
+			std::memcpy(&_ring[0], &_scratch[first], length - first);
+		_head.store(head + length, boost::memory_order_release);
+
+		_previous_time = _tick_time;
+		_pending_drops = 0;
+		_recorded_ticks.store(_recorded_ticks.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+	}
+
+	TraceReader::TraceReader()
+		: _quantum(1.0), _previous_time(0), _pending_tag(-1)
+	{
+	}
+
+	TraceReader::~TraceReader()
+	{
+	}
+
+	void TraceReader::open(const std::string& filename)
+	{
+		_file.close();
+		_file.clear();
+		_file.open(filename.c_str(), std::ios::in | std::ios::binary);
+		if (!_file.is_open())
+			HA_THROW_ERROR("TraceReader.open", "Unable to open trace file " << filename);
+
+		char magic[sizeof(TRACE_MAGIC)];
+		_file.read(magic, sizeof(magic));
+		if (!_file || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+			HA_THROW_ERROR("TraceReader.open", "Not a trace file or unsupported version: " << filename);
+
+		_file.read(reinterpret_cast<char*>(&_quantum), sizeof(_quantum));
+		if (!_file)
+			HA_THROW_ERROR("TraceReader.open", "Truncated trace file: " << filename);
+
+		_channels.clear();
+		_states.clear();
+		_previous_time = 0;
+		_pending_tag = -1;
+	}
+
+	int TraceReader::_get()
+	{
+		const int c = _file.get();
+		if (c == std::char_traits<char>::eof())
+			HA_THROW_ERROR("TraceReader.readTick", "Unexpected end of trace file");
+		return c;
+	}
+
+	unsigned long long TraceReader::_getVarint()
+	{
+		unsigned long long value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			const int c = _get();
+			value |= (unsigned long long)(c & 0x7F) << shift;
+			if (!(c & 0x80))
+				return value;
+		}
+		HA_THROW_ERROR("TraceReader.readTick", "Corrupt varint in trace file");
+	}
+
+	long long TraceReader::_getZigZag()
+	{
+		const unsigned long long value = _getVarint();
+		return (long long)(value >> 1) ^ -(long long)(value & 1);
+	}
+
+	unsigned long long TraceReader::_getXor(unsigned long long previous)
+	{
+		const int header = _get();
+		if (header == 0)
+			return previous;
+		const int trailing = (header >> 3) & 7;
+		const int significant = (header & 7) + 1;
+		unsigned long long x = 0;
+		for (int i = 0; i < significant; ++i)
+			x |= (unsigned long long)_get() << (8 * i);
+		return previous ^ (x << (8 * trailing));
+	}
+
+	void TraceReader::_readValue(Value& value)
+	{
+		value.channel = (int)_getVarint();
+		const int flags = _get();
+		const bool keyframe = (flags & 1) != 0;
+		const bool lossless = (flags & 2) != 0;
+
+		State& state = _states[value.channel];
+		if (keyframe) {
+			state.rows = (int)_getVarint();
+			state.cols = (int)_getVarint();
+			state.quantized.assign(state.rows * state.cols, 0);
+			state.bits.assign(state.rows * state.cols, 0);
+		} else if (state.quantized.empty() && state.rows * state.cols > 0) {
+			HA_THROW_ERROR("TraceReader.readTick", "Delta without keyframe in channel " << value.channel);
+		}
+
+		value.value.resize(state.rows, state.cols);
+		double* data = value.value.data();
+		const int size = state.rows * state.cols;
+		if (lossless) {
+			for (int i = 0; i < size; ++i) {
+				state.bits[i] = _getXor(state.bits[i]);
+				data[i] = bitsToDouble(state.bits[i]);
+			}
+		} else {
+			for (int i = 0; i < size; ++i) {
+				state.quantized[i] += _getZigZag();
+				data[i] = (double)state.quantized[i] * _quantum;
+			}
+		}
+	}
+
+	bool TraceReader::readTick(Tick& tick)
+	{
+		tick.values.clear();
+		tick.transitions.clear();
+		tick.dropped_before = 0;
+		tick.initialize = false;
+
+		bool in_tick = false;
+		for (;;) {
+			int tag = _pending_tag;
+			_pending_tag = -1;
+			if (tag < 0) {
+				tag = _file.get();
+				if (tag == std::char_traits<char>::eof())
+					return in_tick;
+			}
+
+			switch (tag) {
+			case TraceRecorder::TAG_TICK:
+				if (in_tick) {
+					_pending_tag = tag;
+					return true;
+				}
+				in_tick = true;
+				_previous_time = _getXor(_previous_time);
+				tick.time = bitsToDouble(_previous_time);
+				tick.mode = (int)_getVarint() - 1;
+				break;
+
+			case TraceRecorder::TAG_INITIALIZE:
+				tick.initialize = true;
+				break;
+
+			case TraceRecorder::TAG_DROPPED:
+				tick.dropped_before = _getVarint();
+				break;
+
+			case TraceRecorder::TAG_DEFINE: {
+				Channel channel;
+				channel.id = (int)_getVarint();
+				channel.kind = _get();
+				channel.encoding = _get();
+				channel.parent = (int)_getVarint() - 1;
+				const std::size_t length = (std::size_t)_getVarint();
+				channel.name.resize(length);
+				for (std::size_t i = 0; i < length; ++i)
+					channel.name[i] = (char)_get();
+				_channels[channel.id] = channel;
+				break;
+			}
+
+			case TraceRecorder::TAG_VALUE: {
+				tick.values.push_back(Value());
+				_readValue(tick.values.back());
+				break;
+			}
+
+			case TraceRecorder::TAG_TRANSITION: {
+				Transition transition;
+				transition.control_switch = (int)_getVarint();
+				transition.target_mode = (int)_getVarint();
+				tick.transitions.push_back(transition);
+				break;
+			}
+
+			default:
+				HA_THROW_ERROR("TraceReader.readTick", "Unknown record " << tag << " in trace file");
+			}
+		}
+	}
+
+	const std::map<int, TraceReader::Channel>& TraceReader::getChannels() const
+	{
+		return _channels;
+	}
+
+	int TraceReader::findChannel(int kind, const std::string& name) const
+	{
+		for (std::map<int, Channel>::const_iterator it = _channels.begin(); it != _channels.end(); ++it) {
+			if (it->second.kind == kind && it->second.name == name)
+				return it->first;
+		}
+		return -1;
+	}
+
+	std::string TraceReader::getChannelName(int id) const
+	{
+		std::map<int, Channel>::const_iterator it = _channels.find(id);
+		return (it == _channels.end()) ? std::string() : it->second.name;
+	}
+
+	double TraceReader::getQuantum() const
+	{
+		return _quantum;
+	}
+
+}
@@ -0,0 +1,449 @@
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/DescriptionTreeXML.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "hybrid_automaton/Replay.h"
+#include "hybrid_automaton/Profiler.h"
+#include "tests/AllocationTracker.h"
+
+#include <boost/thread/thread.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+// Runs a HybridAutomaton at a fixed rate on a dedicated thread and reports
+// tick latency percentiles, wake-up jitter, deadline misses, and the heap
+// allocations and page faults that happen inside HybridAutomaton::step().
+//
+// Linux only (clock_nanosleep, SCHED_FIFO, RUSAGE_THREAD, glibc malloc hooks).
+// Allocations are counted by the hooks of tests/AllocationTracker.cpp, like in the unit tests.
+
+using namespace ha;
+
+// ----------------------------------
+// Stand-ins for Controller and ControlSet types that are not compiled into
+// this executable (the robot specific ones). A stand-in controller is a joint
+// space PD controller if its goal matches the DOF of the system and outputs
+// zeros otherwise, so the automaton can be stepped without the real robot code.
+class StandInController : public Controller {
+public:
+    virtual void initialize() {
+        updateGoal();
+    }
+
+    virtual void terminate() {}
+
+    virtual ::Eigen::MatrixXd step(const double& t) {
+        const int dof = _system->getDof();
+        if (_absolute_goal.rows() != dof || _absolute_goal.cols() != 1)
+            return ::Eigen::MatrixXd::Zero(dof, 1);
+
+        ::Eigen::MatrixXd kp = ::Eigen::MatrixXd::Ones(dof, 1);
+        ::Eigen::MatrixXd kv = ::Eigen::MatrixXd::Zero(dof, 1);
+        if (_kp.rows() == dof && _kp.cols() == 1)
+            kp = _kp;
+        if (_kv.rows() == dof && _kv.cols() == 1)
+            kv = _kv;
+
+        return kp.cwiseProduct(_absolute_goal - _system->getJointConfiguration())
+            - kv.cwiseProduct(_system->getJointVelocity());
+    }
+
+    virtual ::Eigen::MatrixXd relativeGoalToAbsolute(const Eigen::MatrixXd& goalRel) const {
+        const ::Eigen::MatrixXd q = _system->getJointConfiguration();
+        if (goalRel.rows() != q.rows() || goalRel.cols() != q.cols())
+            return goalRel;
+        return q + goalRel;
+    }
+
+    virtual Controller* _doClone() const {
+        return new StandInController(*this);
+    }
+
+    static Controller::Ptr instance(const DescriptionTreeNode::ConstPtr node, const System::ConstPtr system, const HybridAutomaton* ha) {
+        Controller::Ptr controller(new StandInController);
+        controller->setSystem(system);
+        controller->deserialize(node, system, ha);
+        return controller;
+    }
+
+protected:
+    virtual void _updateAbsoluteGoal(const Eigen::MatrixXd& goal_abs) {
+        _absolute_goal = goal_abs;
+    }
+
+    ::Eigen::MatrixXd _absolute_goal;
+};
+
+class StandInControlSet : public ControlSet {
+public:
+    StandInControlSet(const System::ConstPtr& system) : _system(system) {}
+
+    virtual void initialize() {
+        for (std::map<std::string, Controller::Ptr>::iterator it = _controllers.begin(); it != _controllers.end(); ++it)
+            it->second->initialize();
+    }
+
+    virtual void terminate() {
+        for (std::map<std::string, Controller::Ptr>::iterator it = _controllers.begin(); it != _controllers.end(); ++it)
+            it->second->terminate();
+    }
+
+    virtual ::Eigen::MatrixXd step(const double& t) {
+        ::Eigen::MatrixXd output = ::Eigen::MatrixXd::Zero(_system->getDof(), 1);
+        for (std::map<std::string, Controller::Ptr>::iterator it = _controllers.begin(); it != _controllers.end(); ++it) {
+            const ::Eigen::MatrixXd u = it->second->step(t);
+            if (u.rows() == output.rows() && u.cols() == output.cols())
+                output += u;
+        }
+        return output;
+    }
+
+    virtual void switchControlSet(ControlSet::ConstPtr other_set) {}
+
+    static ControlSet::Ptr instance(const DescriptionTreeNode::ConstPtr node, const System::ConstPtr system, const HybridAutomaton* ha) {
+        ControlSet::Ptr control_set(new StandInControlSet(system));
+        control_set->deserialize(node, system, ha);
+        return control_set;
+    }
+
+protected:
+    virtual ControlSet* _doClone() const {
+        return new StandInControlSet(*this);
+    }
+
+    System::ConstPtr _system;
+};
+
+// register stand-ins for all controller and control set types of the tree that are unknown
+void registerStandIns(const DescriptionTreeNode::ConstPtr& node, std::set<std::string>& stand_ins) {
+    std::string type;
+    if (node->getType() == "Controller" && node->getAttribute<std::string>("type", type)
+            && !HybridAutomaton::isControllerRegistered(type)) {
+        HybridAutomaton::registerController(type, &StandInController::instance);
+        stand_ins.insert("Controller " + type);
+    } else if (node->getType() == "ControlSet" && node->getAttribute<std::string>("type", type)
+            && !HybridAutomaton::isControlSetRegistered(type)) {
+        HybridAutomaton::registerControlSet(type, &StandInControlSet::instance);
+        stand_ins.insert("ControlSet " + type);
+    }
+
+    DescriptionTreeNode::ConstNodeList children;
+    node->getChildrenNodes(children);
+    for (DescriptionTreeNode::ConstNodeList::const_iterator it = children.begin(); it != children.end(); ++it)
+        registerStandIns(*it, stand_ins);
+}
+
+std::string loadXMLFile(const char* filename) {
+    std::ifstream t(filename);
+    if (!t.good()) {
+        HA_THROW_ERROR("hybrid_automaton_jitter", "File not found: " << filename);
+    }
+    return std::string((std::istreambuf_iterator<char>(t)), std::istreambuf_iterator<char>());
+}
+
+// ----------------------------------
+struct Options {
+    Options()
+        : rate(1000.0), duration(10.0), warmup(1000), dof(7), fifo_priority(0), cpu(-1), lock_memory(false),
+          max_misses(0), allow_allocations(false), allow_page_faults(false) {}
+
+    double rate;
+    double duration;
+    unsigned long long warmup;
+    int dof;
+    std::string replay;
+    int fifo_priority;
+    int cpu;
+    bool lock_memory;
+    unsigned long long max_misses;
+    bool allow_allocations;
+    bool allow_page_faults;
+};
+
+struct Statistics {
+    Statistics()
+        : ticks(0), deadline_misses(0), allocations(0), ticks_with_allocations(0),
+          minor_faults(0), major_faults(0), realtime(false) {}
+
+    LatencyHistogram step;
+    LatencyHistogram wakeup;
+    unsigned long long ticks;
+    unsigned long long deadline_misses;
+    unsigned long long allocations;
+    unsigned long long ticks_with_allocations;
+    unsigned long long minor_faults;
+    unsigned long long major_faults;
+    bool realtime;
+    std::string error;
+};
+
+static inline unsigned long long monotonicNow() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline timespec toTimespec(unsigned long long ns) {
+    timespec ts;
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    return ts;
+}
+
+// touch the stack once so that it does not page fault later
+static void prefaultStack() {
+    volatile unsigned char stack[256 * 1024];
+    for (std::size_t i = 0; i < sizeof(stack); i += 4096)
+        stack[i] = 0;
+}
+
+struct ControlLoop {
+    const Options* options;
+    HybridAutomaton::Ptr automaton;
+    SimulatedSystem::Ptr simulated_system;
+    ReplaySystem::Ptr replay_system;
+    const Replay* replay;
+    Statistics* statistics;
+
+    void operator()() {
+        if (options->fifo_priority > 0) {
+            sched_param param;
+            param.sched_priority = options->fifo_priority;
+            int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (error != 0)
+                HA_WARN("hybrid_automaton_jitter", "Cannot switch to SCHED_FIFO: " << strerror(error));
+            else
+                statistics->realtime = true;
+        }
+
+        if (options->cpu >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(options->cpu, &cpus);
+            int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            if (error != 0)
+                HA_WARN("hybrid_automaton_jitter", "Cannot pin the control thread to CPU " << options->cpu << ": " << strerror(error));
+        }
+
+        prefaultStack();
+
+        try {
+            _run();
+        } catch (const std::string& error) {
+            statistics->error = error;
+        } catch (const std::exception& error) {
+            statistics->error = error.what();
+        }
+    }
+
+    void _run() {
+        const double period = 1.0 / options->rate;
+        const unsigned long long period_ns = (unsigned long long)(1e9 / options->rate);
+        const unsigned long long measured = (unsigned long long)(options->duration * options->rate);
+        const unsigned long long total = options->warmup + measured;
+        const std::vector<TraceReader::Tick>* ticks = replay ? &replay->getTicks() : NULL;
+
+        automaton->initialize(0.0);
+
+        unsigned long long deadline = monotonicNow() + period_ns;
+        for (unsigned long long i = 0; i < total; ++i) {
+            const timespec wake = toTimespec(deadline);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {}
+
+            const unsigned long long woken = monotonicNow();
+            const double t = (i + 1) * period;
+
+            rusage before, after;
+            getrusage(RUSAGE_THREAD, &before);
+
+            const unsigned long long allocations_before = testing::AllocationTracker::getThreadCounters().allocations;
+            const ::Eigen::MatrixXd output = automaton->step(t);
+            const unsigned long long allocations = testing::AllocationTracker::getThreadCounters().allocations - allocations_before;
+
+            const unsigned long long done = monotonicNow();
+            getrusage(RUSAGE_THREAD, &after);
+
+            if (i >= options->warmup) {
+                statistics->ticks++;
+                statistics->wakeup.record(woken - deadline);
+                statistics->step.record(done - woken);
+                statistics->allocations += allocations;
+                if (allocations > 0)
+                    statistics->ticks_with_allocations++;
+                statistics->minor_faults += after.ru_minflt - before.ru_minflt;
+                statistics->major_faults += after.ru_majflt - before.ru_majflt;
+                if (done > deadline + period_ns)
+                    statistics->deadline_misses++;
+            }
+
+            // advance the world - outside of the measured step
+            if (simulated_system)
+                simulated_system->integrate(output, period);
+            else if (replay_system && !ticks->empty())
+                replay_system->setValues((*ticks)[i % ticks->size()]);
+
+            deadline += period_ns;
+            // do not try to catch up on missed periods
+            const unsigned long long now = monotonicNow();
+            if (now > deadline)
+                deadline += ((now - deadline) / period_ns + 1) * period_ns;
+        }
+    }
+};
+
+void printRow(const char* name, const LatencyHistogram& h) {
+    std::cout << std::setw(8) << name << " "
+              << std::setw(9) << h.getMin() << " "
+              << std::setw(9) << h.getPercentile(50.0) << " "
+              << std::setw(9) << h.getPercentile(99.0) << " "
+              << std::setw(9) << h.getPercentile(99.9) << " "
+              << std::setw(9) << h.getPercentile(99.99) << " "
+              << std::setw(9) << h.getMax() << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) {
+        HA_ERROR("hybrid_automaton_jitter", "Usage: ./hybrid_automaton_jitter <xml file> [--rate <Hz>] [--duration <s>] [--warmup <ticks>] "
+                 "[--dof <n>] [--replay <trace>] [--fifo <priority>] [--cpu <n>] [--mlock] "
+                 "[--max-misses <n>] [--allow-allocations] [--allow-page-faults]");
+        return 1;
+    }
+
+    Options options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--rate" && i + 1 < argc)
+            options.rate = atof(argv[++i]);
+        else if (arg == "--duration" && i + 1 < argc)
+            options.duration = atof(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc)
+            options.warmup = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--dof" && i + 1 < argc)
+            options.dof = atoi(argv[++i]);
+        else if (arg == "--replay" && i + 1 < argc)
+            options.replay = argv[++i];
+        else if (arg == "--fifo" && i + 1 < argc)
+            options.fifo_priority = atoi(argv[++i]);
+        else if (arg == "--cpu" && i + 1 < argc)
+            options.cpu = atoi(argv[++i]);
+        else if (arg == "--mlock")
+            options.lock_memory = true;
+        else if (arg == "--max-misses" && i + 1 < argc)
+            options.max_misses = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--allow-allocations")
+            options.allow_allocations = true;
+        else if (arg == "--allow-page-faults")
+            options.allow_page_faults = true;
+        else {
+            HA_ERROR("hybrid_automaton_jitter", "Unknown argument: " << arg);
+            return 1;
+        }
+    }
+
+    if (options.rate <= 0.0 || options.duration <= 0.0) {
+        HA_ERROR("hybrid_automaton_jitter", "Rate and duration must be positive");
+        return 1;
+    }
+
+    Replay replay;
+    ReplaySystem::Ptr replay_system;
+    SimulatedSystem::Ptr simulated_system;
+    System::Ptr system;
+    HybridAutomaton::Ptr automaton(new HybridAutomaton);
+    std::set<std::string> stand_ins;
+
+    try {
+        if (!options.replay.empty()) {
+            replay.load(options.replay);
+            if (replay.getNumberOfTicks() == 0) {
+                HA_ERROR("hybrid_automaton_jitter", "Trace " << options.replay << " contains no ticks");
+                return 1;
+            }
+            replay_system = replay.createSystem();
+            system = replay_system;
+        } else {
+            simulated_system.reset(new SimulatedSystem(options.dof));
+            system = simulated_system;
+        }
+
+        DescriptionTreeXML tree(loadXMLFile(argv[1]));
+        registerStandIns(tree.getRootNode(), stand_ins);
+        automaton->deserialize(tree.getRootNode(), system);
+    } catch (const std::string& error) {
+        HA_ERROR("hybrid_automaton_jitter", error);
+        return 1;
+    }
+
+    if (options.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        HA_WARN("hybrid_automaton_jitter", "mlockall failed: " << strerror(errno));
+
+    Statistics statistics;
+    ControlLoop loop;
+    loop.options = &options;
+    loop.automaton = automaton;
+    loop.simulated_system = simulated_system;
+    loop.replay_system = replay_system;
+    loop.replay = options.replay.empty() ? NULL : &replay;
+    loop.statistics = &statistics;
+
+    boost::thread control_thread(loop);
+    control_thread.join();
+
+    if (!statistics.error.empty()) {
+        HA_ERROR("hybrid_automaton_jitter", "Automaton failed: " << statistics.error);
+        return 1;
+    }
+
+    const double period_ns = 1e9 / options.rate;
+
+    std::cout << "automaton: " << argv[1] << std::endl;
+    std::cout << "system:    " << (options.replay.empty() ? "simulated" : "replay of " + options.replay) << std::endl;
+    for (std::set<std::string>::const_iterator it = stand_ins.begin(); it != stand_ins.end(); ++it)
+        std::cout << "stand-in:  " << *it << std::endl;
+    std::cout << "rate:      " << options.rate << " Hz (" << (unsigned long long)period_ns << " ns), "
+              << statistics.ticks << " ticks after " << options.warmup << " warm-up ticks" << std::endl;
+    std::cout << "scheduler: " << (statistics.realtime ? "SCHED_FIFO" : "SCHED_OTHER")
+              << (options.lock_memory ? ", memory locked" : "")
+              << (options.cpu >= 0 ? ", pinned" : "") << std::endl << std::endl;
+
+    std::cout << "   in ns       min       p50       p99     p99.9    p99.99       max" << std::endl;
+    printRow("step", statistics.step);
+    printRow("wake-up", statistics.wakeup);
+    std::cout << std::endl;
+
+    std::cout << "max jitter:      " << statistics.wakeup.getMax() << " ns" << std::endl;
+    std::cout << "deadline misses: " << statistics.deadline_misses << std::endl;
+    std::cout << "allocations:     " << statistics.allocations << " in " << statistics.ticks_with_allocations << " ticks" << std::endl;
+    std::cout << "page faults:     " << statistics.minor_faults << " minor, " << statistics.major_faults << " major" << std::endl;
+
+    bool passed = true;
+    if (statistics.deadline_misses > options.max_misses) {
+        std::cout << "FAILED: " << statistics.deadline_misses << " deadline misses (allowed: " << options.max_misses << ")" << std::endl;
+        passed = false;
+    }
+    if (!options.allow_allocations && statistics.allocations > 0) {
+        std::cout << "FAILED: step() allocates on the heap" << std::endl;
+        passed = false;
+    }
+    if (!options.allow_page_faults && statistics.minor_faults + statistics.major_faults > 0) {
+        std::cout << "FAILED: step() causes page faults" << std::endl;
+        passed = false;
+    }
+
+    return passed ? 0 : 2;
+}
@@ -0,0 +1,184 @@
+#include "hybrid_automaton/error_handling.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <stdlib.h>
+
+// Prints a flame-style breakdown of a profile written by ha::Profiler::dump()
+
+struct ProfileNode {
+    int id;
+    int parent;
+    unsigned long long count;
+    double total, min, p50, p90, p99, p999, max;
+    std::string label;
+    std::vector<int> children;
+};
+
+struct ProfileOverrun {
+    unsigned long long tick;
+    double duration;
+    int culprit;
+};
+
+struct Profile {
+    double ticks;
+    double tick_budget;
+    unsigned long long num_overruns;
+    std::map<int, ProfileNode> nodes;
+    std::vector<int> roots;
+    std::vector<ProfileOverrun> overruns;
+};
+
+bool loadProfile(const char* filename, Profile& profile) {
+    std::ifstream file(filename);
+    if (!file.good()) {
+        HA_ERROR("hybrid_automaton_profile", "File not found: " << filename);
+        return false;
+    }
+
+    profile.ticks = 0;
+    profile.tick_budget = 0;
+    profile.num_overruns = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        ss.imbue(std::locale("C"));
+        std::string key;
+        ss >> key;
+
+        if (key == "ticks") {
+            ss >> profile.ticks;
+        } else if (key == "tick_budget") {
+            ss >> profile.tick_budget;
+        } else if (key == "overruns") {
+            ss >> profile.num_overruns;
+        } else if (key == "node") {
+            ProfileNode n;
+            ss >> n.id >> n.parent >> n.count >> n.total >> n.min >> n.p50 >> n.p90 >> n.p99 >> n.p999 >> n.max;
+            std::getline(ss >> std::ws, n.label);
+            profile.nodes[n.id] = n;
+            if (profile.nodes.find(n.parent) != profile.nodes.end())
+                profile.nodes[n.parent].children.push_back(n.id);
+            else
+                profile.roots.push_back(n.id);
+        } else if (key == "overrun") {
+            ProfileOverrun o;
+            ss >> o.tick >> o.duration >> o.culprit;
+            profile.overruns.push_back(o);
+        }
+    }
+    return true;
+}
+
+double selfTime(const Profile& profile, const ProfileNode& n) {
+    double self = n.total;
+    for (std::vector<int>::const_iterator it = n.children.begin(); it != n.children.end(); ++it)
+        self -= profile.nodes.find(*it)->second.total;
+    return (self > 0.0) ? self : 0.0;
+}
+
+std::string path(const Profile& profile, int id) {
+    std::map<int, ProfileNode>::const_iterator it = profile.nodes.find(id);
+    if (it == profile.nodes.end())
+        return "?";
+    std::string p = it->second.label;
+    for (it = profile.nodes.find(it->second.parent); it != profile.nodes.end(); it = profile.nodes.find(it->second.parent))
+        p = it->second.label + ";" + p;
+    return p;
+}
+
+void printNode(const Profile& profile, int id, int depth, double reference, double min_percent) {
+    const ProfileNode& n = profile.nodes.find(id)->second;
+    const double percent = (reference > 0.0) ? 100.0 * n.total / reference : 0.0;
+    if (percent < min_percent)
+        return;
+
+    const int width = 20;
+    const int filled = (int)(percent / 100.0 * width + 0.5);
+
+    std::cout << std::fixed << std::setprecision(1) << std::setw(6) << percent << "% "
+              << std::setw(6) << ((n.total > 0.0) ? 100.0 * selfTime(profile, n) / n.total : 0.0) << "% "
+              << "[" << std::string(std::min(filled, width), '#') << std::string(width - std::min(filled, width), ' ') << "] "
+              << std::setw(10) << n.count << " "
+              << std::setprecision(0)
+              << std::setw(9) << ((n.count > 0) ? n.total / n.count : 0.0) << " "
+              << std::setw(9) << n.p50 << " "
+              << std::setw(9) << n.p99 << " "
+              << std::setw(9) << n.max << "  "
+              << std::string(2 * depth, ' ') << n.label << std::endl;
+
+    for (std::vector<int>::const_iterator it = n.children.begin(); it != n.children.end(); ++it)
+        printNode(profile, *it, depth + 1, reference, min_percent);
+}
+
+void printCollapsed(const Profile& profile) {
+    for (std::map<int, ProfileNode>::const_iterator it = profile.nodes.begin(); it != profile.nodes.end(); ++it) {
+        const double self = selfTime(profile, it->second);
+        if (self > 0.0)
+            std::cout << path(profile, it->first) << " " << (unsigned long long)self << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) {
+        HA_ERROR("hybrid_automaton_profile", "Usage: ./hybrid_automaton_profile <profile file> [--collapsed] [--min-percent <p>]");
+        return 1;
+    }
+
+    bool collapsed = false;
+    double min_percent = 0.0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--collapsed")
+            collapsed = true;
+        else if (arg == "--min-percent" && i + 1 < argc)
+            min_percent = atof(argv[++i]);
+        else {
+            HA_ERROR("hybrid_automaton_profile", "Unknown argument: " << arg);
+            return 1;
+        }
+    }
+
+    Profile profile;
+    if (!loadProfile(argv[1], profile))
+        return 1;
+
+    // folded stacks for flamegraph.pl
+    if (collapsed) {
+        printCollapsed(profile);
+        return 0;
+    }
+
+    std::cout << "ticks: " << (unsigned long long)profile.ticks;
+    if (profile.tick_budget > 0.0)
+        std::cout << ", budget: " << profile.tick_budget << " ns, overruns: " << profile.num_overruns;
+    std::cout << std::endl << std::endl;
+
+    std::cout << " total    self  " << std::string(22, ' ')
+              << "     calls   mean/ns    p50/ns    p99/ns    max/ns  scope" << std::endl;
+    for (std::vector<int>::const_iterator it = profile.roots.begin(); it != profile.roots.end(); ++it)
+        printNode(profile, *it, 0, profile.nodes[*it].total, min_percent);
+
+    if (!profile.overruns.empty()) {
+        std::cout << std::endl << "last " << profile.overruns.size() << " overruns (tick, duration, most expensive path):" << std::endl;
+        for (std::vector<ProfileOverrun>::const_iterator it = profile.overruns.begin(); it != profile.overruns.end(); ++it) {
+            std::cout << std::setw(10) << it->tick << " " << std::fixed << std::setprecision(0) << std::setw(9) << it->duration
+                      << " ns  " << path(profile, it->culprit) << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "hybrid_automaton/TraceRecorder.h"
+#include "hybrid_automaton/error_handling.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+// Prints a trace written by ha::TraceRecorder as text, one line per tick and channel
+
+const char* kindName(int kind) {
+    switch (kind) {
+    case ha::TraceRecorder::MODE_CHANNEL: return "mode";
+    case ha::TraceRecorder::SWITCH_CHANNEL: return "switch";
+    case ha::TraceRecorder::SENSOR_CHANNEL: return "sensor";
+    case ha::TraceRecorder::CRITERION_CHANNEL: return "criterion";
+    case ha::TraceRecorder::SYSTEM_CHANNEL: return "system";
+    }
+    return "?";
+}
+
+void printValue(const Eigen::MatrixXd& value) {
+    std::cout << "[";
+    for (int i = 0; i < value.rows(); ++i) {
+        if (i > 0)
+            std::cout << "; ";
+        for (int j = 0; j < value.cols(); ++j)
+            std::cout << (j > 0 ? " " : "") << value(i, j);
+    }
+    std::cout << "]";
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) {
+        HA_ERROR("hybrid_automaton_trace", "Usage: ./hybrid_automaton_trace <trace file> [--channels]");
+        return 1;
+    }
+
+    bool channels_only = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--channels")
+            channels_only = true;
+        else {
+            HA_ERROR("hybrid_automaton_trace", "Unknown argument: " << arg);
+            return 1;
+        }
+    }
+
+    ha::TraceReader reader;
+    ha::TraceReader::Tick tick;
+    unsigned long long ticks = 0, dropped = 0;
+    try {
+        reader.open(argv[1]);
+        while (reader.readTick(tick)) {
+            ++ticks;
+            dropped += tick.dropped_before;
+            if (channels_only)
+                continue;
+
+            if (tick.dropped_before > 0)
+                std::cout << "# " << tick.dropped_before << " ticks dropped" << std::endl;
+
+            std::cout << tick.time << " " << reader.getChannelName(tick.mode) << (tick.initialize ? " (initialize)" : "") << std::endl;
+            for (std::vector<ha::TraceReader::Value>::const_iterator it = tick.values.begin(); it != tick.values.end(); ++it) {
+                std::cout << "    " << reader.getChannelName(it->channel) << " ";
+                printValue(it->value);
+                std::cout << std::endl;
+            }
+            for (std::vector<ha::TraceReader::Transition>::const_iterator it = tick.transitions.begin(); it != tick.transitions.end(); ++it)
+                std::cout << "    " << reader.getChannelName(it->control_switch) << " -> " << reader.getChannelName(it->target_mode) << std::endl;
+        }
+    } catch (const std::string& error) {
+        HA_ERROR("hybrid_automaton_trace", error);
+        return 1;
+    }
+
+    if (channels_only) {
+        const std::map<int, ha::TraceReader::Channel>& channels = reader.getChannels();
+        for (std::map<int, ha::TraceReader::Channel>::const_iterator it = channels.begin(); it != channels.end(); ++it)
+            std::cout << it->first << " " << kindName(it->second.kind) << " " << it->second.name << std::endl;
+    }
+
+    std::cout << "# ticks: " << ticks << ", dropped: " << dropped << ", quantum: " << reader.getQuantum() << std::endl;
+    return 0;
+}
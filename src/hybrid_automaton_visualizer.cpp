@@ -40,8 +40,9 @@ namespace ha {
         }
 
         virtual int getDof() const { return 0; }
-        virtual ::Eigen::MatrixXd getConfiguration() const  { ::Eigen::MatrixXd m; return m; }
-        virtual ::Eigen::MatrixXd getForceTorqueMeasurement() const { ::Eigen::MatrixXd m; return m; }
+        virtual ::Eigen::MatrixXd getJointConfiguration() const  { ::Eigen::MatrixXd m; return m; }
+        virtual ::Eigen::MatrixXd getJointVelocity() const  { ::Eigen::MatrixXd m; return m; }
+        virtual ::Eigen::MatrixXd getForceTorqueMeasurement(const int& port = DEFAULT_FT_PORT) const { ::Eigen::MatrixXd m; return m; }
         virtual ::Eigen::MatrixXd getFramePose(const std::string&) const { ::Eigen::MatrixXd m; return m; }
 
     };
@@ -0,0 +1,156 @@
+/**
+ * @file
+ *
+ * Counts heap allocations by replacing malloc/free and friends on Linux (glibc), see AllocationTracker.h.
+ * Linked into the tests and into hybrid_automaton_jitter, so that both count the same allocations.
+ */
+
+#include "tests/AllocationTracker.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <malloc.h>
+
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t num, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+  void* __libc_memalign(size_t alignment, size_t size);
+  void __libc_free(void* ptr);
+}
+
+namespace
+{
+  // must not allocate and must not have constructors (malloc is called before static initialization)
+  unsigned long long g_allocations = 0;
+  unsigned long long g_frees = 0;
+  unsigned long long g_bytes = 0;
+  unsigned long long g_freed_bytes = 0;
+  __thread unsigned long long t_allocations = 0;
+  __thread unsigned long long t_frees = 0;
+  __thread unsigned long long t_bytes = 0;
+  __thread unsigned long long t_freed_bytes = 0;
+
+  inline void* countAllocation(void* ptr)
+  {
+    if (ptr)
+    {
+      const unsigned long long size = malloc_usable_size(ptr);
+      __sync_fetch_and_add(&g_allocations, 1ULL);
+      __sync_fetch_and_add(&g_bytes, size);
+      ++t_allocations;
+      t_bytes += size;
+    }
+    return ptr;
+  }
+
+  inline void countFree(void* ptr)
+  {
+    if (ptr)
+    {
+      const unsigned long long size = malloc_usable_size(ptr);
+      __sync_fetch_and_add(&g_frees, 1ULL);
+      __sync_fetch_and_add(&g_freed_bytes, size);
+      ++t_frees;
+      t_freed_bytes += size;
+    }
+  }
+}
+
+extern "C" {
+  void* malloc(size_t size)
+  {
+    return countAllocation(__libc_malloc(size));
+  }
+
+  void* calloc(size_t num, size_t size)
+  {
+    return countAllocation(__libc_calloc(num, size));
+  }
+
+  void* realloc(void* ptr, size_t size)
+  {
+    countFree(ptr);
+    void* result = __libc_realloc(ptr, size);
+    if (!result && size > 0)
+    {
+      // the old block is still alive
+      countAllocation(ptr);
+      return result;
+    }
+    return countAllocation(result);
+  }
+
+  void* memalign(size_t alignment, size_t size)
+  {
+    return countAllocation(__libc_memalign(alignment, size));
+  }
+
+  void* aligned_alloc(size_t alignment, size_t size)
+  {
+    return countAllocation(__libc_memalign(alignment, size));
+  }
+
+  int posix_memalign(void** ptr, size_t alignment, size_t size)
+  {
+    *ptr = countAllocation(__libc_memalign(alignment, size));
+    return (*ptr || size == 0) ? 0 : ENOMEM;
+  }
+
+  void free(void* ptr)
+  {
+    countFree(ptr);
+    __libc_free(ptr);
+  }
+}
+
+namespace testing
+{
+  bool AllocationTracker::isSupported()
+  {
+    return true;
+  }
+
+  AllocationCounters AllocationTracker::getGlobalCounters()
+  {
+    AllocationCounters counters;
+    counters.allocations = __sync_fetch_and_add(&g_allocations, 0ULL);
+    counters.frees = __sync_fetch_and_add(&g_frees, 0ULL);
+    counters.bytes = __sync_fetch_and_add(&g_bytes, 0ULL);
+    counters.freed_bytes = __sync_fetch_and_add(&g_freed_bytes, 0ULL);
+    return counters;
+  }
+
+  AllocationCounters AllocationTracker::getThreadCounters()
+  {
+    AllocationCounters counters;
+    counters.allocations = t_allocations;
+    counters.frees = t_frees;
+    counters.bytes = t_bytes;
+    counters.freed_bytes = t_freed_bytes;
+    return counters;
+  }
+}
+
+#else
+
+namespace testing
+{
+  bool AllocationTracker::isSupported()
+  {
+    return false;
+  }
+
+  AllocationCounters AllocationTracker::getGlobalCounters()
+  {
+    return AllocationCounters();
+  }
+
+  AllocationCounters AllocationTracker::getThreadCounters()
+  {
+    return AllocationCounters();
+  }
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef HYBRID_AUTOMATON_TESTS_ALLOCATION_TRACKER_H_
+#define HYBRID_AUTOMATON_TESTS_ALLOCATION_TRACKER_H_
+
+#include <cstddef>
+#include <string>
+
+namespace testing {
+
+	/**
+	 * @brief Heap usage counted by the allocation hooks of AllocationTracker.cpp
+	 *
+	 * The hooks replace malloc/free and friends on Linux (operator new and Eigen both end up there).
+	 * On other platforms nothing is counted and isSupported() returns false.
+	 */
+	struct AllocationCounters {
+		AllocationCounters() : allocations(0), frees(0), bytes(0), freed_bytes(0) {}
+
+		unsigned long long allocations;
+		unsigned long long frees;
+		unsigned long long bytes;
+		unsigned long long freed_bytes;
+	};
+
+	class AllocationTracker {
+	public:
+		static bool isSupported();
+
+		/**
+		 * @brief Counters of all threads since program start
+		 */
+		static AllocationCounters getGlobalCounters();
+
+		/**
+		 * @brief Counters of the calling thread since it was started
+		 */
+		static AllocationCounters getThreadCounters();
+	};
+
+	/**
+	 * @brief Fails the current test if the calling thread allocates on the heap while the guard is alive
+	 *
+	 * Use it around the hot path, e.g.:
+	 * @code
+	 *   {
+	 *     ExpectNoAllocations guard("HybridAutomaton::step");
+	 *     ha->step(t);
+	 *   }
+	 * @endcode
+	 *
+	 * Allocations of other threads are not counted. The guard does nothing where
+	 * AllocationTracker::isSupported() is false.
+	 */
+	class ExpectNoAllocations {
+	public:
+		explicit ExpectNoAllocations(const std::string& scope = "");
+		~ExpectNoAllocations();
+
+		/**
+		 * @brief Allocations of the calling thread since construction
+		 */
+		unsigned long long getAllocations() const;
+
+	private:
+		ExpectNoAllocations(const ExpectNoAllocations&);
+		ExpectNoAllocations& operator=(const ExpectNoAllocations&);
+
+		std::string _scope;
+		AllocationCounters _start;
+	};
+
+}
+
+#endif // HYBRID_AUTOMATON_TESTS_ALLOCATION_TRACKER_H_
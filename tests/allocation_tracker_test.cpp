@@ -0,0 +1,55 @@
+#include "gtest/gtest.h"
+#include "gtest/gtest-spi.h"
+
+#include "tests/AllocationTracker.h"
+
+#include "hybrid_automaton/Profiler.h"
+
+#include <cstdlib>
+
+using namespace testing;
+
+namespace {
+    // called through a volatile pointer so the compiler cannot elide the allocation
+    void* (*volatile allocate)(size_t) = &malloc;
+
+    void allocateOnce() {
+        ExpectNoAllocations guard("allocateOnce");
+        free(allocate(64));
+    }
+}
+
+TEST(AllocationTracker, CountsThreadAllocations) {
+    if (!AllocationTracker::isSupported())
+        return;
+
+    AllocationCounters before = AllocationTracker::getThreadCounters();
+    void* p = allocate(100);
+    AllocationCounters during = AllocationTracker::getThreadCounters();
+    free(p);
+    AllocationCounters after = AllocationTracker::getThreadCounters();
+
+    EXPECT_EQ(before.allocations + 1, during.allocations);
+    EXPECT_LE(before.bytes + 100, during.bytes);
+    EXPECT_EQ(before.frees + 1, after.frees);
+    EXPECT_EQ(during.bytes - before.bytes, after.freed_bytes - before.freed_bytes);
+
+    AllocationCounters global = AllocationTracker::getGlobalCounters();
+    EXPECT_GE(global.allocations, during.allocations);
+}
+
+TEST(AllocationTracker, ExpectNoAllocations) {
+    if (!AllocationTracker::isSupported())
+        return;
+
+    EXPECT_NONFATAL_FAILURE(allocateOnce(), "1 heap allocation(s)");
+
+    // the hot path of the profiler does not allocate
+    ha::LatencyHistogram histogram;
+    {
+        ExpectNoAllocations guard("LatencyHistogram::record");
+        for (int i = 0; i < 1000; i++)
+            histogram.record(i);
+        EXPECT_EQ(0u, guard.getAllocations());
+    }
+}
@@ -1,7 +1,113 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include "hybrid_automaton/ControlSwitch.h"
+#include "hybrid_automaton/CycleClock.h"
+#include "hybrid_automaton/Profiler.h"
+
+#include <algorithm>
+
+using namespace ha;
+
+namespace {
+
+	// returns a constant value and counts how often it is read, optionally taking its time
+	class ConstantSensor : public Sensor {
+	public:
+		ConstantSensor(double value, double seconds) : reads(0), _value(value), _seconds(seconds) {}
+		virtual ::Eigen::MatrixXd getCurrentValue() const {
+			++reads;
+			CycleClock::Ticks end = CycleClock::now() + CycleClock::fromSeconds(_seconds);
+			while (CycleClock::now() < end) {}
+			return ::Eigen::MatrixXd::Constant(1, 1, _value);
+		}
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const { return DescriptionTreeNode::Ptr(); }
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha) {}
+		mutable int reads;
+	protected:
+		virtual Sensor* _doClone() const { return new ConstantSensor(*this); }
+		double _value;
+		double _seconds;
+	};
+
+	JumpCondition::Ptr createCondition(Sensor* sensor)
+	{
+		JumpCondition::Ptr jump_condition(new JumpCondition);
+		jump_condition->setSensor(Sensor::Ptr(sensor));
+		jump_condition->setConstantGoal(1.0);
+		jump_condition->setEpsilon(0.1);
+		return jump_condition;
+	}
+
+}
 
 TEST(ControlSwitch, Serialization) {
 	// TODO
-}
\ No newline at end of file
+}
+
+TEST(ControlSwitch, AdaptiveOrdering) {
+	// an expensive condition that always passes before a cheap one that never does
+	ConstantSensor* expensive = new ConstantSensor(1.0, 20e-6);
+	ConstantSensor* cheap = new ConstantSensor(0.0, 0.0);
+
+	ControlSwitch control_switch;
+	control_switch.add(createCondition(expensive));
+	control_switch.add(createCondition(cheap));
+	EXPECT_FALSE(control_switch.getAdaptiveOrdering());
+	control_switch.setAdaptiveOrdering(true);
+	control_switch.initialize(0.0);
+
+	for (int i = 0; i < ControlSwitch::REORDERING_PERIOD; i++)
+		EXPECT_FALSE(control_switch.isActive());
+	EXPECT_LT(0, expensive->reads);
+
+	ASSERT_EQ(2u, control_switch.getEvaluationOrder().size());
+	EXPECT_EQ(1u, control_switch.getEvaluationOrder()[0]);
+	EXPECT_EQ(0u, control_switch.getEvaluationOrder()[1]);
+
+	// now the cheap condition short-circuits the expensive one
+	int expensive_reads = expensive->reads;
+	int cheap_reads = cheap->reads;
+	for (int i = 0; i < 100; i++)
+		EXPECT_FALSE(control_switch.isActive());
+	EXPECT_EQ(expensive_reads, expensive->reads);
+	EXPECT_LT(cheap_reads, cheap->reads);
+
+	// without adaptive ordering the conditions are checked in the order they were added
+	control_switch.setAdaptiveOrdering(false);
+	EXPECT_FALSE(control_switch.isActive());
+	EXPECT_LT(expensive_reads, expensive->reads);
+}
+
+TEST(ControlSwitch, ConditionsOfTheSameSensorTypeAreProfiledApart) {
+	ConstantSensor* first = new ConstantSensor(1.0, 0.0);
+	ConstantSensor* second = new ConstantSensor(0.0, 0.0);
+	first->setType("ConstantSensor");
+	second->setType("ConstantSensor");
+
+	ControlSwitch::Ptr control_switch(new ControlSwitch);
+	control_switch->setName("switch");
+	control_switch->add(createCondition(first));
+	control_switch->add(createCondition(second));
+	EXPECT_EQ("0", control_switch->getJumpConditions()[0]->getPath());
+	EXPECT_EQ("1", control_switch->getJumpConditions()[1]->getPath());
+
+#ifdef HA_ENABLE_PROFILING
+	Profiler& profiler = Profiler::instance();
+	profiler.reset();
+	control_switch->initialize(0.0);
+	{
+		Profiler::TickScope tick_scope("ha");
+		EXPECT_FALSE(control_switch->isActive());
+	}
+
+	std::vector<Profiler::NodeStatistics> statistics;
+	profiler.getStatistics(statistics);
+	std::vector<std::string> paths;
+	for (std::size_t i = 0; i < statistics.size(); ++i)
+		paths.push_back(profiler.getPath(statistics[i].id));
+	EXPECT_NE(paths.end(), std::find(paths.begin(), paths.end(), "HybridAutomaton::step ha;ControlSwitch::isActive switch;JumpCondition::isActive 0 ConstantSensor"));
+	EXPECT_NE(paths.end(), std::find(paths.begin(), paths.end(), "HybridAutomaton::step ha;ControlSwitch::isActive switch;JumpCondition::isActive 1 ConstantSensor"));
+	profiler.reset();
+#endif
+}
@@ -0,0 +1,322 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <cmath>
+#include <map>
+#include <string>
+
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "hybrid_automaton/ClockSensor.h"
+#include "hybrid_automaton/JointConfigurationSensor.h"
+#include "hybrid_automaton/SubjointConfigurationSensor.h"
+#include "hybrid_automaton/FramePoseSensor.h"
+#include "hybrid_automaton/FrameOrientationSensor.h"
+#include "hybrid_automaton/FrameDisplacementSensor.h"
+#include "hybrid_automaton/ForceTorqueSensor.h"
+#include "hybrid_automaton/SharedSensor.h"
+#include "hybrid_automaton/SubsetSensor.h"
+#include "hybrid_automaton/BlockSensor.h"
+#include "hybrid_automaton/FrameTransformSensor.h"
+#include "hybrid_automaton/DifferenceSensor.h"
+#include "hybrid_automaton/NormSensor.h"
+#include "hybrid_automaton/FilterSensor.h"
+#include "hybrid_automaton/DerivativeSensor.h"
+#include "tests/AllocationTracker.h"
+#include "tests/MockDescriptionTreeNode.h"
+
+using ::testing::Return;
+using ::testing::DoAll;
+using ::testing::SetArgReferee;
+using ::testing::_;
+
+using namespace ::ha;
+
+namespace {
+
+	SimulatedSystem::Ptr createRobot()
+	{
+		SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+		::Eigen::MatrixXd q(7, 1);
+		q << 0.1, -0.2, 0.3, -0.4, 0.5, -0.6, 0.7;
+		robot->setJointConfiguration(q);
+		robot->setContactPlane(::Eigen::Vector3d::UnitZ(), 2.0, 1000.0);
+		return robot;
+	}
+
+	void expectSameValue(const Sensor::Ptr& expected, const Sensor::Ptr& actual, const System::ConstPtr& system)
+	{
+		expected->setSystem(system);
+		actual->setSystem(system);
+		expected->initialize(0.0);
+		actual->initialize(0.0);
+
+		::Eigen::MatrixXd expected_value = expected->getCurrentValue();
+		::Eigen::MatrixXd actual_value = actual->getCurrentValue();
+		ASSERT_EQ(expected_value.rows(), actual_value.rows());
+		ASSERT_EQ(expected_value.cols(), actual_value.cols());
+		EXPECT_LT((expected_value - actual_value).norm(), 1e-9) << expected_value << "\n\n" << actual_value;
+	}
+
+	MockDescriptionTreeNode::Ptr createSensorNode(const std::string& type, const DescriptionTreeNode::ConstNodeList& operands)
+	{
+		std::map<std::string, std::string> attributes;
+		attributes["type"] = type;
+
+		MockDescriptionTreeNode::Ptr node(new MockDescriptionTreeNode);
+		EXPECT_CALL(*node, getType())
+			.WillRepeatedly(Return("Sensor"));
+		EXPECT_CALL(*node, getAttributeString(_, _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*node, getAttributeString(std::string("type"), _))
+			.WillRepeatedly(DoAll(SetArgReferee<1>(type),Return(true)));
+		EXPECT_CALL(*node, getAllAttributes(_))
+			.WillRepeatedly(SetArgReferee<0>(attributes));
+		EXPECT_CALL(*node, getChildrenNodes(_))
+			.WillRepeatedly(DoAll(SetArgReferee<0>(operands),Return(!operands.empty())));
+		EXPECT_CALL(*node, getChildrenNodes(std::string("Sensor"), _))
+			.WillRepeatedly(DoAll(SetArgReferee<1>(operands),Return(!operands.empty())));
+		return node;
+	}
+
+}
+
+TEST(DerivedSensor, ReplacesProjectionSensors) {
+	SimulatedSystem::Ptr robot = createRobot();
+
+	// subset of the joints
+	std::vector<int> index;
+	index.push_back(2);
+	index.push_back(5);
+	SubjointConfigurationSensor::Ptr subjoints(new SubjointConfigurationSensor);
+	subjoints->setIndex(index);
+	SubsetSensor::Ptr subset(new SubsetSensor);
+	subset->addOperand(Sensor::Ptr(new JointConfigurationSensor));
+	subset->setIndex(index);
+	expectSameValue(subjoints, subset, robot);
+
+	// rotation and translation of a frame
+	BlockSensor::Ptr rotation(new BlockSensor);
+	rotation->addOperand(Sensor::Ptr(new FramePoseSensor("EE")));
+	rotation->setBlock(0, 0, 3, 3);
+	expectSameValue(Sensor::Ptr(new FrameOrientationSensor("EE")), rotation, robot);
+
+	BlockSensor::Ptr translation(new BlockSensor);
+	translation->addOperand(Sensor::Ptr(new FramePoseSensor("EE")));
+	translation->setBlock(0, 3, 3, 1);
+	expectSameValue(Sensor::Ptr(new FrameDisplacementSensor("EE")), translation, robot);
+
+	// wrench in world coordinates, about a point 0.1m above the origin
+	::Eigen::MatrixXd frame = ::Eigen::MatrixXd::Identity(4, 4);
+	frame(2, 3) = 0.1;
+	ForceTorqueSensor::Ptr raw(new ForceTorqueSensor);
+	raw->setFrame(::Eigen::MatrixXd::Identity(4, 4));
+	FrameTransformSensor::Ptr transformed(new FrameTransformSensor);
+	transformed->addOperand(raw);
+	transformed->addOperand(Sensor::Ptr(new FramePoseSensor("EE")));
+	transformed->setInvertPose(true);
+	transformed->setFrame(frame);
+	transformed->setSystem(robot);
+	transformed->initialize(0.0);
+
+	::Eigen::MatrixXd ee_pose = robot->getFramePose("EE");
+	::Eigen::MatrixXd wrench = robot->getForceTorqueMeasurement();
+	::Eigen::Vector3d force = ee_pose.block(0, 0, 3, 3) * wrench.block(0, 0, 3, 1);
+	::Eigen::Vector3d lever = ee_pose.block(0, 3, 3, 1) - frame.block(0, 3, 3, 1);
+	::Eigen::Vector3d moment = ee_pose.block(0, 0, 3, 3) * wrench.block(3, 0, 3, 1) + lever.cross(force);
+	::Eigen::MatrixXd world_wrench = transformed->getCurrentValue();
+	EXPECT_GT(force.norm(), 0.0);
+	EXPECT_LT((force - world_wrench.block(0, 0, 3, 1)).norm(), 1e-9);
+	EXPECT_LT((moment - world_wrench.block(3, 0, 3, 1)).norm(), 1e-9);
+
+	// points and poses are expressed in the target frame as well
+	FrameTransformSensor::Ptr in_ee(new FrameTransformSensor);
+	in_ee->addOperand(Sensor::Ptr(new FramePoseSensor("link_3")));
+	in_ee->addOperand(Sensor::Ptr(new FramePoseSensor("EE")));
+	in_ee->setSystem(robot);
+	in_ee->initialize(0.0);
+	::Eigen::MatrixXd link_in_ee = ee_pose.inverse() * robot->getFramePose("link_3");
+	EXPECT_LT((link_in_ee - in_ee->getCurrentValue()).norm(), 1e-9);
+
+	// distance between two frames
+	DifferenceSensor::Ptr difference(new DifferenceSensor);
+	difference->addOperand(Sensor::Ptr(new FrameDisplacementSensor("EE")));
+	difference->addOperand(Sensor::Ptr(new FrameDisplacementSensor("link_3")));
+	NormSensor::Ptr distance(new NormSensor);
+	distance->addOperand(difference);
+	distance->setSystem(robot);
+	distance->initialize(0.0);
+	::Eigen::MatrixXd ee = robot->getFramePose("EE");
+	::Eigen::MatrixXd link = robot->getFramePose("link_3");
+	EXPECT_NEAR((ee.block(0, 3, 3, 1) - link.block(0, 3, 3, 1)).norm(), distance->getCurrentValue()(0, 0), 1e-12);
+
+	distance->setNorm(NormSensor::L_INF);
+	EXPECT_NEAR((ee.block(0, 3, 3, 1) - link.block(0, 3, 3, 1)).cwiseAbs().maxCoeff(), distance->getCurrentValue()(0, 0), 1e-12);
+
+	// clones do not share operands
+	DerivedSensor::Ptr clone = distance->clone();
+	ASSERT_EQ(1u, clone->getOperands().size());
+	EXPECT_FALSE(clone->getOperands()[0] == distance->getOperands()[0]);
+
+	// operands are checked when reading
+	BlockSensor::Ptr too_large(new BlockSensor);
+	too_large->addOperand(Sensor::Ptr(new FramePoseSensor("EE")));
+	too_large->setBlock(2, 2, 3, 3);
+	too_large->setSystem(robot);
+	EXPECT_THROW(too_large->getCurrentValue(), std::string);
+	EXPECT_THROW(too_large->setBlock(-1, 0, 1, 1), std::string);
+}
+
+TEST(DerivedSensor, FilterFollowsItsOperand) {
+	FilterSensor filter;
+	filter.addOperand(Sensor::Ptr(new ClockSensor));
+	filter.setTimeConstant(0.1);
+	EXPECT_THROW(filter.setTimeConstant(-1.0), std::string);
+
+	filter.initialize(1.0);
+	EXPECT_DOUBLE_EQ(1.0, filter.getCurrentValue()(0, 0));
+
+	filter.step(1.1);
+	EXPECT_NEAR(1.0 + 0.1 * (1.0 - exp(-1.0)), filter.getCurrentValue()(0, 0), 1e-12);
+
+	// stepping twice in the same cycle does not filter twice
+	filter.step(1.1);
+	EXPECT_NEAR(1.0 + 0.1 * (1.0 - exp(-1.0)), filter.getCurrentValue()(0, 0), 1e-12);
+
+	// relative to the value at initialize()
+	EXPECT_NEAR(0.1 * (1.0 - exp(-1.0)), filter.getRelativeCurrentValue()(0, 0), 1e-12);
+
+	// without a time constant the operand passes through
+	filter.setTimeConstant(0.0);
+	filter.step(1.5);
+	EXPECT_DOUBLE_EQ(1.5, filter.getCurrentValue()(0, 0));
+}
+
+TEST(DerivedSensor, DerivativeOfTheClockIsOne) {
+	for (int window_size = 2; window_size <= 5; window_size++) {
+		DerivativeSensor derivative;
+		derivative.setWindowSize(window_size);
+		derivative.addOperand(Sensor::Ptr(new ClockSensor));
+
+		derivative.initialize(1.0);
+		EXPECT_DOUBLE_EQ(0.0, derivative.getCurrentValue()(0, 0));
+
+		// irregular control cycles
+		const double times[] = { 1.001, 1.003, 1.004, 1.0045, 1.006, 1.0061 };
+		for (int k = 0; k < 6; k++) {
+			derivative.step(times[k]);
+			EXPECT_NEAR(1.0, derivative.getCurrentValue()(0, 0), 1e-9) << "window " << window_size << " sample " << k;
+		}
+	}
+
+	DerivativeSensor derivative;
+	EXPECT_THROW(derivative.setWindowSize(1), std::string);
+}
+
+TEST(DerivedSensor, DerivativeOfAPoseIsItsBodyTwist) {
+	const double dt = 0.001;
+	::Eigen::MatrixXd q0(7, 1), qd(7, 1);
+	q0 << 0.1, -0.2, 0.3, -0.4, 0.5, -0.6, 0.7;
+	qd << 0.5, -0.3, 0.4, 0.2, -0.6, 0.3, 0.8;
+
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	robot->setInputMode(SimulatedSystem::VELOCITY_INPUT);
+	robot->setJointConfiguration(q0);
+
+	DerivativeSensor::Ptr twist(new DerivativeSensor);
+	twist->setWindowSize(3);
+	twist->addOperand(Sensor::Ptr(new FramePoseSensor("EE")));
+	twist->setSystem(robot);
+	twist->initialize(0.0);
+
+	double t = 0.0;
+	for (int k = 0; k < 50; k++) {
+		robot->integrate(qd, dt);
+		t += dt;
+		twist->step(t);
+	}
+
+	// central difference of the pose
+	SimulatedSystem::Ptr reference(new SimulatedSystem(7));
+	const double h = 1e-6;
+	reference->setJointConfiguration(robot->getJointConfiguration() + h * qd);
+	::Eigen::Matrix4d ahead = reference->getFramePose("EE");
+	reference->setJointConfiguration(robot->getJointConfiguration() - h * qd);
+	::Eigen::Matrix4d behind = reference->getFramePose("EE");
+	::Eigen::Matrix4d pose = robot->getFramePose("EE");
+
+	::Eigen::Matrix3d R = pose.topLeftCorner<3, 3>();
+	::Eigen::Vector3d v = R.transpose() * (ahead.topRightCorner<3, 1>() - behind.topRightCorner<3, 1>()) / (2.0 * h);
+	::Eigen::Matrix3d omega_hat = R.transpose() * (ahead.topLeftCorner<3, 3>() - behind.topLeftCorner<3, 3>()) / (2.0 * h);
+	::Eigen::Vector3d omega(omega_hat(2, 1), omega_hat(0, 2), omega_hat(1, 0));
+
+	::Eigen::MatrixXd value = twist->getCurrentValue();
+	ASSERT_EQ(6, value.rows());
+	EXPECT_LT((value.topRows(3) - v).norm(), 1e-2 * v.norm()) << value.transpose() << "\n" << v.transpose();
+	EXPECT_LT((value.bottomRows(3) - omega).norm(), 1e-2 * omega.norm()) << value.transpose() << "\n" << omega.transpose();
+
+	// came to rest once the window only contains the same pose
+	for (int k = 0; k < 3; k++) {
+		robot->integrate(::Eigen::MatrixXd::Zero(7, 1), dt);
+		t += dt;
+		twist->step(t);
+	}
+	EXPECT_LT(twist->getCurrentValue().norm(), 1e-12);
+
+	// the same pose twice in a cycle does not count
+	twist->step(t);
+	EXPECT_LT(twist->getCurrentValue().norm(), 1e-12);
+
+	if (testing::AllocationTracker::isSupported()) {
+		::Eigen::MatrixXd buffer(6, 1);
+		testing::ExpectNoAllocations guard("DerivativeSensor::step");
+		for (int k = 0; k < 10; k++) {
+			t += dt;
+			twist->step(t);
+			twist->readCurrentValue(buffer);
+		}
+	}
+}
+
+TEST(DerivedSensor, SharesCommonSubexpressions) {
+	// enable registration
+	ClockSensor clock_sensor;
+	DifferenceSensor difference_sensor;
+	NormSensor norm_sensor;
+
+	// |clock - clock| written out twice
+	DescriptionTreeNode::ConstNodeList clocks;
+	clocks.push_back(createSensorNode("ClockSensor", DescriptionTreeNode::ConstNodeList()));
+	clocks.push_back(createSensorNode("ClockSensor", DescriptionTreeNode::ConstNodeList()));
+	DescriptionTreeNode::ConstNodeList differences;
+	differences.push_back(createSensorNode("DifferenceSensor", clocks));
+
+	HybridAutomaton hybrid_automaton;
+	System::ConstPtr system;
+	Sensor::Ptr a = hybrid_automaton.createSharedSensor(createSensorNode("NormSensor", differences), system);
+	Sensor::Ptr b = hybrid_automaton.createSharedSensor(createSensorNode("NormSensor", differences), system);
+
+	// one node per distinct subexpression
+	EXPECT_TRUE(a == b);
+	EXPECT_EQ(3u, hybrid_automaton.getNumberOfSharedSensors());
+
+	SharedSensor::Ptr shared = boost::dynamic_pointer_cast<SharedSensor>(a);
+	ASSERT_TRUE(shared.get() != NULL);
+	DerivedSensor::Ptr norm = boost::dynamic_pointer_cast<DerivedSensor>(shared->getSensor());
+	ASSERT_TRUE(norm.get() != NULL);
+	EXPECT_EQ("NormSensor", norm->getType());
+	SharedSensor::Ptr shared_difference = boost::dynamic_pointer_cast<SharedSensor>(norm->getOperands()[0]);
+	ASSERT_TRUE(shared_difference.get() != NULL);
+	DerivedSensor::Ptr difference = boost::dynamic_pointer_cast<DerivedSensor>(shared_difference->getSensor());
+	ASSERT_TRUE(difference.get() != NULL);
+	ASSERT_EQ(2u, difference->getOperands().size());
+	EXPECT_TRUE(difference->getOperands()[0] == difference->getOperands()[1]);
+
+	a->initialize(0.0);
+	a->step(0.5);
+	EXPECT_DOUBLE_EQ(0.0, a->getCurrentValue()(0, 0));
+	EXPECT_DOUBLE_EQ(0.5, difference->getOperands()[0]->getCurrentValue()(0, 0));
+
+	// operators check the number of their operands
+	EXPECT_THROW(hybrid_automaton.createSharedSensor(createSensorNode("DifferenceSensor", differences), system), std::string);
+}
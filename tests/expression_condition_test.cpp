@@ -0,0 +1,233 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <map>
+#include <string>
+
+#include "hybrid_automaton/ExpressionCondition.h"
+#include "hybrid_automaton/ClockSensor.h"
+#include "tests/MockDescriptionTree.h"
+#include "tests/MockDescriptionTreeNode.h"
+
+using ::testing::Return;
+using ::testing::DoAll;
+using ::testing::SetArgReferee;
+using ::testing::_;
+
+using namespace ::ha;
+
+namespace {
+
+	class SwitchableSensor : public Sensor {
+	public:
+		SwitchableSensor() : value(0.0), active(true), reads(0) {}
+		virtual ::Eigen::MatrixXd getCurrentValue() const { ++reads; return ::Eigen::MatrixXd::Constant(1, 1, value); }
+		virtual bool isActive() const { return active; }
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const { return DescriptionTreeNode::Ptr(); }
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha) {}
+		double value;
+		bool active;
+		mutable int reads;
+	protected:
+		virtual Sensor* _doClone() const { return new SwitchableSensor(*this); }
+	};
+
+	// active while the value of the sensor is at least 1
+	JumpCondition::Ptr createComparison(Sensor::Ptr sensor)
+	{
+		JumpCondition::Ptr jump_condition(new JumpCondition);
+		jump_condition->setSensor(sensor);
+		jump_condition->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+		jump_condition->setConstantGoal(1.0);
+		jump_condition->setEpsilon(0.0);
+		return jump_condition;
+	}
+
+	ExpressionCondition::Ptr createExpression(ExpressionCondition::Operator op, const JumpCondition::Ptr& a, const JumpCondition::Ptr& b = JumpCondition::Ptr())
+	{
+		ExpressionCondition::Ptr expression(new ExpressionCondition(op));
+		expression->addOperand(a);
+		if (b)
+			expression->addOperand(b);
+		return expression;
+	}
+
+	MockDescriptionTreeNode::Ptr createNode(const std::string& type, const std::map<std::string, std::string>& attributes,
+		const std::string& children_type = "", const DescriptionTreeNode::ConstNodeList& children = DescriptionTreeNode::ConstNodeList())
+	{
+		MockDescriptionTreeNode::Ptr node(new MockDescriptionTreeNode);
+		EXPECT_CALL(*node, getType())
+			.WillRepeatedly(Return(type));
+		EXPECT_CALL(*node, getAttributeString(_, _))
+			.WillRepeatedly(Return(false));
+		for (std::map<std::string, std::string>::const_iterator it = attributes.begin(); it != attributes.end(); ++it) {
+			EXPECT_CALL(*node, getAttributeString(it->first, _))
+				.WillRepeatedly(DoAll(SetArgReferee<1>(it->second),Return(true)));
+		}
+		EXPECT_CALL(*node, getAllAttributes(_))
+			.WillRepeatedly(SetArgReferee<0>(attributes));
+		EXPECT_CALL(*node, getChildrenNodes(_, _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*node, getChildrenNodes(children_type, _))
+			.WillRepeatedly(DoAll(SetArgReferee<1>(children),Return(!children.empty())));
+		return node;
+	}
+
+	// t >= goal
+	MockDescriptionTreeNode::Ptr createClockNode(const std::string& goal)
+	{
+		std::map<std::string, std::string> attributes;
+		attributes["type"] = "ClockSensor";
+		DescriptionTreeNode::ConstNodeList sensors;
+		sensors.push_back(createNode("Sensor", attributes));
+
+		attributes.clear();
+		attributes["jump_criterion"] = "THRESH_UPPER_BOUND";
+		attributes["goal"] = goal;
+		attributes["epsilon"] = "0";
+		attributes["goal_is_relative"] = "0";
+		attributes["negate"] = "0";
+		return createNode("JumpCondition", attributes, "Sensor", sensors);
+	}
+
+	MockDescriptionTreeNode::Ptr createExpressionNode(const std::string& op, const DescriptionTreeNode::ConstNodeList& operands)
+	{
+		std::map<std::string, std::string> attributes;
+		attributes["expression"] = op;
+		return createNode("JumpCondition", attributes, "JumpCondition", operands);
+	}
+
+}
+
+TEST(ExpressionCondition, ShortCircuitsTheFlatProgram) {
+	SwitchableSensor* a = new SwitchableSensor;
+	SwitchableSensor* b = new SwitchableSensor;
+	SwitchableSensor* c = new SwitchableSensor;
+	JumpCondition::Ptr ca = createComparison(Sensor::Ptr(a));
+	JumpCondition::Ptr cb = createComparison(Sensor::Ptr(b));
+	JumpCondition::Ptr cc = createComparison(Sensor::Ptr(c));
+
+	// a | (!b & c)
+	ExpressionCondition::Ptr expression = createExpression(ExpressionCondition::OR, ca,
+		createExpression(ExpressionCondition::AND, createExpression(ExpressionCondition::NOT, cb), cc));
+	expression->initialize(0.0);
+	EXPECT_EQ(3u, expression->getComparisons().size());
+
+	// (a, b, c) -> result
+	const bool table[8][4] = {
+		{false, false, false, false}, {false, false, true, true},
+		{false, true, false, false}, {false, true, true, false},
+		{true, false, false, true}, {true, false, true, true},
+		{true, true, false, true}, {true, true, true, true}};
+	for (int i = 0; i < 8; i++) {
+		a->value = table[i][0] ? 1.0 : 0.0;
+		b->value = table[i][1] ? 1.0 : 0.0;
+		c->value = table[i][2] ? 1.0 : 0.0;
+		expression->step(i);
+		EXPECT_EQ(table[i][3], expression->isActive()) << i;
+		EXPECT_FALSE(expression->isUnknown());
+	}
+
+	// a decides alone
+	a->value = 1.0;
+	a->reads = b->reads = c->reads = 0;
+	EXPECT_TRUE(expression->isActive());
+	EXPECT_EQ(1, a->reads);
+	EXPECT_EQ(0, b->reads);
+	EXPECT_EQ(0, c->reads);
+
+	// !b is false, c is skipped
+	a->value = 0.0;
+	b->value = 1.0;
+	EXPECT_FALSE(expression->isActive());
+	EXPECT_EQ(0, c->reads);
+}
+
+TEST(ExpressionCondition, UnknownComparisonsFollowThreeValuedLogic) {
+	SwitchableSensor* stale = new SwitchableSensor;
+	SwitchableSensor* fresh = new SwitchableSensor;
+	stale->active = false;
+	stale->value = 0.0;
+	JumpCondition::Ptr unknown = createComparison(Sensor::Ptr(stale));
+	JumpCondition::Ptr known = createComparison(Sensor::Ptr(fresh));
+
+	// a stale sensor does not make its negation active
+	ExpressionCondition::Ptr negation = createExpression(ExpressionCondition::NOT, unknown);
+	negation->initialize(0.0);
+	EXPECT_FALSE(negation->isActive());
+	EXPECT_TRUE(negation->isUnknown());
+
+	ExpressionCondition::Ptr disjunction = createExpression(ExpressionCondition::OR, unknown, known);
+	ExpressionCondition::Ptr conjunction = createExpression(ExpressionCondition::AND, unknown, known);
+	disjunction->initialize(0.0);
+	conjunction->initialize(0.0);
+
+	fresh->value = 1.0;
+	EXPECT_TRUE(disjunction->isActive());
+	EXPECT_FALSE(disjunction->isUnknown());
+	EXPECT_FALSE(conjunction->isActive());
+	EXPECT_TRUE(conjunction->isUnknown());
+
+	fresh->value = 0.0;
+	EXPECT_FALSE(disjunction->isActive());
+	EXPECT_TRUE(disjunction->isUnknown());
+	EXPECT_FALSE(conjunction->isActive());
+	EXPECT_FALSE(conjunction->isUnknown());
+
+	stale->active = true;
+	EXPECT_TRUE(negation->isActive());
+	EXPECT_FALSE(negation->isUnknown());
+}
+
+TEST(ExpressionCondition, Serialization) {
+	// enable registration
+	ClockSensor clock_sensor;
+
+	// t >= 2 or t < 1
+	DescriptionTreeNode::ConstNodeList negated;
+	negated.push_back(createClockNode("[1,1]1"));
+	DescriptionTreeNode::ConstNodeList operands;
+	operands.push_back(createClockNode("[1,1]2"));
+	operands.push_back(createExpressionNode("not", negated));
+	DescriptionTreeNode::Ptr node = createExpressionNode("or", operands);
+
+	JumpCondition::Ptr jump_condition = ExpressionCondition::create(node);
+	ExpressionCondition::Ptr expression = boost::dynamic_pointer_cast<ExpressionCondition>(jump_condition);
+	ASSERT_TRUE(expression.get() != NULL);
+	expression->setSourceModeName("m1");
+	expression->deserialize(node, System::ConstPtr(), NULL);
+	EXPECT_EQ(ExpressionCondition::OR, expression->getOperator());
+	ASSERT_EQ(2u, expression->getOperands().size());
+	EXPECT_EQ(2u, expression->getComparisons().size());
+
+	const double times[4] = {0.5, 1.5, 2.0, 2.5};
+	const bool active[4] = {true, false, true, true};
+	expression->initialize(0.0);
+	for (int i = 0; i < 4; i++) {
+		expression->step(times[i]);
+		EXPECT_EQ(active[i], expression->isActive()) << times[i];
+	}
+
+	// serialized with its operands as children
+	MockDescriptionTree::Ptr tree(new MockDescriptionTree);
+	MockDescriptionTreeNode::Ptr serialized(new MockDescriptionTreeNode);
+	MockDescriptionTreeNode::Ptr operand_node(new MockDescriptionTreeNode);
+	EXPECT_CALL(*tree, createNode("JumpCondition"))
+		.WillOnce(Return(serialized))
+		.WillRepeatedly(Return(operand_node));
+	EXPECT_CALL(*tree, createNode("Sensor"))
+		.WillRepeatedly(Return(DescriptionTreeNode::Ptr(new MockDescriptionTreeNode)));
+	EXPECT_CALL(*serialized, setAttributeString(std::string("expression"), std::string("or")));
+	EXPECT_CALL(*serialized, addChildNode(_))
+		.Times(2);
+	EXPECT_CALL(*operand_node, setAttributeString(_, _))
+		.Times(::testing::AtLeast(0));
+	EXPECT_CALL(*operand_node, addChildNode(_))
+		.Times(::testing::AtLeast(0));
+	expression->serialize(tree);
+
+	// not needs exactly one operand
+	operands.push_back(createClockNode("[1,1]3"));
+	EXPECT_THROW(expression->deserialize(createExpressionNode("not", operands), System::ConstPtr(), NULL), std::string);
+	EXPECT_THROW(ExpressionCondition::operatorFromString("xor"), std::string);
+}
@@ -5,8 +5,13 @@
  *
  * This file implements a main() function for Google Test that runs all tests
  * and detects memory leaks.
+ *
+ * On Linux the allocations, bytes and leaks of each test are reported, as counted
+ * by the malloc/free hooks of AllocationTracker.cpp (see AllocationTracker.h).
  */
 
+#include "tests/AllocationTracker.h"
+
 #ifdef _WIN32
 
 #define _CRTDBG_MAP_ALLOC
@@ -59,4 +64,106 @@ _CrtSetReportMode( _CRT_ERROR, _CRTDBG_MODE_DEBUG );
   return ret;
 }
 
+#elif defined(__linux__)
+
+#include <iostream>
+#include <cstdlib>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace testing;
+
+namespace testing
+{
+  ExpectNoAllocations::ExpectNoAllocations(const string& scope)
+    : _scope(scope)
+  {
+    _start = AllocationTracker::getThreadCounters();
+  }
+
+  ExpectNoAllocations::~ExpectNoAllocations()
+  {
+    const AllocationCounters now = AllocationTracker::getThreadCounters();
+    if (now.allocations != _start.allocations)
+    {
+      ADD_FAILURE() << (now.allocations - _start.allocations) << " heap allocation(s) of "
+                    << (now.bytes - _start.bytes) << " byte(s)"
+                    << (_scope.empty() ? string() : " in " + _scope);
+    }
+  }
+
+  unsigned long long ExpectNoAllocations::getAllocations() const
+  {
+    return AllocationTracker::getThreadCounters().allocations - _start.allocations;
+  }
+
+  class MemoryLeakDetector : public EmptyTestEventListener
+  {
+  public:
+    MemoryLeakDetector(bool fail_on_leaks) : failOnLeaks_(fail_on_leaks) {}
+
+    virtual void OnTestStart(const TestInfo&)
+    {
+      start_ = AllocationTracker::getGlobalCounters();
+    }
+
+    virtual void OnTestEnd(const TestInfo& test_info)
+    {
+      const AllocationCounters now = AllocationTracker::getGlobalCounters();
+      const unsigned long long allocations = now.allocations - start_.allocations;
+      const unsigned long long bytes = now.bytes - start_.bytes;
+      const long long leaked_blocks = (long long)allocations - (long long)(now.frees - start_.frees);
+      const long long leaked_bytes = (long long)bytes - (long long)(now.freed_bytes - start_.freed_bytes);
+
+      cout << "[ ALLOCS   ] " << allocations << " allocation(s), " << bytes << " byte(s)";
+      if (leaked_bytes > 0)
+        cout << ", " << leaked_bytes << " byte(s) in " << leaked_blocks << " block(s) not freed";
+      cout << endl;
+
+      if (failOnLeaks_ && test_info.result()->Passed() && leaked_bytes > 0)
+      {
+        FAIL() << "Memory leak of " << leaked_bytes << " byte(s) detected.";
+      }
+    }
+
+  private:
+    AllocationCounters start_;
+    bool failOnLeaks_;
+  };
+}
+
+GTEST_API_ int main(int argc, char **argv)
+{
+  cout << "Running main() from gtest_mem_main.cpp" << endl;
+
+  // caches that live until the end of the program (static registries, the profiler, ...)
+  // look like leaks of the first test that fills them - leaks are only reported by default
+  const bool fail_on_leaks = getenv("HA_FAIL_ON_LEAKS") != NULL;
+
+  InitGoogleTest(&argc, argv);
+  UnitTest::GetInstance()->listeners().Append(new MemoryLeakDetector(fail_on_leaks));
+  return RUN_ALL_TESTS();
+}
+
+#endif
+
+#ifndef __linux__
+
+namespace testing
+{
+  ExpectNoAllocations::ExpectNoAllocations(const std::string& scope)
+    : _scope(scope)
+  {
+  }
+
+  ExpectNoAllocations::~ExpectNoAllocations()
+  {
+  }
+
+  unsigned long long ExpectNoAllocations::getAllocations() const
+  {
+    return 0;
+  }
+}
+
 #endif
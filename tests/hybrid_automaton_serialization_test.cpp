@@ -244,6 +244,22 @@ protected:
 			.WillRepeatedly(Return("ControlSwitch"));
 		EXPECT_CALL(*cs_node, getAttributeString(std::string("name"), _))
 			.WillRepeatedly(DoAll(SetArgReferee<1>(""),Return(true)));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("evaluation_period"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("priority"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("safety_critical"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("prewarm_margin"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("min_dwell_time"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("prewarm_time"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("max_evaluation_period"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*cs_node, getAttributeString(std::string("adaptive_ordering"), _))
+			.WillRepeatedly(Return(false));
 
 		cs_list.push_back(cs_node);
 
@@ -269,6 +285,12 @@ protected:
 			.WillRepeatedly(Return(false));
         EXPECT_CALL(*js_node, getAttributeString(std::string("negate"), _))
             .WillRepeatedly(Return(false));
+		EXPECT_CALL(*js_node, getAttributeString(std::string("hysteresis"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*js_node, getAttributeString(std::string("expression"), _))
+			.WillRepeatedly(Return(false));
+		EXPECT_CALL(*js_node, getAttributeString(std::string("convergence"), _))
+			.WillRepeatedly(Return(false));
 
 		js_list.push_back(js_node);
 
@@ -6,6 +6,10 @@
 #include "hybrid_automaton/HybridAutomaton.h"
 #include "hybrid_automaton/ControlMode.h"
 #include "hybrid_automaton/ControlSwitch.h"
+#include "hybrid_automaton/ClockSensor.h"
+#include "hybrid_automaton/ConditionBatch.h"
+#include "hybrid_automaton/ConditionView.h"
+#include "hybrid_automaton/DerivativeSensor.h"
 
 
 using namespace std;
@@ -19,6 +23,7 @@ class TestControlMode : public ha::ControlMode {
 	virtual void initialize() {};
 	virtual void terminate() {};
 	virtual ::Eigen::MatrixXd step(const double& t)	{ return ::Eigen::MatrixXd(0,0); }
+	virtual void switchControlMode(ha::ControlMode::Ptr otherMode) {};
 };
 
 using namespace ha;
@@ -80,6 +85,663 @@ TEST_F(HybridAutomatonTest, step) {
     ASSERT_TRUE(expected_result == hybrid_automaton->step(0.0));
 }
 
+// counts how often it is read
+class CountingSensor : public ha::Sensor {
+  public:
+	CountingSensor() : reads(0) {}
+	virtual ::Eigen::MatrixXd getCurrentValue() const { ++reads; return ::Eigen::MatrixXd::Zero(1, 1); }
+	virtual ha::DescriptionTreeNode::Ptr serialize(const ha::DescriptionTree::ConstPtr& factory) const { return ha::DescriptionTreeNode::Ptr(); }
+	virtual void deserialize(const ha::DescriptionTreeNode::ConstPtr& tree, const ha::System::ConstPtr& system, const ha::HybridAutomaton* ha) {}
+	mutable int reads;
+  protected:
+	virtual ha::Sensor* _doClone() const { return new CountingSensor(*this); }
+};
+
+TEST_F(HybridAutomatonTest, stepSkipsSwitchesUntilTimeout) {
+	JumpCondition::Ptr timeout(new JumpCondition);
+	timeout->setSensor(Sensor::Ptr(new ClockSensor));
+	timeout->setConstantGoal(1.0);
+	timeout->setGoalRelative();
+	timeout->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+	timeout->setEpsilon(0.0);
+	s1->add(timeout);
+
+	CountingSensor* counting_sensor = new CountingSensor;
+	JumpCondition::Ptr counting(new JumpCondition);
+	counting->setSensor(Sensor::Ptr(counting_sensor));
+	counting->setConstantGoal(0.0);
+	counting->setEpsilon(0.1);
+	s1->add(counting);
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.5));
+	EXPECT_NEAR(1.5, s1->getEarliestActivationTime(), 1e-6);
+	counting_sensor->reads = 0;
+
+	for (int i = 0; i < 100; i++) {
+		hybrid_automaton->step(0.5 + i * 0.01);
+		EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	}
+	EXPECT_EQ(0, counting_sensor->reads);
+
+	hybrid_automaton->step(1.5);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+	EXPECT_LT(0, counting_sensor->reads);
+}
+
+TEST_F(HybridAutomatonTest, stepEvaluatesSlowSwitchesAtTheirRate) {
+	CountingSensor* counting_sensor = new CountingSensor;
+	JumpCondition::Ptr never(new JumpCondition);
+	never->setSensor(Sensor::Ptr(counting_sensor));
+	never->setConstantGoal(1.0);
+	never->setEpsilon(0.1);
+	s1->add(never);
+	s1->setEvaluationPeriod(0.1);
+
+	// a second slow switch is evaluated in between
+	CountingSensor* other_sensor = new CountingSensor;
+	JumpCondition::Ptr other(new JumpCondition);
+	other->setSensor(Sensor::Ptr(other_sensor));
+	other->setConstantGoal(1.0);
+	other->setEpsilon(0.1);
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(other);
+	s2->setEvaluationPeriod(0.1);
+	hybrid_automaton->addControlSwitch(m1->getName(), s2, m2->getName());
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+	counting_sensor->reads = 0;
+	other_sensor->reads = 0;
+
+	std::vector<int> first_reads, other_reads;
+	for (int i = 0; i < 100; i++) {
+		hybrid_automaton->step(0.001 + i * 0.01);
+		first_reads.push_back(counting_sensor->reads);
+		other_reads.push_back(other_sensor->reads);
+	}
+
+	// each switch about every 10th tick, never both in the same tick
+	EXPECT_NEAR(10, first_reads.back(), 1);
+	EXPECT_NEAR(10, other_reads.back(), 1);
+	for (std::size_t i = 1; i < first_reads.size(); i++)
+		EXPECT_FALSE(first_reads[i] != first_reads[i-1] && other_reads[i] != other_reads[i-1]);
+	EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+}
+
+TEST_F(HybridAutomatonTest, stepEvaluatesSwitchesByPriority) {
+	JumpCondition::Ptr always(new JumpCondition);
+	always->setSensor(Sensor::Ptr(new CountingSensor));
+	always->setConstantGoal(0.0);
+	always->setEpsilon(0.1);
+	s1->add(always);
+
+	// added later, but evaluated first
+	TestControlMode::Ptr m3(new TestControlMode("m3"));
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(always);
+	s2->setPriority(1.0);
+	hybrid_automaton->addControlSwitchAndMode(m1->getName(), s2, m3);
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+	hybrid_automaton->step(0.01);
+	EXPECT_TRUE(m3 == hybrid_automaton->getCurrentControlMode());
+}
+
+TEST_F(HybridAutomatonTest, stepDefersSwitchesOverBudget) {
+	CountingSensor* counting_sensor = new CountingSensor;
+	JumpCondition::Ptr never(new JumpCondition);
+	never->setSensor(Sensor::Ptr(counting_sensor));
+	never->setConstantGoal(1.0);
+	never->setEpsilon(0.1);
+	s1->add(never);
+	s1->setPriority(-1.0);
+
+	CountingSensor* safety_sensor = new CountingSensor;
+	JumpCondition::Ptr safety(new JumpCondition);
+	safety->setSensor(Sensor::Ptr(safety_sensor));
+	safety->setConstantGoal(1.0);
+	safety->setEpsilon(0.1);
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(safety);
+	s2->setSafetyCritical(true);
+	hybrid_automaton->addControlSwitch(m1->getName(), s2, m2->getName());
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+
+	// without budget nothing is deferred
+	for (int i = 0; i < 10; i++)
+		hybrid_automaton->step(0.001 + i * 0.01);
+	EXPECT_EQ(0u, hybrid_automaton->getNumberOfDeferrals());
+
+	// a budget of 1ns is spent after the first evaluation
+	int steps = 100;
+	int safety_evaluations = 0, evaluations = 0;
+	for (int i = 0; i < steps; i++) {
+		int safety_reads = safety_sensor->reads;
+		int reads = counting_sensor->reads;
+		hybrid_automaton->step(0.1 + i * 0.01, 1e-9);
+		if (safety_sensor->reads != safety_reads)
+			safety_evaluations++;
+		if (counting_sensor->reads != reads)
+			evaluations++;
+	}
+
+	// the safety critical switch is never deferred, the other one for at most one step at a time
+	EXPECT_EQ(steps, safety_evaluations);
+	EXPECT_LE(steps / 2, evaluations);
+	EXPECT_EQ((unsigned long long)(steps - evaluations), hybrid_automaton->getNumberOfDeferrals());
+	EXPECT_EQ(hybrid_automaton->getNumberOfDeferrals(), hybrid_automaton->getNumberOfDeferredSteps());
+	EXPECT_LT(0u, hybrid_automaton->getNumberOfDeferrals());
+	EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+}
+
+TEST_F(HybridAutomatonTest, stepDefersBatchedSwitchesOverBudget) {
+	CountingSensor* counting_sensor = new CountingSensor;
+	JumpCondition::Ptr never(new JumpCondition);
+	never->setSensor(Sensor::Ptr(counting_sensor));
+	never->setConstantGoal(1.0);
+	never->setEpsilon(0.1);
+	s1->add(never);
+	s1->setPriority(-1.0);
+
+	CountingSensor* safety_sensor = new CountingSensor;
+	JumpCondition::Ptr safety(new JumpCondition);
+	safety->setSensor(Sensor::Ptr(safety_sensor));
+	safety->setConstantGoal(1.0);
+	safety->setEpsilon(0.1);
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(safety);
+	s2->setSafetyCritical(true);
+	hybrid_automaton->addControlSwitch(m1->getName(), s2, m2->getName());
+
+	hybrid_automaton->setBatchEvaluation(true);
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+
+	// deferred switches are not even gathered into the batch
+	int steps = 100;
+	int safety_evaluations = 0, evaluations = 0;
+	for (int i = 0; i < steps; i++) {
+		int safety_reads = safety_sensor->reads;
+		int reads = counting_sensor->reads;
+		hybrid_automaton->step(0.1 + i * 0.01, 1e-9);
+		if (safety_sensor->reads != safety_reads)
+			safety_evaluations++;
+		if (counting_sensor->reads != reads)
+			evaluations++;
+	}
+
+	EXPECT_EQ(steps, safety_evaluations);
+	EXPECT_LE(steps / 2, evaluations);
+	EXPECT_EQ((unsigned long long)(steps - evaluations), hybrid_automaton->getNumberOfDeferrals());
+	EXPECT_LT(0u, hybrid_automaton->getNumberOfDeferrals());
+	EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+}
+
+// returns the time of the last step and counts how often it is prepared
+class PreparingSensor : public ha::Sensor {
+  public:
+	PreparingSensor() : preparations(0), time(0.0), reads(0) {}
+	virtual ::Eigen::MatrixXd getCurrentValue() const { ++reads; return ::Eigen::MatrixXd::Constant(1, 1, time); }
+	virtual void prepare() { ++preparations; }
+	virtual void step(const double& t) { time = t; }
+	virtual ha::DescriptionTreeNode::Ptr serialize(const ha::DescriptionTree::ConstPtr& factory) const { return ha::DescriptionTreeNode::Ptr(); }
+	virtual void deserialize(const ha::DescriptionTreeNode::ConstPtr& tree, const ha::System::ConstPtr& system, const ha::HybridAutomaton* ha) {}
+	int preparations;
+	double time;
+	mutable int reads;
+  protected:
+	virtual ha::Sensor* _doClone() const { return new PreparingSensor(*this); }
+};
+
+TEST_F(HybridAutomatonTest, stepPreparesLikelyTargetMode) {
+	// switches at t = 1
+	JumpCondition::Ptr timeout(new JumpCondition);
+	timeout->setSensor(Sensor::Ptr(new PreparingSensor));
+	timeout->setConstantGoal(1.0);
+	timeout->setEpsilon(0.001);
+	s1->add(timeout);
+	s1->setPrewarmMargin(0.2);
+
+	// the outgoing switch of the target mode
+	PreparingSensor* target_sensor = new PreparingSensor;
+	JumpCondition::Ptr back(new JumpCondition);
+	back->setSensor(Sensor::Ptr(target_sensor));
+	back->setConstantGoal(-1.0);
+	back->setEpsilon(0.001);
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(back);
+	hybrid_automaton->addControlSwitch(m2->getName(), s2, m1->getName());
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+
+	for (int i = 1; i < 100; i++) {
+		hybrid_automaton->step(i * 0.01);
+		EXPECT_EQ(i * 0.01 < 0.795 ? 0 : 1, target_sensor->preparations) << "t = " << i * 0.01;
+		EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	}
+
+	hybrid_automaton->step(1.0);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+	EXPECT_EQ(1, target_sensor->preparations);
+
+	// without margin nothing is prepared
+	EXPECT_FALSE(s2->isNearlyActive());
+
+	// explicitly
+	hybrid_automaton->prepareControlMode("m2");
+	EXPECT_EQ(2, target_sensor->preparations);
+	EXPECT_ANY_THROW(hybrid_automaton->prepareControlMode("huhu"));
+}
+
+TEST_F(HybridAutomatonTest, stepSchedulesSwitchesByPredictedActivation) {
+	// switches at t = 1, but is only evaluated every half second
+	PreparingSensor* sensor = new PreparingSensor;
+	JumpCondition::Ptr timeout(new JumpCondition);
+	timeout->setSensor(Sensor::Ptr(sensor));
+	timeout->setConstantGoal(1.0);
+	timeout->setEpsilon(0.001);
+	s1->add(timeout);
+	s1->setEvaluationPeriod(0.5);
+	s1->setPrewarmTime(0.2);
+	EXPECT_ANY_THROW(s1->setPrewarmTime(-1.0));
+	EXPECT_ANY_THROW(s1->setMaxEvaluationPeriod(-1.0));
+
+	PreparingSensor* target_sensor = new PreparingSensor;
+	JumpCondition::Ptr back(new JumpCondition);
+	back->setSensor(Sensor::Ptr(target_sensor));
+	back->setConstantGoal(-1.0);
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(back);
+	hybrid_automaton->addControlSwitch(m2->getName(), s2, m1->getName());
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+	sensor->reads = 0;
+
+	// evaluated at 0.01 and 0.5, which predicts the activation at 0.999 - before the period is over,
+	// and at 0.8 to prepare the target mode in time
+	for (int i = 1; i < 100; i++) {
+		hybrid_automaton->step(i * 0.01);
+		EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	}
+	EXPECT_EQ(3, sensor->reads);
+	EXPECT_EQ(1, target_sensor->preparations);
+	EXPECT_NEAR(0.999, s1->getPredictedActivationTime(), 1e-6);
+
+	hybrid_automaton->step(1.0);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+}
+
+TEST_F(HybridAutomatonTest, stepEvaluatesDistantSwitchesLessOften) {
+	// switches at t = 10
+	PreparingSensor* sensor = new PreparingSensor;
+	JumpCondition::Ptr timeout(new JumpCondition);
+	timeout->setSensor(Sensor::Ptr(sensor));
+	timeout->setConstantGoal(10.0);
+	timeout->setEpsilon(0.001);
+	s1->add(timeout);
+	s1->setMaxEvaluationPeriod(0.5);
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+	sensor->reads = 0;
+
+	int i = 1;
+	for (; i < 500; i++) {
+		hybrid_automaton->step(i * 0.01);
+		EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	}
+	EXPECT_NEAR(12, sensor->reads, 2);
+
+	// evaluated more often when getting closer, without missing the activation
+	for (; i < 1000; i++) {
+		hybrid_automaton->step(i * 0.01);
+		EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	}
+	EXPECT_GT(100, sensor->reads);
+	hybrid_automaton->step(10.0);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+
+	// safety critical switches are evaluated in every step
+	s1->setSafetyCritical(true);
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+	sensor->reads = 0;
+	for (i = 1; i < 100; i++)
+		hybrid_automaton->step(i * 0.01);
+	EXPECT_EQ(99, sensor->reads);
+}
+
+TEST_F(HybridAutomatonTest, conditionViewExposesCriteria) {
+	// active at t = 1
+	JumpCondition::Ptr timeout(new JumpCondition);
+	timeout->setSensor(Sensor::Ptr(new PreparingSensor));
+	timeout->setConstantGoal(1.0);
+	timeout->setEpsilon(0.1);
+	s1->add(timeout);
+
+	JumpCondition::Ptr negated(new JumpCondition);
+	negated->setSensor(Sensor::Ptr(new PreparingSensor));
+	negated->setConstantGoal(0.0);
+	negated->setEpsilon(0.5);
+	negated->setNegate(true);
+	s1->add(negated);
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+
+	const ConditionView& view = hybrid_automaton->getConditionView();
+	ASSERT_EQ(2u, view.size());
+	EXPECT_TRUE(s1.get() == view.getControlSwitch(0));
+	EXPECT_TRUE(timeout.get() == view.getJumpCondition(0));
+	EXPECT_TRUE(negated.get() == view.getJumpCondition(1));
+	EXPECT_FALSE(view.hasCriterion(0));
+
+	s1->setAdaptiveOrdering(false);
+	hybrid_automaton->step(0.3);
+	EXPECT_TRUE(view.isCurrent(0, 0.3));
+	EXPECT_NEAR(0.7, view.getCriterion(0), 1e-9);
+	EXPECT_NEAR(-0.6, view.getMargin(0), 1e-9);
+
+	// short-circuited by the first condition
+	EXPECT_FALSE(view.hasCriterion(1));
+
+	hybrid_automaton->step(0.95);
+	EXPECT_TRUE(view.isCurrent(0, 0.95));
+	EXPECT_NEAR(0.05, view.getMargin(0), 1e-9);
+	EXPECT_TRUE(view.isCurrent(1, 0.95));
+	EXPECT_NEAR(0.45, view.getMargin(1), 1e-9);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+}
+
+TEST_F(HybridAutomatonTest, stepEnforcesMinDwellTime) {
+	// always active
+	JumpCondition::Ptr always(new JumpCondition);
+	always->setSensor(Sensor::Ptr(new PreparingSensor));
+	always->setConstantGoal(0.0);
+	always->setEpsilon(1e6);
+	s1->add(always);
+	s1->setMinDwellTime(0.5);
+	EXPECT_ANY_THROW(s1->setMinDwellTime(-1.0));
+
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(always);
+	s2->setMinDwellTime(0.5);
+	hybrid_automaton->addControlSwitch(m2->getName(), s2, m1->getName());
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(1.0));
+
+	// one transition every 0.5s instead of one per step
+	int transitions = 0;
+	ControlMode::Ptr mode = hybrid_automaton->getCurrentControlMode();
+	for (int i = 1; i <= 210; i++) {
+		hybrid_automaton->step(1.0 + i * 0.01);
+		if (hybrid_automaton->getCurrentControlMode() != mode) {
+			transitions++;
+			mode = hybrid_automaton->getCurrentControlMode();
+		}
+	}
+	EXPECT_EQ(4, transitions);
+}
+
+// returns a value that is set from outside
+class ValueSensor : public ha::Sensor {
+  public:
+	ValueSensor() : value(0.0) {}
+	virtual ::Eigen::MatrixXd getCurrentValue() const { return ::Eigen::MatrixXd::Constant(1, 1, value); }
+	virtual ha::DescriptionTreeNode::Ptr serialize(const ha::DescriptionTree::ConstPtr& factory) const { return ha::DescriptionTreeNode::Ptr(); }
+	virtual void deserialize(const ha::DescriptionTreeNode::ConstPtr& tree, const ha::System::ConstPtr& system, const ha::HybridAutomaton* ha) {}
+	double value;
+  protected:
+	virtual ha::Sensor* _doClone() const { return new ValueSensor(*this); }
+};
+
+TEST_F(HybridAutomatonTest, stepDampsChatteringWithHysteresis) {
+	ValueSensor* force = new ValueSensor;
+	Sensor::Ptr force_sensor(force);
+
+	// m1 -> m2 at a force of 10 or more, m2 -> m1 at 10 or less
+	JumpCondition::Ptr above(new JumpCondition);
+	above->setSensor(force_sensor);
+	above->setConstantGoal(10.0);
+	above->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+	above->setEpsilon(0.0);
+	s1->add(above);
+
+	JumpCondition::Ptr below(new JumpCondition);
+	below->setSensor(force_sensor);
+	below->setConstantGoal(10.0);
+	below->setJumpCriterion(JumpCondition::THRESH_LOWER_BOUND);
+	below->setEpsilon(0.0);
+	ControlSwitch::Ptr s2(new ControlSwitch);
+	s2->add(below);
+	hybrid_automaton->addControlSwitch(m2->getName(), s2, m1->getName());
+
+	// noise around 10
+	const double noise[] = { 10.5, 9.5, 10.5, 9.5, 10.5, 9.5, 10.5, 9.5 };
+	const int num_noise = sizeof(noise) / sizeof(noise[0]);
+
+	// without hysteresis every step switches
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+	int transitions = 0;
+	ControlMode::Ptr mode = hybrid_automaton->getCurrentControlMode();
+	for (int i = 0; i < num_noise; i++) {
+		force->value = noise[i];
+		hybrid_automaton->step(0.01 * (i + 1));
+		if (hybrid_automaton->getCurrentControlMode() != mode) {
+			transitions++;
+			mode = hybrid_automaton->getCurrentControlMode();
+		}
+	}
+	EXPECT_EQ(num_noise, transitions);
+
+	// with it the way back needs the force to cross the band
+	above->setHysteresis(1.0);
+	below->setHysteresis(1.0);
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(1.0));
+	transitions = 0;
+	mode = hybrid_automaton->getCurrentControlMode();
+	for (int i = 0; i < num_noise; i++) {
+		force->value = noise[i];
+		hybrid_automaton->step(1.0 + 0.01 * (i + 1));
+		if (hybrid_automaton->getCurrentControlMode() != mode) {
+			transitions++;
+			mode = hybrid_automaton->getCurrentControlMode();
+		}
+	}
+	EXPECT_EQ(1, transitions);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+	EXPECT_TRUE(below->isReturning());
+
+	// leaving the band switches back, and then the band has to be crossed in the other direction
+	force->value = 8.5;
+	hybrid_automaton->step(1.1);
+	EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	force->value = 10.5;
+	hybrid_automaton->step(1.11);
+	EXPECT_TRUE(m1 == hybrid_automaton->getCurrentControlMode());
+	force->value = 11.5;
+	hybrid_automaton->step(1.12);
+	EXPECT_TRUE(m2 == hybrid_automaton->getCurrentControlMode());
+}
+
+TEST_F(HybridAutomatonTest, stepStepsSensorsOfWaitingSwitches) {
+	// the speed of a position that starts to move at 1m/s at t = 0.3
+	ValueSensor* position = new ValueSensor;
+	DerivativeSensor::Ptr speed(new DerivativeSensor);
+	speed->addOperand(Sensor::Ptr(position));
+	speed->setWindowSize(3);
+
+	JumpCondition::Ptr moving(new JumpCondition);
+	moving->setSensor(speed);
+	moving->setConstantGoal(0.5);
+	moving->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+	moving->setEpsilon(0.0);
+	s1->add(moving);
+	s1->setMinDwellTime(0.5);
+
+	ASSERT_NO_THROW(hybrid_automaton->setCurrentControlMode("m1"));
+	ASSERT_NO_THROW(hybrid_automaton->initialize(0.0));
+
+	// the derivative is taken over the last control cycles, not over the whole dwell time
+	for (int i = 1; i <= 50; i++) {
+		const double t = 0.01 * i;
+		position->value = std::max(t - 0.3, 0.0);
+		hybrid_automaton->step(t);
+		EXPECT_TRUE((i < 50 ? m1 : m2) == hybrid_automaton->getCurrentControlMode()) << "t = " << t;
+	}
+	EXPECT_NEAR(1.0, speed->getCurrentValue()(0), 1e-9);
+}
+
+class IdentitySensor : public ha::Sensor {
+  public:
+	virtual ::Eigen::MatrixXd getCurrentValue() const { return ::Eigen::MatrixXd::Identity(3, 3); }
+	virtual ha::DescriptionTreeNode::Ptr serialize(const ha::DescriptionTree::ConstPtr& factory) const { return ha::DescriptionTreeNode::Ptr(); }
+	virtual void deserialize(const ha::DescriptionTreeNode::ConstPtr& tree, const ha::System::ConstPtr& system, const ha::HybridAutomaton* ha) {}
+  protected:
+	virtual ha::Sensor* _doClone() const { return new IdentitySensor(*this); }
+};
+
+static JumpCondition::Ptr createTimeCondition(JumpCondition::JumpCriterion criterion, double goal, double epsilon, bool negate = false)
+{
+	JumpCondition::Ptr jump_condition(new JumpCondition);
+	jump_condition->setSensor(Sensor::Ptr(new PreparingSensor));
+	jump_condition->setJumpCriterion(criterion);
+	jump_condition->setConstantGoal(goal);
+	jump_condition->setEpsilon(epsilon);
+	jump_condition->setNegate(negate);
+	return jump_condition;
+}
+
+static HybridAutomaton::Ptr createManySwitches(bool batch_evaluation)
+{
+	HybridAutomaton::Ptr hybrid_automaton(new HybridAutomaton);
+	hybrid_automaton->setBatchEvaluation(batch_evaluation);
+	hybrid_automaton->addControlMode(ControlMode::Ptr(new TestControlMode("m1")));
+	hybrid_automaton->addControlMode(ControlMode::Ptr(new TestControlMode("m2")));
+
+	// active for t in [1.95, 2.05]
+	ControlSwitch::Ptr s(new ControlSwitch);
+	s->add(createTimeCondition(JumpCondition::THRESH_UPPER_BOUND, 0.5, 0.0));
+	s->add(createTimeCondition(JumpCondition::NORM_L1, 2.0, 0.05));
+	hybrid_automaton->addControlSwitch("m1", s, "m2");
+
+	// active for t in [1.15, 1.25], the rotation is not batched and only checked after the norm
+	s.reset(new ControlSwitch);
+	s->setAdaptiveOrdering(false);
+	JumpCondition::Ptr weighted = createTimeCondition(JumpCondition::NORM_L2, 1.2, 0.1);
+	weighted->setJumpCriterion(JumpCondition::NORM_L2, ::Eigen::MatrixXd::Constant(1, 1, 4.0));
+	s->add(weighted);
+	JumpCondition::Ptr rotation(new JumpCondition);
+	rotation->setSensor(Sensor::Ptr(new IdentitySensor));
+	rotation->setJumpCriterion(JumpCondition::NORM_ROTATION);
+	rotation->setConstantGoal(::Eigen::MatrixXd::Identity(3, 3));
+	rotation->setEpsilon(0.01);
+	s->add(rotation);
+	hybrid_automaton->addControlSwitch("m1", s, "m2");
+
+	// active for t in [0.775, 0.825]
+	s.reset(new ControlSwitch);
+	s->add(createTimeCondition(JumpCondition::THRESH_LOWER_BOUND, 0.5, 0.1, true));
+	s->add(createTimeCondition(JumpCondition::NORM_L_INF, 0.8, 0.025));
+	hybrid_automaton->addControlSwitch("m1", s, "m2");
+
+	// active for t >= 3
+	s.reset(new ControlSwitch);
+	s->add(createTimeCondition(JumpCondition::THRESH_UPPER_BOUND, 3.0, 0.0));
+	hybrid_automaton->addControlSwitch("m1", s, "m2");
+
+	hybrid_automaton->setCurrentControlMode("m1");
+	hybrid_automaton->initialize(0.0);
+	return hybrid_automaton;
+}
+
+TEST(HybridAutomatonBatchEvaluation, stepEvaluatesConditionsInBatches) {
+	HybridAutomaton::Ptr sequential = createManySwitches(false);
+	HybridAutomaton::Ptr batched = createManySwitches(true);
+	const ConditionView& sequential_view = sequential->getConditionView();
+	const ConditionView& batched_view = batched->getConditionView();
+	ASSERT_EQ(7u, batched_view.size());
+
+	// the rotation cannot be batched, the two upper bounds share a group
+	ConditionBatch batch;
+	for (std::size_t i = 0; i < batched_view.size(); i++) {
+		if (i == 0 || batched_view.getControlSwitch(i) != batched_view.getControlSwitch(i - 1))
+			batch.add(const_cast<ControlSwitch*>(batched_view.getControlSwitch(i)));
+	}
+	EXPECT_EQ(4u, batch.getNumberOfSwitches());
+	EXPECT_EQ(6u, batch.getNumberOfBatchedConditions());
+	EXPECT_EQ(5u, batch.getNumberOfGroups());
+
+	int transition = -1;
+	for (int i = 1; i <= 100 && transition < 0; i++) {
+		const double t = i * 0.01;
+		sequential->step(t);
+		batched->step(t);
+		EXPECT_EQ(sequential->getCurrentControlMode()->getName(), batched->getCurrentControlMode()->getName());
+		if (batched->getCurrentControlMode()->getName() == "m2")
+			transition = i;
+
+		// the batch computes at least what was computed one by one, with the same result
+		for (std::size_t j = 0; j < sequential_view.size(); j++) {
+			if (!sequential_view.isCurrent(j, t))
+				continue;
+			EXPECT_TRUE(batched_view.isCurrent(j, t));
+			EXPECT_NEAR(sequential_view.getCriterion(j), batched_view.getCriterion(j), 1e-12);
+		}
+	}
+	EXPECT_EQ(78, transition);
+}
+
+namespace {
+	// a condition that is never active, whatever its criterion says
+	class VetoCondition : public JumpCondition {
+	public:
+		VetoCondition() : evaluations(0) {}
+		virtual bool isActive() const { ++evaluations; return false; }
+		mutable int evaluations;
+	protected:
+		virtual JumpCondition* _doClone() const { return new VetoCondition(*this); }
+	};
+}
+
+TEST(HybridAutomatonBatchEvaluation, stepDoesNotBatchSubclasses) {
+	HybridAutomaton::Ptr hybrid_automaton(new HybridAutomaton);
+	hybrid_automaton->setBatchEvaluation(true);
+	hybrid_automaton->addControlMode(ControlMode::Ptr(new TestControlMode("m1")));
+	hybrid_automaton->addControlMode(ControlMode::Ptr(new TestControlMode("m2")));
+
+	// batchable by its criterion and goal, but it overrides isActive()
+	VetoCondition* veto = new VetoCondition;
+	veto->setSensor(Sensor::Ptr(new PreparingSensor));
+	veto->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+	veto->setConstantGoal(0.5);
+	veto->setEpsilon(0.0);
+	ControlSwitch::Ptr s(new ControlSwitch);
+	s->add(JumpCondition::Ptr(veto));
+	hybrid_automaton->addControlSwitch("m1", s, "m2");
+
+	hybrid_automaton->setCurrentControlMode("m1");
+	hybrid_automaton->initialize(0.0);
+
+	ConditionBatch batch;
+	batch.add(s.get());
+	EXPECT_EQ(0u, batch.getNumberOfBatchedConditions());
+
+	for (int i = 1; i <= 10; i++)
+		hybrid_automaton->step(i * 0.1);
+	EXPECT_EQ("m1", hybrid_automaton->getCurrentControlMode()->getName());
+	EXPECT_EQ(10, veto->evaluations);
+}
+
 //TEST_F(HybridAutomatonTest, stepAndSwitch) {
 //	double switching_time = 1.0;
 //	TimeConditionPtr time_switch(new TimeCondition(switching_time));
@@ -1,7 +1,9 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include <cmath>
 #include <string>
+#include <limits>
 
 #include "hybrid_automaton/JumpCondition.h"
 #include "hybrid_automaton/DescriptionTreeNode.h"
@@ -9,6 +11,8 @@
 #include "hybrid_automaton/FrameOrientationSensor.h"
 #include "hybrid_automaton/FrameDisplacementSensor.h"
 #include "hybrid_automaton/FramePoseSensor.h"
+#include "hybrid_automaton/ClockSensor.h"
+#include "hybrid_automaton/ROSTopicSensor.h"
 #include "tests/MockDescriptionTree.h"
 #include "tests/MockDescriptionTreeNode.h"
 
@@ -287,3 +291,309 @@ TEST(JumpCondition, Activation) {
     jc1->setNegate(false);
 }
 
+TEST(JumpCondition, EarliestActivationTime) {
+	using namespace ha;
+
+	JumpCondition::Ptr jc(new JumpCondition);
+	ClockSensor::Ptr clock(new ClockSensor);
+	jc->setSensor(clock);
+	jc->setConstantGoal(2.0);
+	jc->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+	jc->setEpsilon(0.5);
+	jc->initialize(1.0);
+
+	// absolute: t >= goal - epsilon
+	EXPECT_NEAR(1.5, jc->getEarliestActivationTime(), 1e-6);
+	EXPECT_LT(jc->getEarliestActivationTime(), 1.5);
+
+	// relative to the time of initialize()
+	jc->setGoalRelative();
+	EXPECT_NEAR(2.5, jc->getEarliestActivationTime(), 1e-6);
+
+	// weights scale epsilon
+	::Eigen::MatrixXd weights(1,1);
+	weights << 2.0;
+	jc->setJumpCriterion(JumpCondition::NORM_L_INF, weights);
+	EXPECT_NEAR(2.75, jc->getEarliestActivationTime(), 1e-6);
+
+	// never active
+	jc->setEpsilon(-1.0);
+	EXPECT_EQ(std::numeric_limits<double>::infinity(), jc->getEarliestActivationTime());
+
+	// active right away / unknown
+	jc->setEpsilon(0.5);
+	jc->setNegate(true);
+	EXPECT_EQ(-std::numeric_limits<double>::infinity(), jc->getEarliestActivationTime());
+
+	jc->setJumpCriterion(JumpCondition::THRESH_LOWER_BOUND);
+	EXPECT_NEAR(3.5, jc->getEarliestActivationTime(), 1e-6);
+	jc->setNegate(false);
+	EXPECT_EQ(-std::numeric_limits<double>::infinity(), jc->getEarliestActivationTime());
+
+	// the condition agrees at the earliest time
+	jc->setJumpCriterion(JumpCondition::THRESH_UPPER_BOUND);
+	jc->setGoalAbsolute();
+	clock->step(1.5 - 1e-3);
+	EXPECT_FALSE(jc->isActive());
+	clock->step(1.5);
+	EXPECT_TRUE(jc->isActive());
+
+	// other sensors are not clocks
+	JumpCondition::Ptr joints(new JumpCondition);
+	joints->setSensor(Sensor::Ptr(new JointConfigurationSensor));
+	joints->setConstantGoal(2.0);
+	EXPECT_EQ(-std::numeric_limits<double>::infinity(), joints->getEarliestActivationTime());
+}
+
+namespace {
+	// reports a new value only when told so
+	class EventSensor : public ha::Sensor {
+	public:
+		EventSensor() : value(::Eigen::MatrixXd::Zero(1,1)), updated(true), reads(0) {}
+		virtual ::Eigen::MatrixXd getCurrentValue() const { ++reads; return value; }
+		virtual bool hasNewValue() const { return updated; }
+		virtual ha::DescriptionTreeNode::Ptr serialize(const ha::DescriptionTree::ConstPtr& factory) const { return ha::DescriptionTreeNode::Ptr(); }
+		virtual void deserialize(const ha::DescriptionTreeNode::ConstPtr& tree, const ha::System::ConstPtr& system, const ha::HybridAutomaton* ha) {}
+		::Eigen::MatrixXd value;
+		bool updated;
+		mutable int reads;
+	protected:
+		virtual ha::Sensor* _doClone() const { return new EventSensor(*this); }
+	};
+}
+
+TEST(JumpCondition, EventDrivenSensor) {
+	using namespace ha;
+
+	EventSensor* sensor = new EventSensor;
+	JumpCondition::Ptr jc(new JumpCondition);
+	jc->setSensor(Sensor::Ptr(sensor));
+	jc->setConstantGoal(1.0);
+	jc->setEpsilon(0.1);
+	jc->initialize(0.0);
+
+	EXPECT_FALSE(jc->isActive());
+
+	// no new value: the last result is reused without reading the sensor
+	sensor->updated = false;
+	sensor->value(0,0) = 1.0;
+	sensor->reads = 0;
+	EXPECT_FALSE(jc->isActive());
+	EXPECT_EQ(0, sensor->reads);
+
+	sensor->updated = true;
+	EXPECT_TRUE(jc->isActive());
+
+	// changing the condition invalidates the last result
+	sensor->updated = false;
+	jc->setNegate(true);
+	EXPECT_FALSE(jc->isActive());
+}
+
+namespace {
+	// a topic whose update flag is consumed when it is queried
+	class ROSTopicSystem : public JumpConditionSerialization1::MockSystem {
+	public:
+		ROSTopicSystem() : pose(::Eigen::MatrixXd::Zero(1,1)), updated(true) {}
+		virtual bool subscribeToROSMessage(const std::string& topic) const { return true; }
+		virtual bool isROSTopicAvailable(const std::string& topic_name) const { return true; }
+		virtual bool isROSTopicUpdated(const std::string& topic_name) const { bool ret = updated; updated = false; return ret; }
+		virtual bool getROSPose(const std::string& topic_name, const std::string& topic_type, ::Eigen::MatrixXd& pose) const { pose = this->pose; return true; }
+		void publish(double value) { pose(0,0) = value; updated = true; }
+		::Eigen::MatrixXd pose;
+		mutable bool updated;
+	};
+}
+
+TEST(JumpCondition, ROSTopicUpdateIsLatchedPerStep) {
+	using namespace ha;
+
+	ROSTopicSystem* system = new ROSTopicSystem;
+	ROSTopicSensor::Ptr sensor(new ROSTopicSensor);
+	sensor->setSystem(System::ConstPtr(system));
+	sensor->setTopic("/pose", "Float64");
+
+	JumpCondition::Ptr jc(new JumpCondition);
+	jc->setSensor(sensor);
+	jc->setConstantGoal(1.0);
+	jc->setEpsilon(0.1);
+	jc->initialize(0.0);
+	EXPECT_FALSE(jc->isActive());
+
+	// the update is seen by hasNewValue and getCurrentValue alike
+	system->publish(1.0);
+	jc->step(0.1);
+	EXPECT_TRUE(sensor->hasNewValue());
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_DOUBLE_EQ(1.0, sensor->getCurrentValue()(0,0));
+
+	// until the next step
+	jc->step(0.2);
+	EXPECT_FALSE(sensor->hasNewValue());
+	EXPECT_TRUE(jc->isActive());
+
+	system->publish(0.0);
+	jc->step(0.3);
+	EXPECT_FALSE(jc->isActive());
+}
+
+TEST(JumpCondition, Hysteresis) {
+	EventSensor* sensor = new EventSensor;
+	JumpCondition::Ptr jc(new JumpCondition);
+	jc->setSensor(Sensor::Ptr(sensor));
+	jc->setConstantGoal(1.0);
+	jc->setEpsilon(0.1);
+	jc->setHysteresis(0.05);
+	EXPECT_ANY_THROW(jc->setHysteresis(-1.0));
+	EXPECT_DOUBLE_EQ(0.05, jc->getHysteresis());
+	jc->initialize(0.0);
+
+	// enters at epsilon
+	sensor->value(0,0) = 0.88;
+	EXPECT_FALSE(jc->isActive());
+	sensor->value(0,0) = 0.91;
+	EXPECT_TRUE(jc->isActive());
+
+	// noise around epsilon does not make it inactive, leaving the band does
+	sensor->value(0,0) = 0.88;
+	EXPECT_TRUE(jc->isActive());
+	sensor->value(0,0) = 0.86;
+	EXPECT_TRUE(jc->isActive());
+	sensor->value(0,0) = 0.84;
+	EXPECT_FALSE(jc->isActive());
+	sensor->value(0,0) = 0.88;
+	EXPECT_FALSE(jc->isActive());
+
+	// negated: active above epsilon, inactive below epsilon - hysteresis
+	jc->setNegate(true);
+	sensor->value(0,0) = 0.85;
+	EXPECT_TRUE(jc->isActive());
+	sensor->value(0,0) = 0.93;
+	EXPECT_TRUE(jc->isActive());
+	sensor->value(0,0) = 0.96;
+	EXPECT_FALSE(jc->isActive());
+
+	// a new activation starts outside the band
+	jc->setNegate(false);
+	sensor->value(0,0) = 0.91;
+	EXPECT_TRUE(jc->isActive());
+	jc->initialize(1.0);
+	sensor->value(0,0) = 0.88;
+	EXPECT_FALSE(jc->isActive());
+}
+
+namespace {
+	class GoalCountingController : public ha::Controller {
+	public:
+		GoalCountingController() : goal_reads(0) {}
+		virtual ::Eigen::MatrixXd getGoal() const { ++goal_reads; return ha::Controller::getGoal(); }
+		mutable int goal_reads;
+	};
+}
+
+TEST(JumpCondition, ControllerGoalIsCopiedWhenItChanges) {
+	using namespace ha;
+
+	EventSensor* sensor = new EventSensor;
+	GoalCountingController* controller = new GoalCountingController;
+	Controller::Ptr controller_ptr(controller);
+	controller->setGoal(::Eigen::MatrixXd::Constant(1, 1, 1.0));
+
+	JumpCondition::Ptr jc(new JumpCondition);
+	jc->setSensor(Sensor::Ptr(sensor));
+	jc->setControllerGoal(controller_ptr);
+	jc->setEpsilon(0.1);
+	jc->initialize(0.0);
+
+	// unversioned goals (the default) are copied in every evaluation
+	EXPECT_FALSE(controller->getGoalVersioning());
+	EXPECT_EQ((unsigned long)Controller::UNVERSIONED_GOAL, controller->getGoalVersion());
+	sensor->value(0,0) = 1.0;
+	sensor->reads = 0;
+	EXPECT_TRUE(jc->isActive());
+	sensor->updated = false;
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_EQ(2, controller->goal_reads);
+	EXPECT_EQ(2, sensor->reads);
+
+	sensor->updated = true;
+	sensor->reads = 0;
+	controller->goal_reads = 0;
+	controller->setGoalVersioning(true);
+	EXPECT_NE((unsigned long)Controller::UNVERSIONED_GOAL, controller->getGoalVersion());
+	jc->initialize(0.0);
+
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_EQ(1, controller->goal_reads);
+
+	// a new goal is used from the next evaluation on
+	unsigned long version = controller->getGoalVersion();
+	controller->setGoal(::Eigen::MatrixXd::Constant(1, 1, 2.0));
+	EXPECT_NE(version, controller->getGoalVersion());
+	EXPECT_FALSE(jc->isActive());
+	EXPECT_EQ(2, controller->goal_reads);
+
+	// without a new sensor value only a new goal causes an evaluation
+	sensor->updated = false;
+	sensor->reads = 0;
+	EXPECT_FALSE(jc->isActive());
+	EXPECT_EQ(0, sensor->reads);
+	controller->setGoal(::Eigen::MatrixXd::Constant(1, 1, 1.0));
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_EQ(1, sensor->reads);
+	EXPECT_EQ(3, controller->goal_reads);
+
+	// every activation starts with a fresh copy
+	jc->initialize(1.0);
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_EQ(4, controller->goal_reads);
+}
+
+TEST(JumpCondition, PredictedActivationTime) {
+	using namespace ha;
+
+	EventSensor* sensor = new EventSensor;
+	JumpCondition::Ptr jc(new JumpCondition);
+	jc->setSensor(Sensor::Ptr(sensor));
+	jc->setConstantGoal(1.0);
+	jc->setEpsilon(0.1);
+	jc->initialize(0.0);
+	EXPECT_EQ(JumpCondition::LINEAR, jc->getConvergenceModel());
+
+	// no prediction before there are two criteria
+	EXPECT_EQ(-std::numeric_limits<double>::infinity(), jc->getPredictedActivationTime());
+
+	// the criterion shrinks by 0.1 per second and reaches the epsilon at t = 9
+	for (int i = 0; i < 3; i++) {
+		sensor->value(0,0) = 0.1 * i;
+		jc->step(i);
+		EXPECT_FALSE(jc->isActive());
+	}
+	EXPECT_NEAR(9.0, jc->getPredictedActivationTime(), 1e-6);
+
+	// a condition that moves away is never predicted to become active
+	jc->initialize(5.0);
+	for (int i = 0; i < 3; i++) {
+		sensor->value(0,0) = -0.5 * i;
+		jc->step(5.0 + i);
+		EXPECT_FALSE(jc->isActive());
+	}
+	EXPECT_EQ(std::numeric_limits<double>::infinity(), jc->getPredictedActivationTime());
+
+	// the criterion halves every second and reaches the epsilon 1.32 seconds after t = 2
+	jc->setConvergenceModel(JumpCondition::EXPONENTIAL);
+	jc->initialize(0.0);
+	for (int i = 0; i < 3; i++) {
+		sensor->value(0,0) = 1.0 - std::pow(0.5, i);
+		jc->step(i);
+		EXPECT_FALSE(jc->isActive());
+	}
+	EXPECT_NEAR(2.0 + std::log(0.25 / 0.1) / std::log(2.0), jc->getPredictedActivationTime(), 1e-6);
+
+	// an active condition is active now
+	sensor->value(0,0) = 1.0;
+	jc->step(3.0);
+	EXPECT_TRUE(jc->isActive());
+	EXPECT_DOUBLE_EQ(3.0, jc->getPredictedActivationTime());
+}
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "hybrid_automaton/Profiler.h"
+
+#include <sstream>
+
+using namespace ha;
+
+TEST(LatencyHistogram, Buckets) {
+    // small values are exact
+    for (int i = 0; i < LatencyHistogram::SUB_BUCKETS; i++) {
+        EXPECT_EQ(i, LatencyHistogram::bucketIndex(i));
+        EXPECT_EQ((LatencyHistogram::Ticks)i, LatencyHistogram::bucketUpperBound(i));
+    }
+
+    // every value lies within its bucket and the relative error is bounded
+    for (LatencyHistogram::Ticks v = 1; v < (1ULL << 40); v = v * 3 + 1) {
+        int idx = LatencyHistogram::bucketIndex(v);
+        EXPECT_LE(v, LatencyHistogram::bucketUpperBound(idx));
+        EXPECT_GT(v, LatencyHistogram::bucketUpperBound(idx - 1));
+        EXPECT_LE((double)(LatencyHistogram::bucketUpperBound(idx) - v) / v, 1.0 / LatencyHistogram::SUB_BUCKETS);
+    }
+}
+
+TEST(LatencyHistogram, Percentiles) {
+    LatencyHistogram h;
+    EXPECT_EQ(0u, h.getCount());
+    EXPECT_EQ(0u, h.getPercentile(50.0));
+
+    for (int i = 1; i <= 1000; i++)
+        h.record(i);
+
+    EXPECT_EQ(1000u, h.getCount());
+    EXPECT_EQ(1u, h.getMin());
+    EXPECT_EQ(1000u, h.getMax());
+    EXPECT_EQ(500500u, h.getTotal());
+    EXPECT_NEAR(500.0, (double)h.getPercentile(50.0), 500.0 / LatencyHistogram::SUB_BUCKETS);
+    EXPECT_NEAR(990.0, (double)h.getPercentile(99.0), 990.0 / LatencyHistogram::SUB_BUCKETS);
+    EXPECT_EQ(1000u, h.getPercentile(100.0));
+
+    h.reset();
+    EXPECT_EQ(0u, h.getCount());
+}
+
+TEST(Profiler, ScopeTreeAndOverruns) {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+    profiler.setTickBudget(1e-12);
+
+    for (int tick = 0; tick < 3; tick++) {
+        Profiler::TickScope tick_scope("ha");
+        {
+            Profiler::Scope scope("ControlSwitch::isActive", "cheap");
+        }
+        {
+            Profiler::Scope scope("ControlSwitch::isActive", "expensive");
+            volatile double x = 0.0;
+            for (int i = 0; i < 100000; i++)
+                x += i;
+        }
+    }
+
+    std::vector<Profiler::NodeStatistics> statistics;
+    profiler.getStatistics(statistics);
+    ASSERT_EQ(3u, statistics.size());
+    EXPECT_EQ("HybridAutomaton::step ha", statistics[0].label);
+    EXPECT_EQ("ControlSwitch::isActive cheap", statistics[1].label);
+    EXPECT_EQ("ControlSwitch::isActive expensive", statistics[2].label);
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(3u, statistics[i].count);
+    EXPECT_GE(statistics[0].total, statistics[1].total + statistics[2].total);
+
+    EXPECT_EQ(3u, profiler.getTickCount());
+    EXPECT_EQ(3u, profiler.getOverrunCount());
+    std::vector<Profiler::Overrun> overruns;
+    profiler.getOverruns(overruns);
+    ASSERT_EQ(3u, overruns.size());
+    EXPECT_EQ("HybridAutomaton::step ha;ControlSwitch::isActive expensive", profiler.getPath(overruns[0].culprit));
+
+    std::stringstream ss;
+    profiler.dump(ss);
+    EXPECT_NE(std::string::npos, ss.str().find("ControlSwitch::isActive expensive"));
+
+    profiler.setTickBudget(0.0);
+    profiler.reset();
+}
+
+TEST(Profiler, NodesAreKeyedByName) {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+
+    // e.g. the same automaton deserialized again: same names, other objects
+    for (int tick = 0; tick < 2; tick++) {
+        Profiler::TickScope tick_scope("ha");
+        Profiler::Scope scope("ControlSwitch::isActive", std::string("switch"));
+    }
+    {
+        Profiler::TickScope tick_scope("other");
+        Profiler::Scope scope("ControlSwitch::isActive", "switch");
+    }
+
+    std::vector<Profiler::NodeStatistics> statistics;
+    profiler.getStatistics(statistics);
+    ASSERT_EQ(4u, statistics.size());
+    EXPECT_EQ("HybridAutomaton::step ha", statistics[0].label);
+    EXPECT_EQ(2u, statistics[0].count);
+    EXPECT_EQ(2u, statistics[1].count);
+    EXPECT_EQ("HybridAutomaton::step other;ControlSwitch::isActive switch", profiler.getPath(statistics[3].id));
+    EXPECT_EQ(1u, statistics[3].count);
+
+    profiler.reset();
+}
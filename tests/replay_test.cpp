@@ -0,0 +1,268 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <Eigen/Dense>
+
+#include "hybrid_automaton/Replay.h"
+#include "hybrid_automaton/ReplaySystem.h"
+#include "hybrid_automaton/TraceRecorder.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/JointConfigurationSensor.h"
+#include "hybrid_automaton/AsyncSensor.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace ha;
+
+namespace {
+
+    // a single joint moving along a sine
+    class SineSystem : public System {
+    public:
+        SineSystem() : time(0.0) {}
+        virtual int getDof() const { return 1; }
+        virtual ::Eigen::MatrixXd getJointConfiguration() const { return ::Eigen::MatrixXd::Constant(1, 1, std::sin(time)); }
+        virtual ::Eigen::MatrixXd getJointVelocity() const { return ::Eigen::MatrixXd::Constant(1, 1, std::cos(time)); }
+        virtual ::Eigen::MatrixXd getForceTorqueMeasurement(const int& port) const { return ::Eigen::MatrixXd::Zero(6, 1); }
+        virtual ::Eigen::MatrixXd getFramePose(const std::string& frame_id) const { return ::Eigen::MatrixXd::Identity(4, 4); }
+        double time;
+    };
+
+    class ReplayControlMode : public ControlMode {
+    public:
+        ReplayControlMode(const std::string& s) : ControlMode(s) {}
+        virtual void initialize() {}
+        virtual void terminate() {}
+        virtual ::Eigen::MatrixXd step(const double& t) { return ::Eigen::MatrixXd(0, 0); }
+        virtual void switchControlMode(ControlMode::Ptr otherMode) {}
+    };
+
+    // throws from step() once the joint passes 0.5
+    class ThrowingControlMode : public ReplayControlMode {
+    public:
+        ThrowingControlMode(const std::string& s, const System::ConstPtr& system, bool standard) : ReplayControlMode(s), system(system), standard(standard) {}
+        virtual ::Eigen::MatrixXd step(const double& t) {
+            if (system->getJointConfiguration()(0, 0) > 0.5) {
+                if (standard)
+                    throw std::runtime_error("joint limit");
+                throw 42;
+            }
+            return ::Eigen::MatrixXd(0, 0);
+        }
+        System::ConstPtr system;
+        bool standard;
+    };
+
+    ControlSwitch::Ptr createSwitch(const std::string& name, const System::ConstPtr& system, double goal, double epsilon) {
+        Sensor::Ptr sensor(new JointConfigurationSensor());
+        sensor->setSystem(system);
+        JumpCondition::Ptr jump_condition(new JumpCondition());
+        jump_condition->setSensor(sensor);
+        jump_condition->setConstantGoal(goal);
+        jump_condition->setJumpCriterion(JumpCondition::NORM_L_INF);
+        jump_condition->setEpsilon(epsilon);
+        ControlSwitch::Ptr control_switch(new ControlSwitch());
+        control_switch->setName(name);
+        control_switch->add(jump_condition);
+        return control_switch;
+    }
+
+    ControlSwitch::Ptr createAsyncSwitch(const std::string& name, const System::ConstPtr& system, double goal, double epsilon) {
+        Sensor::Ptr sensor(new AsyncSensor("marker"));
+        sensor->setSystem(system);
+        JumpCondition::Ptr jump_condition(new JumpCondition());
+        jump_condition->setSensor(sensor);
+        jump_condition->setConstantGoal(goal);
+        jump_condition->setJumpCriterion(JumpCondition::NORM_L_INF);
+        jump_condition->setEpsilon(epsilon);
+        ControlSwitch::Ptr control_switch(new ControlSwitch());
+        control_switch->setName(name);
+        control_switch->add(jump_condition);
+        return control_switch;
+    }
+
+    // oscillates between up and down whenever the joint gets close to +-0.9
+    HybridAutomaton::Ptr createAutomaton(const System::ConstPtr& system, double epsilon) {
+        HybridAutomaton::Ptr ha(new HybridAutomaton);
+        ha->addControlMode(ControlMode::Ptr(new ReplayControlMode("up")));
+        ha->addControlMode(ControlMode::Ptr(new ReplayControlMode("down")));
+        ha->addControlSwitch("up", createSwitch("reached_top", system, 0.9, epsilon), "down");
+        ha->addControlSwitch("down", createSwitch("reached_bottom", system, -0.9, epsilon), "up");
+        ha->setCurrentControlMode("up");
+        return ha;
+    }
+}
+
+TEST(Replay, ReproducesTransitions) {
+    const std::string filename = "replay_test.hatrace";
+    const int num_ticks = 20000;
+
+    // record
+    boost::shared_ptr<SineSystem> sine(new SineSystem());
+    RecordingSystem::Ptr recording_system(new RecordingSystem(sine));
+    HybridAutomaton::Ptr recorded = createAutomaton(recording_system, 0.01);
+
+    TraceRecorder::Ptr recorder(new TraceRecorder());
+    ASSERT_TRUE(recorder->open(filename));
+    recorded->setTraceRecorder(recorder);
+    recorded->initialize(0.0);
+
+    std::vector<std::string> recorded_modes;
+    for (int i = 1; i < num_ticks; i++) {
+        sine->time = 0.001 * i;
+        recorded->step(sine->time);
+        recorded_modes.push_back(recorded->getCurrentControlMode()->getName());
+    }
+    recorder->close();
+    ASSERT_EQ(0u, recorder->getDroppedTicks());
+
+    Replay replay;
+    replay.load(filename);
+    EXPECT_EQ((unsigned long long)num_ticks, replay.getNumberOfTicks());
+    EXPECT_EQ(0u, replay.getDroppedTicks());
+    ASSERT_LE(4u, replay.getRecordedTransitions().size());
+    EXPECT_EQ("reached_top", replay.getRecordedTransitions()[0].control_switch);
+    EXPECT_EQ("down", replay.getRecordedTransitions()[0].target_mode);
+
+    // the same automaton reproduces all transitions exactly
+    ReplaySystem::Ptr system = replay.createSystem();
+    EXPECT_EQ(1, system->getDof());
+    Replay::Result result = replay.run(createAutomaton(system, 0.01), system);
+    EXPECT_TRUE(result.error.empty()) << result.error;
+    EXPECT_TRUE(result.matches);
+    EXPECT_EQ((unsigned long long)num_ticks, result.ticks);
+    EXPECT_TRUE(result.transitions == replay.getRecordedTransitions());
+
+    // modified automata in parallel
+    double epsilons[] = { 0.01, 0.001, 0.05, 0.01 };
+    std::vector<HybridAutomaton::Ptr> automata;
+    std::vector<ReplaySystem::Ptr> systems;
+    for (int i = 0; i < 4; i++) {
+        systems.push_back(replay.createSystem());
+        automata.push_back(createAutomaton(systems.back(), epsilons[i]));
+    }
+    std::vector<Replay::Result> results = replay.run(automata, systems, 2);
+    ASSERT_EQ(4u, results.size());
+    EXPECT_TRUE(results[0].matches);
+    EXPECT_TRUE(results[3].matches);
+    EXPECT_FALSE(results[1].matches);
+    EXPECT_FALSE(results[2].matches);
+    EXPECT_LT(replay.getRecordedTransitions()[0].tick, results[1].transitions[0].tick);
+    EXPECT_GT(replay.getRecordedTransitions()[0].tick, results[2].transitions[0].tick);
+    EXPECT_EQ(results[1].first_mismatch, replay.getRecordedTransitions()[0].tick);
+
+    std::remove(filename.c_str());
+}
+
+TEST(Replay, ReportsAnyException) {
+    const std::string filename = "replay_exception_test.hatrace";
+
+    boost::shared_ptr<SineSystem> sine(new SineSystem());
+    RecordingSystem::Ptr recording_system(new RecordingSystem(sine));
+    HybridAutomaton::Ptr recorded = createAutomaton(recording_system, 0.01);
+
+    TraceRecorder::Ptr recorder(new TraceRecorder());
+    ASSERT_TRUE(recorder->open(filename));
+    recorded->setTraceRecorder(recorder);
+    recorded->initialize(0.0);
+    for (int i = 1; i < 1000; i++) {
+        sine->time = 0.001 * i;
+        recorded->step(sine->time);
+    }
+    recorder->close();
+
+    Replay replay;
+    replay.load(filename);
+
+    // neither kind of exception may escape the worker threads
+    std::vector<HybridAutomaton::Ptr> automata;
+    std::vector<ReplaySystem::Ptr> systems;
+    for (int i = 0; i < 2; i++) {
+        systems.push_back(replay.createSystem());
+        HybridAutomaton::Ptr ha(new HybridAutomaton);
+        ha->addControlMode(ControlMode::Ptr(new ThrowingControlMode("up", systems.back(), i == 0)));
+        ha->addControlMode(ControlMode::Ptr(new ReplayControlMode("down")));
+        ha->addControlSwitch("up", createSwitch("reached_top", systems.back(), 0.9, 0.01), "down");
+        ha->setCurrentControlMode("up");
+        automata.push_back(ha);
+    }
+    std::vector<Replay::Result> results = replay.run(automata, systems, 2);
+    ASSERT_EQ(2u, results.size());
+    EXPECT_EQ("joint limit", results[0].error);
+    EXPECT_EQ("unknown exception", results[1].error);
+    for (int i = 0; i < 2; i++) {
+        EXPECT_FALSE(results[i].matches);
+        EXPECT_GT(1000u, results[i].ticks);
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(Replay, ReproducesAsyncSensors) {
+    const std::string filename = "replay_async_test.hatrace";
+    const int num_ticks = 10000;
+
+    // a marker that is tracked at a fifth of the control rate
+    SimulatedSystem::Ptr simulated_system(new SimulatedSystem(1));
+    SensorSource::Ptr marker(new SensorSource("marker", 1, 1));
+    simulated_system->addSensorSource(marker);
+    RecordingSystem::Ptr recording_system(new RecordingSystem(simulated_system));
+    EXPECT_TRUE(recording_system->getSensorSource("marker") == recording_system->getSensorSource("marker"));
+    EXPECT_FALSE(recording_system->getSensorSource("unknown"));
+
+    HybridAutomaton::Ptr recorded(new HybridAutomaton);
+    recorded->addControlMode(ControlMode::Ptr(new ReplayControlMode("up")));
+    recorded->addControlMode(ControlMode::Ptr(new ReplayControlMode("down")));
+    recorded->addControlSwitch("up", createAsyncSwitch("reached_top", recording_system, 0.9, 0.01), "down");
+    recorded->addControlSwitch("down", createAsyncSwitch("reached_bottom", recording_system, -0.9, 0.01), "up");
+    recorded->setCurrentControlMode("up");
+
+    TraceRecorder::Ptr recorder(new TraceRecorder());
+    ASSERT_TRUE(recorder->open(filename));
+    recorded->setTraceRecorder(recorder);
+    marker->publish(::Eigen::MatrixXd::Zero(1, 1), 0.0);
+    recorded->initialize(0.0);
+    for (int i = 1; i < num_ticks; i++) {
+        const double t = 0.001 * i;
+        if (i % 5 == 0)
+            marker->publish(::Eigen::MatrixXd::Constant(1, 1, std::sin(t)), t);
+        recorded->step(t);
+    }
+    recorder->close();
+
+    Replay replay;
+    replay.load(filename);
+    ASSERT_LE(2u, replay.getRecordedTransitions().size());
+
+    // the replayed sources deliver the samples in the same ticks
+    ReplaySystem::Ptr system = replay.createSystem();
+    HybridAutomaton::Ptr replayed(new HybridAutomaton);
+    replayed->addControlMode(ControlMode::Ptr(new ReplayControlMode("up")));
+    replayed->addControlMode(ControlMode::Ptr(new ReplayControlMode("down")));
+    replayed->addControlSwitch("up", createAsyncSwitch("reached_top", system, 0.9, 0.01), "down");
+    replayed->addControlSwitch("down", createAsyncSwitch("reached_bottom", system, -0.9, 0.01), "up");
+    replayed->setCurrentControlMode("up");
+
+    Replay::Result result = replay.run(replayed, system);
+    EXPECT_TRUE(result.error.empty()) << result.error;
+    EXPECT_TRUE(result.matches);
+    EXPECT_TRUE(result.transitions == replay.getRecordedTransitions());
+
+    SensorSource::Ptr replayed_marker = system->getSensorSource("marker");
+    ASSERT_TRUE(replayed_marker.get() != NULL);
+    EXPECT_EQ((unsigned long long)(num_ticks - 1) / 5 + 1, replayed_marker->getSequence());
+    EXPECT_DOUBLE_EQ(0.001 * ((num_ticks - 1) / 5 * 5), replayed_marker->getTime());
+
+    std::remove(filename.c_str());
+}
+
+TEST(ReplaySystem, ThrowsForUnrecordedValues) {
+    std::map<int, TraceReader::Channel> channels;
+    ReplaySystem system(channels);
+    EXPECT_THROW(system.getJointConfiguration(), std::string);
+    EXPECT_THROW(system.getFramePose("base"), std::string);
+    EXPECT_TRUE(system.subscribeToROSMessage("topic"));
+}
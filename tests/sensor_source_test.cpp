@@ -0,0 +1,329 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "hybrid_automaton/SensorSource.h"
+#include "hybrid_automaton/AsyncSensor.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "hybrid_automaton/JumpCondition.h"
+#include "hybrid_automaton/RigidBodyMotion.h"
+#include "tests/AllocationTracker.h"
+
+using namespace ::ha;
+
+namespace {
+
+	// publishes 6x1 samples whose entries all equal the sequence number
+	void publishSamples(SensorSource* source, int count)
+	{
+		::Eigen::MatrixXd value(6, 1);
+		for (int k = 1; k <= count; k++) {
+			value.setConstant(k);
+			source->publish(value, 0.001 * k);
+		}
+	}
+
+	// fails to connect the first few times, like a topic that is not advertised yet
+	class FlakySource : public SensorSource {
+	public:
+		FlakySource(const std::string& name, int failures)
+			: SensorSource(name), attempts(0), _failures(failures)
+		{
+		}
+
+		int attempts;
+
+	protected:
+		virtual bool _connect()
+		{
+			return ++attempts > _failures;
+		}
+
+		int _failures;
+	};
+
+}
+
+TEST(SensorSource, HandsOverWholeSamples) {
+	SensorSource source("wrench", 6, 1);
+	EXPECT_FALSE(source.fetch());
+	EXPECT_EQ(0u, source.getSequence());
+
+	const int count = 200000;
+	boost::thread producer(boost::bind(&publishSamples, &source, count));
+
+	unsigned long long last = 0;
+	int fetched = 0;
+	while (last < static_cast<unsigned long long>(count)) {
+		if (!source.fetch())
+			continue;
+		fetched++;
+
+		// never a torn sample, never an older one
+		const unsigned long long sequence = source.getSequence();
+		ASSERT_GT(sequence, last);
+		ASSERT_EQ(6, source.getValue().rows());
+		for (int i = 0; i < 6; i++)
+			ASSERT_EQ(static_cast<double>(sequence), source.getValue()(i));
+		EXPECT_DOUBLE_EQ(0.001 * sequence, source.getTime());
+		last = sequence;
+	}
+	producer.join();
+
+	EXPECT_GT(fetched, 0);
+	EXPECT_FALSE(source.fetch());
+}
+
+TEST(SensorSource, SubscriberRetriesOutsideTheControlThread) {
+	boost::shared_ptr<FlakySource> flaky(new FlakySource("marker", 2));
+	SensorSource::Ptr local(new SensorSource("local"));
+
+	SensorSourceSubscriber subscriber(0.001);
+	subscriber.add(flaky);
+	subscriber.add(local);
+	EXPECT_EQ(1, subscriber.subscribeAll());
+	EXPECT_TRUE(local->isSubscribed());
+	EXPECT_FALSE(flaky->isSubscribed());
+
+	subscriber.start();
+	for (int i = 0; i < 1000 && !flaky->isSubscribed(); i++)
+		boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+	subscriber.stop();
+
+	EXPECT_TRUE(flaky->isSubscribed());
+	EXPECT_EQ(3, flaky->attempts);
+	EXPECT_EQ(0, subscriber.subscribeAll());
+	EXPECT_EQ(3, flaky->attempts);
+
+	flaky->unsubscribe();
+	EXPECT_FALSE(flaky->isSubscribed());
+}
+
+TEST(SensorSource, AsyncSensorReadsTheLatestSample) {
+	// enable registration
+	AsyncSensor async_sensor;
+
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	SensorSource::Ptr source(new SensorSource("marker_pose", 4, 4));
+	robot->addSensorSource(source);
+
+	AsyncSensor::Ptr missing(new AsyncSensor("camera"));
+	missing->setSystem(robot);
+	EXPECT_THROW(missing->initialize(0.0), std::string);
+
+	AsyncSensor::Ptr sensor(new AsyncSensor("marker_pose"));
+	sensor->setSystem(robot);
+	sensor->initialize(0.0);
+	EXPECT_EQ(source, sensor->getSource());
+	EXPECT_FALSE(sensor->isActive());
+
+	// the first sample becomes the initial value
+	::Eigen::MatrixXd pose = ::Eigen::MatrixXd::Identity(4, 4);
+	pose(0, 3) = 0.5;
+	source->publish(pose, 0.01);
+	sensor->step(0.02);
+	EXPECT_TRUE(sensor->isActive());
+	EXPECT_TRUE(sensor->hasNewValue());
+	double sample_time = 0.0;
+	EXPECT_TRUE(sensor->getSampleTime(sample_time));
+	EXPECT_DOUBLE_EQ(0.01, sample_time);
+	EXPECT_LT((sensor->getCurrentValue() - pose).norm(), 1e-12);
+	EXPECT_LT(sensor->getRelativeCurrentValue().norm(), 1e-12);
+
+	sensor->step(0.03);
+	EXPECT_FALSE(sensor->hasNewValue());
+
+	// only the latest of several samples is seen
+	pose(1, 3) = 0.25;
+	source->publish(pose, 0.031);
+	pose(2, 3) = 0.125;
+	source->publish(pose, 0.032);
+	::Eigen::MatrixXd value(4, 4);
+	{
+		testing::ExpectNoAllocations guard("AsyncSensor::step");
+		sensor->step(0.04);
+		sensor->readCurrentValue(value);
+	}
+	EXPECT_TRUE(sensor->hasNewValue());
+	EXPECT_TRUE(sensor->getSampleTime(sample_time));
+	EXPECT_DOUBLE_EQ(0.032, sample_time);
+	EXPECT_LT((value - pose).norm(), 1e-12);
+	EXPECT_DOUBLE_EQ(0.125, sensor->getRelativeCurrentValue()(2, 3));
+}
+
+TEST(SensorSource, SensorsShareTheirSource) {
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	SensorSource::Ptr source(new SensorSource("distance", 1, 1));
+	robot->addSensorSource(source);
+
+	// differently configured sensors are not shared, both read the same mailbox
+	AsyncSensor::Ptr plain(new AsyncSensor("distance"));
+	AsyncSensor::Ptr extrapolating(new AsyncSensor("distance"));
+	extrapolating->setExtrapolate(true);
+	plain->setSystem(robot);
+	extrapolating->setSystem(robot);
+	plain->initialize(0.0);
+	extrapolating->initialize(0.0);
+
+	for (int k = 1; k <= 3; k++) {
+		const double t = 0.1 * k;
+		source->publish(::Eigen::MatrixXd::Constant(1, 1, t), t);
+		plain->step(t);
+		extrapolating->step(t);
+		EXPECT_TRUE(plain->hasNewValue());
+		EXPECT_TRUE(extrapolating->hasNewValue());
+		EXPECT_DOUBLE_EQ(t, plain->getCurrentValue()(0));
+		EXPECT_DOUBLE_EQ(t, extrapolating->getCurrentValue()(0));
+	}
+
+	// a sample that arrives during a control cycle is seen by all sensors in the next one
+	plain->step(0.35);
+	source->publish(::Eigen::MatrixXd::Constant(1, 1, 0.35), 0.35);
+	extrapolating->step(0.35);
+	EXPECT_DOUBLE_EQ(0.3, plain->getCurrentValue()(0));
+	EXPECT_NEAR(0.35, extrapolating->getCurrentValue()(0), 1e-12);
+	plain->step(0.4);
+	extrapolating->step(0.4);
+	EXPECT_TRUE(plain->hasNewValue());
+	EXPECT_TRUE(extrapolating->hasNewValue());
+	EXPECT_DOUBLE_EQ(0.35, plain->getCurrentValue()(0));
+	EXPECT_NEAR(0.4, extrapolating->getCurrentValue()(0), 1e-12);
+}
+
+TEST(SensorSource, StaleSamplesMakeConditionsUnknown) {
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	SensorSource::Ptr source(new SensorSource("distance", 1, 1));
+	robot->addSensorSource(source);
+
+	AsyncSensor::Ptr sensor(new AsyncSensor("distance"));
+	sensor->setMaxAge(0.05);
+	sensor->setLatency(0.02);
+	EXPECT_THROW(sensor->setMaxAge(-1.0), std::string);
+
+	JumpCondition::Ptr close_enough(new JumpCondition);
+	close_enough->setSensor(sensor);
+	close_enough->setConstantGoal(0.0);
+	close_enough->setEpsilon(0.1);
+	sensor->setSystem(robot);
+	close_enough->initialize(0.0);
+	EXPECT_FALSE(close_enough->isActive());
+	EXPECT_TRUE(close_enough->isUnknown());
+
+	// stamped at 0.1, acquired at 0.08
+	source->publish(::Eigen::MatrixXd::Constant(1, 1, 0.05), 0.1);
+	close_enough->step(0.1);
+	double sample_time = 0.0;
+	EXPECT_TRUE(sensor->getSampleTime(sample_time));
+	EXPECT_DOUBLE_EQ(0.08, sample_time);
+	EXPECT_TRUE(close_enough->isActive());
+	EXPECT_FALSE(close_enough->isUnknown());
+
+	close_enough->step(0.125);
+	EXPECT_TRUE(close_enough->isActive());
+
+	// no new sample for more than 50ms
+	close_enough->step(0.14);
+	EXPECT_TRUE(sensor->isStale());
+	EXPECT_FALSE(close_enough->isActive());
+	EXPECT_TRUE(close_enough->isUnknown());
+
+	source->publish(::Eigen::MatrixXd::Constant(1, 1, 0.5), 0.15);
+	close_enough->step(0.15);
+	EXPECT_FALSE(close_enough->isActive());
+	EXPECT_FALSE(close_enough->isUnknown());
+}
+
+TEST(SensorSource, ExtrapolatesToTheControlCycle) {
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	SensorSource::Ptr marker(new SensorSource("marker_pose", 4, 4));
+	SensorSource::Ptr distance(new SensorSource("distance", 2, 1));
+	robot->addSensorSource(marker);
+	robot->addSensorSource(distance);
+
+	AsyncSensor::Ptr pose_sensor(new AsyncSensor("marker_pose"));
+	pose_sensor->setExtrapolate(true);
+	pose_sensor->setSystem(robot);
+	pose_sensor->initialize(0.0);
+	AsyncSensor::Ptr distance_sensor(new AsyncSensor("distance"));
+	distance_sensor->setExtrapolate(true);
+	distance_sensor->setSystem(robot);
+	distance_sensor->initialize(0.0);
+
+	// a marker moving along a constant twist, seen with 30ms delay
+	::Eigen::Matrix<double, 6, 1> twist;
+	twist << 0.2, -0.1, 0.05, 0.3, 0.4, -0.2;
+	::Eigen::Matrix4d start = ::Eigen::Matrix4d::Identity();
+	start.topRightCorner<3, 1>() << 0.5, 0.0, 0.3;
+
+	::Eigen::Matrix4d motion;
+	for (int k = 0; k <= 2; k++) {
+		const double t = 0.1 * k;
+		expTwist(t * twist, motion);
+		marker->publish(start * motion, t);
+		::Eigen::MatrixXd d(2, 1);
+		d << 1.0 - t, 2.0 * t;
+		distance->publish(d, t);
+
+		pose_sensor->step(t + 0.03);
+		distance_sensor->step(t + 0.03);
+	}
+
+	expTwist(0.23 * twist, motion);
+	::Eigen::Matrix4d expected = start * motion;
+	EXPECT_LT((pose_sensor->getCurrentValue() - expected).norm(), 1e-9) << pose_sensor->getCurrentValue() << "\n\n" << expected;
+	EXPECT_NEAR(1.0 - 0.23, distance_sensor->getCurrentValue()(0), 1e-12);
+	EXPECT_NEAR(2.0 * 0.23, distance_sensor->getCurrentValue()(1), 1e-12);
+
+	// the value keeps moving between samples without allocating
+	::Eigen::MatrixXd value(4, 4);
+	{
+		testing::ExpectNoAllocations guard("AsyncSensor::step");
+		pose_sensor->step(0.25);
+		pose_sensor->readCurrentValue(value);
+	}
+	EXPECT_TRUE(pose_sensor->hasNewValue());
+	expTwist(0.25 * twist, motion);
+	expected = start * motion;
+	EXPECT_LT((value - expected).norm(), 1e-9);
+
+	// logPose inverts expTwist
+	::Eigen::Matrix<double, 6, 1> log;
+	logPose(motion, log);
+	EXPECT_LT((log - 0.25 * twist).norm(), 1e-12);
+}
+
+TEST(SensorSource, ConditionsSeeTheExtrapolatedValue) {
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	SensorSource::Ptr source(new SensorSource("distance", 1, 1));
+	robot->addSensorSource(source);
+
+	AsyncSensor::Ptr sensor(new AsyncSensor("distance"));
+	sensor->setExtrapolate(true);
+
+	// the distance drops below 0.5
+	JumpCondition::Ptr close_enough(new JumpCondition);
+	close_enough->setSensor(sensor);
+	close_enough->setConstantGoal(0.5);
+	close_enough->setJumpCriterion(JumpCondition::THRESH_LOWER_BOUND);
+	close_enough->setEpsilon(0.0);
+	sensor->setSystem(robot);
+
+	// samples every 100ms, approaching with 2m/s
+	source->publish(::Eigen::MatrixXd::Constant(1, 1, 1.0), 0.0);
+	close_enough->initialize(0.0);
+	close_enough->step(0.0);
+	EXPECT_FALSE(close_enough->isActive());
+	source->publish(::Eigen::MatrixXd::Constant(1, 1, 0.8), 0.1);
+	close_enough->step(0.1);
+	EXPECT_FALSE(close_enough->isActive());
+
+	// no further sample arrives, but the extrapolated distance crosses 0.5 at 0.25
+	close_enough->step(0.2);
+	EXPECT_FALSE(close_enough->isActive());
+	close_enough->step(0.24);
+	EXPECT_FALSE(close_enough->isActive());
+	close_enough->step(0.26);
+	EXPECT_TRUE(close_enough->isActive());
+}
@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <map>
+#include <string>
+
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/ClockSensor.h"
+#include "hybrid_automaton/SharedSensor.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "tests/MockDescriptionTreeNode.h"
+
+using ::testing::Return;
+using ::testing::DoAll;
+using ::testing::SetArgReferee;
+using ::testing::_;
+
+using namespace ::ha;
+
+namespace {
+
+	// counts how often it is initialized, stepped and read
+	class CountingSensor : public Sensor {
+	public:
+		CountingSensor() : initializations(0), steps(0), reads(0) {}
+		virtual ::Eigen::MatrixXd getCurrentValue() const { ++reads; return ::Eigen::MatrixXd::Constant(1, 1, steps); }
+		virtual void initialize(const double& t) { ++initializations; Sensor::initialize(t); }
+		virtual void step(const double& t) { ++steps; }
+		virtual DescriptionTreeNode::Ptr serialize(const DescriptionTree::ConstPtr& factory) const { return DescriptionTreeNode::Ptr(); }
+		virtual void deserialize(const DescriptionTreeNode::ConstPtr& tree, const System::ConstPtr& system, const HybridAutomaton* ha) {}
+		int initializations;
+		int steps;
+		mutable int reads;
+	protected:
+		virtual Sensor* _doClone() const { return new CountingSensor(*this); }
+	};
+
+	MockDescriptionTreeNode::Ptr createSensorNode(const std::string& frame_id)
+	{
+		std::map<std::string, std::string> attributes;
+		attributes["type"] = "ClockSensor";
+		attributes["frame_id"] = frame_id;
+
+		MockDescriptionTreeNode::Ptr node(new MockDescriptionTreeNode);
+		EXPECT_CALL(*node, getType())
+			.WillRepeatedly(Return("Sensor"));
+		EXPECT_CALL(*node, getAttributeString(std::string("type"), _))
+			.WillRepeatedly(DoAll(SetArgReferee<1>("ClockSensor"),Return(true)));
+		EXPECT_CALL(*node, getAllAttributes(_))
+			.WillRepeatedly(SetArgReferee<0>(attributes));
+		EXPECT_CALL(*node, getChildrenNodes(_))
+			.WillRepeatedly(Return(false));
+		return node;
+	}
+
+}
+
+TEST(SharedSensor, CreatedOncePerDescription) {
+	ClockSensor clock_sensor; // to enable registration
+
+	HybridAutomaton hybrid_automaton;
+	System::ConstPtr system;
+
+	Sensor::Ptr a = hybrid_automaton.createSharedSensor(createSensorNode("a"), system);
+	Sensor::Ptr b = hybrid_automaton.createSharedSensor(createSensorNode("b"), system);
+	Sensor::Ptr a2 = hybrid_automaton.createSharedSensor(createSensorNode("a"), system);
+
+	EXPECT_TRUE(a == a2);
+	EXPECT_FALSE(a == b);
+	EXPECT_EQ(2u, hybrid_automaton.getNumberOfSharedSensors());
+	EXPECT_EQ("ClockSensor", a->getType());
+	EXPECT_TRUE(a->isClock());
+
+	// sensors of another system are not shared
+	System::ConstPtr other_system(new SimulatedSystem(1));
+	Sensor::Ptr a4 = hybrid_automaton.createSharedSensor(createSensorNode("a"), other_system);
+	EXPECT_FALSE(a == a4);
+	EXPECT_EQ(3u, hybrid_automaton.getNumberOfSharedSensors());
+
+	// without sharing every node gets its own sensor
+	hybrid_automaton.setShareSensors(false);
+	Sensor::Ptr a3 = hybrid_automaton.createSharedSensor(createSensorNode("a"), system);
+	EXPECT_FALSE(a == a3);
+	EXPECT_EQ(3u, hybrid_automaton.getNumberOfSharedSensors());
+}
+
+TEST(SharedSensor, EvaluatedOncePerCycle) {
+	CountingSensor* counting_sensor = new CountingSensor;
+	Sensor::Ptr sensor(counting_sensor);
+	ControlCycle::Ptr cycle(new ControlCycle);
+	SharedSensor shared_sensor(sensor, cycle);
+
+	// three JumpConditions using the same sensor
+	{
+		ControlCycle::Scope scope(*cycle);
+		for (int i = 0; i < 3; i++)
+			shared_sensor.initialize(0.0);
+	}
+	EXPECT_EQ(1, counting_sensor->initializations);
+
+	// also if the time does not change
+	for (int cycle_number = 1; cycle_number <= 10; cycle_number++) {
+		ControlCycle::Scope scope(*cycle);
+		for (int i = 0; i < 3; i++) {
+			shared_sensor.step(0.01);
+			EXPECT_EQ(cycle_number, shared_sensor.getCurrentValue()(0, 0));
+		}
+	}
+	EXPECT_EQ(10, counting_sensor->steps);
+	EXPECT_EQ(1 + 10, counting_sensor->reads);
+
+	// outside of a cycle the sensor is read live
+	counting_sensor->steps = 42;
+	EXPECT_EQ(42, shared_sensor.getCurrentValue()(0, 0));
+	EXPECT_EQ(42, shared_sensor.getCurrentValue()(0, 0));
+	EXPECT_EQ(1 + 12, counting_sensor->reads);
+
+	// a new activation initializes again
+	{
+		ControlCycle::Scope scope(*cycle);
+		shared_sensor.initialize(1.0);
+	}
+	EXPECT_EQ(2, counting_sensor->initializations);
+}
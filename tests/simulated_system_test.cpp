@@ -0,0 +1,220 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <Eigen/Dense>
+
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "hybrid_automaton/HybridAutomaton.h"
+#include "hybrid_automaton/JointConfigurationSensor.h"
+#include "hybrid_automaton/ForceTorqueSensor.h"
+#include "hybrid_automaton/JointVelocitySensor.h"
+#include "hybrid_automaton/SubjointConfigurationSensor.h"
+#include "hybrid_automaton/FramePoseSensor.h"
+#include "hybrid_automaton/FrameOrientationSensor.h"
+#include "hybrid_automaton/FrameDisplacementSensor.h"
+#include "hybrid_automaton/ClockSensor.h"
+
+#include "tests/AllocationTracker.h"
+
+#include <cmath>
+
+using namespace ha;
+
+namespace {
+
+    // PD control towards the goal of its controller
+    class SimulatedControlSet : public ControlSet {
+    public:
+        SimulatedControlSet(const System::ConstPtr& system, const ::Eigen::MatrixXd& goal) : _system(system), _goal(goal) {}
+        virtual void initialize() {}
+        virtual void terminate() {}
+        virtual void switchControlSet(ControlSet::ConstPtr other_set) {}
+        virtual ::Eigen::MatrixXd step(const double& t) {
+            return 100.0 * (_goal - _system->getJointConfiguration()) - 20.0 * _system->getJointVelocity();
+        }
+    protected:
+        System::ConstPtr _system;
+        ::Eigen::MatrixXd _goal;
+    };
+}
+
+TEST(SimulatedSystem, ForwardKinematics) {
+    // planar arm: two joints about z, links of 1m along x
+    SimulatedSystem robot(0);
+    robot.addJoint(::Eigen::Vector3d::UnitZ(), ::Eigen::Vector3d::Zero());
+    robot.addJoint(::Eigen::Vector3d::UnitZ(), ::Eigen::Vector3d(1.0, 0.0, 0.0));
+    ::Eigen::MatrixXd tool = ::Eigen::MatrixXd::Identity(4, 4);
+    tool(0, 3) = 1.0;
+    robot.setToolOffset(tool);
+    EXPECT_EQ(2, robot.getDof());
+
+    ::Eigen::MatrixXd q(2, 1);
+    q << M_PI / 2.0, -M_PI / 2.0;
+    robot.setJointConfiguration(q);
+
+    ::Eigen::MatrixXd ee = robot.getFramePose("EE");
+    EXPECT_NEAR(1.0, ee(0, 3), 1e-12);
+    EXPECT_NEAR(1.0, ee(1, 3), 1e-12);
+    EXPECT_NEAR(1.0, ee(0, 0), 1e-12);
+
+    ::Eigen::MatrixXd link = robot.getFramePose("link_1");
+    EXPECT_NEAR(0.0, link(0, 3), 1e-12);
+    EXPECT_NEAR(1.0, link(1, 3), 1e-12);
+
+    robot.addFrame("elbow_marker", 0, ::Eigen::MatrixXd::Identity(4, 4));
+    EXPECT_TRUE(robot.getFramePose("elbow_marker").isApprox(robot.getFramePose("link_0")));
+    EXPECT_TRUE(robot.getFramePose("base").isIdentity());
+    EXPECT_THROW(robot.getFramePose("link_2"), std::string);
+    EXPECT_THROW(robot.getFramePose("unknown"), std::string);
+}
+
+TEST(SimulatedSystem, Integration) {
+    SimulatedSystem robot(3);
+    robot.setInputMode(SimulatedSystem::VELOCITY_INPUT);
+    for (int i = 0; i < 1000; i++)
+        robot.integrate(::Eigen::MatrixXd::Constant(3, 1, 0.5), 0.001);
+    EXPECT_NEAR(1.0, robot.getTime(), 1e-9);
+    EXPECT_TRUE(robot.getJointConfiguration().isApprox(::Eigen::MatrixXd::Constant(3, 1, 0.5)));
+
+    // damping brings a torque driven joint to rest
+    robot.setInputMode(SimulatedSystem::TORQUE_INPUT);
+    robot.setDynamics(1.0, 10.0);
+    for (int i = 0; i < 5000; i++)
+        robot.integrate(::Eigen::MatrixXd::Zero(3, 1), 0.001);
+    EXPECT_NEAR(0.0, robot.getJointVelocity().norm(), 1e-6);
+
+    EXPECT_THROW(robot.integrate(::Eigen::MatrixXd::Zero(2, 1), 0.001), std::string);
+}
+
+TEST(SimulatedSystem, NoiseIsDeterministic) {
+    SimulatedSystem a(2), b(2);
+    a.setMeasurementNoise(0.01, 42);
+    b.setMeasurementNoise(0.01, 42);
+    for (int i = 0; i < 10; i++) {
+        a.integrate(::Eigen::MatrixXd::Zero(2, 1), 0.001);
+        b.integrate(::Eigen::MatrixXd::Zero(2, 1), 0.001);
+    }
+    EXPECT_TRUE(a.getJointConfiguration() == b.getJointConfiguration());
+    EXPECT_FALSE(a.getJointConfiguration().isZero());
+}
+
+TEST(SimulatedSystem, ContactForce) {
+    // single vertical link: EE at z = 0.2 after a joint about y
+    SimulatedSystem robot(0);
+    robot.addJoint(::Eigen::Vector3d::UnitY(), ::Eigen::Vector3d::Zero());
+    ::Eigen::MatrixXd tool = ::Eigen::MatrixXd::Identity(4, 4);
+    tool(2, 3) = 0.2;
+    robot.setToolOffset(tool);
+
+    robot.setContactPlane(::Eigen::Vector3d::UnitZ(), 0.25, 1000.0);
+    EXPECT_NEAR(50.0, robot.getContactForce()(2), 1e-9);
+    ::Eigen::MatrixXd wrench = robot.getForceTorqueMeasurement();
+    EXPECT_NEAR(50.0, wrench(2), 1e-9);
+
+    robot.removeContactPlane();
+    EXPECT_TRUE(robot.getForceTorqueMeasurement().isZero());
+}
+
+TEST(SimulatedSystem, ConvergenceConditionFires) {
+    SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+    ::Eigen::MatrixXd goal = ::Eigen::MatrixXd::Constant(7, 1, 0.3);
+
+    ControlMode::Ptr move(new ControlMode("move"));
+    move->setControlSet(ControlSet::Ptr(new SimulatedControlSet(robot, goal)));
+    ControlMode::Ptr hold(new ControlMode("hold"));
+    hold->setControlSet(ControlSet::Ptr(new SimulatedControlSet(robot, goal)));
+
+    Sensor::Ptr sensor(new JointConfigurationSensor);
+    sensor->setSystem(robot);
+    JumpCondition::Ptr converged(new JumpCondition);
+    converged->setSensor(sensor);
+    converged->setConstantGoal(goal);
+    converged->setJumpCriterion(JumpCondition::NORM_L_INF);
+    converged->setEpsilon(0.001);
+    ControlSwitch::Ptr reached(new ControlSwitch);
+    reached->setName("reached");
+    reached->add(converged);
+
+    HybridAutomaton ha;
+    ha.addControlMode(move);
+    ha.addControlMode(hold);
+    ha.addControlSwitch("move", reached, "hold");
+    ha.setCurrentControlMode("move");
+    ha.initialize(0.0);
+
+    double t = 0.0;
+    while (t < 5.0 && ha.getCurrentControlMode() == move) {
+        t += 0.001;
+        robot->integrate(ha.step(t), 0.001);
+    }
+    EXPECT_EQ(hold, ha.getCurrentControlMode());
+    EXPECT_LT(t, 5.0);
+}
+
+TEST(SimulatedSystem, SensorReadsDoNotAllocate) {
+    SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+    robot->setJointConfiguration(::Eigen::MatrixXd::Constant(7, 1, 0.1));
+    robot->setContactPlane(::Eigen::Vector3d::UnitZ(), 2.0, 1000.0);
+
+    std::vector<int> index;
+    index.push_back(1);
+    index.push_back(4);
+    SubjointConfigurationSensor::Ptr subjoints(new SubjointConfigurationSensor);
+    subjoints->setIndex(index);
+    ForceTorqueSensor::Ptr ft(new ForceTorqueSensor);
+    ft->setFrameId("world");
+    ft->setFrame(::Eigen::MatrixXd::Identity(4, 4));
+
+    std::vector<Sensor::Ptr> sensors;
+    sensors.push_back(Sensor::Ptr(new JointConfigurationSensor));
+    sensors.push_back(Sensor::Ptr(new JointVelocitySensor));
+    sensors.push_back(subjoints);
+    sensors.push_back(Sensor::Ptr(new FramePoseSensor("EE")));
+    sensors.push_back(Sensor::Ptr(new FrameOrientationSensor("EE")));
+    sensors.push_back(Sensor::Ptr(new FrameDisplacementSensor("EE")));
+    sensors.push_back(ft);
+    sensors.push_back(Sensor::Ptr(new ClockSensor));
+    for (size_t i = 0; i < sensors.size(); i++) {
+        sensors[i]->setSystem(robot);
+        sensors[i]->initialize(0.0);
+    }
+
+    robot->integrate(::Eigen::MatrixXd::Constant(7, 1, 0.5), 0.1);
+    for (size_t i = 0; i < sensors.size(); i++)
+        sensors[i]->step(0.1);
+
+    // the read* methods return the same values as the get* methods
+    std::vector< ::Eigen::MatrixXd> current(sensors.size()), relative(sensors.size()), initial(sensors.size());
+    for (size_t i = 0; i < sensors.size(); i++) {
+        sensors[i]->readCurrentValue(current[i]);
+        sensors[i]->readRelativeCurrentValue(relative[i]);
+        sensors[i]->readInitialValue(initial[i]);
+        EXPECT_LT((current[i] - sensors[i]->getCurrentValue()).norm(), 1e-12) << "sensor " << i;
+        EXPECT_LT((relative[i] - sensors[i]->getRelativeCurrentValue()).norm(), 1e-12) << "sensor " << i;
+        EXPECT_LT((initial[i] - sensors[i]->getInitialValue()).norm(), 1e-12) << "sensor " << i;
+    }
+    EXPECT_GT(relative[0].norm(), 0.0);
+    EXPECT_GT(ft->getCurrentValue().norm(), 0.0);
+
+    // a condition on the EE pose reuses its buffers
+    JumpCondition::Ptr reached(new JumpCondition);
+    reached->setSensor(sensors[3]);
+    reached->setConstantGoal(robot->getFramePose("EE"));
+    reached->setJumpCriterion(JumpCondition::NORM_TRANSFORM);
+    reached->setEpsilon(0.01);
+    EXPECT_TRUE(reached->isActive());
+
+    if (!testing::AllocationTracker::isSupported())
+        return;
+
+    testing::ExpectNoAllocations guard("Sensor::read*");
+    for (int k = 0; k < 10; k++) {
+        for (size_t i = 0; i < sensors.size(); i++) {
+            sensors[i]->readCurrentValue(current[i]);
+            sensors[i]->readRelativeCurrentValue(relative[i]);
+            sensors[i]->readInitialValue(initial[i]);
+        }
+        reached->isActive();
+    }
+    EXPECT_EQ(0u, guard.getAllocations());
+}
@@ -0,0 +1,276 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hybrid_automaton/StreamingFilter.h"
+#include "hybrid_automaton/FilterSensor.h"
+#include "hybrid_automaton/ForceTorqueSensor.h"
+#include "hybrid_automaton/SimulatedSystem.h"
+#include "tests/AllocationTracker.h"
+#include "tests/MockDescriptionTreeNode.h"
+
+using ::testing::Return;
+using ::testing::DoAll;
+using ::testing::SetArgReferee;
+using ::testing::_;
+
+using namespace ::ha;
+
+namespace {
+
+	// deterministic noisy wrench-like samples
+	std::vector< ::Eigen::MatrixXd> createSamples(int count)
+	{
+		std::vector< ::Eigen::MatrixXd> samples;
+		unsigned int seed = 12345;
+		for (int k = 0; k < count; k++) {
+			::Eigen::MatrixXd x(6, 1);
+			for (int c = 0; c < 6; c++) {
+				seed = seed * 1103515245u + 12345u;
+				x(c) = c + ((seed >> 16) % 1000) / 100.0;
+			}
+			samples.push_back(x);
+		}
+		return samples;
+	}
+
+	double reference(StreamingFilter::Type type, const std::vector<double>& window)
+	{
+		std::vector<double> sorted(window);
+		std::sort(sorted.begin(), sorted.end());
+		const std::size_t n = sorted.size();
+		switch (type) {
+			case StreamingFilter::MEDIAN:
+				return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+			case StreamingFilter::WINDOW_MIN:
+				return sorted.front();
+			case StreamingFilter::WINDOW_MAX:
+				return sorted.back();
+			default: {
+				double sum = 0.0;
+				for (std::size_t i = 0; i < n; i++)
+					sum += sorted[i];
+				return sum / n;
+			}
+		}
+	}
+
+}
+
+TEST(StreamingFilter, WindowedFiltersMatchReference) {
+	const std::vector< ::Eigen::MatrixXd> samples = createSamples(50);
+	const StreamingFilter::Type types[] = { StreamingFilter::MEDIAN, StreamingFilter::WINDOW_MIN,
+		StreamingFilter::WINDOW_MAX, StreamingFilter::WINDOW_MEAN };
+
+	for (int t = 0; t < 4; t++) {
+		for (int window_size = 1; window_size <= 6; window_size++) {
+			StreamingFilter filter;
+			filter.setType(types[t]);
+			filter.setWindowSize(window_size);
+			filter.reset(samples[0]);
+
+			for (std::size_t k = 0; k < samples.size(); k++) {
+				if (k > 0)
+					filter.update(samples[k], 0.001);
+
+				const std::size_t first = (k + 1 >= static_cast<std::size_t>(window_size)) ? k + 1 - window_size : 0;
+				for (int c = 0; c < 6; c++) {
+					std::vector<double> window;
+					for (std::size_t i = first; i <= k; i++)
+						window.push_back(samples[i](c));
+					EXPECT_NEAR(reference(types[t], window), filter.getValue()(c), 1e-12)
+						<< StreamingFilter::typeToString(types[t]) << " window " << window_size << " sample " << k << " channel " << c;
+				}
+			}
+		}
+	}
+}
+
+TEST(StreamingFilter, ButterworthPassesLowAndAttenuatesHighFrequencies) {
+	const double dt = 0.001;
+	StreamingFilter filter;
+	filter.setType(StreamingFilter::BUTTERWORTH);
+	filter.setCutoffFrequency(10.0);
+
+	// starts in the steady state of the first sample
+	filter.reset(::Eigen::MatrixXd::Constant(6, 1, 2.0));
+	for (int k = 0; k < 100; k++)
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 2.0), dt);
+	EXPECT_NEAR(2.0, filter.getValue()(0), 1e-9);
+
+	// follows a step
+	for (int k = 0; k < 1000; k++)
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0), dt);
+	EXPECT_NEAR(5.0, filter.getValue()(5), 1e-6);
+
+	// 200 Hz is damped by about (10 / 200)^2
+	double peak = 0.0;
+	for (int k = 0; k < 2000; k++) {
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0 + sin(2.0 * 3.14159265358979 * 200.0 * k * dt)), dt);
+		if (k > 1000)
+			peak = std::max(peak, std::abs(filter.getValue()(3) - 5.0));
+	}
+	EXPECT_LT(peak, 0.005);
+	EXPECT_GT(peak, 0.001);
+
+	// without cutoff it passes its input through
+	filter.setCutoffFrequency(0.0);
+	filter.update(::Eigen::MatrixXd::Constant(6, 1, 7.0), dt);
+	EXPECT_DOUBLE_EQ(7.0, filter.getValue()(1));
+}
+
+TEST(StreamingFilter, ButterworthKeepsItsStateOverGaps) {
+	const double dt = 0.001;
+	StreamingFilter filter;
+	filter.setType(StreamingFilter::BUTTERWORTH);
+	filter.setCutoffFrequency(10.0);
+	filter.reset(::Eigen::MatrixXd::Constant(6, 1, 5.0));
+	for (int k = 0; k < 10; k++)
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0), dt);
+
+	// a single long sample period (above the Nyquist frequency of the cutoff) must not restart the filter at 0
+	filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0), 0.1);
+	EXPECT_NEAR(5.0, filter.getValue()(0), 1e-9);
+	for (int k = 0; k < 100; k++) {
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0), dt);
+		ASSERT_NEAR(5.0, filter.getValue()(0), 1e-9) << "sample " << k << " after the gap";
+	}
+
+	// the same for a gap below the Nyquist frequency and for jitter of the sample period
+	filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0), 0.02);
+	for (int k = 0; k < 100; k++) {
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 5.0), (k % 2) ? 0.00102 : 0.00098);
+		ASSERT_NEAR(5.0, filter.getValue()(0), 1e-9) << "sample " << k << " after the gap";
+	}
+
+	// and it still follows a step afterwards
+	for (int k = 0; k < 1000; k++)
+		filter.update(::Eigen::MatrixXd::Constant(6, 1, 2.0), dt);
+	EXPECT_NEAR(2.0, filter.getValue()(0), 1e-6);
+}
+
+TEST(StreamingFilter, ChecksItsParameters) {
+	StreamingFilter filter;
+	EXPECT_THROW(filter.setWindowSize(0), std::string);
+	EXPECT_THROW(filter.setTimeConstant(-1.0), std::string);
+	EXPECT_THROW(filter.setCutoffFrequency(-1.0), std::string);
+	EXPECT_THROW(StreamingFilter::typeFromString("kalman"), std::string);
+	EXPECT_EQ(StreamingFilter::WINDOW_MAX, StreamingFilter::typeFromString(StreamingFilter::typeToString(StreamingFilter::WINDOW_MAX)));
+
+	// samples of another size restart the filter
+	filter.setType(StreamingFilter::WINDOW_MEAN);
+	filter.setWindowSize(3);
+	filter.reset(::Eigen::MatrixXd::Constant(6, 1, 1.0));
+	filter.update(::Eigen::MatrixXd::Constant(3, 1, 4.0), 0.001);
+	EXPECT_EQ(3, filter.getValue().rows());
+	EXPECT_DOUBLE_EQ(4.0, filter.getValue()(0));
+}
+
+TEST(StreamingFilter, FilteringForceTorqueDoesNotAllocate) {
+	if (!testing::AllocationTracker::isSupported())
+		return;
+
+	// enable registration
+	FilterSensor filter_sensor;
+	ForceTorqueSensor ft_sensor;
+
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	robot->setJointConfiguration(::Eigen::MatrixXd::Constant(7, 1, 0.1));
+	robot->setContactPlane(::Eigen::Vector3d::UnitZ(), 2.0, 1000.0);
+
+	const StreamingFilter::Type types[] = { StreamingFilter::LOW_PASS, StreamingFilter::BUTTERWORTH, StreamingFilter::MEDIAN,
+		StreamingFilter::WINDOW_MIN, StreamingFilter::WINDOW_MAX, StreamingFilter::WINDOW_MEAN };
+	for (int t = 0; t < 6; t++) {
+		StreamingFilter parameters;
+		parameters.setType(types[t]);
+		parameters.setTimeConstant(0.01);
+		parameters.setCutoffFrequency(20.0);
+		parameters.setWindowSize(7);
+
+		ForceTorqueSensor::Ptr ft(new ForceTorqueSensor);
+		ft->setFrame(::Eigen::MatrixXd::Identity(4, 4));
+
+		FilterSensor::Ptr filter(new FilterSensor);
+		filter->setFilter(parameters);
+		filter->addOperand(ft);
+		filter->setSystem(robot);
+		filter->initialize(0.0);
+
+		::Eigen::MatrixXd value(6, 1);
+		{
+			testing::ExpectNoAllocations guard(StreamingFilter::typeToString(types[t]));
+			for (int k = 1; k <= 100; k++) {
+				filter->step(k * 0.001);
+				filter->readCurrentValue(value);
+			}
+		}
+	}
+}
+
+TEST(StreamingFilter, FilterSensorSelectsTheFilter) {
+	// enable registration
+	FilterSensor filter_sensor;
+	ForceTorqueSensor ft_sensor;
+
+	std::map<std::string, std::string> attributes;
+	attributes["type"] = "ForceTorqueSensor";
+	MockDescriptionTreeNode::Ptr ft_node(new MockDescriptionTreeNode);
+	EXPECT_CALL(*ft_node, getType())
+		.WillRepeatedly(Return("Sensor"));
+	EXPECT_CALL(*ft_node, getAttributeString(_, _))
+		.WillRepeatedly(Return(false));
+	EXPECT_CALL(*ft_node, getAttributeString(std::string("type"), _))
+		.WillRepeatedly(DoAll(SetArgReferee<1>(std::string("ForceTorqueSensor")),Return(true)));
+	EXPECT_CALL(*ft_node, getAllAttributes(_))
+		.WillRepeatedly(SetArgReferee<0>(attributes));
+
+	DescriptionTreeNode::ConstNodeList operands;
+	operands.push_back(ft_node);
+
+	attributes["type"] = "FilterSensor";
+	attributes["filter"] = "median";
+	attributes["window"] = "5";
+	MockDescriptionTreeNode::Ptr node(new MockDescriptionTreeNode);
+	EXPECT_CALL(*node, getType())
+		.WillRepeatedly(Return("Sensor"));
+	EXPECT_CALL(*node, getAttributeString(_, _))
+		.WillRepeatedly(Return(false));
+	EXPECT_CALL(*node, getAttributeString(std::string("type"), _))
+		.WillRepeatedly(DoAll(SetArgReferee<1>(std::string("FilterSensor")),Return(true)));
+	EXPECT_CALL(*node, getAttributeString(std::string("filter"), _))
+		.WillRepeatedly(DoAll(SetArgReferee<1>(std::string("median")),Return(true)));
+	EXPECT_CALL(*node, getAttributeString(std::string("window"), _))
+		.WillRepeatedly(DoAll(SetArgReferee<1>(std::string("5")),Return(true)));
+	EXPECT_CALL(*node, getAllAttributes(_))
+		.WillRepeatedly(SetArgReferee<0>(attributes));
+	EXPECT_CALL(*node, getChildrenNodes(_))
+		.WillRepeatedly(DoAll(SetArgReferee<0>(operands),Return(true)));
+	EXPECT_CALL(*node, getChildrenNodes(std::string("Sensor"), _))
+		.WillRepeatedly(DoAll(SetArgReferee<1>(operands),Return(true)));
+
+	SimulatedSystem::Ptr robot(new SimulatedSystem(7));
+	robot->setJointConfiguration(::Eigen::MatrixXd::Constant(7, 1, 0.1));
+	robot->setContactPlane(::Eigen::Vector3d::UnitZ(), 2.0, 1000.0);
+	Sensor::Ptr sensor = HybridAutomaton::createSensor(node, robot, NULL);
+	FilterSensor::Ptr filter = boost::dynamic_pointer_cast<FilterSensor>(sensor);
+	ASSERT_TRUE(filter);
+	EXPECT_EQ(StreamingFilter::MEDIAN, filter->getFilter().getType());
+	EXPECT_EQ(5, filter->getFilter().getWindowSize());
+	ASSERT_EQ(1u, filter->getOperands().size());
+
+	// a single spike does not get through the median
+	filter->initialize(0.0);
+	::Eigen::MatrixXd before = filter->getCurrentValue();
+	ASSERT_GT(before.norm(), 0.0);
+	robot->setContactPlane(::Eigen::Vector3d::UnitZ(), -10.0, 1000.0);
+	filter->step(0.001);
+	robot->setContactPlane(::Eigen::Vector3d::UnitZ(), 2.0, 1000.0);
+	filter->step(0.002);
+	filter->step(0.003);
+	EXPECT_LT((filter->getCurrentValue() - before).norm(), 1e-12);
+}
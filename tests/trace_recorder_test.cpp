@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "hybrid_automaton/TraceRecorder.h"
+#include "hybrid_automaton/ControlMode.h"
+#include "hybrid_automaton/ControlSwitch.h"
+#include "hybrid_automaton/JumpCondition.h"
+#include "hybrid_automaton/ClockSensor.h"
+#include "tests/AllocationTracker.h"
+
+#include <cstdio>
+#include <limits>
+
+using namespace ha;
+
+TEST(TraceRecorder, RoundTrip) {
+    const std::string filename = "trace_recorder_test.hatrace";
+
+    ControlMode::Ptr m1(new ControlMode("m1"));
+    ControlMode::Ptr m2(new ControlMode("m2"));
+    ControlSwitch::Ptr cs(new ControlSwitch());
+    cs->setName("cs");
+    JumpCondition::Ptr jc(new JumpCondition());
+    cs->add(jc);
+    Sensor::Ptr sensor(new ClockSensor());
+
+    TraceRecorder recorder(1 << 16, 1e-3);
+    ASSERT_TRUE(recorder.open(filename, 0.0));
+
+    const int num_ticks = 100;
+    ::Eigen::MatrixXd value(3, 1);
+    for (int i = 0; i < num_ticks; i++) {
+        const double t = 0.001 * i;
+        TraceRecorder::TickScope scope(&recorder, t, (i < 50) ? m1.get() : m2.get());
+        EXPECT_EQ(&recorder, TraceRecorder::current());
+
+        recorder.beginSwitch(cs.get());
+        value << t, -t, 0.1234567;
+        recorder.recordSensorValue(jc.get(), sensor.get(), value);
+        // recorded only once per tick
+        recorder.recordSensorValue(jc.get(), sensor.get(), value);
+        recorder.recordCriterion(jc.get(), (i == 10) ? std::numeric_limits<double>::infinity() : 1.0 - t);
+
+        ::Eigen::MatrixXd system_value(1, 1);
+        system_value << 1.0 / (i + 1);
+        recorder.recordSystemValue("system", system_value);
+
+        if (i == 49)
+            recorder.recordTransition(cs.get(), m2.get());
+    }
+    EXPECT_TRUE(TraceRecorder::current() == NULL);
+    recorder.close();
+
+    EXPECT_EQ((unsigned long long)num_ticks, recorder.getRecordedTicks());
+    EXPECT_EQ(0u, recorder.getDroppedTicks());
+
+    TraceReader reader;
+    reader.open(filename);
+    EXPECT_DOUBLE_EQ(1e-3, reader.getQuantum());
+
+    TraceReader::Tick tick;
+    int i = 0;
+    while (reader.readTick(tick)) {
+        const double t = 0.001 * i;
+        EXPECT_EQ(t, tick.time);
+        EXPECT_EQ((i < 50) ? "m1" : "m2", reader.getChannelName(tick.mode));
+        ASSERT_EQ(3u, tick.values.size());
+
+        EXPECT_EQ("cs/0/ClockSensor", reader.getChannelName(tick.values[0].channel));
+        ASSERT_EQ(3, tick.values[0].value.rows());
+        EXPECT_NEAR(t, tick.values[0].value(0), 0.5e-3);
+        EXPECT_NEAR(-t, tick.values[0].value(1), 0.5e-3);
+        EXPECT_NEAR(0.1234567, tick.values[0].value(2), 0.5e-3);
+
+        EXPECT_EQ("cs/0", reader.getChannelName(tick.values[1].channel));
+        if (i == 10)
+            EXPECT_EQ(std::numeric_limits<double>::infinity(), tick.values[1].value(0));
+        else
+            EXPECT_NEAR(1.0 - t, tick.values[1].value(0), 0.5e-3);
+
+        // system values are lossless
+        EXPECT_EQ(1.0 / (i + 1), tick.values[2].value(0));
+
+        if (i == 49) {
+            ASSERT_EQ(1u, tick.transitions.size());
+            EXPECT_EQ("cs", reader.getChannelName(tick.transitions[0].control_switch));
+            EXPECT_EQ("m2", reader.getChannelName(tick.transitions[0].target_mode));
+        } else {
+            EXPECT_TRUE(tick.transitions.empty());
+        }
+        i++;
+    }
+    EXPECT_EQ(num_ticks, i);
+    EXPECT_EQ(reader.getChannelName(tick.values[0].channel),
+              reader.getChannelName(reader.findChannel(TraceRecorder::SENSOR_CHANNEL, "cs/0/ClockSensor")));
+
+    std::remove(filename.c_str());
+}
+
+TEST(TraceRecorder, ChannelsAreKeyedByName) {
+    const std::string filename = "trace_recorder_test_names.hatrace";
+
+    ControlMode::Ptr m1(new ControlMode("m1"));
+    ControlMode::Ptr m2(new ControlMode("m2"));
+    ControlSwitch::Ptr cs(new ControlSwitch());
+    cs->setName("cs");
+    JumpCondition::Ptr jc(new JumpCondition());
+    Sensor::Ptr sensor(new ClockSensor());
+    jc->setSensor(sensor);
+    cs->add(jc);
+
+    TraceRecorder recorder(1 << 16, 1e-3);
+    ASSERT_TRUE(recorder.open(filename, 0.0));
+
+    ::Eigen::MatrixXd value = ::Eigen::MatrixXd::Zero(1, 1);
+    recorder.registerControlMode(m1.get());
+    recorder.registerControlSwitch(cs.get(), m2.get());
+    {
+        TraceRecorder::TickScope scope(&recorder, 0.0, m1.get());
+        recorder.beginSwitch(cs.get());
+        recorder.recordSensorValue(jc.get(), sensor.get(), value);
+        recorder.recordCriterion(jc.get(), 1.0);
+    }
+
+    // the same addresses in an automaton with other names, e.g. one that was loaded again
+    m1->setName("m3");
+    cs->setName("cs2");
+    recorder.registerControlMode(m1.get());
+    recorder.registerControlSwitch(cs.get(), m2.get());
+    {
+        TraceRecorder::TickScope scope(&recorder, 0.001, m1.get());
+        recorder.beginSwitch(cs.get());
+        recorder.recordCriterion(jc.get(), 2.0);
+    }
+
+    // other objects with the old names continue the old channels, registered they do not allocate
+    ControlMode::Ptr m1_again(new ControlMode("m1"));
+    ControlSwitch::Ptr cs_again(new ControlSwitch());
+    cs_again->setName("cs");
+    JumpCondition::Ptr jc_again(new JumpCondition());
+    jc_again->setSensor(sensor);
+    cs_again->add(jc_again);
+    recorder.registerControlMode(m1_again.get());
+    recorder.registerControlSwitch(cs_again.get(), m2.get());
+    {
+        TraceRecorder::TickScope scope(&recorder, 0.002, m1_again.get());
+        testing::ExpectNoAllocations guard("TraceRecorder");
+        recorder.beginSwitch(cs_again.get());
+        recorder.recordSensorValue(jc_again.get(), sensor.get(), value);
+        recorder.recordCriterion(jc_again.get(), 3.0);
+    }
+    recorder.close();
+
+    TraceReader reader;
+    reader.open(filename);
+    std::vector<TraceReader::Tick> ticks(3);
+    for (int i = 0; i < 3; i++)
+        ASSERT_TRUE(reader.readTick(ticks[i]));
+
+    EXPECT_EQ("m1", reader.getChannelName(ticks[0].mode));
+    EXPECT_EQ("m3", reader.getChannelName(ticks[1].mode));
+    EXPECT_EQ(ticks[0].mode, ticks[2].mode);
+
+    ASSERT_EQ(2u, ticks[0].values.size());
+    EXPECT_EQ("cs/0", reader.getChannelName(ticks[0].values[1].channel));
+    ASSERT_EQ(1u, ticks[1].values.size());
+    EXPECT_EQ("cs2/0", reader.getChannelName(ticks[1].values[0].channel));
+    ASSERT_EQ(2u, ticks[2].values.size());
+    EXPECT_EQ(ticks[0].values[0].channel, ticks[2].values[0].channel);
+    EXPECT_EQ(ticks[0].values[1].channel, ticks[2].values[1].channel);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TraceRecorder, DropsTicksWhenFull) {
+    const std::string filename = "trace_recorder_test_drop.hatrace";
+
+    ControlMode::Ptr m1(new ControlMode("m1"));
+    TraceRecorder recorder(1024, 1e-6);
+    ASSERT_TRUE(recorder.open(filename, 0.0));
+
+    // without a writer thread nobody empties the ring buffer
+    ::Eigen::MatrixXd value = ::Eigen::MatrixXd::Random(10, 1);
+    int num_ticks = 0;
+    while (recorder.getDroppedTicks() < 5) {
+        TraceRecorder::TickScope scope(&recorder, 0.001 * num_ticks, m1.get());
+        recorder.recordSystemValue("system", value);
+        num_ticks++;
+    }
+    recorder.flush();
+    for (int i = 0; i < 3; i++, num_ticks++) {
+        TraceRecorder::TickScope scope(&recorder, 0.001 * num_ticks, m1.get());
+        recorder.recordSystemValue("system", value);
+    }
+    recorder.close();
+
+    EXPECT_EQ((unsigned long long)num_ticks, recorder.getRecordedTicks() + recorder.getDroppedTicks());
+
+    TraceReader reader;
+    reader.open(filename);
+    TraceReader::Tick tick;
+    unsigned long long ticks = 0, dropped = 0;
+    while (reader.readTick(tick)) {
+        ticks++;
+        dropped += tick.dropped_before;
+        ASSERT_EQ(1u, tick.values.size());
+        EXPECT_TRUE(tick.values[0].value == value);
+    }
+    EXPECT_EQ(recorder.getRecordedTicks(), ticks);
+    EXPECT_EQ(recorder.getDroppedTicks(), dropped);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TraceReader, RejectsOtherFiles) {
+    const std::string filename = "trace_recorder_test_invalid.hatrace";
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    std::fputs("<HybridAutomaton/>", file);
+    std::fclose(file);
+
+    TraceReader reader;
+    EXPECT_THROW(reader.open(filename), std::string);
+
+    std::remove(filename.c_str());
+}